@@ -0,0 +1,219 @@
+`timescale 1ns/1ps
+
+// AXI4 master (read channels only) fetching a region of interest of a costmap in memory.
+// The ROI is cfg_height rows of cfg_width cells (one byte per cell); row y starts at
+// cfg_base + y * cfg_stride. Base and stride must be multiples of 4 bytes, the width can be anything.
+// Each row is read with INCR bursts of at most MAX_BURST_LEN beats that never cross a 4 KB page,
+// and up to MAX_OUTSTANDING bursts are in flight. A burst is only requested once the read FIFO has
+// room for all its beats, so RREADY stays high and the memory can stream every burst at full rate
+// while the engine takes the cells at its own pace.
+// The cells leave on m_axis in memory order, first cell in the MSBs of the beat (the order of s_axis),
+// m_axis_tbytes gives the number of cells in the beat and m_axis_tlast marks the end of a ROI row.
+module axi_roi_reader #(
+    parameter ADDR_WIDTH      = 32,
+    parameter BUS_WIDTH       = 32,
+    parameter MAX_BURST_LEN   = 16,   // beats per burst (1..256)
+    parameter MAX_OUTSTANDING = 4,    // bursts in flight
+    parameter FIFO_DEPTH      = 64    // read FIFO words (power of 2, MAX_BURST_LEN at least)
+)(
+    input  clk,
+    input  rstn,
+
+    // Control
+    input                       start,       // one cycle pulse, samples the ROI registers
+    input  [ADDR_WIDTH - 1 : 0] cfg_base,
+    input  [ADDR_WIDTH - 1 : 0] cfg_stride,  // bytes between two ROI rows
+    input  [15 : 0]             cfg_width,   // cells per ROI row
+    input  [15 : 0]             cfg_height,  // ROI rows
+    output                      busy,        // until the last cell left on m_axis
+    output reg                  error,       // a burst answered SLVERR/DECERR, sticky until the next start
+
+    // AXI4 Read Address Channel
+    output [ADDR_WIDTH - 1 : 0] m_axi_araddr,
+    output [7 : 0]              m_axi_arlen,
+    output [2 : 0]              m_axi_arsize,
+    output [1 : 0]              m_axi_arburst,
+    output                      m_axi_arvalid,
+    input                       m_axi_arready,
+
+    // AXI4 Read Data Channel
+    input  [BUS_WIDTH - 1 : 0]  m_axi_rdata,
+    input  [1 : 0]              m_axi_rresp,
+    input                       m_axi_rlast,
+    input                       m_axi_rvalid,
+    output                      m_axi_rready,
+
+    // AXI Stream Master Interface (ROI cells)
+    output [BUS_WIDTH - 1 : 0]  m_axis_tdata,
+    output [$clog2(BUS_WIDTH / 8 + 1) - 1 : 0] m_axis_tbytes,
+    output                      m_axis_tlast,
+    output                      m_axis_tvalid,
+    input                       m_axis_tready
+);
+
+    localparam BYTES     = BUS_WIDTH / 8;
+    localparam BYTE_BITS = $clog2(BYTES);
+    localparam PAGE      = 4096;
+    localparam FIFO_PTR  = $clog2(FIFO_DEPTH);
+    localparam WORD_WIDTH = 1 + (BYTE_BITS + 1) + BUS_WIDTH;   // {tlast, tbytes, tdata}
+
+    // ROI sampled on start
+    reg [ADDR_WIDTH - 1 : 0] roi_stride;
+    reg [15 : 0]             roi_height;
+    reg [15 : 0]             words_per_row;   // beats per ROI row
+    reg [BYTE_BITS : 0]      last_bytes;      // cells in the last beat of a row
+
+    // Address side
+    reg                      ar_active;
+    reg [ADDR_WIDTH - 1 : 0] ar_row_addr;     // first byte of the current row
+    reg [15 : 0]             ar_word;         // next beat of the current row
+    reg [15 : 0]             ar_row;
+    reg [$clog2(MAX_OUTSTANDING + 1) - 1 : 0] outstanding;
+    reg [FIFO_PTR : 0]       pending;         // beats requested and not received yet
+
+    // Read FIFO
+    wire [FIFO_PTR : 0]      fifo_level;
+    wire                     fifo_ready;
+    wire [BUS_WIDTH - 1 : 0] r_cells;
+
+    // Data side
+    reg                      r_busy;
+    reg [15 : 0]             rd_word;
+    reg [15 : 0]             rd_row;
+
+    wire [ADDR_WIDTH - 1 : 0] ar_addr = ar_row_addr + (ar_word << BYTE_BITS);
+    wire [15 : 0] words_left   = words_per_row - ar_word;
+    wire [12 : 0] page_words   = (PAGE - ar_addr[11 : 0]) >> BYTE_BITS;   // beats before the next 4 KB page
+    wire [15 : 0] burst_words  = (words_left < MAX_BURST_LEN) ? ((words_left < page_words) ? words_left : page_words)
+                                                              : ((MAX_BURST_LEN < page_words) ? MAX_BURST_LEN : page_words);
+
+    wire ar_fire = m_axi_arvalid && m_axi_arready;
+    wire r_fire  = m_axi_rvalid && m_axi_rready;
+    wire row_end = (rd_word == words_per_row - 1);
+    wire fifo_room = (fifo_level + pending + burst_words) <= FIFO_DEPTH;
+
+    assign m_axi_araddr  = ar_addr;
+    assign m_axi_arlen   = burst_words - 1;
+    assign m_axi_arsize  = BYTE_BITS;
+    assign m_axi_arburst = 2'b01;   // INCR
+    assign m_axi_arvalid = ar_active && (outstanding < MAX_OUTSTANDING) && fifo_room;
+
+    // The FIFO always has room for the beats of the bursts in flight
+    assign m_axi_rready  = fifo_ready;
+    assign busy          = r_busy || (fifo_level != 0);
+
+    // memory is little endian (lowest address in the LSBs), the stream puts the first cell in the MSBs
+    genvar b;
+    generate
+        for (b = 0; b < BYTES; b = b + 1) begin
+            assign r_cells[BUS_WIDTH - 1 - b*8 -: 8] = m_axi_rdata[b*8 +: 8];
+        end
+    endgenerate
+
+    fifo_fwft #(
+        .DATAWIDTH(WORD_WIDTH),
+        .DEPTH(FIFO_DEPTH),
+        .PTR_WIDTH(FIFO_PTR)
+    ) read_fifo (
+        .clk(clk),
+        .rstn(rstn && !start),
+
+        .s_tvalid(m_axi_rvalid),
+        .s_tdata({row_end, (row_end ? last_bytes : BYTES[BYTE_BITS : 0]), r_cells}),
+        .s_tready(fifo_ready),
+
+        .m_tready(m_axis_tready),
+        .m_tdata({m_axis_tlast, m_axis_tbytes, m_axis_tdata}),
+        .m_tvalid(m_axis_tvalid),
+
+        .prog_full_thresh(FIFO_DEPTH[FIFO_PTR : 0]),
+        .prog_empty_thresh({(FIFO_PTR + 1){1'b0}}),
+        .almost_full(),
+        .almost_empty(),
+        .level(fifo_level)
+    );
+
+    // Address generator
+    always @(posedge clk) begin
+        if (!rstn) begin
+            ar_active     <= 1'b0;
+            ar_row_addr   <= 0;
+            ar_word       <= 0;
+            ar_row        <= 0;
+            roi_stride    <= 0;
+            roi_height    <= 0;
+            words_per_row <= 0;
+            last_bytes    <= 0;
+        end
+        else if (start) begin
+            ar_active     <= (cfg_width != 0) && (cfg_height != 0);
+            ar_row_addr   <= {cfg_base[ADDR_WIDTH - 1 : BYTE_BITS], {BYTE_BITS{1'b0}}};
+            ar_word       <= 0;
+            ar_row        <= 0;
+            roi_stride    <= {cfg_stride[ADDR_WIDTH - 1 : BYTE_BITS], {BYTE_BITS{1'b0}}};
+            roi_height    <= cfg_height;
+            words_per_row <= (cfg_width + BYTES - 1) >> BYTE_BITS;
+            last_bytes    <= (cfg_width[BYTE_BITS - 1 : 0] == 0) ? BYTES : cfg_width[BYTE_BITS - 1 : 0];
+        end
+        else if (ar_fire) begin
+            if (burst_words == words_left) begin
+                // last burst of the row
+                ar_word     <= 0;
+                ar_row      <= ar_row + 1;
+                ar_row_addr <= ar_row_addr + roi_stride;
+                if (ar_row == roi_height - 1)
+                    ar_active <= 1'b0;
+            end
+            else begin
+                ar_word <= ar_word + burst_words;
+            end
+        end
+    end
+
+    // Bursts and beats in flight
+    always @(posedge clk) begin
+        if (!rstn || start) begin
+            outstanding <= 0;
+            pending     <= 0;
+        end
+        else begin
+            if (ar_fire && !(r_fire && m_axi_rlast))
+                outstanding <= outstanding + 1;
+            else if (!ar_fire && (r_fire && m_axi_rlast))
+                outstanding <= outstanding - 1;
+
+            pending <= pending + (ar_fire ? burst_words : 0) - r_fire;
+        end
+    end
+
+    // Data side : the bursts come back in order, so counting beats is enough to find row ends
+    always @(posedge clk) begin
+        if (!rstn) begin
+            r_busy  <= 1'b0;
+            error   <= 1'b0;
+            rd_word <= 0;
+            rd_row  <= 0;
+        end
+        else if (start) begin
+            r_busy  <= (cfg_width != 0) && (cfg_height != 0);
+            error   <= 1'b0;
+            rd_word <= 0;
+            rd_row  <= 0;
+        end
+        else if (r_fire) begin
+            if (m_axi_rresp[1])
+                error <= 1'b1;
+
+            if (row_end) begin
+                rd_word <= 0;
+                rd_row  <= rd_row + 1;
+                if (rd_row == roi_height - 1)
+                    r_busy <= 1'b0;
+            end
+            else begin
+                rd_word <= rd_word + 1;
+            end
+        end
+    end
+
+endmodule
@@ -0,0 +1,270 @@
+`timescale 1ns/1ps
+
+// AXI4 master (write channels only) storing the inflated region back into a costmap in memory.
+// The engine results (the inflated or convolved costs, not the input cells) arrive one cell per transfer,
+// row after row (cfg_height rows of cfg_width cells). A result is saturated to one byte and row y is written from cfg_base + y * cfg_stride
+// (base and stride multiples of 4 bytes), with WSTRB masking the end of each row.
+// Rows are written with INCR bursts of at most MAX_BURST_LEN beats that never cross a 4 KB page;
+// the write addresses run ahead of the data by at most MAX_OUTSTANDING bursts.
+module axi_roi_writer #(
+    parameter ADDR_WIDTH      = 32,
+    parameter BUS_WIDTH       = 32,
+    parameter CELL_WIDTH      = 8,    // width of an engine result
+    parameter MAX_BURST_LEN   = 16,   // beats per burst (1..256)
+    parameter MAX_OUTSTANDING = 4     // bursts waiting for their response
+)(
+    input  clk,
+    input  rstn,
+
+    // Control
+    input                       start,       // one cycle pulse, samples the ROI registers
+    input  [ADDR_WIDTH - 1 : 0] cfg_base,
+    input  [ADDR_WIDTH - 1 : 0] cfg_stride,  // bytes between two ROI rows
+    input  [15 : 0]             cfg_width,   // cells per ROI row
+    input  [15 : 0]             cfg_height,  // ROI rows
+    output reg                  busy,
+    output                      done,        // one cycle pulse : the last write response is in
+    output reg                  error,       // a burst answered SLVERR/DECERR, sticky until the next start
+
+    // AXI Stream Slave Interface (engine results)
+    input  [CELL_WIDTH - 1 : 0] s_axis_tdata,
+    input                       s_axis_tvalid,
+    output                      s_axis_tready,
+
+    // AXI4 Write Address Channel
+    output [ADDR_WIDTH - 1 : 0] m_axi_awaddr,
+    output [7 : 0]              m_axi_awlen,
+    output [2 : 0]              m_axi_awsize,
+    output [1 : 0]              m_axi_awburst,
+    output                      m_axi_awvalid,
+    input                       m_axi_awready,
+
+    // AXI4 Write Data Channel
+    output reg [BUS_WIDTH - 1 : 0]     m_axi_wdata,
+    output reg [BUS_WIDTH / 8 - 1 : 0] m_axi_wstrb,
+    output reg                  m_axi_wlast,
+    output reg                  m_axi_wvalid,
+    input                       m_axi_wready,
+
+    // AXI4 Write Response Channel
+    input  [1 : 0]              m_axi_bresp,
+    input                       m_axi_bvalid,
+    output                      m_axi_bready
+);
+
+    localparam BYTES     = BUS_WIDTH / 8;
+    localparam BYTE_BITS = $clog2(BYTES);
+    localparam PAGE      = 4096;
+
+    // ROI sampled on start
+    reg [ADDR_WIDTH - 1 : 0] roi_stride;
+    reg [15 : 0]             roi_height;
+    reg [15 : 0]             roi_width;
+    reg [15 : 0]             words_per_row;
+    reg [31 : 0]             total_bursts;     // bursts of the whole ROI, counted by the address side
+
+    // Address side
+    reg                      aw_active;
+    reg [ADDR_WIDTH - 1 : 0] aw_row_addr;
+    reg [15 : 0]             aw_word;
+    reg [15 : 0]             aw_row;
+    reg [31 : 0]             aw_count;         // bursts issued
+    reg [$clog2(MAX_OUTSTANDING + 1) - 1 : 0] outstanding;
+
+    // Data side : follows the same burst split as the address side
+    reg [ADDR_WIDTH - 1 : 0] w_row_addr;
+    reg [15 : 0]             w_word;           // beat of the row being filled
+    reg [8 : 0]              w_burst_left;     // beats left in the current burst (0 : a new burst starts)
+    reg [15 : 0]             w_col;            // cell of the row being filled
+    reg [BYTE_BITS - 1 : 0]  w_lane;
+    reg [BUS_WIDTH - 1 : 0]  pack_data;
+    reg [BYTES - 1 : 0]      pack_strb;
+
+    // Response side
+    reg [31 : 0]             b_count;
+
+    // burst size for a row position : at most MAX_BURST_LEN, the end of the row and the end of the 4 KB page
+    function [8 : 0] burst_len;
+        input [ADDR_WIDTH - 1 : 0] addr;
+        input [15 : 0]             words_left;
+        reg   [12 : 0]             page_words;
+        begin
+            page_words = (PAGE - addr[11 : 0]) >> BYTE_BITS;
+            burst_len  = MAX_BURST_LEN;
+            if (words_left < burst_len)
+                burst_len = words_left;
+            if (page_words < burst_len)
+                burst_len = page_words;
+        end
+    endfunction
+
+    wire [ADDR_WIDTH - 1 : 0] aw_addr     = aw_row_addr + (aw_word << BYTE_BITS);
+    wire [8 : 0]              aw_len      = burst_len(aw_addr, words_per_row - aw_word);
+    wire [ADDR_WIDTH - 1 : 0] w_addr      = w_row_addr + (w_word << BYTE_BITS);
+    wire [8 : 0]              w_len       = burst_len(w_addr, words_per_row - w_word);
+
+    wire aw_fire   = m_axi_awvalid && m_axi_awready;
+    wire b_fire    = m_axi_bvalid && m_axi_bready;
+    wire w_free    = !m_axi_wvalid || m_axi_wready;
+    wire cell_fire = s_axis_tvalid && s_axis_tready;
+    wire row_last  = (w_col == roi_width - 1);
+
+    // saturate the engine result to a one byte cost
+    wire [7 : 0] cell_cost = (s_axis_tdata > 8'hFF) ? 8'hFF : s_axis_tdata[7 : 0];
+
+    assign m_axi_awaddr  = aw_addr;
+    assign m_axi_awlen   = aw_len - 1;
+    assign m_axi_awsize  = BYTE_BITS;
+    assign m_axi_awburst = 2'b01;   // INCR
+    assign m_axi_awvalid = aw_active && (outstanding < MAX_OUTSTANDING);
+    assign m_axi_bready  = 1'b1;
+
+    // a cell is packed when the beat it completes can leave
+    assign s_axis_tready = busy && w_free;
+    assign done = busy && (aw_count == total_bursts) && (b_count == total_bursts);
+
+    // 1. Address generator
+    always @(posedge clk) begin
+        if (!rstn) begin
+            aw_active   <= 1'b0;
+            aw_row_addr <= 0;
+            aw_word     <= 0;
+            aw_row      <= 0;
+            aw_count    <= 0;
+        end
+        else if (start) begin
+            aw_active   <= (cfg_width != 0) && (cfg_height != 0);
+            aw_row_addr <= {cfg_base[ADDR_WIDTH - 1 : BYTE_BITS], {BYTE_BITS{1'b0}}};
+            aw_word     <= 0;
+            aw_row      <= 0;
+            aw_count    <= 0;
+        end
+        else if (aw_fire) begin
+            aw_count <= aw_count + 1;
+            if (aw_word + aw_len == words_per_row) begin
+                aw_word     <= 0;
+                aw_row      <= aw_row + 1;
+                aw_row_addr <= aw_row_addr + roi_stride;
+                if (aw_row == roi_height - 1)
+                    aw_active <= 1'b0;
+            end
+            else begin
+                aw_word <= aw_word + aw_len;
+            end
+        end
+    end
+
+    // Bursts issued and not yet answered
+    always @(posedge clk) begin
+        if (!rstn || start)
+            outstanding <= 0;
+        else if (aw_fire && !b_fire)
+            outstanding <= outstanding + 1;
+        else if (!aw_fire && b_fire)
+            outstanding <= outstanding - 1;
+    end
+
+    // 2. Data packer : cells are packed little endian (first cell at the lowest address)
+    always @(posedge clk) begin
+        if (!rstn) begin
+            m_axi_wdata  <= 0;
+            m_axi_wstrb  <= 0;
+            m_axi_wlast  <= 1'b0;
+            m_axi_wvalid <= 1'b0;
+            w_row_addr   <= 0;
+            w_word       <= 0;
+            w_burst_left <= 0;
+            w_col        <= 0;
+            w_lane       <= 0;
+            pack_data    <= 0;
+            pack_strb    <= 0;
+        end
+        else if (start) begin
+            m_axi_wvalid <= 1'b0;
+            w_row_addr   <= {cfg_base[ADDR_WIDTH - 1 : BYTE_BITS], {BYTE_BITS{1'b0}}};
+            w_word       <= 0;
+            w_burst_left <= 0;
+            w_col        <= 0;
+            w_lane       <= 0;
+            pack_data    <= 0;
+            pack_strb    <= 0;
+        end
+        else begin
+            if (m_axi_wready)
+                m_axi_wvalid <= 1'b0;
+
+            if (cell_fire) begin
+                if (w_lane == BYTES - 1 || row_last) begin
+                    // the beat is complete (or the row ends) : send it
+                    m_axi_wdata  <= pack_data | (cell_cost << (w_lane * 8));
+                    m_axi_wstrb  <= pack_strb | (1'b1 << w_lane);
+                    m_axi_wvalid <= 1'b1;
+                    pack_data    <= 0;
+                    pack_strb    <= 0;
+                    w_lane       <= 0;
+
+                    if (w_burst_left == 0) begin
+                        m_axi_wlast  <= (w_len == 1);
+                        w_burst_left <= w_len - 1;
+                    end
+                    else begin
+                        m_axi_wlast  <= (w_burst_left == 1);
+                        w_burst_left <= w_burst_left - 1;
+                    end
+
+                    if (row_last) begin
+                        w_col      <= 0;
+                        w_word     <= 0;
+                        w_row_addr <= w_row_addr + roi_stride;
+                    end
+                    else begin
+                        w_col  <= w_col + 1;
+                        w_word <= w_word + 1;
+                    end
+                end
+                else begin
+                    pack_data <= pack_data | (cell_cost << (w_lane * 8));
+                    pack_strb <= pack_strb | (1'b1 << w_lane);
+                    w_lane    <= w_lane + 1;
+                    w_col     <= w_col + 1;
+                end
+            end
+        end
+    end
+
+    // 3. Responses
+    always @(posedge clk) begin
+        if (!rstn) begin
+            busy         <= 1'b0;
+            error        <= 1'b0;
+            b_count      <= 0;
+            roi_stride   <= 0;
+            roi_height   <= 0;
+            roi_width    <= 0;
+            words_per_row <= 0;
+            total_bursts <= 0;
+        end
+        else if (start) begin
+            busy         <= (cfg_width != 0) && (cfg_height != 0);
+            error        <= 1'b0;
+            b_count      <= 0;
+            roi_stride   <= {cfg_stride[ADDR_WIDTH - 1 : BYTE_BITS], {BYTE_BITS{1'b0}}};
+            roi_height   <= cfg_height;
+            roi_width    <= cfg_width;
+            words_per_row <= (cfg_width + BYTES - 1) >> BYTE_BITS;
+            total_bursts <= 32'hFFFF_FFFF;   // known once the address side has issued its last burst
+        end
+        else begin
+            if (b_fire) begin
+                b_count <= b_count + 1;
+                if (m_axi_bresp[1])
+                    error <= 1'b1;
+            end
+            if (aw_active && aw_fire && (aw_word + aw_len == words_per_row) && (aw_row == roi_height - 1))
+                total_bursts <= aw_count + 1;
+            if (done)
+                busy <= 1'b0;
+        end
+    end
+
+endmodule
@@ -1,9 +1,66 @@
 `timescale 1ns/1ps
 
+// AXI4-Lite control/status register file of the accelerator
+//
+//  offset | name         | access | content
+//  -------+--------------+--------+----------------------------------------------------
+//   0x00  | CTRL         | W      | bit0 START, bit1 STOP, bit2 PERF_SNAPSHOT, bit3 PERF_CLEAR, bit4 KGEN_START
+//         |              |        | (self clearing pulses, KGEN_START : kernel of RADIUS and KGEN_*, see kernel_gen.sv)
+//   0x04  | STATUS       | R      | bit0 BUSY, bit1 DONE, bit2 WEIGHTS_LOADING, bit3 SHADOW_PENDING, bit4 KGEN_BUSY
+//   0x08  | FRAME_WIDTH  | R/W    | cells per row
+//   0x0C  | FRAME_HEIGHT | R/W    | rows per frame
+//   0x10  | RADIUS       | R/W    | inflation radius in cells (kernel = 2*RADIUS+1)
+//   0x14  | MODE         | R/W    | bit0 : 0 = convolution (sum of products over the window), 1 = inflation (max
+//         |              |        |        over the whole window of the own cost and the weights of the lethal cells)
+//         |              |        | bit1 : input format, 0 = one byte per cell, 1 = one bit per cell (1 = lethal)
+//         |              |        | bit2 : output format, 0 = one cost per transfer, 1 = run-length tokens
+//         |              |        | bit3 : frame streaming, 1 = after START every frame starts on s_axis_tuser SOF,
+//         |              |        |        one after the other until STOP (see top.v)
+//         |              |        | bit4 : border generation, the map comes unpadded (see window_gen.sv), otherwise
+//         |              |        |        the input is the map padded by RADIUS cells on every side
+//         |              |        | bit5 : border policy, 0 = zero padding, 1 = replicate the edge cells
+//   0x18  | IRQ_ENABLE   | R/W    | bit0 frame done, bit1 kernel ready
+//   0x1C  | IRQ_STATUS   | R/W1C  | bit0 frame done, bit1 kernel ready (KGEN_BUSY and WEIGHTS_LOADING low again)
+//   0x20  | VERSION      | R      | VERSION parameter
+//   0x24  | CONFIG       | R      | bits 7:0 ARRAY_SIZE (synthesized kernel size), bits 15:8 NUM_ENGINES
+//         |              |        | (more than one engine : plain output packs BUS_WIDTH/8 costs per transfer),
+//         |              |        | bits 23:16 COST_WIDTH : every output cell (plain, run-length or written to
+//         |              |        | the destination ROI) is the result saturated to a cost of 8 bits, any build
+//   0x28  | KGEN_SCALE      | R/W | cost scaling factor (1/m), Q16.16 (reset 10.0)
+//   0x2C  | KGEN_INSCRIBED  | R/W | inscribed radius (m), Q16.16 (reset 0)
+//   0x30  | KGEN_RESOLUTION | R/W | map resolution (m per cell), Q16.16 (reset 0.05)
+//   0x40  | PERF_CYCLES      | R | cycles since the last PERF_CLEAR
+//   0x44  | PERF_ACTIVE      | R | window positions stepped
+//   0x48  | PERF_OUT_STALL   | R | cycles stalled by m_axis_tready low
+//   0x4C  | PERF_IN_STARVED  | R | cycles waiting for an input word
+//   0x50  | PERF_WEIGHT_LOAD | R | cycles spent loading weights
+//   0x54  | PERF_XBAR_IDLE   | R | window positions without a result (border or halo positions)
+//   0x60 + 4*i | PERF_FIFO_HWM[i] | R | high-water mark of input FIFO i (one FIFO, the input words of the first engine)
+//   (the PERF_* registers hold the values of the last PERF_SNAPSHOT)
+//   0xA0  | DMA_CTRL     | R/W    | bit0 READ_EN (START fetches the source ROI), bit1 WRITE_EN (results go to the destination ROI)
+//   0xA4  | DMA_STATUS   | R      | bit0 READ_BUSY, bit1 WRITE_BUSY, bit2 READ_ERROR, bit3 WRITE_ERROR
+//   0xA8  | SRC_ADDR     | R/W    | address of the first cell of the source ROI (multiple of 4)
+//   0xAC  | SRC_STRIDE   | R/W    | bytes between two source rows (multiple of 4)
+//   0xB0  | SRC_WIDTH    | R/W    | cells per source row : FRAME_WIDTH with MODE bit4, FRAME_WIDTH + 2*RADIUS without
+//   0xB4  | SRC_HEIGHT   | R/W    | source rows : FRAME_HEIGHT with MODE bit4, FRAME_HEIGHT + 2*RADIUS without
+//   0xB8  | DST_ADDR     | R/W    | address of the first cell of the destination ROI (multiple of 4)
+//   0xBC  | DST_STRIDE   | R/W    | bytes between two destination rows (multiple of 4)
+//   (every source row is one input row of the engines, whole; the destination ROI is FRAME_WIDTH x FRAME_HEIGHT
+//    cells of the inflated, saturated results)
+//
+// Any other address answers SLVERR. Write and read channels are independent and
+// both accept one transaction per clock cycle.
 module axim_reg
 #(
     parameter ADDRESS_WIDTH = 32,
-    parameter DATA_WIDTH = 32
+    parameter DATA_WIDTH = 32,
+    parameter RADIUS_WIDTH = 4,
+    parameter RADIUS_RESET = 1,
+    parameter VERSION = 32'h0001_0000,
+    parameter ARRAY_SIZE = 3,   // size of the synthesized PE array
+    parameter NUM_ENGINES = 1,
+    parameter NUM_FIFOS = 3,    // number of FIFO high-water marks (16 at most)
+    parameter LEVEL_WIDTH = 3
 )
 (
     input  clk,
@@ -12,102 +69,314 @@ module axim_reg
     // Write Address Channel
     input [ADDRESS_WIDTH-1:0] s_axi_awaddr,
     input                     s_axi_awvalid,
-    output reg                s_axi_awready,
+    output                    s_axi_awready,
 
     // Write Data Channel
     input  [DATA_WIDTH-1:0]   s_axi_wdata,
+    input  [DATA_WIDTH/8-1:0] s_axi_wstrb,
     input                     s_axi_wvalid,
-    output reg                s_axi_wready,
+    output                    s_axi_wready,
 
     // Write Response Channel
     output reg [1:0]          s_axi_bresp,
     output reg                s_axi_bvalid,
     input                     s_axi_bready,
 
-    // Output Register
-    output reg [DATA_WIDTH-1:0] output_reg
+    // Read Address Channel
+    input [ADDRESS_WIDTH-1:0] s_axi_araddr,
+    input                     s_axi_arvalid,
+    output                    s_axi_arready,
+
+    // Read Data Channel
+    output reg [DATA_WIDTH-1:0] s_axi_rdata,
+    output reg [1:0]            s_axi_rresp,
+    output reg                  s_axi_rvalid,
+    input                       s_axi_rready,
+
+    // Control outputs
+    output reg                    ctrl_start,     // one cycle pulse
+    output reg                    ctrl_stop,      // one cycle pulse
+    output reg [15:0]             cfg_frame_width,
+    output reg [15:0]             cfg_frame_height,
+    output reg [RADIUS_WIDTH-1:0] cfg_radius,
+    output reg                    cfg_mode,
+    output reg                    cfg_packed_input,
+    output reg                    cfg_rle_output,
+    output reg                    cfg_stream_frames,
+    output reg                    cfg_border,
+    output reg                    cfg_border_replicate,
+    output reg                    perf_snapshot,  // one cycle pulse
+    output reg                    perf_clear,     // one cycle pulse
+    output reg                    kgen_start,     // one cycle pulse
+    output reg [DATA_WIDTH-1:0]   cfg_kgen_scale,
+    output reg [DATA_WIDTH-1:0]   cfg_kgen_inscribed,
+    output reg [DATA_WIDTH-1:0]   cfg_kgen_resolution,
+    output reg                    dma_rd_en,
+    output reg                    dma_wr_en,
+    output reg [DATA_WIDTH-1:0]   cfg_src_addr,
+    output reg [DATA_WIDTH-1:0]   cfg_src_stride,
+    output reg [15:0]             cfg_src_width,
+    output reg [15:0]             cfg_src_height,
+    output reg [DATA_WIDTH-1:0]   cfg_dst_addr,
+    output reg [DATA_WIDTH-1:0]   cfg_dst_stride,
+
+    // Status inputs
+    input                         status_busy,
+    input                         status_loading,
+    input                         status_shadow_pending,
+    input                         status_kgen_busy,
+    input                         frame_done,     // one cycle pulse at the end of a frame
+    input                         kernel_ready,   // one cycle pulse once a kernel load is over
+    input                         dma_rd_busy,
+    input                         dma_wr_busy,
+    input                         dma_rd_error,
+    input                         dma_wr_error,
+
+    // Performance counters (snapshot values)
+    input  [DATA_WIDTH-1:0]       perf_cycles,
+    input  [DATA_WIDTH-1:0]       perf_active,
+    input  [DATA_WIDTH-1:0]       perf_out_stall,
+    input  [DATA_WIDTH-1:0]       perf_in_starved,
+    input  [DATA_WIDTH-1:0]       perf_weight_load,
+    input  [DATA_WIDTH-1:0]       perf_xbar_idle,
+    input  [NUM_FIFOS*LEVEL_WIDTH-1:0] perf_fifo_hwm,
+
+    // Interrupt (level, active high)
+    output                        irq
 );
 
-    // State definition
-    typedef enum {IDLE, WR_DATA, WR_RESP} state_t;
+    // Register offsets
+    localparam ADDR_CTRL         = 8'h00;
+    localparam ADDR_STATUS       = 8'h04;
+    localparam ADDR_FRAME_WIDTH  = 8'h08;
+    localparam ADDR_FRAME_HEIGHT = 8'h0C;
+    localparam ADDR_RADIUS       = 8'h10;
+    localparam ADDR_MODE         = 8'h14;
+    localparam ADDR_IRQ_ENABLE   = 8'h18;
+    localparam ADDR_IRQ_STATUS   = 8'h1C;
+    localparam ADDR_VERSION      = 8'h20;
+    localparam ADDR_CONFIG       = 8'h24;
+    localparam COST_WIDTH        = 8;   // output cells, saturated (top.v)
+    localparam [23:0] CONFIG_VALUE = (COST_WIDTH << 16) | (NUM_ENGINES << 8) | ARRAY_SIZE;
+    localparam ADDR_KGEN_SCALE      = 8'h28;
+    localparam ADDR_KGEN_INSCRIBED  = 8'h2C;
+    localparam ADDR_KGEN_RESOLUTION = 8'h30;
+    localparam KGEN_SCALE_RESET      = 32'h000A_0000;   // 10.0
+    localparam KGEN_RESOLUTION_RESET = 32'h0000_0CCD;   // 0.05
+    localparam ADDR_PERF_CYCLES      = 8'h40;
+    localparam ADDR_PERF_ACTIVE      = 8'h44;
+    localparam ADDR_PERF_OUT_STALL   = 8'h48;
+    localparam ADDR_PERF_IN_STARVED  = 8'h4C;
+    localparam ADDR_PERF_WEIGHT_LOAD = 8'h50;
+    localparam ADDR_PERF_XBAR_IDLE   = 8'h54;
+    localparam ADDR_PERF_FIFO_HWM    = 8'h60;
+    localparam ADDR_DMA_CTRL     = 8'hA0;
+    localparam ADDR_DMA_STATUS   = 8'hA4;
+    localparam ADDR_SRC_ADDR     = 8'hA8;
+    localparam ADDR_SRC_STRIDE   = 8'hAC;
+    localparam ADDR_SRC_WIDTH    = 8'hB0;
+    localparam ADDR_SRC_HEIGHT   = 8'hB4;
+    localparam ADDR_DST_ADDR     = 8'hB8;
+    localparam ADDR_DST_STRIDE   = 8'hBC;
+
+    localparam RESP_OKAY   = 2'b00;
+    localparam RESP_SLVERR = 2'b10;
 
-   // reg [1:0] state;
-    state_t state;
-    reg [DATA_WIDTH-1:0] tmp_data;
-    reg load_en;
-    reg [ADDRESS_WIDTH-1:0] waddr;
+    reg       done_flag;   // sticky until the next START
+    reg [1:0] irq_enable;
+    reg [1:0] irq_status;
+
+    // the address is valid if it hits one of the registers above
+    function addr_valid;
+        input [ADDRESS_WIDTH-1:0] addr;
+        begin
+            addr_valid = (addr[ADDRESS_WIDTH-1:8] == 0) && (addr[1:0] == 2'b00) &&
+                         ((addr[7:0] <= ADDR_KGEN_RESOLUTION) ||
+                          (addr[7:0] >= ADDR_PERF_CYCLES && addr[7:0] <= ADDR_PERF_XBAR_IDLE) ||
+                          (addr[7:0] >= ADDR_PERF_FIFO_HWM && addr[7:0] < ADDR_PERF_FIFO_HWM + 4*NUM_FIFOS) ||
+                          (addr[7:0] >= ADDR_DMA_CTRL && addr[7:0] <= ADDR_DST_STRIDE));
+        end
+    endfunction
+
+    // byte enables applied on the previous value of a register
+    function [DATA_WIDTH-1:0] apply_wstrb;
+        input [DATA_WIDTH-1:0] old_value;
+        input [DATA_WIDTH-1:0] new_value;
+        input [DATA_WIDTH/8-1:0] strb;
+        integer k;
+        begin
+            for (k = 0; k < DATA_WIDTH/8; k = k + 1)
+                apply_wstrb[k*8 +: 8] = strb[k] ? new_value[k*8 +: 8] : old_value[k*8 +: 8];
+        end
+    endfunction
+
+    // ------------------------------------------------------------------
+    // Write channel : address and data are taken together, as soon as the
+    // previous response is gone (or leaves in the same cycle)
+    // ------------------------------------------------------------------
+    wire wr_fire = s_axi_awvalid && s_axi_wvalid && (!s_axi_bvalid || s_axi_bready);
+    wire [DATA_WIDTH-1:0] wr_data = apply_wstrb({DATA_WIDTH{1'b0}}, s_axi_wdata, s_axi_wstrb);
+
+    assign s_axi_awready = wr_fire;
+    assign s_axi_wready  = wr_fire;
 
-    // control logic : FSM State Transitions
     always @(posedge clk) begin
         if (!rstn) begin
-            state    <= IDLE;
+            s_axi_bvalid     <= 1'b0;
+            s_axi_bresp      <= RESP_OKAY;
+            ctrl_start       <= 1'b0;
+            ctrl_stop        <= 1'b0;
+            perf_snapshot    <= 1'b0;
+            perf_clear       <= 1'b0;
+            kgen_start       <= 1'b0;
+            cfg_kgen_scale      <= KGEN_SCALE_RESET;
+            cfg_kgen_inscribed  <= 0;
+            cfg_kgen_resolution <= KGEN_RESOLUTION_RESET;
+            cfg_frame_width  <= 16'd0;
+            cfg_frame_height <= 16'd0;
+            cfg_radius       <= RADIUS_RESET;
+            cfg_mode         <= 1'b0;
+            cfg_packed_input <= 1'b0;
+            cfg_rle_output   <= 1'b0;
+            cfg_stream_frames <= 1'b0;
+            cfg_border       <= 1'b0;
+            cfg_border_replicate <= 1'b0;
+            irq_enable       <= 2'b00;
+            irq_status       <= 2'b00;
+            done_flag        <= 1'b0;
+            dma_rd_en        <= 1'b0;
+            dma_wr_en        <= 1'b0;
+            cfg_src_addr     <= 0;
+            cfg_src_stride   <= 0;
+            cfg_src_width    <= 16'd0;
+            cfg_src_height   <= 16'd0;
+            cfg_dst_addr     <= 0;
+            cfg_dst_stride   <= 0;
         end
-       	else begin
-            case (state)
-                IDLE: begin
-                    // Wait for the master to start a write address transaction
-                    if (s_axi_awvalid) 
-                        state <= WR_DATA;
-                end
+        else begin
+            ctrl_start    <= 1'b0;
+            ctrl_stop     <= 1'b0;
+            perf_snapshot <= 1'b0;
+            perf_clear    <= 1'b0;
+            kgen_start    <= 1'b0;
 
-                WR_DATA: begin
-                    // Wait for valid data from the master
-                    if (s_axi_wvalid)
-                        state <= WR_RESP;
-                end
+            // events from the engine
+            if (frame_done) begin
+                done_flag     <= 1'b1;
+                irq_status[0] <= 1'b1;
+            end
+            if (kernel_ready)
+                irq_status[1] <= 1'b1;
 
-                WR_RESP: begin
-                    // Wait for the master to acknowledge the response (BREADY)
-                    if (s_axi_bready)
-                        state <= IDLE;
+            if (wr_fire) begin
+                s_axi_bvalid <= 1'b1;
+                s_axi_bresp  <= addr_valid(s_axi_awaddr) ? RESP_OKAY : RESP_SLVERR;
+
+                if (addr_valid(s_axi_awaddr)) begin
+                    case (s_axi_awaddr[7:0])
+                        ADDR_CTRL: begin
+                            ctrl_start <= wr_data[0];
+                            ctrl_stop  <= wr_data[1];
+                            perf_snapshot <= wr_data[2];
+                            perf_clear    <= wr_data[3];
+                            kgen_start    <= wr_data[4];
+                            if (wr_data[0])
+                                done_flag <= 1'b0;
+                        end
+                        ADDR_FRAME_WIDTH:  cfg_frame_width  <= apply_wstrb(cfg_frame_width,  s_axi_wdata, s_axi_wstrb);
+                        ADDR_FRAME_HEIGHT: cfg_frame_height <= apply_wstrb(cfg_frame_height, s_axi_wdata, s_axi_wstrb);
+                        ADDR_RADIUS:       cfg_radius       <= apply_wstrb(cfg_radius,       s_axi_wdata, s_axi_wstrb);
+                        ADDR_MODE:         {cfg_border_replicate, cfg_border, cfg_stream_frames, cfg_rle_output, cfg_packed_input, cfg_mode} <=
+                                               apply_wstrb({cfg_border_replicate, cfg_border, cfg_stream_frames, cfg_rle_output, cfg_packed_input, cfg_mode}, s_axi_wdata, s_axi_wstrb);
+                        ADDR_IRQ_ENABLE:   irq_enable       <= apply_wstrb(irq_enable,       s_axi_wdata, s_axi_wstrb);
+                        ADDR_KGEN_SCALE:      cfg_kgen_scale      <= apply_wstrb(cfg_kgen_scale,      s_axi_wdata, s_axi_wstrb);
+                        ADDR_KGEN_INSCRIBED:  cfg_kgen_inscribed  <= apply_wstrb(cfg_kgen_inscribed,  s_axi_wdata, s_axi_wstrb);
+                        ADDR_KGEN_RESOLUTION: cfg_kgen_resolution <= apply_wstrb(cfg_kgen_resolution, s_axi_wdata, s_axi_wstrb);
+                        // write one to clear, a new event in the same cycle wins
+                        ADDR_IRQ_STATUS: begin
+                            if (wr_data[0] && !frame_done)   irq_status[0] <= 1'b0;
+                            if (wr_data[1] && !kernel_ready) irq_status[1] <= 1'b0;
+                        end
+                        ADDR_DMA_CTRL: begin
+                            dma_rd_en <= wr_data[0];
+                            dma_wr_en <= wr_data[1];
+                        end
+                        ADDR_SRC_ADDR:     cfg_src_addr     <= apply_wstrb(cfg_src_addr,     s_axi_wdata, s_axi_wstrb);
+                        ADDR_SRC_STRIDE:   cfg_src_stride   <= apply_wstrb(cfg_src_stride,   s_axi_wdata, s_axi_wstrb);
+                        ADDR_SRC_WIDTH:    cfg_src_width    <= apply_wstrb(cfg_src_width,    s_axi_wdata, s_axi_wstrb);
+                        ADDR_SRC_HEIGHT:   cfg_src_height   <= apply_wstrb(cfg_src_height,   s_axi_wdata, s_axi_wstrb);
+                        ADDR_DST_ADDR:     cfg_dst_addr     <= apply_wstrb(cfg_dst_addr,     s_axi_wdata, s_axi_wstrb);
+                        ADDR_DST_STRIDE:   cfg_dst_stride   <= apply_wstrb(cfg_dst_stride,   s_axi_wdata, s_axi_wstrb);
+                        default: ; // read only registers : write ignored
+                    endcase
                 end
-                default: state <= IDLE;
-            endcase
+            end
+            else if (s_axi_bready) begin
+                s_axi_bvalid <= 1'b0;
+            end
         end
     end
 
-    // dataflow logic
-    always @(*) begin
-        // Default values
-        s_axi_awready  = 1'b0;
-        s_axi_wready   = 1'b0;
-        s_axi_bvalid   = 1'b0;
-	s_axi_bresp   = 2'b00;
-        load_en  = 1'b0;
-       // tmp_data = {DATA_WIDTH{1'b0}};
-        tmp_data = s_axi_wdata;
-
-        case (state)
-            IDLE: begin
-		s_axi_wready   = 1'b0;
-                s_axi_awready = 1'b1;
-	       	s_axi_bvalid   = 1'b0;
-		waddr = s_axi_awaddr;
-            end
-            WR_DATA: begin
-                s_axi_wready = 1'b1;
-	        s_axi_awready  = 1'b0;
-               // tmp_data = s_axi_wdata;
-                // Only trigger the load enable if data is valid
-                if (s_axi_wvalid && (waddr == 0) ) load_en = 1'b1;
-            end
+    // ------------------------------------------------------------------
+    // Read channel : registered data, one read per cycle
+    // ------------------------------------------------------------------
+    wire rd_fire = s_axi_arvalid && s_axi_arready;
 
-            WR_RESP: begin
-		s_axi_wready = 1'b0;
-                s_axi_bvalid = 1'b1;
-		if(waddr == 0) 
-		   s_axi_bresp = 2'b00;
-		else
-		  s_axi_bresp = 2'b10;
-            end
-        endcase
-    end
+    assign s_axi_arready = !s_axi_rvalid || s_axi_rready;
 
-    // ---write the output in a register ---
     always @(posedge clk) begin
-        if (!rstn)
-            output_reg <= {DATA_WIDTH{1'b0}};
-        else if (load_en)
-            output_reg <= tmp_data;
+        if (!rstn) begin
+            s_axi_rvalid <= 1'b0;
+            s_axi_rresp  <= RESP_OKAY;
+            s_axi_rdata  <= {DATA_WIDTH{1'b0}};
+        end
+        else begin
+            if (rd_fire) begin
+                s_axi_rvalid <= 1'b1;
+                s_axi_rresp  <= addr_valid(s_axi_araddr) ? RESP_OKAY : RESP_SLVERR;
+                case (s_axi_araddr[7:0])
+                    ADDR_STATUS:       s_axi_rdata <= {{(DATA_WIDTH-5){1'b0}}, status_kgen_busy, status_shadow_pending, status_loading, done_flag, status_busy};
+                    ADDR_FRAME_WIDTH:  s_axi_rdata <= cfg_frame_width;
+                    ADDR_FRAME_HEIGHT: s_axi_rdata <= cfg_frame_height;
+                    ADDR_RADIUS:       s_axi_rdata <= cfg_radius;
+                    ADDR_MODE:         s_axi_rdata <= {cfg_border_replicate, cfg_border, cfg_stream_frames, cfg_rle_output, cfg_packed_input, cfg_mode};
+                    ADDR_IRQ_ENABLE:   s_axi_rdata <= {{(DATA_WIDTH-2){1'b0}}, irq_enable};
+                    ADDR_IRQ_STATUS:   s_axi_rdata <= {{(DATA_WIDTH-2){1'b0}}, irq_status};
+                    ADDR_VERSION:      s_axi_rdata <= VERSION;
+                    ADDR_CONFIG:       s_axi_rdata <= {{(DATA_WIDTH-24){1'b0}}, CONFIG_VALUE};
+                    ADDR_KGEN_SCALE:      s_axi_rdata <= cfg_kgen_scale;
+                    ADDR_KGEN_INSCRIBED:  s_axi_rdata <= cfg_kgen_inscribed;
+                    ADDR_KGEN_RESOLUTION: s_axi_rdata <= cfg_kgen_resolution;
+                    ADDR_PERF_CYCLES:      s_axi_rdata <= perf_cycles;
+                    ADDR_PERF_ACTIVE:      s_axi_rdata <= perf_active;
+                    ADDR_PERF_OUT_STALL:   s_axi_rdata <= perf_out_stall;
+                    ADDR_PERF_IN_STARVED:  s_axi_rdata <= perf_in_starved;
+                    ADDR_PERF_WEIGHT_LOAD: s_axi_rdata <= perf_weight_load;
+                    ADDR_PERF_XBAR_IDLE:   s_axi_rdata <= perf_xbar_idle;
+                    ADDR_DMA_CTRL:     s_axi_rdata <= {{(DATA_WIDTH-2){1'b0}}, dma_wr_en, dma_rd_en};
+                    ADDR_DMA_STATUS:   s_axi_rdata <= {{(DATA_WIDTH-4){1'b0}}, dma_wr_error, dma_rd_error, dma_wr_busy, dma_rd_busy};
+                    ADDR_SRC_ADDR:     s_axi_rdata <= cfg_src_addr;
+                    ADDR_SRC_STRIDE:   s_axi_rdata <= cfg_src_stride;
+                    ADDR_SRC_WIDTH:    s_axi_rdata <= cfg_src_width;
+                    ADDR_SRC_HEIGHT:   s_axi_rdata <= cfg_src_height;
+                    ADDR_DST_ADDR:     s_axi_rdata <= cfg_dst_addr;
+                    ADDR_DST_STRIDE:   s_axi_rdata <= cfg_dst_stride;
+                    default: begin
+                        if (s_axi_araddr[7:0] >= ADDR_PERF_FIFO_HWM)
+                            s_axi_rdata <= perf_fifo_hwm[((s_axi_araddr[7:0] - ADDR_PERF_FIFO_HWM) >> 2)*LEVEL_WIDTH +: LEVEL_WIDTH];
+                        else
+                            s_axi_rdata <= {DATA_WIDTH{1'b0}}; // CTRL reads as 0
+                    end
+                endcase
+                if (!addr_valid(s_axi_araddr))
+                    s_axi_rdata <= {DATA_WIDTH{1'b0}};
+            end
+            else if (s_axi_rready) begin
+                s_axi_rvalid <= 1'b0;
+            end
+        end
     end
+
+    assign irq = |(irq_enable & irq_status);
+
 endmodule
@@ -0,0 +1,57 @@
+`timescale 1ns/1ps
+
+// Simulation only : handshake trace of an AXI Stream interface (or of LANES parallel ones, like the
+// rows of the PE array), for long runs where a -debug all waveform gets too big and too slow.
+// With +trace on the simulator command line (xsim -testplusarg trace), every change of
+// {valid, ready, level} is written to "<instance path>.trc" as four 32-bit words :
+//     cycle (clk cycles since the start of the simulation), valid lanes, ready lanes, level
+// after a header of three words : TRACE_MAGIC, LANES, 0. The state holds until the next record,
+// so a steady stream (or a long stall) costs one record. level is the occupancy behind the
+// interface (FIFO level, results in flight), 0 when it has none.
+// trace_bind.sv attaches the monitors to the design, trace_report.py reads the files.
+// Not yet run in xsim or Verilator : the monitors and the bind have not been through a simulator.
+module axis_trace #(
+    parameter LANES = 1                // 1 .. 32
+)(
+    input                  clk,
+    input  [LANES - 1 : 0] valid,
+    input  [LANES - 1 : 0] ready,
+    input  [31 : 0]        level
+);
+
+    localparam [31 : 0] TRACE_MAGIC = 32'h4154_5231;   // "ATR1"
+
+    integer          fd = 0;
+    reg     [31 : 0] cycle = 0;
+    reg              first = 1'b1;
+    reg     [LANES - 1 : 0] last_valid;
+    reg     [LANES - 1 : 0] last_ready;
+    reg     [31 : 0] last_level;
+
+    wire    [31 : 0] valid_word = valid;
+    wire    [31 : 0] ready_word = ready;
+
+    initial begin
+        if ($test$plusargs("trace")) begin
+            fd = $fopen($sformatf("%m.trc"), "wb");
+            if (fd != 0)
+                $fwrite(fd, "%u%u%u", TRACE_MAGIC, LANES, 32'd0);
+        end
+    end
+
+    always @(posedge clk) begin
+        cycle <= cycle + 1;
+        if (fd != 0 && (first || valid != last_valid || ready != last_ready || level != last_level))
+            $fwrite(fd, "%u%u%u%u", cycle, valid_word, ready_word, level);
+        first      <= 1'b0;
+        last_valid <= valid;
+        last_ready <= ready;
+        last_level <= level;
+    end
+
+    final begin
+        if (fd != 0)
+            $fclose(fd);
+    end
+
+endmodule
@@ -19,7 +19,10 @@ module axis_unpack_data #(
     // Interface to read from the FIFOs (Master-like outputs)
     input  [KERNEL_SIZE-1:0]            m_axis_tready, // One for each FIFO
     output [(KERNEL_SIZE*DATA_WIDTH)-1:0] m_axis_tdata,
-    output [KERNEL_SIZE-1:0]            m_axis_tvalid
+    output [KERNEL_SIZE-1:0]            m_axis_tvalid,
+
+    // Occupancy of each FIFO (for the performance counters)
+    output [(PTR_WIDTH+1)*KERNEL_SIZE-1:0] fifo_level
 );
 
     // Internal wires to connect to FIFO slave ports
@@ -52,7 +55,8 @@ module axis_unpack_data #(
                 // Master interface (Exposed to the next module)
                 .m_tready(m_axis_tready[i]),
                 .m_tdata (m_axis_tdata[i*DATA_WIDTH +: DATA_WIDTH]),
-                .m_tvalid(m_axis_tvalid[i] )
+                .m_tvalid(m_axis_tvalid[i] ),
+                .level   (fifo_level[i*(PTR_WIDTH+1) +: (PTR_WIDTH+1)])
             );
         end
     endgenerate
@@ -0,0 +1,75 @@
+`timescale 1ns/1ps
+
+// Moves a bus from src_clk to dst_clk with a request/acknowledge toggle handshake.
+// src_send copies src_data into a holding register that stays still until the destination has taken
+// it, so every bit is stable long before dst_clk samples it. src_busy is high from src_send until the
+// acknowledge is back (a src_send while busy is ignored), dst_valid pulses with the new dst_data.
+module cdc_bus #(
+    parameter WIDTH = 8
+)(
+    // source domain
+    input                      src_clk,
+    input                      src_rstn,
+    input  [WIDTH - 1 : 0]     src_data,
+    input                      src_send,
+    output                     src_busy,
+
+    // destination domain
+    input                      dst_clk,
+    input                      dst_rstn,
+    output reg [WIDTH - 1 : 0] dst_data,
+    output reg                 dst_valid
+);
+
+    reg  [WIDTH - 1 : 0] hold;
+    reg                  req;
+    reg                  ack;
+    wire                 req_sync;   // req in the destination domain
+    wire                 ack_sync;   // ack in the source domain
+
+    assign src_busy = (req != ack_sync);
+
+    // 1. source : hold the data and toggle the request
+    always @(posedge src_clk) begin
+        if (!src_rstn) begin
+            hold <= 0;
+            req  <= 1'b0;
+        end
+        else if (src_send && !src_busy) begin
+            hold <= src_data;
+            req  <= ~req;
+        end
+    end
+
+    // 2. destination : copy the held data and answer with the same toggle
+    always @(posedge dst_clk) begin
+        if (!dst_rstn) begin
+            dst_data  <= 0;
+            dst_valid <= 1'b0;
+            ack       <= 1'b0;
+        end
+        else begin
+            dst_valid <= 1'b0;
+            if (req_sync != ack) begin
+                dst_data  <= hold;
+                dst_valid <= 1'b1;
+                ack       <= req_sync;
+            end
+        end
+    end
+
+    cdc_sync #(.WIDTH(1)) req_sync_inst (
+        .dst_clk(dst_clk),
+        .dst_rstn(dst_rstn),
+        .src_data(req),
+        .dst_data(req_sync)
+    );
+
+    cdc_sync #(.WIDTH(1)) ack_sync_inst (
+        .dst_clk(src_clk),
+        .dst_rstn(src_rstn),
+        .src_data(ack),
+        .dst_data(ack_sync)
+    );
+
+endmodule
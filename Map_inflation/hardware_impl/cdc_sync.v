@@ -0,0 +1,34 @@
+`timescale 1ns/1ps
+
+// Multi-flop synchronizer for levels entering the dst_clk domain.
+// Every bit is synchronized on its own : only use it for single bits, or for buses where at most
+// one bit changes between two source samples (gray-coded counters).
+module cdc_sync #(
+    parameter WIDTH       = 1,
+    parameter STAGES      = 2,
+    parameter RESET_VALUE = 0
+)(
+    input                  dst_clk,
+    input                  dst_rstn,   // synchronous active-low reset of the destination domain
+    input  [WIDTH - 1 : 0] src_data,
+    output [WIDTH - 1 : 0] dst_data
+);
+
+    (* ASYNC_REG = "TRUE" *) reg [WIDTH - 1 : 0] sync [0 : STAGES - 1];
+    integer i;
+
+    always @(posedge dst_clk) begin
+        if (!dst_rstn) begin
+            for (i = 0; i < STAGES; i = i + 1)
+                sync[i] <= RESET_VALUE;
+        end
+        else begin
+            sync[0] <= src_data;
+            for (i = 1; i < STAGES; i = i + 1)
+                sync[i] <= sync[i-1];
+        end
+    end
+
+    assign dst_data = sync[STAGES - 1];
+
+endmodule
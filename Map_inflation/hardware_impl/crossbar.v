@@ -2,12 +2,15 @@
 
 module crossbar
 #(
-    parameter KERNEL_SIZE = 3,
+    parameter KERNEL_SIZE = 3,  // size of the synthesized (maximum) PE array
     parameter DATA_WIDTH  = 18
 )(
     input clk,
     input rstn,
 
+    // Runtime kernel size : only the first cfg_kernel_size rows take part in the round-robin
+    input [$clog2(KERNEL_SIZE + 1) - 1 : 0] cfg_kernel_size,
+
     // Slave Interfaces (From Adder Trees)
     input  [KERNEL_SIZE-1:0] s_axis_tvalid,
     input  [DATA_WIDTH*KERNEL_SIZE-1:0] s_axis_tdata,
@@ -16,7 +19,10 @@ module crossbar
     // Master Interface (To Output Module)
     output reg m_axis_tvalid,
     output reg [DATA_WIDTH-1:0] m_axis_tdata,
-    input  m_axis_tready
+    input  m_axis_tready,
+
+    // the round-robin had to wait on a row that is not ready (for the performance counters)
+    output idle_slot
 );
 
     reg [DATA_WIDTH-1:0] reg_s_tdata  [0:KERNEL_SIZE-1];
@@ -27,15 +33,18 @@ module crossbar
     // Combinational signals
     wire output_fire = m_axis_tvalid && m_axis_tready;
     wire can_update = m_axis_tready || !m_axis_tvalid;
-    wire all_slots_valid = &reg_s_tvalid;
+    wire [KERNEL_SIZE-1:0] active_rows;
+    wire all_slots_valid = &(reg_s_tvalid | ~active_rows); // masked rows never receive data
 
     // Next count value (for better timing)
-    wire [$clog2(KERNEL_SIZE)-1:0] count_next = (count == KERNEL_SIZE - 1) ? 'd0 : count + 1'd1;
+    wire [$clog2(KERNEL_SIZE)-1:0] count_next = (count == cfg_kernel_size - 1) ? 'd0 : count + 1'd1;
         
    //1. buffering stage 
     genvar i;
     generate
         for (i = 0; i < KERNEL_SIZE; i = i + 1) begin 
+            assign active_rows[i] = (i < cfg_kernel_size);
+
             // the counter is pointing a the buffer slot i,  the master is ready to accept data, the crossbar is currently outputting valid data
 	    wire slot_selected = (count == i);
             wire slot_being_read = slot_selected && output_fire;
@@ -59,6 +68,8 @@ module crossbar
         end
     endgenerate
 
+    assign idle_slot = start_counter && can_update && !reg_s_tvalid[count];
+
     // 2.  Sequence Logic 
     always @(posedge clk) begin
         if (!rstn) begin
@@ -74,11 +85,11 @@ module crossbar
                 
                 if (!start_counter) begin
                     //  start condition :  Wait until every row(slots) has at least one value
-                    if (&reg_s_tvalid) begin 
+                    if (all_slots_valid) begin 
                         start_counter   <= 1'b1;
                         m_axis_tdata  <= reg_s_tdata[0]; // Start with Row 0
                         m_axis_tvalid <= 1'b1;
-                        count         <= 'd1; // Prepare to look at Row 1
+                        count         <= count_next; // Prepare to look at Row 1 (Row 0 again for a 1x1 kernel)
                     end else begin
                         m_axis_tvalid <= 1'b0;
                         count         <= 0; // Stay parked at Row 0
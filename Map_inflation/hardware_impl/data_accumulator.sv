@@ -1,12 +1,15 @@
 `timescale 1ns/1ps
 
 module data_accumulator #(
-    parameter KERNEL_SIZE = 3,
+    parameter KERNEL_SIZE = 3,  // size of the synthesized (maximum) PE array
     parameter DATA_WIDTH  = 8,
     parameter BUS_WIDTH   = 32
 )(
     input  clk,
     input  rstn,
+
+    // Runtime kernel size (1..KERNEL_SIZE): number of pixels in one row of the window
+    input  [$clog2(KERNEL_SIZE + 1) - 1 : 0] cfg_kernel_size,
      
     // Control signal - enable accumulator (should be low during weight loading)
     input                       enable,
@@ -29,6 +32,8 @@ module data_accumulator #(
     
     // Internal signals
     reg [PADDED_SIZE - 1 : 0] row_buffer;
+    wire [$clog2(NUM_TRANSFERS + 1) - 1 : 0] active_transfers; // transfers needed for a row of cfg_kernel_size pixels
+    wire [PADDED_SIZE - 1 : 0] aligned_row;  // first received transfer moved back to the MSBs
     integer transfer_count;
     //reg [$clog2(NUM_TRANSFERS) : 0] transfer_count;
     reg row_valid;
@@ -41,11 +46,24 @@ module data_accumulator #(
     assign s_axis_tready = (state == ACCUMULATING);
     assign m_axis_tvalid = row_valid;
     
+    // A smaller kernel needs fewer transfers per row
+    assign active_transfers = (cfg_kernel_size * DATA_WIDTH + BUS_WIDTH - 1) / BUS_WIDTH;
+
     // Slice only the bits we need for the output
     //assign m_axis_tdata = row_buffer[REQUIRED_BITS - 1 : 0];
     
-    // This takes the first 'REQUIRED_BITS' from the most significant part of the buffer
-    assign m_axis_tdata = row_buffer[PADDED_SIZE - 1 : PADDED_SIZE - REQUIRED_BITS];
+    // When less than NUM_TRANSFERS transfers were shifted in, the row sits in the LSBs of the buffer
+    assign aligned_row = row_buffer << ((NUM_TRANSFERS - active_transfers) * BUS_WIDTH);
+
+    // This takes the first 'REQUIRED_BITS' from the most significant part of the buffer.
+    // Pixels beyond cfg_kernel_size are the padding of the last transfer : they are forced to zero
+    genvar p;
+    generate
+        for (p = 0; p < KERNEL_SIZE; p = p + 1) begin
+            assign m_axis_tdata[REQUIRED_BITS - 1 - p*DATA_WIDTH -: DATA_WIDTH] =
+                (p < cfg_kernel_size) ? aligned_row[PADDED_SIZE - 1 - p*DATA_WIDTH -: DATA_WIDTH] : {DATA_WIDTH{1'b0}};
+        end
+    endgenerate
     
     // Accumulator FSM
     always @(posedge clk) begin
@@ -67,7 +85,7 @@ module data_accumulator #(
                             row_buffer <= s_axis_tdata; // If the row is only 1 bus-width wide, just load the data
                         end
                         
-                        if (transfer_count == NUM_TRANSFERS - 1) begin
+                        if (transfer_count == active_transfers - 1) begin
                             row_valid <= 1'b1;   // we have a valid complete  row 
                             transfer_count <= 0;
                             state <= OUTPUTTING;
@@ -0,0 +1,169 @@
+`timescale 1ns/1ps
+
+// One row of the PE array on DSP48E1 slices (pe_wrapper.v with USE_DSP_ROWS = 1) : it takes the place
+// of the KERNEL_SIZE PEs and the tree of one window row. The products run down a systolic chain, one DSP
+// per stage : stage s gets its pixel s steps late and adds its product (MREG) to the partial sum of
+// stage s - 1 (PREG), a plain P + M that maps on the PCIN/PCOUT cascade with no fabric adder. The row
+// sum leaves the last stage ROW_LATENCY = stages + 2 enabled cycles after the window register, and no
+// path gets longer with KERNEL_SIZE.
+// DSP_PACK = 1 does two multiplies per DSP with the pre-adder : column c and its mirror k-1-c share
+// their weight, (x[c] + x[k-1-c]) * w[c] (ADREG), so (KERNEL_SIZE + 1) / 2 stages are enough. The weights
+// of every row must then be symmetric left to right (the inflation kernels are).
+// The inflation mode (max of the weights of the lethal neighbours, and of the cost of the centre cell
+// on the centre row) runs in fabric along the same chain.
+// Every register moves on the enable of its pipeline stage (en[d] for the registers d steps after the
+// window register), like the other stages of pe_wrapper.v, so the chain is as elastic as the rest.
+module dsp_row #(
+    parameter KERNEL_SIZE  = 3,    // columns (size of the synthesized PE array)
+    parameter DATA_WIDTH   = 8,
+    parameter WEIGHT_WIDTH = 8,
+    parameter DSP_PACK     = 0,
+    parameter LETHAL_COST  = 254   // cost of a lethal obstacle cell
+)(
+    input  clk,
+    input  rstn,
+
+    input  [(DSP_PACK ? (KERNEL_SIZE + 1) / 2 + 3 : KERNEL_SIZE + 2) : 1] en,   // stage d of the chain moves
+    input  [$clog2(KERNEL_SIZE + 1) - 1 : 0] cfg_kernel_size,  // columns outside the kernel are masked
+    input  max_mode,               // 0 : sum of products, 1 : inflation
+    input  centre_row,             // the row of the centre cell : its cost is the floor of the inflation
+
+    input  [DATA_WIDTH * KERNEL_SIZE - 1 : 0]   pixels_in,   // row of the window, column c at c * DATA_WIDTH
+    input  [WEIGHT_WIDTH * KERNEL_SIZE - 1 : 0] weights,
+    output [(DATA_WIDTH + WEIGHT_WIDTH + $clog2(KERNEL_SIZE)) - 1 : 0] row_out   // row result, ROW_LATENCY steps after pixels_in
+);
+
+    localparam PRODUCT_WIDTH = DATA_WIDTH + WEIGHT_WIDTH;
+    localparam SUM_WIDTH     = PRODUCT_WIDTH + $clog2(KERNEL_SIZE);
+    localparam STAGES        = DSP_PACK ? (KERNEL_SIZE + 1) / 2 : KERNEL_SIZE;
+    localparam KSIZE_W       = $clog2(KERNEL_SIZE + 1);
+    localparam COST_WIDTH    = (DATA_WIDTH > WEIGHT_WIDTH) ? DATA_WIDTH : WEIGHT_WIDTH;   // inflation chain
+
+    // 1. Pixels of the row (the window register is the input register of the chain)
+    wire [DATA_WIDTH * KERNEL_SIZE - 1 : 0] pix_reg = pixels_in;
+
+    wire [KERNEL_SIZE - 1 : 0] col_active;
+    wire [KSIZE_W - 1 : 0]     half = (cfg_kernel_size - 1) / 2;   // centre column of the runtime kernel
+
+    // 2. Systolic chain
+    wire [SUM_WIDTH * (STAGES + 1) - 1 : 0]    sum_chain;   // PCIN/PCOUT
+    wire [COST_WIDTH * (STAGES + 1) - 1 : 0]   max_chain;
+
+    assign sum_chain[SUM_WIDTH - 1 : 0]    = 0;
+    assign max_chain[COST_WIDTH - 1 : 0]   = 0;
+
+    genvar s;
+    generate
+        for (s = 0; s < KERNEL_SIZE; s = s + 1) begin : gen_col
+            assign col_active[s] = (s < cfg_kernel_size);
+        end
+
+        for (s = 0; s < STAGES; s = s + 1) begin : gen_stage
+            wire [DATA_WIDTH - 1 : 0]   a_src = pix_reg[s * DATA_WIDTH +: DATA_WIDTH];
+            wire [DATA_WIDTH - 1 : 0]   d_src;          // mirror column (DSP_PACK)
+            wire [WEIGHT_WIDTH - 1 : 0] w_src;          // 0 for a masked column
+
+            if (DSP_PACK) begin : gen_pack
+                wire [KSIZE_W - 1 : 0] mirror = cfg_kernel_size - 1 - s;
+                assign d_src = (s < half) ? pix_reg[mirror * DATA_WIDTH +: DATA_WIDTH] : {DATA_WIDTH{1'b0}};
+                assign w_src = (s <= half) ? weights[s * WEIGHT_WIDTH +: WEIGHT_WIDTH] : {WEIGHT_WIDTH{1'b0}};
+            end
+            else begin : gen_no_pack
+                assign d_src = {DATA_WIDTH{1'b0}};
+                assign w_src = col_active[s] ? weights[s * WEIGHT_WIDTH +: WEIGHT_WIDTH] : {WEIGHT_WIDTH{1'b0}};
+            end
+
+            // lethal neighbour of this stage (the mirror only counts when it is a real column)
+            wire lethal_src = (a_src == LETHAL_COST) || (DSP_PACK && (s < half) && (d_src == LETHAL_COST));
+
+            // stage s works s steps after stage 0
+            reg  [DATA_WIDTH - 1 : 0] a_dly [0 : s];
+            reg  [DATA_WIDTH - 1 : 0] d_dly [0 : s];
+            reg  [s : 0]              l_dly;
+            integer i;
+
+            always @(posedge clk) begin
+                if (en[1]) begin
+                    a_dly[0] <= a_src;
+                    d_dly[0] <= d_src;
+                end
+                for (i = 1; i <= s; i = i + 1)
+                    if (en[i + 1]) begin
+                        a_dly[i] <= a_dly[i-1];
+                        d_dly[i] <= d_dly[i-1];
+                    end
+            end
+
+            always @(posedge clk) begin
+                if (!rstn)
+                    l_dly <= 0;
+                else
+                    for (i = 0; i <= s; i = i + 1)
+                        if (en[i + 1])
+                            l_dly[i] <= (i == 0) ? lethal_src : l_dly[(i > 0) ? i - 1 : 0];
+            end
+
+            // multiplier input : the pixel, or the pre-added pixel pair
+            wire [DATA_WIDTH : 0] mul_in;
+            wire                  lethal;
+
+            if (DSP_PACK) begin : gen_preadd
+                reg [DATA_WIDTH : 0] ad;
+                reg                  ad_lethal;
+
+                always @(posedge clk) begin
+                    if (en[s + 2]) begin
+                        ad        <= a_dly[s] + d_dly[s];
+                        ad_lethal <= l_dly[s];
+                    end
+                end
+
+                assign mul_in = ad;
+                assign lethal = ad_lethal;
+            end
+            else begin : gen_direct
+                assign mul_in = {1'b0, a_dly[s]};
+                assign lethal = l_dly[s];
+            end
+
+            (* use_dsp = "yes" *) reg [SUM_WIDTH - 1 : 0] m;
+            (* use_dsp = "yes" *) reg [SUM_WIDTH - 1 : 0] p;
+            reg [COST_WIDTH - 1 : 0] q;
+            reg [COST_WIDTH - 1 : 0] mx;
+
+            wire [COST_WIDTH - 1 : 0] mx_in = max_chain[s * COST_WIDTH +: COST_WIDTH];
+            // the centre column is stage half, alone in its stage with DSP_PACK (mul_in is its cell)
+            wire [COST_WIDTH - 1 : 0] inflated = lethal ? w_src : {COST_WIDTH{1'b0}};
+            wire [COST_WIDTH - 1 : 0] own      = (centre_row && s == half) ? mul_in[DATA_WIDTH - 1 : 0] : {COST_WIDTH{1'b0}};
+
+            always @(posedge clk) begin
+                if (!rstn) begin
+                    m  <= 0;
+                    p  <= 0;
+                    q  <= 0;
+                    mx <= 0;
+                end
+                else begin
+                    if (en[s + 2 + DSP_PACK]) begin
+                        m  <= mul_in * w_src;
+                        q  <= (own > inflated) ? own : inflated;
+                    end
+                    if (en[s + 3 + DSP_PACK]) begin
+                        p  <= sum_chain[s * SUM_WIDTH +: SUM_WIDTH] + m;
+                        mx <= (q > mx_in) ? q : mx_in;
+                    end
+                end
+            end
+
+            assign sum_chain[(s + 1) * SUM_WIDTH +: SUM_WIDTH]       = p;
+            assign max_chain[(s + 1) * COST_WIDTH +: COST_WIDTH]     = mx;
+        end
+    endgenerate
+
+    // 3. Row result
+    wire [SUM_WIDTH - 1 : 0] row_sum = sum_chain[STAGES * SUM_WIDTH +: SUM_WIDTH];
+    wire [SUM_WIDTH - 1 : 0] row_max = {{(SUM_WIDTH - COST_WIDTH){1'b0}}, max_chain[STAGES * COST_WIDTH +: COST_WIDTH]};
+
+    assign row_out = max_mode ? row_max : row_sum;
+
+endmodule
@@ -0,0 +1,325 @@
+`timescale 1ns/1ps
+
+// Compute core of top.v : the window engine(s) between the input rows of the frame and the results.
+// The input rows start on a new word each, first cell in the MSBs : with cfg_border the map rows
+// (cfg_width x cfg_height), otherwise the map already padded by (cfg_kernel_size - 1) / 2 cells on
+// every side (the windows of the border cells read the padding).
+//     - NUM_ENGINES = 1 : one engine, one run per frame, one result per transfer on m_axis
+//       (m_axis_tdata holds the result zero extended, m_axis_tbytes is 1, m_axis_tlast marks the last
+//       result of the frame),
+//     - NUM_ENGINES > 1 : stripe dispatcher, window engines and merger, the engines work on column
+//       stripes of every row side by side, BUS_WIDTH/8 one byte costs per transfer in raster order,
+//       m_axis_tlast on the last transfer of the frame. The input buffer of an engine must hold the
+//       words of one row of its stripe (ENGINE_IN_DEPTH * BUS_WIDTH/8 >= cfg_width / NUM_ENGINES +
+//       kernel size + BUS_WIDTH/8) for the engines to overlap, and a frame starts once the one
+//       before it has left the core (top.v).
+// A frame starts on start : its run begins as soon as the engine has stepped the last window of the
+// frame before, so back-to-back frames need no flush. With several engines every stripe restarts on
+// start as well : each used engine gets the descriptor of the new frame (its window generator starts
+// a new run, the rows left in the line buffers are overwritten before a window reads them), the
+// packers drop any part row and the merger starts again from engine 0. abort drops everything in
+// the core (START, STOP). Everything here runs on clk, so top.v can put the core on its own clock (DUAL_CLOCK) with
+// async FIFOs on both streams. The configuration must not change while a frame is in the core.
+module engine_core #(
+    parameter KERNEL_SIZE      = 3,    // size of the synthesized (maximum) PE array
+    parameter DATA_WIDTH       = 8,
+    parameter WEIGHT_WIDTH     = 8,
+    parameter DEPTH            = 4,    // input FIFO depth (words)
+    parameter PTR_WIDTH        = 2,    // clog2(DEPTH)
+    parameter BUS_WIDTH        = 32,
+    parameter NUM_ENGINES      = 1,
+    parameter ENGINE_IN_DEPTH  = 512,  // input buffer of an engine (words) with several engines
+    parameter ENGINE_OUT_DEPTH = 512,
+    parameter MAX_WIDTH        = 2048, // longest input row
+    parameter USE_DSP_ROWS     = 0,
+    parameter DSP_PACK         = 0
+)(
+    input  clk,
+    input  rstn,
+    input  start,                  // one cycle pulse at the start of a frame
+    input  abort,                  // one cycle pulse : drops the frames in the core
+
+    // Configuration
+    input  [15 : 0]             cfg_width,       // result cells per row
+    input  [15 : 0]             cfg_height,      // result rows
+    input                       cfg_border,      // the input is the unpadded map, the border is generated
+    input                       cfg_replicate,   // border policy : 0 zeros, 1 copies of the edge cells
+    input  [$clog2(KERNEL_SIZE + 1) - 1 : 0] cfg_kernel_size,
+    input                       cfg_mode,
+    input  [(WEIGHT_WIDTH * KERNEL_SIZE * KERNEL_SIZE) - 1 : 0] weightsIn,
+
+    // AXI Stream Slave Interface (input rows)
+    input  [BUS_WIDTH - 1 : 0]  s_axis_tdata,
+    input                       s_axis_tvalid,
+    output                      s_axis_tready,
+
+    // AXI Stream Master Interface (results)
+    output [BUS_WIDTH - 1 : 0]  m_axis_tdata,
+    output [$clog2(BUS_WIDTH / 8 + 1) - 1 : 0] m_axis_tbytes,
+    output                      m_axis_tlast,
+    output                      m_axis_tvalid,
+    input                       m_axis_tready,
+
+    // Status
+    output                      busy,        // a word, a window or a result is still in the core
+    output                      active,      // window position stepped (performance counter event)
+    output                      step_idle,   // ... that gives no result (border or halo position)
+    output [PTR_WIDTH : 0]      fifo_level
+);
+
+    localparam RESULT_WIDTH     = DATA_WIDTH + WEIGHT_WIDTH + $clog2(KERNEL_SIZE * KERNEL_SIZE);
+    localparam COUNT_WIDTH      = $clog2(BUS_WIDTH / 8 + 1);
+
+    // cells per input row : the map row, or the map row and its padding
+    wire [15 : 0] pad      = (cfg_kernel_size - 1) >> 1;
+    wire [15 : 0] in_width = cfg_border ? cfg_width : cfg_width + 2 * pad;
+
+    generate
+        if (NUM_ENGINES == 1) begin : gen_single_engine
+            wire [RESULT_WIDTH - 1 : 0] res_tdata;
+            wire desc_ready;
+
+            // one run per frame, queued on start until the engine takes it (top.v lets up to 4 frames
+            // in, the words of the next ones wait in the input FIFO behind the run in progress)
+            reg  [2 : 0] pending;
+            wire         desc_fire = (pending != 0) && desc_ready;
+
+            always @(posedge clk) begin
+                if (!rstn)
+                    pending <= 0;
+                else if (abort)
+                    pending <= start;
+                else
+                    pending <= pending + start - desc_fire;
+            end
+
+            assign m_axis_tdata  = {{(BUS_WIDTH - RESULT_WIDTH){1'b0}}, res_tdata};
+            assign m_axis_tbytes = 1;
+
+            window_engine #(
+                .KERNEL_SIZE(KERNEL_SIZE),
+                .DATA_WIDTH(DATA_WIDTH),
+                .WEIGHT_WIDTH(WEIGHT_WIDTH),
+                .DEPTH(DEPTH),
+                .PTR_WIDTH(PTR_WIDTH),
+                .BUS_WIDTH(BUS_WIDTH),
+                .MAX_WIDTH(MAX_WIDTH),
+                .USE_DSP_ROWS(USE_DSP_ROWS),
+                .DSP_PACK(DSP_PACK)
+            ) engine_inst (
+                .clk(clk),
+                .rstn(rstn),
+                .abort(abort),
+
+                .cfg_in_width(in_width),
+                .cfg_in_skip({COUNT_WIDTH{1'b0}}),
+                .cfg_border_left(cfg_border),
+                .cfg_border_right(cfg_border),
+                .cfg_replicate(cfg_replicate),
+                .cfg_kernel_size(cfg_kernel_size),
+                .cfg_mode(cfg_mode),
+                .weightsIn(weightsIn),
+
+                // the whole frame : the map rows, or the padded ones
+                .desc_rows(cfg_border ? cfg_height : cfg_height + 2 * pad),
+                .desc_border_top(cfg_border),
+                .desc_border_bottom(cfg_border),
+                .desc_valid(pending != 0),
+                .desc_ready(desc_ready),
+
+                .s_axis_tdata(s_axis_tdata),
+                .s_axis_tvalid(s_axis_tvalid),
+                .s_axis_tready(s_axis_tready),
+
+                .m_axis_tdata(res_tdata),
+                .m_axis_tlast(m_axis_tlast),
+                .m_axis_tvalid(m_axis_tvalid),
+                .m_axis_tready(m_axis_tready),
+
+                .busy(busy),
+                .step(active),
+                .step_idle(step_idle),
+                .fifo_level(fifo_level)
+            );
+        end
+        else begin : gen_multi_engine
+            localparam IN_PTR   = $clog2(ENGINE_IN_DEPTH);
+            localparam SEL_WIDTH = $clog2(NUM_ENGINES);
+
+            wire [BUS_WIDTH - 1 : 0]   word_tdata;
+            wire [NUM_ENGINES - 1 : 0] word_tvalid;
+            wire [NUM_ENGINES - 1 : 0] word_tready;
+            wire [15 : 0]              desc_rows;
+            wire                       desc_border_top;
+            wire                       desc_border_bottom;
+            wire [NUM_ENGINES - 1 : 0] desc_valid;
+            wire [NUM_ENGINES - 1 : 0] desc_ready;
+
+            wire [NUM_ENGINES * 16 - 1 : 0]          stripe_in_width;
+            wire [NUM_ENGINES * COUNT_WIDTH - 1 : 0] stripe_in_skip;
+            wire [NUM_ENGINES * 16 - 1 : 0]          stripe_cells;
+            wire [NUM_ENGINES - 1 : 0]               stripe_border_left;
+            wire [NUM_ENGINES - 1 : 0]               stripe_border_right;
+            wire [SEL_WIDTH - 1 : 0]                 last_engine;
+
+            wire [NUM_ENGINES * BUS_WIDTH - 1 : 0]   eng_tdata;
+            wire [NUM_ENGINES * COUNT_WIDTH - 1 : 0] eng_tbytes;
+            wire [NUM_ENGINES - 1 : 0] eng_tlast;
+            wire [NUM_ENGINES - 1 : 0] eng_tvalid;
+            wire [NUM_ENGINES - 1 : 0] eng_tready;
+            wire [NUM_ENGINES - 1 : 0] eng_busy;
+            wire [NUM_ENGINES - 1 : 0] eng_active;
+            wire [NUM_ENGINES - 1 : 0] eng_step_idle;
+            wire [(IN_PTR + 1) * NUM_ENGINES - 1 : 0] eng_fifo_level;
+            wire [IN_PTR : 0]          level0 = eng_fifo_level[IN_PTR : 0];
+
+            assign busy       = |eng_busy || m_axis_tvalid;
+            assign active     = |eng_active;
+            assign step_idle  = |eng_step_idle;
+            // engine 0 stands for the others, its input buffer is ENGINE_IN_DEPTH deep : saturated at DEPTH
+            assign fifo_level = (level0 > DEPTH) ? DEPTH : level0[PTR_WIDTH : 0];
+
+            // 1. Input rows -> column stripes (with their halo) of the engines
+            stripe_dispatcher #(
+                .NUM_ENGINES(NUM_ENGINES),
+                .KERNEL_SIZE(KERNEL_SIZE),
+                .BUS_WIDTH(BUS_WIDTH)
+            ) dispatcher_inst (
+                .clk(clk),
+                .rstn(rstn),
+                .start(start),
+                .abort(abort),
+                .cfg_kernel_size(cfg_kernel_size),
+                .cfg_width(cfg_width),
+                .cfg_height(cfg_height),
+                .cfg_border(cfg_border),
+
+                .s_axis_tdata(s_axis_tdata),
+                .s_axis_tvalid(s_axis_tvalid),
+                .s_axis_tready(s_axis_tready),
+
+                .m_axis_tdata(word_tdata),
+                .m_axis_tvalid(word_tvalid),
+                .m_axis_tready(word_tready),
+
+                .stripe_in_width(stripe_in_width),
+                .stripe_in_skip(stripe_in_skip),
+                .stripe_cells(stripe_cells),
+                .stripe_border_left(stripe_border_left),
+                .stripe_border_right(stripe_border_right),
+                .last_engine(last_engine),
+
+                .desc_rows(desc_rows),
+                .desc_border_top(desc_border_top),
+                .desc_border_bottom(desc_border_bottom),
+                .desc_valid(desc_valid),
+                .desc_ready(desc_ready)
+            );
+
+            // 2. Window engines and their output buffers, same weights for all
+            genvar e;
+            for (e = 0; e < NUM_ENGINES; e = e + 1) begin : gen_engine
+                wire [RESULT_WIDTH - 1 : 0] res_tdata;
+                wire res_tvalid;
+                wire res_tready;
+                wire engine_busy;
+                wire packer_idle;
+
+                assign eng_busy[e] = engine_busy || !packer_idle;
+
+                window_engine #(
+                    .KERNEL_SIZE(KERNEL_SIZE),
+                    .DATA_WIDTH(DATA_WIDTH),
+                    .WEIGHT_WIDTH(WEIGHT_WIDTH),
+                    .DEPTH(ENGINE_IN_DEPTH),
+                    .PTR_WIDTH(IN_PTR),
+                    .FIFO_MEMORY("block"),
+                    .BUS_WIDTH(BUS_WIDTH),
+                    .MAX_WIDTH(MAX_WIDTH),
+                    .USE_DSP_ROWS(USE_DSP_ROWS),
+                    .DSP_PACK(DSP_PACK)
+                ) engine_inst (
+                    .clk(clk),
+                    .rstn(rstn),
+                    .abort(abort),
+
+                    .cfg_in_width(stripe_in_width[e * 16 +: 16]),
+                    .cfg_in_skip(stripe_in_skip[e * COUNT_WIDTH +: COUNT_WIDTH]),
+                    .cfg_border_left(stripe_border_left[e]),
+                    .cfg_border_right(stripe_border_right[e]),
+                    .cfg_replicate(cfg_replicate),
+                    .cfg_kernel_size(cfg_kernel_size),
+                    .cfg_mode(cfg_mode),
+                    .weightsIn(weightsIn),
+
+                    .desc_rows(desc_rows),
+                    .desc_border_top(desc_border_top),
+                    .desc_border_bottom(desc_border_bottom),
+                    .desc_valid(desc_valid[e]),
+                    .desc_ready(desc_ready[e]),
+
+                    .s_axis_tdata(word_tdata),
+                    .s_axis_tvalid(word_tvalid[e]),
+                    .s_axis_tready(word_tready[e]),
+
+                    .m_axis_tdata(res_tdata),
+                    .m_axis_tlast(),
+                    .m_axis_tvalid(res_tvalid),
+                    .m_axis_tready(res_tready),
+
+                    .busy(engine_busy),
+                    .step(eng_active[e]),
+                    .step_idle(eng_step_idle[e]),
+                    .fifo_level(eng_fifo_level[e * (IN_PTR + 1) +: IN_PTR + 1])
+                );
+
+                stripe_packer #(
+                    .RESULT_WIDTH(RESULT_WIDTH),
+                    .BUS_WIDTH(BUS_WIDTH),
+                    .OUT_DEPTH(ENGINE_OUT_DEPTH)
+                ) packer_inst (
+                    .clk(clk),
+                    .rstn(rstn),
+                    .clear(abort || start),
+                    .cfg_row_cells(stripe_cells[e * 16 +: 16]),
+
+                    .s_axis_tdata(res_tdata),
+                    .s_axis_tvalid(res_tvalid),
+                    .s_axis_tready(res_tready),
+
+                    .m_axis_tdata(eng_tdata[e * BUS_WIDTH +: BUS_WIDTH]),
+                    .m_axis_tbytes(eng_tbytes[e * COUNT_WIDTH +: COUNT_WIDTH]),
+                    .m_axis_tlast(eng_tlast[e]),
+                    .m_axis_tvalid(eng_tvalid[e]),
+                    .m_axis_tready(eng_tready[e]),
+                    .idle(packer_idle)
+                );
+            end
+
+            // 3. Stripes -> raster order
+            stripe_merger #(
+                .NUM_ENGINES(NUM_ENGINES),
+                .BUS_WIDTH(BUS_WIDTH)
+            ) merger_inst (
+                .clk(clk),
+                .rstn(rstn && !abort),
+                .start(start),
+                .frame_cells(cfg_width * cfg_height),
+                .last_engine(last_engine),
+
+                .s_axis_tdata(eng_tdata),
+                .s_axis_tbytes(eng_tbytes),
+                .s_axis_tlast(eng_tlast),
+                .s_axis_tvalid(eng_tvalid),
+                .s_axis_tready(eng_tready),
+
+                .m_axis_tdata(m_axis_tdata),
+                .m_axis_tbytes(m_axis_tbytes),
+                .m_axis_tlast(m_axis_tlast),
+                .m_axis_tvalid(m_axis_tvalid),
+                .m_axis_tready(m_axis_tready)
+            );
+        end
+    endgenerate
+
+endmodule
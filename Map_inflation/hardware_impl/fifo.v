@@ -17,7 +17,10 @@ module fifo
     // read interface
     input RD,
     output reg [DATAWIDTH-1:0]  dataOut,
-    output   empty
+    output   empty,
+
+    // occupancy
+    output [PTR_WIDTH:0] level
   );
 
    reg [PTR_WIDTH-1 : 0] wr_addr;
@@ -99,6 +102,9 @@ module fifo
 
           assign empty =(wr_addr == rd_addr) && (wr_cnt == rd_cnt) ;
 	  assign full = (wr_addr == rd_addr) &&  (wr_cnt != rd_cnt );
+
+   // same lap : distance between the pointers, otherwise the write pointer has wrapped once more
+	  assign level = (wr_cnt == rd_cnt) ? (wr_addr - rd_addr) : (DEPTH - rd_addr + wr_addr);
                   
    endmodule
 
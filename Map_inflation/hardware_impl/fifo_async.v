@@ -0,0 +1,94 @@
+`timescale 1ns/1ps
+
+// Asynchronous FIFO between two clock domains (AXI Stream handshake on both sides).
+// Each side keeps a binary and a gray-coded pointer with one extra lap bit. Only the gray pointers
+// cross, through cdc_sync, so a pointer seen on the other side is always a value it really had :
+// full and empty are pessimistic for two cycles but never wrong. The words sit in LUT RAM and are
+// shown first-word-fall-through on m_tdata.
+// DEPTH = 2**PTR_WIDTH, PTR_WIDTH of 2 at least.
+module fifo_async
+ #(
+    parameter DATAWIDTH = 8,
+    parameter PTR_WIDTH = 4
+  )
+  (
+    // write side
+    input                   s_clk,
+    input                   s_rstn,
+    input                   s_tvalid,
+    input  [DATAWIDTH-1:0]  s_tdata,
+    output                  s_tready,
+    output                  s_empty,     // every word has been read (seen from the write side)
+
+    // read side
+    input                   m_clk,
+    input                   m_rstn,
+    input                   m_tready,
+    output [DATAWIDTH-1:0]  m_tdata,
+    output                  m_tvalid
+  );
+
+   localparam DEPTH = 1 << PTR_WIDTH;
+
+   (* ram_style = "distributed" *) reg [DATAWIDTH-1:0] MEM [0:DEPTH-1];
+
+   reg  [PTR_WIDTH:0] wr_bin;
+   reg  [PTR_WIDTH:0] wr_gray;
+   reg  [PTR_WIDTH:0] rd_bin;
+   reg  [PTR_WIDTH:0] rd_gray;
+   wire [PTR_WIDTH:0] rd_gray_s;   // read pointer in the write domain
+   wire [PTR_WIDTH:0] wr_gray_s;   // write pointer in the read domain
+
+   wire [PTR_WIDTH:0] wr_bin_next = wr_bin + 1;
+   wire [PTR_WIDTH:0] rd_bin_next = rd_bin + 1;
+
+   // full : same position, one lap ahead (the two MSBs of a gray pointer flip every lap)
+   wire full  = (wr_gray == {~rd_gray_s[PTR_WIDTH:PTR_WIDTH-1], rd_gray_s[PTR_WIDTH-2:0]});
+   wire empty = (rd_gray == wr_gray_s);
+
+   assign s_tready = !full;
+   assign s_empty  = (wr_gray == rd_gray_s);
+   assign m_tvalid = !empty;
+   assign m_tdata  = MEM[rd_bin[PTR_WIDTH-1:0]];
+
+   //write interface
+   always @(posedge s_clk) begin
+      if (!s_rstn) begin
+         wr_bin  <= 0;
+         wr_gray <= 0;
+      end
+      else if (s_tvalid && !full) begin
+         MEM[wr_bin[PTR_WIDTH-1:0]] <= s_tdata;
+         wr_bin  <= wr_bin_next;
+         wr_gray <= (wr_bin_next >> 1) ^ wr_bin_next;
+      end
+   end
+
+   //read interface
+   always @(posedge m_clk) begin
+      if (!m_rstn) begin
+         rd_bin  <= 0;
+         rd_gray <= 0;
+      end
+      else if (m_tready && !empty) begin
+         rd_bin  <= rd_bin_next;
+         rd_gray <= (rd_bin_next >> 1) ^ rd_bin_next;
+      end
+   end
+
+   //pointer synchronizers
+   cdc_sync #(.WIDTH(PTR_WIDTH + 1)) rd_ptr_sync (
+      .dst_clk(s_clk),
+      .dst_rstn(s_rstn),
+      .src_data(rd_gray),
+      .dst_data(rd_gray_s)
+   );
+
+   cdc_sync #(.WIDTH(PTR_WIDTH + 1)) wr_ptr_sync (
+      .dst_clk(m_clk),
+      .dst_rstn(m_rstn),
+      .src_data(wr_gray),
+      .dst_data(wr_gray_s)
+   );
+
+endmodule
@@ -17,7 +17,10 @@ module fifo_axis
     // read interface
     input m_tready,
     output  [DATAWIDTH-1:0] m_tdata ,
-    output   m_tvalid
+    output   m_tvalid,
+
+    // occupancy
+    output  [PTR_WIDTH:0] level
   );
 
   wire full;
@@ -39,7 +42,8 @@ module fifo_axis
 
          .dataOut( m_tdata),
          .empty(empty),
-         .RD(m_tready)
+         .RD(m_tready),
+         .level(level)
   );
 
 
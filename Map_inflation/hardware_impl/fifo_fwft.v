@@ -0,0 +1,172 @@
+`timescale 1ns/1ps
+
+// Synchronous FIFO family with first-word-fall-through output (AXI Stream handshake on both sides).
+// The storage follows the depth : shift registers (SRL16/SRL32) up to 32 words, block RAM above,
+// MEMORY_TYPE forces "srl", "distributed" (LUT RAM) or "block". The memory is always read one cycle
+// ahead into a register (the BRAM output latch, or the flip-flop behind the SRL). With OUTPUT_REG = 1
+// a second register drives m_tdata/m_tvalid, so no memory path reaches the consumer and a word can
+// leave every cycle. Both registers count in level : DEPTH words fit whatever the options.
+// almost_full/almost_empty are registered, they compare level with thresholds that can change at runtime.
+// DEPTH must be a power of 2 for the RAM types.
+module fifo_fwft
+ #(
+    parameter DATAWIDTH   = 8,
+    parameter DEPTH       = 16,
+    parameter PTR_WIDTH   = 4,        // clog2(DEPTH)
+    parameter MEMORY_TYPE = "auto",   // "auto", "srl", "distributed" or "block"
+    parameter OUTPUT_REG  = 1
+  )
+  (
+    input clk,
+    input rstn,
+
+    // write interface
+    input                   s_tvalid,
+    input  [DATAWIDTH-1:0]  s_tdata,
+    output                  s_tready,
+
+    // read interface (first word shown as soon as it is in)
+    input                   m_tready,
+    output [DATAWIDTH-1:0]  m_tdata,
+    output                  m_tvalid,
+
+    // occupancy and early warning flags
+    input  [PTR_WIDTH:0]    prog_full_thresh,    // almost_full when level >= prog_full_thresh
+    input  [PTR_WIDTH:0]    prog_empty_thresh,   // almost_empty when level <= prog_empty_thresh
+    output reg              almost_full,
+    output reg              almost_empty,
+    output [PTR_WIDTH:0]    level
+  );
+
+   localparam USE_SRL = (MEMORY_TYPE == "srl") || ((MEMORY_TYPE == "auto") && (DEPTH <= 32));
+
+   reg  [PTR_WIDTH:0]   count;       // words in the FIFO (memory and registers)
+   reg  [PTR_WIDTH:0]   mem_count;   // words in the memory
+
+   // read-ahead register
+   reg  [DATAWIDTH-1:0] q_data;
+   reg                  q_valid;
+
+   wire wr     = s_tvalid && s_tready;
+   wire rd     = m_tvalid && m_tready;
+   wire q_free;
+   wire mem_rd = (mem_count != 0) && q_free;
+
+   wire [PTR_WIDTH:0] next_count = count + wr - rd;
+
+   assign s_tready = (count < DEPTH);
+   assign level    = count;
+
+   //output stage
+   generate
+      if (OUTPUT_REG) begin : gen_out_reg
+         reg [DATAWIDTH-1:0] o_data;
+         reg                 o_valid;
+         wire                o_load = q_valid && (!o_valid || m_tready);
+
+         assign q_free   = !q_valid || o_load;
+         assign m_tdata  = o_data;
+         assign m_tvalid = o_valid;
+
+         always @(posedge clk) begin
+            if (!rstn)
+               o_valid <= 1'b0;
+            else if (o_load)
+               o_valid <= 1'b1;
+            else if (m_tready)
+               o_valid <= 1'b0;
+
+            if (o_load)
+               o_data <= q_data;
+         end
+      end
+      else begin : gen_no_out_reg
+         assign q_free   = !q_valid || m_tready;
+         assign m_tdata  = q_data;
+         assign m_tvalid = q_valid;
+      end
+   endgenerate
+
+   always @(posedge clk) begin
+      if (!rstn)
+         q_valid <= 1'b0;
+      else if (mem_rd)
+         q_valid <= 1'b1;
+      else if (q_free)
+         q_valid <= 1'b0;
+   end
+
+   //storage
+   generate
+      if (USE_SRL) begin : gen_srl
+         // data shifts in at 0, the oldest word sits at mem_count - 1
+         (* shreg_extract = "yes" *) reg [DATAWIDTH-1:0] srl [0:DEPTH-1];
+         integer i;
+
+         always @(posedge clk) begin
+            if (wr) begin
+               srl[0] <= s_tdata;
+               for (i = 1; i < DEPTH; i = i + 1)
+                  srl[i] <= srl[i-1];
+            end
+            if (mem_rd)
+               q_data <= srl[mem_count - 1];
+         end
+      end
+      else begin : gen_ram
+         reg [PTR_WIDTH-1:0] wr_addr;
+         reg [PTR_WIDTH-1:0] rd_addr;
+
+         if (MEMORY_TYPE == "distributed") begin : gen_lutram
+            (* ram_style = "distributed" *) reg [DATAWIDTH-1:0] MEM [0:DEPTH-1];
+
+            always @(posedge clk) begin
+               if (wr)
+                  MEM[wr_addr] <= s_tdata;
+               if (mem_rd)
+                  q_data <= MEM[rd_addr];
+            end
+         end
+         else begin : gen_bram
+            (* ram_style = "block" *) reg [DATAWIDTH-1:0] MEM [0:DEPTH-1];
+
+            always @(posedge clk) begin
+               if (wr)
+                  MEM[wr_addr] <= s_tdata;
+               if (mem_rd)
+                  q_data <= MEM[rd_addr];
+            end
+         end
+
+         always @(posedge clk) begin
+            if (!rstn) begin
+               wr_addr <= 0;
+               rd_addr <= 0;
+            end
+            else begin
+               if (wr)
+                  wr_addr <= wr_addr + 1;
+               if (mem_rd)
+                  rd_addr <= rd_addr + 1;
+            end
+         end
+      end
+   endgenerate
+
+   //occupancy and flags
+   always @(posedge clk) begin
+      if (!rstn) begin
+         count        <= 0;
+         mem_count    <= 0;
+         almost_full  <= 1'b0;
+         almost_empty <= 1'b1;
+      end
+      else begin
+         count        <= next_count;
+         mem_count    <= mem_count + wr - mem_rd;
+         almost_full  <= (next_count >= prog_full_thresh);
+         almost_empty <= (next_count <= prog_empty_thresh);
+      end
+   end
+
+endmodule
@@ -0,0 +1,251 @@
+`timescale 1ns/1ps
+
+// On-chip kernel generator (CTRL bit4) : computes the inflation kernel of kernel_compute() from the cost
+// scaling factor, the inscribed radius and the map resolution (Q16.16 registers) instead of receiving
+// its cfg_kernel_size x cfg_kernel_size weights from the host. For the cell (dx, dy) of the centre :
+//     dx^2 + dy^2 > r^2            -> 0
+//     distance <= inscribed radius -> 254 (lethal)
+//     otherwise                    -> 253 * exp(-scale * (distance - inscribed)), truncated
+// with distance = resolution * sqrt(dx^2 + dy^2) (integer square root in 1/256 cell) and
+// exp(-x) = 2^-(x * log2(e)) : an integer shift and a 33 entry table of 2^(-i/32), linearly interpolated.
+// The kernel is radially symmetric, so only one octant is computed (dx <= dy, a few cycles per cell)
+// into a quadrant table, then the whole kernel is streamed row-major from it, BUS_WIDTH/WEIGHT_WIDTH
+// weights per transfer (first one in the MSBs), in the format of weight_loader.sv.
+// software_impl/host/kernel_gen.c is the bit exact reference model.
+module kernel_gen #(
+    parameter KERNEL_SIZE  = 13,   // size of the synthesized (maximum) PE array
+    parameter WEIGHT_WIDTH = 8,
+    parameter BUS_WIDTH    = 32
+)(
+    input  clk,
+    input  rstn,
+    input  start,                  // one cycle pulse, ignored while busy
+
+    input  [$clog2(KERNEL_SIZE + 1) - 1 : 0] cfg_kernel_size,   // odd, sampled on start
+    input  [31 : 0]             cfg_scale,        // cost scaling factor (1/m), Q16.16
+    input  [31 : 0]             cfg_inscribed,    // inscribed radius (m), Q16.16
+    input  [31 : 0]             cfg_resolution,   // map resolution (m per cell), Q16.16
+    output                      busy,
+
+    // AXI Stream Master Interface (weights, to the weight loader)
+    output reg [BUS_WIDTH - 1 : 0] m_axis_tdata,
+    output reg                  m_axis_tvalid,
+    input                       m_axis_tready
+);
+
+    localparam KSIZE_W  = $clog2(KERNEL_SIZE + 1);
+    localparam R_MAX    = (KERNEL_SIZE - 1) / 2;
+    localparam TABLE_W  = R_MAX + 1;                   // quadrant table : TABLE_W x TABLE_W costs
+    localparam LANES    = BUS_WIDTH / WEIGHT_WIDTH;
+    localparam [16 : 0] LOG2E = 17'd94548;             // log2(e) in Q16.16
+    localparam [7 : 0]  LETHAL = 8'd254;
+
+    typedef enum {IDLE, SETUP, CELL, SQRT, DIST, EXPO, MANT, SCALE, WRITE, STREAM} state_t;
+    state_t state;
+
+    reg  [KSIZE_W - 1 : 0] k;           // kernel size of this run
+    reg  [KSIZE_W - 1 : 0] r;           // and its radius
+    reg  [31 : 0]          scale_l2e;   // scale * log2(e), Q16.16
+    reg  [31 : 0]          inscribed;
+    reg  [31 : 0]          resolution;
+
+    reg  [KSIZE_W - 1 : 0] dx, dy;      // cell of the octant (dx <= dy)
+    reg  [31 : 0]          d2;          // dx^2 + dy^2, then << 16
+    reg  [15 : 0]          root;        // sqrt(d2), 1/256 cell
+    reg  [4 : 0]           sqrt_bit;
+    reg  [47 : 0]          dist;        // meters, Q16.16
+    reg  [47 : 0]          y;           // scale * log2(e) * excess, Q16.16
+    reg  [16 : 0]          mant;        // 2^-frac(y), Q16.16
+    reg  [7 : 0]           cost;
+
+    reg  [WEIGHT_WIDTH - 1 : 0] table_q [0 : TABLE_W * TABLE_W - 1];
+
+    reg  [KSIZE_W - 1 : 0] row, col;    // kernel cell of the first weight of the next transfer
+    integer l;
+    integer lane_row, lane_col;
+    integer qy, qx;
+
+    wire out_free = !m_axis_tvalid || m_axis_tready;
+
+    assign busy = (state != IDLE) || m_axis_tvalid;
+
+    // 2^(-i/32), Q16.16
+    function [16 : 0] exp2_lut;
+        input [5 : 0] i;
+        begin
+            case (i)
+                6'd0:  exp2_lut = 17'd65536;  6'd1:  exp2_lut = 17'd64132;  6'd2:  exp2_lut = 17'd62757;
+                6'd3:  exp2_lut = 17'd61413;  6'd4:  exp2_lut = 17'd60097;  6'd5:  exp2_lut = 17'd58809;
+                6'd6:  exp2_lut = 17'd57549;  6'd7:  exp2_lut = 17'd56316;  6'd8:  exp2_lut = 17'd55109;
+                6'd9:  exp2_lut = 17'd53928;  6'd10: exp2_lut = 17'd52773;  6'd11: exp2_lut = 17'd51642;
+                6'd12: exp2_lut = 17'd50535;  6'd13: exp2_lut = 17'd49452;  6'd14: exp2_lut = 17'd48393;
+                6'd15: exp2_lut = 17'd47356;  6'd16: exp2_lut = 17'd46341;  6'd17: exp2_lut = 17'd45348;
+                6'd18: exp2_lut = 17'd44376;  6'd19: exp2_lut = 17'd43425;  6'd20: exp2_lut = 17'd42495;
+                6'd21: exp2_lut = 17'd41584;  6'd22: exp2_lut = 17'd40693;  6'd23: exp2_lut = 17'd39821;
+                6'd24: exp2_lut = 17'd38968;  6'd25: exp2_lut = 17'd38133;  6'd26: exp2_lut = 17'd37316;
+                6'd27: exp2_lut = 17'd36516;  6'd28: exp2_lut = 17'd35734;  6'd29: exp2_lut = 17'd34968;
+                6'd30: exp2_lut = 17'd34219;  6'd31: exp2_lut = 17'd33486;  default: exp2_lut = 17'd32768;
+            endcase
+        end
+    endfunction
+
+    // 1. Arithmetic of the current cell
+    wire [31 : 0] dist2         = dx * dx + dy * dy;
+    wire [31 : 0] radius2       = r * r;
+    wire [63 : 0] scale_product = cfg_scale * LOG2E;
+    wire [15 : 0] sqrt_trial    = root | (16'd1 << sqrt_bit);
+    wire [63 : 0] dist_product  = resolution * root;
+    wire [47 : 0] excess_full   = dist - inscribed;
+    wire [31 : 0] excess        = (excess_full[47 : 32] != 0) ? 32'hFFFF_FFFF : excess_full[31 : 0];
+    wire [63 : 0] y_product     = scale_l2e * excess;
+    wire [4 : 0]  frac_index    = y[15 : 11];
+    wire [10 : 0] frac_step     = y[10 : 0];
+    wire [16 : 0] lut_lo        = exp2_lut(frac_index);
+    wire [16 : 0] lut_hi        = exp2_lut(frac_index + 6'd1);
+    wire [27 : 0] interp        = (lut_lo - lut_hi) * frac_step;
+    wire [24 : 0] cost_scaled   = 8'd253 * mant;
+
+    // 2. Octant of the quadrant table, then the kernel stream
+    always @(posedge clk) begin
+        if (!rstn) begin
+            state         <= IDLE;
+            k             <= 1;
+            r             <= 0;
+            scale_l2e     <= 0;
+            inscribed     <= 0;
+            resolution    <= 0;
+            dx            <= 0;
+            dy            <= 0;
+            d2            <= 0;
+            root          <= 0;
+            sqrt_bit      <= 0;
+            dist          <= 0;
+            y             <= 0;
+            mant          <= 0;
+            cost          <= 0;
+            row           <= 0;
+            col           <= 0;
+            m_axis_tdata  <= 0;
+            m_axis_tvalid <= 1'b0;
+        end
+        else begin
+            if (m_axis_tready)
+                m_axis_tvalid <= 1'b0;
+
+            case (state)
+                IDLE: begin
+                    if (start) begin
+                        k          <= cfg_kernel_size;
+                        r          <= (cfg_kernel_size - 1) >> 1;
+                        inscribed  <= cfg_inscribed;
+                        resolution <= cfg_resolution;
+                        scale_l2e  <= (scale_product[63 : 48] != 0) ? 32'hFFFF_FFFF : scale_product[47 : 16];
+                        state      <= SETUP;
+                    end
+                end
+
+                SETUP: begin
+                    dx    <= 0;
+                    dy    <= 0;
+                    state <= CELL;
+                end
+
+                CELL: begin
+                    // outside the inflation radius : no square root needed
+                    d2 <= dist2 << 16;
+                    if (dist2 > radius2) begin
+                        cost  <= 0;
+                        state <= WRITE;
+                    end
+                    else begin
+                        root     <= 0;
+                        sqrt_bit <= 15;
+                        state    <= SQRT;
+                    end
+                end
+
+                // floor(sqrt(d2)), one result bit per cycle
+                SQRT: begin
+                    if (sqrt_trial * sqrt_trial <= d2)
+                        root <= sqrt_trial;
+                    sqrt_bit <= sqrt_bit - 1;
+                    if (sqrt_bit == 0)
+                        state <= DIST;
+                end
+
+                DIST: begin
+                    dist  <= dist_product[55 : 8];
+                    state <= EXPO;
+                end
+
+                EXPO: begin
+                    y     <= y_product[63 : 16];
+                    state <= MANT;
+                    if (dist <= inscribed) begin
+                        cost  <= LETHAL;
+                        state <= WRITE;
+                    end
+                end
+
+                MANT: begin
+                    mant  <= lut_lo - interp[27 : 11];
+                    state <= SCALE;
+                end
+
+                // 253 * 2^-(n + f) : 2^-8 and below truncate to zero
+                SCALE: begin
+                    cost  <= (y[47 : 16] >= 8) ? 8'd0 : cost_scaled >> (16 + y[18 : 16]);
+                    state <= WRITE;
+                end
+
+                // radial symmetry : (dx, dy) and (dy, dx) of the quadrant
+                WRITE: begin
+                    table_q[dy * TABLE_W + dx] <= cost;
+                    table_q[dx * TABLE_W + dy] <= cost;
+
+                    // next cell of the octant
+                    state <= CELL;
+                    if (dx == dy) begin
+                        dx <= 0;
+                        dy <= dy + 1;
+                        if (dy == r) begin
+                            row   <= 0;
+                            col   <= 0;
+                            state <= STREAM;
+                        end
+                    end
+                    else
+                        dx <= dx + 1;
+                end
+
+                // the kernel, row-major, folded on the quadrant table
+                STREAM: begin
+                    if (out_free) begin
+                        lane_row = row;
+                        lane_col = col;
+                        for (l = 0; l < LANES; l = l + 1) begin
+                            qy = (lane_row >= r) ? lane_row - r : r - lane_row;
+                            qx = (lane_col >= r) ? lane_col - r : r - lane_col;
+                            m_axis_tdata[BUS_WIDTH - 1 - l*WEIGHT_WIDTH -: WEIGHT_WIDTH] <=
+                                (lane_row < k) ? table_q[qy * TABLE_W + qx] : {WEIGHT_WIDTH{1'b0}};
+                            if (lane_col == k - 1) begin
+                                lane_col = 0;
+                                lane_row = lane_row + 1;
+                            end
+                            else
+                                lane_col = lane_col + 1;
+                        end
+                        m_axis_tvalid <= 1'b1;
+                        row <= lane_row;
+                        col <= lane_col;
+                        if (lane_row >= k)
+                            state <= IDLE;
+                    end
+                end
+
+                default: state <= IDLE;
+            endcase
+        end
+    end
+
+endmodule
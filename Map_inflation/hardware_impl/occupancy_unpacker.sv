@@ -0,0 +1,92 @@
+`timescale 1ns/1ps
+
+// Bit-packed occupancy input : one bit per cell (1 = lethal obstacle), BUS_WIDTH cells per transfer.
+// The cells form one continuous bit stream, first cell in the MSB of the first transfer, and every
+// cfg_width bits make one input row. The rows are expanded to the byte per cell input of the
+// engine (LETHAL_COST for an obstacle, 0 otherwise) : every row starts on a new word, first cell in
+// the MSBs, BUS_WIDTH/8 cells per word, so the rest of the engine is unchanged.
+// The padding bits after the last row of a frame are dropped by start.
+module occupancy_unpacker #(
+    parameter DATA_WIDTH  = 8,
+    parameter BUS_WIDTH   = 32,  // cells per transfer
+    parameter LETHAL_COST = 254
+)(
+    input  clk,
+    input  rstn,
+
+    input  [15 : 0]             cfg_width,   // cells per input row
+    input                       start,       // one cycle pulse at the start of a frame, drops the leftover bits
+
+    // AXI Stream Slave Interface (packed cells)
+    input  [BUS_WIDTH - 1 : 0]  s_axis_tdata,
+    input                       s_axis_tvalid,
+    output                      s_axis_tready,
+
+    // AXI Stream Master Interface (input rows, one byte per cell)
+    input                       m_axis_tready,
+    output reg [BUS_WIDTH - 1 : 0] m_axis_tdata,
+    output reg                  m_axis_tvalid,
+
+    output                      idle     // no full word left : the remaining bits (if any) are padding
+);
+
+    localparam BUF_BITS = 2 * BUS_WIDTH;
+    localparam CELLS    = BUS_WIDTH / DATA_WIDTH;   // cells per output word
+
+    reg [BUF_BITS - 1 : 0]            bit_buf;   // first cell in the MSB
+    reg [$clog2(BUF_BITS + 1) - 1 : 0] bit_cnt;
+    reg [15 : 0]                      col;       // column of the first cell of the next word
+
+    reg [BUF_BITS - 1 : 0]            next_buf;
+    reg [$clog2(BUF_BITS + 1) - 1 : 0] next_cnt;
+    integer p;
+
+    // cells of the next word : a full word, or what is left of the row
+    wire [15 : 0] row_left = cfg_width - col;
+    wire [15 : 0] n        = (row_left < CELLS) ? row_left : CELLS;
+
+    // a transfer is taken as long as it fits behind the cells still waiting
+    assign s_axis_tready = (bit_cnt <= BUS_WIDTH);
+
+    wire emit = (!m_axis_tvalid || m_axis_tready) && (bit_cnt >= n);
+
+    assign idle = !m_axis_tvalid && (bit_cnt < n);
+
+    always @(posedge clk) begin
+        if (!rstn || start) begin
+            bit_buf       <= 0;
+            bit_cnt       <= 0;
+            col           <= 0;
+            m_axis_tdata  <= 0;
+            m_axis_tvalid <= 1'b0;
+        end
+        else begin
+            next_buf = bit_buf;
+            next_cnt = bit_cnt;
+
+            if (m_axis_tready)
+                m_axis_tvalid <= 1'b0;
+
+            // 1. one word of the row per cycle
+            if (emit) begin
+                for (p = 0; p < CELLS; p = p + 1)
+                    m_axis_tdata[BUS_WIDTH - 1 - p*DATA_WIDTH -: DATA_WIDTH] <=
+                        (p < n && bit_buf[BUF_BITS - 1 - p]) ? LETHAL_COST : {DATA_WIDTH{1'b0}};
+                m_axis_tvalid <= 1'b1;
+                col <= (n == row_left) ? 16'd0 : col + n;
+                next_buf = bit_buf << n;
+                next_cnt = bit_cnt - n;
+            end
+
+            // 2. new cells appended behind the remaining ones
+            if (s_axis_tvalid && s_axis_tready) begin
+                next_buf = next_buf | ({s_axis_tdata, {BUS_WIDTH{1'b0}}} >> next_cnt);
+                next_cnt = next_cnt + BUS_WIDTH;
+            end
+
+            bit_buf <= next_buf;
+            bit_cnt <= next_cnt;
+        end
+    end
+
+endmodule
@@ -1,63 +1,38 @@
 `timescale 1ns/1ps
 
-module pe 
+module pe
    #(
         parameter WEIGHT_WIDTH = 8,
-	parameter DATA_WIDTH = 8
+	parameter DATA_WIDTH = 8,
+	parameter LETHAL_COST = 254                          // cost of a lethal obstacle cell
     )
     (
 	input clk,
 	input rstn,
-        //inputs interface	
-	input [(DATA_WIDTH-1):0] pe_input,                   // input pixel 
+        //inputs interface
+	input [(DATA_WIDTH-1):0] pe_input,                   // cell of the window (pe_wrapper.v)
 	input [(WEIGHT_WIDTH-1):0] pe_weight,                // processing element weight
-        input pe_en,                                         // when this is asserted,  the PE start
+        input pe_en,                                         // the product register takes the cell of a new window
+        input max_mode,                                      // 0 : product pixel*weight, 1 : inflation (weight if the pixel is lethal)
+        input own_cell,                                      // the PE holds the centre cell : its cost is the floor of the inflation
 	// outpute interface
-	output reg [(DATA_WIDTH-1):0] pe_pixel_out,          // output pixel = input pixel transfered to the next PE
-	output reg [(DATA_WIDTH+WEIGHT_WIDTH)-1 :0] pe_output,  // this is the result currently computed
-	output reg pe_done
+	output reg [(DATA_WIDTH+WEIGHT_WIDTH)-1 :0] pe_output  // product of the last window taken
      );
 
-    // Input Registers
-    reg [(DATA_WIDTH-1):0] pe_input_reg;
-    reg [(WEIGHT_WIDTH-1):0] pe_weight_reg;
-
-    reg  pe_en_reg;
+    // the neighbour only inflates if it is an obstacle
+    wire [(DATA_WIDTH+WEIGHT_WIDTH)-1 :0] inflated = (pe_input == LETHAL_COST) ? pe_weight : 0;
 
+    // The window register of window_gen.sv is the input register of the PE : one register stage here,
+    // enabled like every other stage of the pipeline
     always @(posedge clk) begin
-        if (!rstn) begin
-	    pe_input_reg  <= 0;
-            pe_weight_reg <= 0;
-            pe_output     <= 0;
-            pe_pixel_out  <= 0;
-            pe_done    <= 1'b0;
-	    pe_en_reg <= 0;
-        end
-        else begin
-	    // register  inputs
-	    pe_input_reg <= pe_input;
-	    pe_weight_reg <= pe_weight;
-
-            
-            pe_en_reg <= pe_en;
-            // forward pixel regardless
-           // pe_pixel_out <= pe_input_reg;
-           // pe_pixel_out <= pe_input;
-            if (pe_en_reg) begin
-                pe_pixel_out <= pe_input_reg; // to allow differents row pe to get an input at the same clock cyle
-                
-		(* use_dsp = "yes" *) // to Map the multiplication below to a DSP block
-                pe_output <= pe_input_reg * pe_weight_reg;
-                pe_done    <= 1'b1;
-            end
+        if (!rstn)
+            pe_output <= 0;
+        else if (pe_en) begin
+            if (max_mode)
+                pe_output <= (own_cell && pe_input > inflated) ? pe_input : inflated;
             else
-                begin
-            	   pe_done    <= 1'b0;
-            	 //  pe_output <= 0;
-            	 //  pe_pixel_out <= 0;
-            	end
-            	
-               
-       end
-   end
+	        (* use_dsp = "yes" *) // to Map the multiplication below to a DSP block
+                pe_output <= pe_input * pe_weight;
+        end
+    end
 endmodule
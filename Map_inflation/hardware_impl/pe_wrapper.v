@@ -1,137 +1,177 @@
 `timescale 1ns/1ps
+
+// PE array of a window engine : one KERNEL_SIZE x KERNEL_SIZE window per transfer (window_gen.sv),
+// one result per window. PE(r, c) takes cell (r, c) of the window and the weight of the same
+// position, every row is reduced by its adder tree (or its DSP48 cascade, dsp_row.v) and the row
+// results by the tree of the array :
+//     - convolution (cfg_mode = 0) : sum of pixel * weight over the window,
+//     - inflation   (cfg_mode = 1) : max over the whole window, the row trees and the tree of the
+//       array alike, of the weights of the lethal cells and of the cost of the centre cell itself,
+//       as map_inflation_compute() (inflation_random.c).
+// PEs outside the cfg_kernel_size x cfg_kernel_size corner get a zero weight (and window_gen.sv
+// gives them zero cells). Every stage t of the pipeline has its valid bit and moves on its own enable
+// ce[t] : it takes the window of the stage before it when it is empty or when the stage after it
+// moves, so a stall on m_axis only holds the stages that hold a window and the bubbles between
+// them are filled. Results leave in window order, m_axis_tlast is the tlast of their window.
 module pe_wrapper #(
-    parameter KERNEL_SIZE  = 3,
+    parameter KERNEL_SIZE  = 3,  // size of the synthesized (maximum) PE array
     parameter DATA_WIDTH   = 8,
-    parameter WEIGHT_WIDTH = 8
+    parameter WEIGHT_WIDTH = 8,
+    parameter USE_DSP_ROWS = 0,  // 1 : rows built on DSP48 cascades (dsp_row.v) instead of PEs and an adder tree
+    parameter DSP_PACK     = 0   // with USE_DSP_ROWS : two columns per DSP, for left/right symmetric kernels only
 )(
     input  clk,
     input  rstn,
-    input  en,
-    input  [DATA_WIDTH * KERNEL_SIZE - 1 : 0] dataIn,
+    input  [$clog2(KERNEL_SIZE + 1) - 1 : 0] cfg_kernel_size, // runtime kernel size : PEs outside the cfg_kernel_size x cfg_kernel_size corner are masked
+    input  cfg_mode,  // 0 : convolution (sum of products), 1 : inflation (max of the own cost and the weights of the lethal neighbours)
     input  [(WEIGHT_WIDTH * KERNEL_SIZE * KERNEL_SIZE) - 1 : 0] weightsIn,
 
-    input m_axis_tready,
-    output [(DATA_WIDTH + WEIGHT_WIDTH +  $clog2(KERNEL_SIZE)) - 1 : 0] m_axis_tdata,
+    // AXI Stream Slave Interface (windows, cell (r, c) at (r * KERNEL_SIZE + c) * DATA_WIDTH)
+    input  [(DATA_WIDTH * KERNEL_SIZE * KERNEL_SIZE) - 1 : 0] s_axis_tdata,
+    input  s_axis_tlast,
+    input  s_axis_tvalid,
+    output s_axis_tready,
+
+    // AXI Stream Master Interface (one result per window)
+    input  m_axis_tready,
+    output [(DATA_WIDTH + WEIGHT_WIDTH + $clog2(KERNEL_SIZE * KERNEL_SIZE)) - 1 : 0] m_axis_tdata,
+    output m_axis_tlast,
     output m_axis_tvalid,
-   // output [(DATA_WIDTH + WEIGHT_WIDTH + KERNEL_SIZE) * KERNEL_SIZE - 1 : 0] dataOut,
-    output ready
+    output idle         // no window left in the array
 );
     localparam PRODUCT_WIDTH = DATA_WIDTH + WEIGHT_WIDTH;
-    localparam SUM_WIDTH     = DATA_WIDTH + WEIGHT_WIDTH + $clog2(KERNEL_SIZE);
-    localparam PARTIAL_SUM_WIDTH = PRODUCT_WIDTH + $clog2(KERNEL_SIZE);
+    localparam ROW_WIDTH     = PRODUCT_WIDTH + $clog2(KERNEL_SIZE);           // result of one row
+    localparam RESULT_WIDTH  = DATA_WIDTH + WEIGHT_WIDTH + $clog2(KERNEL_SIZE * KERNEL_SIZE);
     localparam ROW_STRIDE    = DATA_WIDTH * KERNEL_SIZE;
-    localparam TOTAL_DONE_DELAY = 3; // Adder latency: 3 cycles
-    
-    //reg start_counter;
-    
-    // Bus for vertical pixel propagation
-    wire [ROW_STRIDE * (KERNEL_SIZE + 1) - 1 : 0] vertical_pixel_bus;
-    wire [KERNEL_SIZE - 1 : 0] row_ready_signals;
-    
-    // --- Intermediate AXI-Stream signals to collect results from all rows ---
-    wire [KERNEL_SIZE-1:0] row_tvalid;
-    wire [KERNEL_SIZE-1:0] row_tready;
-    wire [PARTIAL_SUM_WIDTH * KERNEL_SIZE - 1 : 0] row_tdata;
-    
-    assign ready = rstn;
-    
-    // 1. Input Mapping (Direct wire to start the pipeline)
-    assign vertical_pixel_bus[ROW_STRIDE - 1 : 0] = dataIn;
-    
+    // steps from the window to the row results : PE and row tree, or the DSP chain (dsp_row.v)
+    localparam ROW_LATENCY   = !USE_DSP_ROWS ? 2 : DSP_PACK ? (KERNEL_SIZE + 1) / 2 + 3 : KERNEL_SIZE + 2;
+    localparam STAGES        = ROW_LATENCY + 1;                               // and the tree of the array
+
+    // Active rows/columns of the PE array for the runtime kernel size, and the centre one
+    wire [KERNEL_SIZE - 1 : 0] active_lines;
+    wire [$clog2(KERNEL_SIZE + 1) - 1 : 0] centre = (cfg_kernel_size - 1) >> 1;
+
+    // Row results, into the tree of the array
+    wire [ROW_WIDTH * KERNEL_SIZE - 1 : 0] row_results;
+    wire [ROW_WIDTH + $clog2(KERNEL_SIZE) - 1 : 0] array_result;
+
+    // valid / last of the window in every stage (stage 0 is the window on s_axis)
+    reg  [STAGES : 1] valid_pipe;
+    reg  [STAGES : 1] last_pipe;
+    wire [STAGES : 0] valid_in = {valid_pipe, s_axis_tvalid};
+    wire [STAGES : 0] last_in  = {last_pipe, s_axis_tlast};
+
+    // 1. Flow control : stage t moves when it is empty or when stage t + 1 moves (ce[STAGES + 1] : the
+    //    result is taken)
+    wire [STAGES + 1 : 1] ce;
+
+    assign ce[STAGES + 1] = m_axis_tready;
+    assign s_axis_tready  = ce[1];
+    assign m_axis_tvalid  = valid_pipe[STAGES];
+    assign m_axis_tlast   = last_pipe[STAGES];
+    assign m_axis_tdata   = array_result[RESULT_WIDTH - 1 : 0];
+    assign idle           = !(|valid_pipe);
+
+    genvar t;
+    generate
+        for (t = 1; t <= STAGES; t = t + 1) begin : gen_ce
+            assign ce[t] = !valid_pipe[t] || ce[t + 1];
+        end
+    endgenerate
+
+    integer i;
+    always @(posedge clk) begin
+        if (!rstn) begin
+            valid_pipe <= 0;
+            last_pipe  <= 0;
+        end
+        else
+            for (i = 1; i <= STAGES; i = i + 1)
+                if (ce[i]) begin
+                    valid_pipe[i] <= valid_in[i - 1];
+                    last_pipe[i]  <= last_in[i - 1];
+                end
+    end
+
+    // 2. Rows of the array
     genvar r, c;
     generate
-        for (r = 0; r < KERNEL_SIZE; r = r + 1) begin 
-            wire [KERNEL_SIZE-1:0] row_pe_dones;
-            wire [PRODUCT_WIDTH*KERNEL_SIZE-1:0] products;
-            
-            // This row's adder is active when its PEs are done
-            wire row_adder_en = &row_pe_dones;
-            assign row_ready_signals[r] = row_adder_en;
-            
-            for (c = 0; c < KERNEL_SIZE; c = c + 1) begin 
+        for (r = 0; r < KERNEL_SIZE; r = r + 1) begin
+            assign active_lines[r] = (r < cfg_kernel_size);
+        end
+
+        for (r = 0; r < KERNEL_SIZE; r = r + 1) begin : gen_row
+            wire [ROW_STRIDE - 1 : 0] row_pixels = s_axis_tdata[r * ROW_STRIDE +: ROW_STRIDE];
+
+          if (USE_DSP_ROWS) begin : gen_dsp_row
+            // a masked row gets zero weights (dsp_row.v masks the columns)
+            wire [WEIGHT_WIDTH * KERNEL_SIZE - 1 : 0] row_weights =
+                active_lines[r] ? weightsIn[r * KERNEL_SIZE * WEIGHT_WIDTH +: KERNEL_SIZE * WEIGHT_WIDTH] : {(WEIGHT_WIDTH * KERNEL_SIZE){1'b0}};
+
+            dsp_row #(
+                .KERNEL_SIZE(KERNEL_SIZE),
+                .DATA_WIDTH(DATA_WIDTH),
+                .WEIGHT_WIDTH(WEIGHT_WIDTH),
+                .DSP_PACK(DSP_PACK)
+            ) row_inst (
+                .clk(clk),
+                .rstn(rstn),
+                .en(ce[ROW_LATENCY : 1]),
+                .cfg_kernel_size(cfg_kernel_size),
+                .max_mode(cfg_mode),
+                .centre_row(r == centre),
+                .pixels_in(row_pixels),
+                .weights(row_weights),
+                .row_out(row_results[r * ROW_WIDTH +: ROW_WIDTH])
+            );
+          end
+          else begin : gen_pe_row
+            wire [PRODUCT_WIDTH * KERNEL_SIZE - 1 : 0] products;
+
+            for (c = 0; c < KERNEL_SIZE; c = c + 1) begin : gen_pe
                 pe #(
                     .DATA_WIDTH(DATA_WIDTH),
                     .WEIGHT_WIDTH(WEIGHT_WIDTH)
                 ) pe_inst (
                     .clk(clk),
                     .rstn(rstn),
-                    .pe_en(en),
-                    .pe_input(vertical_pixel_bus[(r * ROW_STRIDE) + ((KERNEL_SIZE - 1 - c) * DATA_WIDTH) +: DATA_WIDTH]),
-                    // Input comes from previous row's output bus
-                   // .pe_input(vertical_pixel_bus[(r * ROW_STRIDE) + (c * DATA_WIDTH) +: DATA_WIDTH]),
-                    .pe_weight(weightsIn[(r*KERNEL_SIZE + c)*WEIGHT_WIDTH +: WEIGHT_WIDTH]),
-                    // Output goes to next row's input bus
-                    //.pe_pixel_out(vertical_pixel_bus[((r+1) * ROW_STRIDE) + (c * DATA_WIDTH) +: DATA_WIDTH]),
-                    .pe_output(products[c*PRODUCT_WIDTH +: PRODUCT_WIDTH]),
-                    // Keep output consistent with the input flip
-                    .pe_pixel_out(vertical_pixel_bus[((r+1) * ROW_STRIDE) + ((KERNEL_SIZE - 1 - c) * DATA_WIDTH) +: DATA_WIDTH]),
-                    .pe_done(row_pe_dones[c])
+                    .pe_en(ce[1]),
+                    .max_mode(cfg_mode),
+                    .own_cell((r == centre) && (c == centre)),
+                    .pe_input(row_pixels[c * DATA_WIDTH +: DATA_WIDTH]),
+                    // masked PEs get a zero weight
+                    .pe_weight((active_lines[r] && active_lines[c]) ? weightsIn[(r*KERNEL_SIZE + c)*WEIGHT_WIDTH +: WEIGHT_WIDTH] : {WEIGHT_WIDTH{1'b0}}),
+                    .pe_output(products[c*PRODUCT_WIDTH +: PRODUCT_WIDTH])
                 );
             end
-            
-            // 2. Adder Tree - connect to INTERMEDIATE signal
+
+            // Adder Tree of the row
             adder_tree #(
                 .KERNEL_SIZE(KERNEL_SIZE),
-                .DATA_WIDTH(DATA_WIDTH),
-                .WEIGHT_WIDTH(WEIGHT_WIDTH)
+                .IN_WIDTH(PRODUCT_WIDTH)
             ) row_sum_adder (
                 .clk(clk),
                 .rstn(rstn),
-                // write interface
-                .adder_en(row_adder_en),
+                .max_mode(cfg_mode),
+                .adder_en(ce[2]),
                 .adder_dataIn(products),
-                // read interface
-		.m_axis_tready(row_tready[r]),
-		.m_axis_tvalid(row_tvalid[r]),
-		.m_axis_tdata(row_tdata[r * PARTIAL_SUM_WIDTH +: PARTIAL_SUM_WIDTH])
-               // .adder_dataOut(dataOut[r*SUM_WIDTH +: SUM_WIDTH]) // Connect to intermediate wire, NOT final output
+                .adder_dataOut(row_results[r * ROW_WIDTH +: ROW_WIDTH])
             );
+          end
         end
     endgenerate
-    
-    //logic to start our cross bar module:
-    /*always @(posedge clk) begin
-        if (!rstn) begin
-            start_counter <= 1'b0;
-        end 
-        else begin
-            if (|row_tvalid) begin
-                start_counter <= 1'b1;
-            end
-        end
-    end*/
-    
-    // 3. The Crossbar - Multiplexes kernel size rows into 1 final output
-    crossbar#(
-        .KERNEL_SIZE(KERNEL_SIZE),
-        .DATA_WIDTH(PARTIAL_SUM_WIDTH)
-    ) crossbar_inst (
-        .clk(clk),
-        .rstn(rstn),
 
-        // Slave side: connected to all the row adders
-        .s_axis_tvalid(row_tvalid),
-        .s_axis_tdata (row_tdata),
-        .s_axis_tready(row_tready),
-
-        // Master side: final output of the pe_wrapper
-        .m_axis_tvalid(m_axis_tvalid),
-        .m_axis_tdata (m_axis_tdata),
-        .m_axis_tready(m_axis_tready)
-    );
-    
-
-    
-    // 3. Streaming Done Signal
-   /* delay #(
-        .LATENCY(TOTAL_DONE_DELAY), 
-        .WIDTH(1)
-      ) delay_inst (
+    // 3. Tree of the array : the row results of one window into its result
+    adder_tree #(
+        .KERNEL_SIZE(KERNEL_SIZE),
+        .IN_WIDTH(ROW_WIDTH)
+    ) array_adder (
         .clk(clk),
         .rstn(rstn),
-        .dataIn(en), // this asserts one thepe_wrapper is enable                    // (|row_ready_signals : This asserts if adder of Row 0 OR Row 1 OR Row 2 ... is enable)
-        .dataOut(dataOut_done)
+        .max_mode(cfg_mode),
+        .adder_en(ce[STAGES]),
+        .adder_dataIn(row_results),
+        .adder_dataOut(array_result)
     );
-    */
-    
+
 endmodule
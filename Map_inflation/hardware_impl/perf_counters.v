@@ -0,0 +1,94 @@
+`timescale 1ns/1ps
+
+// Free-running performance counters of the accelerator.
+// The counters run all the time; a snapshot copies all of them on the same
+// clock edge so software reads a coherent set, and clear restarts them from 0.
+module perf_counters #(
+    parameter NUM_FIFOS   = 3,   // number of input FIFOs
+    parameter LEVEL_WIDTH = 3,   // width of a FIFO occupancy
+    parameter COUNT_WIDTH = 32
+)(
+    input  clk,
+    input  rstn,
+
+    // control
+    input  snapshot,
+    input  clear,
+
+    // events, sampled every cycle
+    input  ev_active,        // a window position is stepped
+    input  ev_out_stall,     // output valid but m_axis_tready low
+    input  ev_in_starved,    // the engine could take a word but s_axis_tvalid is low
+    input  ev_weight_load,   // a weight transfer (data stream or side channel) is accepted or waited for
+    input  ev_xbar_idle,     // a window position gives no result (border or halo position)
+    input  [NUM_FIFOS * LEVEL_WIDTH - 1 : 0] fifo_level,
+
+    // snapshot values
+    output reg [COUNT_WIDTH - 1 : 0] snap_cycles,
+    output reg [COUNT_WIDTH - 1 : 0] snap_active,
+    output reg [COUNT_WIDTH - 1 : 0] snap_out_stall,
+    output reg [COUNT_WIDTH - 1 : 0] snap_in_starved,
+    output reg [COUNT_WIDTH - 1 : 0] snap_weight_load,
+    output reg [COUNT_WIDTH - 1 : 0] snap_xbar_idle,
+    output reg [NUM_FIFOS * LEVEL_WIDTH - 1 : 0] snap_fifo_hwm
+);
+
+    reg [COUNT_WIDTH - 1 : 0] cnt_cycles;
+    reg [COUNT_WIDTH - 1 : 0] cnt_active;
+    reg [COUNT_WIDTH - 1 : 0] cnt_out_stall;
+    reg [COUNT_WIDTH - 1 : 0] cnt_in_starved;
+    reg [COUNT_WIDTH - 1 : 0] cnt_weight_load;
+    reg [COUNT_WIDTH - 1 : 0] cnt_xbar_idle;
+    reg [NUM_FIFOS * LEVEL_WIDTH - 1 : 0] fifo_hwm;   // high-water mark of each FIFO
+
+    integer i;
+
+    // counters
+    always @(posedge clk) begin
+        if (!rstn || clear) begin
+            cnt_cycles      <= 0;
+            cnt_active      <= 0;
+            cnt_out_stall   <= 0;
+            cnt_in_starved  <= 0;
+            cnt_weight_load <= 0;
+            cnt_xbar_idle   <= 0;
+            fifo_hwm        <= 0;
+        end
+        else begin
+            cnt_cycles      <= cnt_cycles      + 1;
+            cnt_active      <= cnt_active      + ev_active;
+            cnt_out_stall   <= cnt_out_stall   + ev_out_stall;
+            cnt_in_starved  <= cnt_in_starved  + ev_in_starved;
+            cnt_weight_load <= cnt_weight_load + ev_weight_load;
+            cnt_xbar_idle   <= cnt_xbar_idle   + ev_xbar_idle;
+
+            for (i = 0; i < NUM_FIFOS; i = i + 1) begin
+                if (fifo_level[i*LEVEL_WIDTH +: LEVEL_WIDTH] > fifo_hwm[i*LEVEL_WIDTH +: LEVEL_WIDTH])
+                    fifo_hwm[i*LEVEL_WIDTH +: LEVEL_WIDTH] <= fifo_level[i*LEVEL_WIDTH +: LEVEL_WIDTH];
+            end
+        end
+    end
+
+    // snapshot
+    always @(posedge clk) begin
+        if (!rstn) begin
+            snap_cycles      <= 0;
+            snap_active      <= 0;
+            snap_out_stall   <= 0;
+            snap_in_starved  <= 0;
+            snap_weight_load <= 0;
+            snap_xbar_idle   <= 0;
+            snap_fifo_hwm    <= 0;
+        end
+        else if (snapshot) begin
+            snap_cycles      <= cnt_cycles;
+            snap_active      <= cnt_active;
+            snap_out_stall   <= cnt_out_stall;
+            snap_in_starved  <= cnt_in_starved;
+            snap_weight_load <= cnt_weight_load;
+            snap_xbar_idle   <= cnt_xbar_idle;
+            snap_fifo_hwm    <= fifo_hwm;
+        end
+    end
+
+endmodule
@@ -0,0 +1,259 @@
+#!/usr/bin/env python3
+"""Analytical model of top.v : cycles per frame, cells per cycle, latency and approximate resources.
+
+    python3 perf_model.py --array 13 --radius 6 --width 200 --height 200 [--engines 2] [--clock 100]
+    python3 perf_model.py --check verilator/obj_bench_top/bench_top [--tolerance 0.1]
+
+The model follows the datapath of a frame with the on-chip border (MODE bit4) or a map the host
+padded, one engine or several (column stripes, see stripe_dispatcher.sv) :
+    - input     : s_axis beats, ceil(row / (BUS_WIDTH/8)) per input row, at the s_axis_tvalid duty cycle,
+    - compute   : the window generator of an engine steps one position per cycle (window_gen.sv),
+                  every input cell plus the right / bottom border positions, the engines work on
+                  their stripes (with the halo columns of the neighbours) in parallel,
+    - output    : one cell per m_axis transfer (BUS_WIDTH/8 with several engines and plain output),
+                  at the m_axis_tready duty cycle.
+A streamed frame takes the slowest of the three, the pipeline fill (latency) only shows at the start
+of a stream. The resource figures are rough per-block estimates for a 7-series part (LUT, FF, DSP48,
+36 Kb BRAM), meant to compare parameter sets before synthesis, not to replace the report.
+
+--check runs the Verilator benchmark (bench_top, see verilator/build.sh) on a few frame sizes, radii
+and duty cycles, and compares its cycles per cell and first-result latency with the model.
+Unverified : --check has never been run (no Verilator build of top.v so far), so the latency
+constants and the resource figures are read off the RTL, not validated against simulation or
+synthesis.
+"""
+
+import argparse
+import math
+import subprocess
+import sys
+
+DATA_WIDTH = 8
+WEIGHT_WIDTH = 8
+
+# pipeline stages of the datapath, in cycles (see window_engine.v, pe_wrapper.v)
+INPUT_LATENCY = 1        # input register
+FIFO_LATENCY = 2         # input FIFO write, read register
+WINDOW_LATENCY = 3       # row serializer, line buffer read, window register (window_gen.sv)
+PE_LATENCY = 2           # PE input register, product register
+ADDER_LATENCY = 2        # adder_tree.v
+OUTPUT_LATENCY = 2       # row combine, output register
+STRIPE_LATENCY = 3       # dispatcher, stripe packer, merger (several engines)
+
+
+def row_latency(array, dsp_rows, dsp_pack):
+    if not dsp_rows:
+        return ADDER_LATENCY
+    return (array + 1) // 2 + 3 if dsp_pack else array + 2
+
+
+def stripes(p, pad):
+    """Input columns and positions of every used engine : [(in_width, positions)]."""
+    border = p.border != "none"
+    if p.engines == 1:
+        in_width = p.width if border else p.width + 2 * pad
+        return [(in_width, in_width + (pad if border else 0))]
+    stripe = -(-p.width // p.engines)
+    result = []
+    for e in range(p.engines):
+        x0 = e * stripe
+        if x0 >= p.width:
+            break
+        x1 = min(x0 + stripe, p.width)
+        if border:
+            in_width = min(x1 + pad, p.width) - max(x0 - pad, 0)
+            result.append((in_width, in_width + (pad if x1 == p.width else 0)))
+        else:
+            result.append((x1 - x0 + 2 * pad, x1 - x0 + 2 * pad))
+    return result
+
+
+def model(p):
+    """Cycle and latency figures of one frame for the parameter set p (argparse namespace)."""
+    k = min(2 * p.radius + 1, p.array)
+    lanes = p.bus // 8
+    pad = (k - 1) // 2
+    border = p.border != "none"
+
+    in_rows = p.height if border else p.height + 2 * pad
+    pos_rows = p.height + pad if border else in_rows
+    in_width = p.width if border else p.width + 2 * pad
+    in_beats = in_rows * -(-in_width // lanes)
+    kept = p.width * p.height
+
+    # every engine steps the positions of its stripe, the slowest one sets the pace
+    engine_stripes = stripes(p, pad)
+    positions = sum(width for _, width in engine_stripes) * pos_rows
+    compute = max(width for _, width in engine_stripes) * pos_rows
+
+    wide_out = p.engines > 1
+    out_cycles = (kept / lanes if wide_out else kept) / p.out_duty
+    in_cycles = in_beats / p.in_duty
+
+    bounds = {"input": in_cycles, "compute": compute, "output": out_cycles}
+    bottleneck = max(bounds, key=bounds.get)
+    frame = bounds[bottleneck]
+
+    fill = (INPUT_LATENCY + FIFO_LATENCY + WINDOW_LATENCY + PE_LATENCY +
+            row_latency(p.array, p.dsp_rows, p.dsp_pack) + OUTPUT_LATENCY +
+            (STRIPE_LATENCY if p.engines > 1 else 0))
+    # the first window comes once its bottom-right cell is in : lead rows and columns of positions
+    # (pad with the on-chip border, 2 * pad in a pre-padded map)
+    lead = pad if border else 2 * pad
+    first = fill + lead * engine_stripes[0][1] + lead
+
+    return {
+        "kernel": k,
+        "positions": positions,
+        "results": kept,
+        "cells": kept,
+        "bounds": bounds,
+        "bottleneck": bottleneck,
+        "frame_cycles": frame,
+        "cells_per_cycle": kept / frame,
+        "fill": fill,
+        "first_latency": first,
+        "frame_latency": frame + fill,
+    }
+
+
+def resources(p):
+    """Approximate LUT / FF / DSP48 / BRAM36 of the whole design."""
+    a = p.array
+    sum_width = DATA_WIDTH + WEIGHT_WIDTH + math.ceil(math.log2(a)) if a > 1 else DATA_WIDTH + WEIGHT_WIDTH
+    engines = p.engines
+
+    # one engine : PE array, row adders, window register and line buffers, input FIFO
+    pe_ff = 42                                   # input, weight, product, pixel registers
+    pe_lut = 12                                  # lethal compare, max mode select
+    if p.dsp_rows:
+        dsp = a * ((a + 1) // 2 if p.dsp_pack else a)
+        row_lut = 4 * sum_width
+        row_ff = sum_width * (a + 4)
+    else:
+        dsp = a * a
+        row_lut = (a - 1) * sum_width + 8 * sum_width // 2   # adder tree, result FIFO (SRL)
+        row_ff = 3 * sum_width * a // 2
+    engine_lut = a * a * pe_lut + a * row_lut + a * sum_width // 2 + a * DATA_WIDTH * max(p.depth // 16, 1)
+    engine_ff = a * a * pe_ff + a * row_ff + (a + 2) * sum_width + a * DATA_WIDTH * p.depth
+    engine_lut += a * a * DATA_WIDTH // 4        # window register shift / border select
+    engine_ff += a * a * DATA_WIDTH
+    # k - 1 line buffers of MAX_WIDTH cells, one BRAM18 (half a BRAM36) per 18 Kb
+    engine_bram = (a - 1) * math.ceil(p.max_width * DATA_WIDTH / 18432.0) / 2.0
+    if engines > 1:
+        engine_bram += max(1.0, p.engine_in_depth * p.bus / 36864.0)
+        engine_bram += max(1.0, p.engine_out_depth * p.bus / 36864.0)
+        engine_lut += 150
+        engine_ff += 200
+
+    # shared : two weight banks, register file, counters, DMA, kernel generator, occupancy unpacker,
+    # run-length encoder, output FIFO
+    weights_ff = 2 * a * a * WEIGHT_WIDTH
+    weights_lut = a * a * WEIGHT_WIDTH // 2
+    shared_lut = 3500 + weights_lut + a * DATA_WIDTH
+    shared_ff = 3000 + weights_ff + a * DATA_WIDTH * 2
+    shared_dsp = 4                               # kernel generator, distance and exponent products
+    if engines > 1:
+        shared_lut += 400 * engines
+        shared_ff += 300 * engines
+
+    return {
+        "LUT": int(engines * engine_lut + shared_lut),
+        "FF": int(engines * engine_ff + shared_ff),
+        "DSP48": engines * dsp + shared_dsp,
+        "BRAM36": math.ceil(engines * engine_bram),
+    }
+
+
+def report(p):
+    m = model(p)
+    r = resources(p)
+    print("array %dx%d, kernel %dx%d (radius %d), %d engine(s), BUS_WIDTH %d, DEPTH %d%s" %
+          (p.array, p.array, m["kernel"], m["kernel"], p.radius, p.engines, p.bus, p.depth,
+           ", DSP rows" + (" packed" if p.dsp_pack else "") if p.dsp_rows else ""))
+    print("frame %dx%d, %s border, duty cycles s_axis %.2f m_axis %.2f, %.0f MHz" %
+          (p.width, p.height, p.border, p.in_duty, p.out_duty, p.clock))
+    print()
+    print("positions / results    : %d / %d" % (m["positions"], m["results"]))
+    for name, cycles in m["bounds"].items():
+        print("%-22s : %.0f cycles%s" % (name + " bound", cycles, "  <- bottleneck" if name == m["bottleneck"] else ""))
+    print("cycles per frame       : %.0f (streamed)" % m["frame_cycles"])
+    print("cells per cycle        : %.3f (%.3f cycles per cell)" % (m["cells_per_cycle"], 1.0 / m["cells_per_cycle"]))
+    print("frames per second      : %.1f" % (p.clock * 1e6 / m["frame_cycles"]))
+    print("latency                : %.0f cycles to the first result, %.0f to the last (%.1f us)" %
+          (m["first_latency"], m["frame_latency"], m["frame_latency"] / p.clock))
+    print("resources (approx.)    : %d LUT, %d FF, %d DSP48, %d BRAM36" % (r["LUT"], r["FF"], r["DSP48"], r["BRAM36"]))
+
+
+def check(p):
+    """Model against the Verilator benchmark, on a small grid of runs."""
+    points = []
+    for width, height in ((32, 24), (100, 60)):
+        for radius in (1, 3, 6):
+            for in_duty, out_duty in ((1.0, 1.0), (1.0, 0.5), (0.3, 1.0)):
+                points.append((width, height, radius, in_duty, out_duty))
+
+    failures = 0
+    print("%-18s %6s %7s %7s  %10s %10s %6s  %8s %8s %6s" % ("run", "radius", "s_axis", "m_axis", "cyc/cell", "model",
+                                                             "error", "latency", "model", "error"))
+    for width, height, radius, in_duty, out_duty in points:
+        command = [p.check, "--width", str(width), "--height", str(height), "--radius", str(radius),
+                   "--frames", str(p.frames), "--in-duty", str(in_duty), "--out-duty", str(out_duty), "--csv"]
+        result = subprocess.run(command, capture_output=True, text=True)
+        if result.returncode != 0 or not result.stdout.strip():
+            print("%s : failed\n%s" % (" ".join(command), result.stderr.strip()))
+            failures += 1
+            continue
+        fields = result.stdout.strip().splitlines()[-1].split(",")
+        array = int(fields[0])
+        measured_cpc = float(fields[9])
+        measured_first = float(fields[13])
+
+        q = argparse.Namespace(**vars(p))
+        q.array, q.width, q.height, q.radius = array, width, height, radius
+        q.in_duty, q.out_duty, q.border = in_duty, out_duty, "zero"
+        m = model(q)
+        model_cpc = (p.frames * m["frame_cycles"] + m["fill"]) / (p.frames * m["cells"])
+        cpc_error = (model_cpc - measured_cpc) / measured_cpc
+        first_error = (m["first_latency"] - measured_first) / max(measured_first, 1.0)
+        bad = abs(cpc_error) > p.tolerance or abs(first_error) > p.tolerance
+        failures += bad
+        print("%-18s %6d %7.2f %7.2f  %10.3f %10.3f %5.1f%%  %8.0f %8.0f %5.1f%%%s" %
+              ("%dx%d" % (width, height), radius, in_duty, out_duty, measured_cpc, model_cpc, 100 * cpc_error,
+               measured_first, m["first_latency"], 100 * first_error, "  <-" if bad else ""))
+
+    print("%d runs, %d outside %.0f%%" % (len(points), failures, 100 * p.tolerance))
+    return failures == 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--array", type=int, default=13, help="KERNEL_SIZE, synthesized PE array")
+    parser.add_argument("--radius", type=int, default=6, help="RADIUS register (kernel 2r+1, clamped to the array)")
+    parser.add_argument("--width", type=int, default=100)
+    parser.add_argument("--height", type=int, default=100)
+    parser.add_argument("--bus", type=int, default=32, help="BUS_WIDTH")
+    parser.add_argument("--depth", type=int, default=4, help="DEPTH, input FIFOs")
+    parser.add_argument("--engines", type=int, default=1, help="NUM_ENGINES")
+    parser.add_argument("--engine-in-depth", type=int, default=512, help="ENGINE_IN_DEPTH")
+    parser.add_argument("--engine-out-depth", type=int, default=512, help="ENGINE_OUT_DEPTH")
+    parser.add_argument("--max-width", type=int, default=2048, help="MAX_WIDTH, line buffer depth")
+    parser.add_argument("--dsp-rows", action="store_true", help="USE_DSP_ROWS")
+    parser.add_argument("--dsp-pack", action="store_true", help="DSP_PACK")
+    parser.add_argument("--border", choices=["zero", "replicate", "none"], default="zero",
+                        help="on-chip border (MODE bit4/bit5), none : the host pads the map")
+    parser.add_argument("--in-duty", type=float, default=1.0, help="s_axis_tvalid duty cycle")
+    parser.add_argument("--out-duty", type=float, default=1.0, help="m_axis_tready duty cycle")
+    parser.add_argument("--clock", type=float, default=100.0, help="clk in MHz")
+    parser.add_argument("--check", metavar="BENCH", help="compare with runs of this bench_top executable")
+    parser.add_argument("--frames", type=int, default=3, help="frames per benchmark run (--check)")
+    parser.add_argument("--tolerance", type=float, default=0.1, help="relative error allowed by --check")
+    p = parser.parse_args()
+
+    if p.check:
+        sys.exit(0 if check(p) else 1)
+    report(p)
+
+
+if __name__ == "__main__":
+    main()
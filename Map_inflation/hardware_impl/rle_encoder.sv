@@ -0,0 +1,112 @@
+`timescale 1ns/1ps
+
+// Optional run-length encoder of the output stream.
+// Every result is saturated to a one byte cost and runs of equal costs leave as one token :
+//     token[OUT_WIDTH-1 : VALUE_WIDTH] = run length (1 .. 2^RUN_WIDTH - 1), token[VALUE_WIDTH-1 : 0] = cost
+// A run never goes past the last cell of a frame (s_axis_tlast), so every frame ends on a token,
+// the one with m_axis_tlast.
+// With enable low the results pass through unchanged (zero extended to OUT_WIDTH).
+module rle_encoder #(
+    parameter IN_WIDTH    = 20,  // width of one engine result
+    parameter VALUE_WIDTH = 8,   // width of the encoded cost
+    parameter OUT_WIDTH   = 32
+)(
+    input  clk,
+    input  rstn,
+    input  enable,               // change it between frames only
+
+    // AXI Stream Slave Interface (engine results)
+    input  [IN_WIDTH - 1 : 0]   s_axis_tdata,
+    input                       s_axis_tlast,   // last cell of the frame
+    input                       s_axis_tvalid,
+    output                      s_axis_tready,
+
+    // AXI Stream Master Interface (results or tokens)
+    output [OUT_WIDTH - 1 : 0]  m_axis_tdata,
+    output                      m_axis_tlast,   // last token (or cell) of the frame
+    output                      m_axis_tvalid,
+    input                       m_axis_tready
+);
+
+    localparam RUN_WIDTH = OUT_WIDTH - VALUE_WIDTH;
+    localparam [RUN_WIDTH - 1 : 0] MAX_RUN = {RUN_WIDTH{1'b1}};
+    localparam [VALUE_WIDTH - 1 : 0] MAX_VALUE = {VALUE_WIDTH{1'b1}};
+
+    reg [VALUE_WIDTH - 1 : 0] run_value;
+    reg [RUN_WIDTH - 1 : 0]   run_len;
+    reg                       run_open;
+    reg                       flush_pending;  // the last run of the frame still has to leave
+    reg [OUT_WIDTH - 1 : 0]   token;
+    reg                       token_last;
+    reg                       token_valid;
+
+    wire [VALUE_WIDTH - 1 : 0] cost = (s_axis_tdata > MAX_VALUE) ? MAX_VALUE : s_axis_tdata[VALUE_WIDTH - 1 : 0];
+    wire out_free  = !token_valid || m_axis_tready;
+    wire rle_ready = out_free && !flush_pending;
+    wire rle_fire  = enable && s_axis_tvalid && rle_ready;
+    wire same_run  = run_open && (cost == run_value) && (run_len != MAX_RUN);
+
+    // Bypass or encoded output
+    assign s_axis_tready = enable ? rle_ready : m_axis_tready;
+    assign m_axis_tvalid = enable ? token_valid : s_axis_tvalid;
+    assign m_axis_tdata  = enable ? token : {{(OUT_WIDTH - IN_WIDTH){1'b0}}, s_axis_tdata};
+    assign m_axis_tlast  = enable ? token_last : s_axis_tlast;
+
+    always @(posedge clk) begin
+        if (!rstn || !enable) begin
+            run_value     <= 0;
+            run_len       <= 0;
+            run_open      <= 1'b0;
+            flush_pending <= 1'b0;
+            token         <= 0;
+            token_last    <= 1'b0;
+            token_valid   <= 1'b0;
+        end
+        else begin
+            if (m_axis_tready)
+                token_valid <= 1'b0;
+
+            // 1. the last run of the frame, once the token before it is gone
+            if (flush_pending && out_free) begin
+                token         <= {run_len, run_value};
+                token_last    <= 1'b1;
+                token_valid   <= 1'b1;
+                run_open      <= 1'b0;
+                flush_pending <= 1'b0;
+            end
+
+            // 2. a new cell
+            else if (rle_fire) begin
+                if (same_run) begin
+                    // the run grows, it only leaves at the end of the frame
+                    run_len <= run_len + 1;
+                    if (s_axis_tlast) begin
+                        token       <= {run_len + 1'b1, run_value};
+                        token_last  <= 1'b1;
+                        token_valid <= 1'b1;
+                        run_open    <= 1'b0;
+                    end
+                end
+                else begin
+                    // the cost changes (or the run is full) : the previous run leaves, a new one starts
+                    run_value <= cost;
+                    run_len   <= 1;
+                    run_open  <= 1'b1;
+                    if (run_open) begin
+                        token         <= {run_len, run_value};
+                        token_last    <= 1'b0;
+                        token_valid   <= 1'b1;
+                        flush_pending <= s_axis_tlast;
+                    end
+                    else if (s_axis_tlast) begin
+                        token       <= {{(RUN_WIDTH - 1){1'b0}}, 1'b1, cost};
+                        token_last  <= 1'b1;
+                        token_valid <= 1'b1;
+                        run_open    <= 1'b0;
+                    end
+                end
+            end
+        end
+    end
+
+endmodule
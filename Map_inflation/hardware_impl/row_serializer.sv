@@ -0,0 +1,71 @@
+`timescale 1ns/1ps
+
+// Input rows -> one cell per transfer (window_gen.sv). Every row starts on a new transfer, first cell
+// in the MSBs, BUS_WIDTH / DATA_WIDTH cells per transfer : the first cfg_skip cells of the first
+// transfer belong to the stripe on the left and are dropped (a stripe starts anywhere in a word,
+// stripe_dispatcher.sv), the last transfer of a row holds the cells left of cfg_width, the rest of
+// it is padding and dropped. The next transfer is taken with the last cell of the current one, so
+// the cells leave back to back.
+module row_serializer #(
+    parameter DATA_WIDTH = 8,
+    parameter BUS_WIDTH  = 32
+)(
+    input  clk,
+    input  rstn,
+    input  clear,                  // drops the transfer in progress, the next one starts a row
+
+    input  [15 : 0]             cfg_width,   // cells per row
+    input  [$clog2(BUS_WIDTH / DATA_WIDTH + 1) - 1 : 0] cfg_skip,   // cells dropped ahead of every row (< BUS_WIDTH / DATA_WIDTH)
+
+    // AXI Stream Slave Interface (rows)
+    input  [BUS_WIDTH - 1 : 0]  s_axis_tdata,
+    input                       s_axis_tvalid,
+    output                      s_axis_tready,
+
+    // AXI Stream Master Interface (cells)
+    output [DATA_WIDTH - 1 : 0] m_axis_tdata,
+    output                      m_axis_tvalid,
+    input                       m_axis_tready,
+
+    output                      idle         // no cell left
+);
+
+    localparam CELLS       = BUS_WIDTH / DATA_WIDTH;
+    localparam COUNT_WIDTH = $clog2(CELLS + 1);
+
+    reg [BUS_WIDTH - 1 : 0]   word;      // cells still to send, next one in the MSBs
+    reg [COUNT_WIDTH - 1 : 0] left;
+    reg [15 : 0]              col;       // column of the next cell
+
+    wire        out_fire = m_axis_tvalid && m_axis_tready;
+    wire        in_fire  = s_axis_tvalid && s_axis_tready;
+    wire [15:0] next_col = !out_fire ? col : (col == cfg_width - 1) ? 16'd0 : col + 1;
+    wire [15:0] row_left = cfg_width - next_col;   // cells of the row from the next transfer on
+    wire [COUNT_WIDTH - 1 : 0] lead = (next_col == 0) ? cfg_skip : 0;
+    wire [COUNT_WIDTH - 1 : 0] room = CELLS - lead;
+
+    assign m_axis_tdata  = word[BUS_WIDTH - 1 -: DATA_WIDTH];
+    assign m_axis_tvalid = (left != 0);
+    assign s_axis_tready = (left == 0) || ((left == 1) && m_axis_tready);
+    assign idle          = (left == 0);
+
+    always @(posedge clk) begin
+        if (!rstn || clear) begin
+            word <= 0;
+            left <= 0;
+            col  <= 0;
+        end
+        else begin
+            col <= next_col;
+            if (in_fire) begin
+                word <= s_axis_tdata << (lead * DATA_WIDTH);
+                left <= (row_left < room) ? row_left[COUNT_WIDTH - 1 : 0] : room;
+            end
+            else if (out_fire) begin
+                word <= word << DATA_WIDTH;
+                left <= left - 1;
+            end
+        end
+    end
+
+endmodule
@@ -11,7 +11,19 @@ set sim_pe "tb_pe"
 set sim_axim_reg "tb_axim_reg"
 set sim_top_fifo "tb_top_fifo"
 set sim_fifo "tb_fifo"
+set sim_fifo_fwft "tb_fifo_fwft"
+set sim_fifo_async "tb_fifo_async"
 set sim_weight_loader "tb_weight_loader"
+set sim_kernel_gen "tb_kernel_gen"
+set sim_perf_counters "tb_perf_counters"
+set sim_roi_reader "tb_axi_roi_reader"
+set sim_roi_writer "tb_axi_roi_writer"
+set sim_occupancy "tb_occupancy_unpacker"
+set sim_rle_encoder "tb_rle_encoder"
+set sim_dispatcher "tb_stripe_dispatcher"
+set sim_merger "tb_stripe_merger"
+set sim_dsp_row "tb_dsp_row"
+set sim_window_gen "tb_window_gen"
 #set sim_pe_wrapper "tb_pe_wrapper"
 
 
@@ -30,16 +42,34 @@ cd work
 # compile design and testbench
 exec xvlog ./../../pe.v
 exec xvlog ./../../adder_tree.v
+exec xvlog ./../../dsp_row.v
 exec xvlog -sv ./../../data_accumulator.sv
+exec xvlog -sv ./../../occupancy_unpacker.sv
 exec xvlog -sv ./../../weight_loader.sv
+exec xvlog -sv ./../../kernel_gen.sv
 exec xvlog -sv ./../../axim_reg.sv
 exec xvlog ./../../fifo.v
 exec xvlog ./../../fifo_axis.v
+exec xvlog ./../../fifo_fwft.v
+exec xvlog ./../../cdc_sync.v
+exec xvlog ./../../cdc_bus.v
+exec xvlog ./../../fifo_async.v
 exec xvlog ./../../top_fifo.v
 exec xvlog ./../../axis_unpack_data.v
 exec xvlog ./../../delay.v
+exec xvlog ./../../perf_counters.v
+exec xvlog -sv ./../../axi_roi_reader.sv
+exec xvlog -sv ./../../row_serializer.sv
+exec xvlog -sv ./../../window_gen.sv
+exec xvlog -sv ./../../axi_roi_writer.sv
+exec xvlog -sv ./../../rle_encoder.sv
+exec xvlog -sv ./../../stripe_dispatcher.sv
+exec xvlog -sv ./../../stripe_packer.sv
+exec xvlog -sv ./../../stripe_merger.sv
 exec xvlog ./../../crossbar.v
 exec xvlog ./../../pe_wrapper.v
+exec xvlog ./../../window_engine.v
+exec xvlog ./../../engine_core.v
 exec xvlog ./../../top.v
 #exec xvlog ./../../fsm.v
 
@@ -48,9 +78,21 @@ exec xvlog ./../../top.v
 exec xvlog ./../../tb_pe.v
 #exec xvlog ./../../tb_adder.v
 exec xvlog ./../../tb_weight_loader.v
+exec xvlog ./../../tb_kernel_gen.v
 exec xvlog ./../../tb_axim_reg.v
+exec xvlog ./../../tb_perf_counters.v
+exec xvlog ./../../tb_axi_roi_reader.v
+exec xvlog ./../../tb_axi_roi_writer.v
+exec xvlog ./../../tb_occupancy_unpacker.v
+exec xvlog ./../../tb_rle_encoder.v
+exec xvlog ./../../tb_stripe_dispatcher.v
+exec xvlog ./../../tb_stripe_merger.v
+exec xvlog ./../../tb_dsp_row.v
+exec xvlog ./../../tb_window_gen.v
 exec xvlog ./../../tb_top_fifo.v
 exec xvlog ./../../tb_fifo.v
+exec xvlog ./../../tb_fifo_fwft.v
+exec xvlog ./../../tb_fifo_async.v
 #exec xvlog ./../../tb_pe_wrapper.v
 exec xvlog ./../../tb_top2.v
  
@@ -59,8 +101,20 @@ exec xvlog ./../../tb_top2.v
 exec xelab $sim_pe -debug all
 #exec xelab $sim_adder -debug all
 exec xelab  $sim_weight_loader -debug all
+exec xelab $sim_kernel_gen -debug all
 exec xelab $sim_axim_reg -debug all
+exec xelab $sim_perf_counters -debug all
+exec xelab $sim_roi_reader -debug all
+exec xelab $sim_roi_writer -debug all
+exec xelab $sim_occupancy -debug all
+exec xelab $sim_rle_encoder -debug all
+exec xelab $sim_dispatcher -debug all
+exec xelab $sim_merger -debug all
+exec xelab $sim_dsp_row -debug all
+exec xelab $sim_window_gen -debug all
 exec xelab $sim_fifo -debug all
+exec xelab $sim_fifo_fwft -debug all
+exec xelab $sim_fifo_async -debug all
 exec xelab  $sim_top_fifo -debug all
 #exec xelab  $sim_pe_wrapper -debug all
 exec xelab $sim_top_module -debug all
@@ -70,8 +124,20 @@ exec xelab $sim_top_module -debug all
 #exec xsim $sim_pe -R
 #exec xsim $sim_adder -R
 #exec xsim  $sim_weight_loader -R
+#exec xsim $sim_kernel_gen -R
 #exec xsim $sim_axim_reg -R
+#exec xsim $sim_perf_counters -R
+#exec xsim $sim_roi_reader -R
+#exec xsim $sim_roi_writer -R
+#exec xsim $sim_occupancy -R
+#exec xsim $sim_rle_encoder -R
+#exec xsim $sim_dispatcher -R
+#exec xsim $sim_merger -R
+#exec xsim $sim_dsp_row -R
+#exec xsim $sim_window_gen -R
 #exec xsim $sim_fifo -R
+#exec xsim $sim_fifo_fwft -R
+#exec xsim $sim_fifo_async -R
 #exec xsim $sim_top_fifo -R
 #exec xsim  $sim_pe_wrapper -R
 #exec  xsim $sim_top_module -R
@@ -89,15 +155,33 @@ cd  synth_place_route
 #load design sources
 read_verilog ./../pe.v
 read_verilog ./../adder_tree.v
+read_verilog ./../dsp_row.v
 read_verilog  -sv ./../data_accumulator.sv
+read_verilog -sv ./../occupancy_unpacker.sv
 read_verilog -sv ./../weight_loader.sv
+read_verilog -sv ./../kernel_gen.sv
 read_verilog -sv ./../axim_reg.sv
 read_verilog ./../fifo.v
 read_verilog ./../fifo_axis.v
+read_verilog ./../fifo_fwft.v
+read_verilog ./../cdc_sync.v
+read_verilog ./../cdc_bus.v
+read_verilog ./../fifo_async.v
 read_verilog ./../top_fifo.v
 read_verilog ./../axis_unpack_data.v
 read_verilog ./../delay.v
+read_verilog ./../perf_counters.v
+read_verilog -sv ./../axi_roi_reader.sv
+read_verilog -sv ./../row_serializer.sv
+read_verilog -sv ./../window_gen.sv
+read_verilog -sv ./../axi_roi_writer.sv
+read_verilog -sv ./../rle_encoder.sv
+read_verilog -sv ./../stripe_dispatcher.sv
+read_verilog -sv ./../stripe_packer.sv
+read_verilog -sv ./../stripe_merger.sv
 read_verilog ./../pe_wrapper.v
+read_verilog ./../window_engine.v
+read_verilog ./../engine_core.v
 read_verilog ./../crossbar.v
 read_verilog ./../top.v
 
@@ -8,6 +8,26 @@ xvlog fifo.v
 
 xvlog fifo_axis.v
 
+xvlog fifo_fwft.v
+
+#xvlog tb_fifo_fwft.v
+
+#xelab tb_fifo_fwft -debug all
+
+#xsim tb_fifo_fwft -R
+
+xvlog cdc_sync.v
+
+xvlog cdc_bus.v
+
+xvlog fifo_async.v
+
+#xvlog tb_fifo_async.v
+
+#xelab tb_fifo_async -debug all
+
+#xsim tb_fifo_async -R
+
 xvlog axis_unpack_data.v
 
 xvlog top_fifo.v
@@ -24,20 +44,102 @@ xvlog  -sv weight_loader.sv
 
 xvlog  -sv data_accumulator.sv
 
+xvlog  -sv occupancy_unpacker.sv
+
+#xvlog  tb_occupancy_unpacker.v
+
+#xelab tb_occupancy_unpacker -debug all
+
+#xsim tb_occupancy_unpacker -R
+
 #xvlog  tb_weight_loader.v
 
 #xelab tb_weight_loader -debug all
 
 #xsim tb_weight_loader -R
 
+xvlog -sv kernel_gen.sv
+
+#xvlog tb_kernel_gen.v
+
+#xelab tb_kernel_gen -debug all
+
+#xsim tb_kernel_gen -R
+
 xvlog pe.v
 
 xvlog adder_tree.v
 
+xvlog dsp_row.v
+
+#xvlog tb_dsp_row.v
+
+#xelab tb_dsp_row -debug all
+
+#xsim tb_dsp_row -R
+
 xvlog delay.v
 
+xvlog perf_counters.v
+
+xvlog -sv axi_roi_reader.sv
+
+xvlog -sv row_serializer.sv
+
+xvlog -sv window_gen.sv
+
+#xvlog tb_window_gen.v
+
+#xelab tb_window_gen -debug all
+
+#xsim tb_window_gen -R
+
+xvlog -sv axi_roi_writer.sv
+
+xvlog -sv rle_encoder.sv
+
+#xvlog tb_rle_encoder.v
+
+#xelab tb_rle_encoder -debug all
+
+#xsim tb_rle_encoder -R
+
+#xvlog tb_axi_roi_reader.v
+
+#xelab tb_axi_roi_reader -debug all
+
+#xsim tb_axi_roi_reader -R
+
+#xvlog tb_axi_roi_writer.v
+
+#xelab tb_axi_roi_writer -debug all
+
+#xsim tb_axi_roi_writer -R
+
+xvlog -sv stripe_dispatcher.sv
+
+xvlog -sv stripe_packer.sv
+
+xvlog -sv stripe_merger.sv
+
+#xvlog tb_stripe_dispatcher.v
+
+#xelab tb_stripe_dispatcher -debug all
+
+#xsim tb_stripe_dispatcher -R
+
+#xvlog tb_stripe_merger.v
+
+#xelab tb_stripe_merger -debug all
+
+#xsim tb_stripe_merger -R
+
 xvlog pe_wrapper.v
 
+xvlog window_engine.v
+
+xvlog engine_core.v
+
 #xvlog tb_pe.v
 
 #xvlog tb_pe_wrapper.v
@@ -70,3 +172,13 @@ xelab tb_top2 -debug all
 
 xsim tb_top2 -R
 
+# handshake traces instead of the -debug all waveform (see axis_trace.sv, trace_report.py)
+
+#xvlog -sv axis_trace.sv trace_bind.sv
+
+#xelab tb_top2
+
+#xsim tb_top2 -R -testplusarg trace
+
+#python3 trace_report.py *.trc --buckets 20
+
@@ -0,0 +1,176 @@
+`timescale 1ns/1ps
+
+// Splits the columns of a frame into stripes for the window engines : stripe e covers the result
+// columns x0 .. x1 - 1 of every row, x0 = e * ceil(cfg_width / NUM_ENGINES) (the engines past the
+// right edge of a narrow map stay idle), and goes to engine e. Its engine needs the input columns
+// of the windows of these results :
+//     - cfg_border (the map comes unpadded) : columns x0 - pad .. x1 - 1 + pad of the map, cut at its
+//       left and right edge, where the engine generates the border itself,
+//     - pre-padded map : columns x0 .. x1 - 1 + 2 * pad of the input.
+// Every row goes to all the engines at once, each one takes the words holding its columns (the
+// words at a stripe boundary, its halo, go to both sides) and drops the cells of the neighbours in
+// them (stripe_in_skip, row_serializer.sv). So all the engines step their windows together, each
+// one on its own part of the row : the input buffer of an engine holds at least the words of one
+// row of its stripe, so the row is handed out while the engines work on the rows before it.
+// On start the geometry of the frame is computed from the configuration (two cycles), then every
+// engine of a stripe gets the descriptor of its run (the whole frame) before the first word.
+module stripe_dispatcher #(
+    parameter NUM_ENGINES = 2,    // 64 at most
+    parameter KERNEL_SIZE = 3,    // size of the synthesized (maximum) PE array
+    parameter BUS_WIDTH   = 32
+)(
+    input  clk,
+    input  rstn,
+    input  start,                  // one cycle pulse at the start of a frame
+    input  abort,                  // drops the frame (start wins over it)
+
+    input  [$clog2(KERNEL_SIZE + 1) - 1 : 0] cfg_kernel_size,
+    input  [15 : 0]             cfg_width,       // result cells per row
+    input  [15 : 0]             cfg_height,      // result rows
+    input                       cfg_border,
+
+    // AXI Stream Slave Interface (input rows, every row starts on a new word)
+    input  [BUS_WIDTH - 1 : 0]  s_axis_tdata,
+    input                       s_axis_tvalid,
+    output                      s_axis_tready,
+
+    // AXI Stream Master Interfaces (one per engine, shared data)
+    output [BUS_WIDTH - 1 : 0]  m_axis_tdata,
+    output [NUM_ENGINES - 1 : 0] m_axis_tvalid,
+    input  [NUM_ENGINES - 1 : 0] m_axis_tready,
+
+    // Stripes of the frame (one per engine, held until the next start)
+    output [NUM_ENGINES * 16 - 1 : 0] stripe_in_width,   // input cells per row
+    output [NUM_ENGINES * $clog2(BUS_WIDTH / 8 + 1) - 1 : 0] stripe_in_skip,   // cells ahead of them in the first word
+    output [NUM_ENGINES * 16 - 1 : 0] stripe_cells,      // result cells per row
+    output [NUM_ENGINES - 1 : 0] stripe_border_left,
+    output [NUM_ENGINES - 1 : 0] stripe_border_right,
+    output [(NUM_ENGINES > 1 ? $clog2(NUM_ENGINES) : 1) - 1 : 0] last_engine,   // engine of the last stripe
+
+    // Run descriptors (one per engine, shared data, see window_engine.v)
+    output [15 : 0]             desc_rows,
+    output                      desc_border_top,
+    output                      desc_border_bottom,
+    output [NUM_ENGINES - 1 : 0] desc_valid,
+    input  [NUM_ENGINES - 1 : 0] desc_ready
+);
+
+    localparam SEL_WIDTH   = (NUM_ENGINES > 1) ? $clog2(NUM_ENGINES) : 1;
+    localparam CELLS       = BUS_WIDTH / 8;
+    localparam COUNT_WIDTH = $clog2(CELLS + 1);
+    // ceil(w / NUM_ENGINES) as a product : exact for w < 2^16 and NUM_ENGINES < 128
+    localparam RECIP_SHIFT = 24;
+    localparam [24 : 0] RECIP = ((1 << RECIP_SHIFT) + NUM_ENGINES - 1) / NUM_ENGINES;
+
+    wire [15 : 0] pad      = (cfg_kernel_size - 1) >> 1;
+    wire [15 : 0] in_width = cfg_border ? cfg_width : cfg_width + 2 * pad;
+
+    // 1. Geometry of the frame, registered in two steps (the configuration does not change during a frame)
+    reg  [15 : 0]            stripe_w;
+    reg  [15 : 0]            x_first [0 : NUM_ENGINES - 1];   // first input column of stripe e
+    reg  [15 : 0]            x_end   [0 : NUM_ENGINES - 1];   // input column after its last one
+    reg  [15 : 0]            cells   [0 : NUM_ENGINES - 1];
+    reg  [NUM_ENGINES - 1 : 0] used;                          // the stripe holds columns of the map
+    reg  [NUM_ENGINES - 1 : 0] right;
+    reg  [SEL_WIDTH - 1 : 0] last;
+    wire [41 : 0]            quotient = ({1'b0, cfg_width} + NUM_ENGINES - 1) * RECIP;
+
+    always @(posedge clk)
+        stripe_w <= quotient[RECIP_SHIFT +: 16];
+
+    genvar e;
+    generate
+        for (e = 0; e < NUM_ENGINES; e = e + 1) begin : gen_stripe
+            wire [31 : 0] x0 = e * stripe_w;
+            wire [31 : 0] x1 = (x0 + stripe_w < cfg_width) ? x0 + stripe_w : cfg_width;
+
+            always @(posedge clk) begin
+                used[e]    <= (x0 < cfg_width);
+                right[e]   <= cfg_border && (x1 == cfg_width);
+                cells[e]   <= x1 - x0;
+                x_first[e] <= !cfg_border ? x0 : (x0 > pad) ? x0 - pad : 0;
+                x_end[e]   <= !cfg_border ? x1 + 2 * pad : (x1 + pad < cfg_width) ? x1 + pad : cfg_width;
+            end
+
+            assign stripe_in_width[e * 16 +: 16]                 = x_end[e] - x_first[e];
+            assign stripe_in_skip[e * COUNT_WIDTH +: COUNT_WIDTH] = x_first[e] % CELLS;
+            assign stripe_cells[e * 16 +: 16]                    = cells[e];
+            assign stripe_border_left[e]                         = cfg_border && (e == 0);
+            assign stripe_border_right[e]                        = right[e];
+        end
+    endgenerate
+
+    integer i;
+    always @(*) begin
+        last = 0;
+        for (i = 1; i < NUM_ENGINES; i = i + 1)
+            if (used[i])
+                last = i;
+    end
+
+    assign last_engine = last;
+
+    // 2. Descriptors : every engine of a stripe at once, once the geometry is in
+    reg  [1 : 0]  settle;     // cycles until the geometry of the frame is registered
+    reg           pending;    // descriptors to send
+    reg           sent;       // descriptors sent, the words of the frame go out
+    reg  [15 : 0] col;        // first cell of the next word in its row
+
+    wire desc_all = &(desc_ready | ~used);
+    wire desc_go  = pending && (settle == 0) && desc_all;
+
+    assign desc_rows          = cfg_border ? cfg_height : cfg_height + 2 * pad;
+    assign desc_border_top    = cfg_border;
+    assign desc_border_bottom = cfg_border;
+    assign desc_valid         = desc_go ? used : {NUM_ENGINES{1'b0}};
+
+    // 3. Words : to every stripe they hold columns of
+    wire [NUM_ENGINES - 1 : 0] target;
+    generate
+        for (e = 0; e < NUM_ENGINES; e = e + 1) begin : gen_target
+            assign target[e] = used[e] && (col < x_end[e]) && (col + CELLS > x_first[e]);
+        end
+    endgenerate
+
+    wire all_ready = &(m_axis_tready | ~target);
+    wire word_fire = s_axis_tvalid && sent && all_ready;
+    wire row_end   = (col + CELLS >= in_width);
+
+    assign s_axis_tready = sent && all_ready;
+    assign m_axis_tdata  = s_axis_tdata;
+    assign m_axis_tvalid = word_fire ? target : {NUM_ENGINES{1'b0}};
+
+    always @(posedge clk) begin
+        if (!rstn) begin
+            settle  <= 0;
+            pending <= 1'b0;
+            sent    <= 1'b0;
+            col     <= 0;
+        end
+        else if (start) begin
+            settle  <= 2;
+            pending <= 1'b1;
+            sent    <= 1'b0;
+            col     <= 0;
+        end
+        else if (abort) begin
+            settle  <= 0;
+            pending <= 1'b0;
+            sent    <= 1'b0;
+            col     <= 0;
+        end
+        else begin
+            if (settle != 0)
+                settle <= settle - 1;
+
+            if (desc_go) begin
+                pending <= 1'b0;
+                sent    <= 1'b1;
+            end
+
+            if (word_fire)
+                col <= row_end ? 16'd0 : col + CELLS;
+        end
+    end
+
+endmodule
@@ -0,0 +1,122 @@
+`timescale 1ns/1ps
+
+// Puts the stripes of the window engines back in raster order : every row is the words of engine 0
+// up to its s_axis_tlast (the end of its part of the row), then those of engine 1, and so on up to
+// last_engine. The cells are repacked into full words across the stripe boundaries (first cell in
+// the low byte), only the last word of a frame may hold fewer cells (m_axis_tbytes) and it carries
+// m_axis_tlast.
+module stripe_merger #(
+    parameter NUM_ENGINES = 2,
+    parameter BUS_WIDTH   = 32
+)(
+    input  clk,
+    input  rstn,
+    input  start,                  // one cycle pulse at the start of a frame : back to engine 0
+
+    input  [31 : 0]             frame_cells,
+    input  [(NUM_ENGINES > 1 ? $clog2(NUM_ENGINES) : 1) - 1 : 0] last_engine,   // engine of the last stripe of a row
+
+    // AXI Stream Slave Interfaces (packed costs of every engine)
+    input  [NUM_ENGINES * BUS_WIDTH - 1 : 0]                   s_axis_tdata,
+    input  [NUM_ENGINES * $clog2(BUS_WIDTH / 8 + 1) - 1 : 0]   s_axis_tbytes,
+    input  [NUM_ENGINES - 1 : 0]                               s_axis_tlast,   // last word of a row of a stripe
+    input  [NUM_ENGINES - 1 : 0]                               s_axis_tvalid,
+    output [NUM_ENGINES - 1 : 0]                               s_axis_tready,
+
+    // AXI Stream Master Interface (packed costs in raster order)
+    output reg [BUS_WIDTH - 1 : 0]                  m_axis_tdata,
+    output reg [$clog2(BUS_WIDTH / 8 + 1) - 1 : 0]  m_axis_tbytes,
+    output reg                                      m_axis_tlast,   // last word of the frame
+    output reg                                      m_axis_tvalid,
+    input                                           m_axis_tready
+);
+
+    localparam BYTES       = BUS_WIDTH / 8;
+    localparam COUNT_WIDTH = $clog2(BYTES + 1);
+    localparam BUF_BITS    = 2 * BUS_WIDTH;   // two words of cells
+    localparam SEL_WIDTH   = (NUM_ENGINES > 1) ? $clog2(NUM_ENGINES) : 1;
+
+    reg [SEL_WIDTH - 1 : 0]             cur;        // engine of the current part of the row
+    reg [BUF_BITS - 1 : 0]              cell_buf;   // first cell in the low byte
+    reg [$clog2(2 * BYTES + 1) - 1 : 0] cell_cnt;
+    reg [31 : 0]                        in_cells;   // cells of the frame taken from the engines
+
+    // word of the current engine
+    wire [BUS_WIDTH - 1 : 0]   in_data  = s_axis_tdata[cur * BUS_WIDTH +: BUS_WIDTH];
+    wire [COUNT_WIDTH - 1 : 0] in_bytes = s_axis_tbytes[cur * COUNT_WIDTH +: COUNT_WIDTH];
+    wire                       in_last  = s_axis_tlast[cur];
+
+    wire all_in   = (in_cells == frame_cells);     // the rest of the frame is in cell_buf
+    wire in_ok    = !all_in && (cell_cnt <= BYTES);
+    wire in_fire  = in_ok && s_axis_tvalid[cur];
+    wire out_free = !m_axis_tvalid || m_axis_tready;
+    wire emit     = out_free && ((cell_cnt >= BYTES) || (all_in && cell_cnt != 0));
+
+    genvar e;
+    generate
+        for (e = 0; e < NUM_ENGINES; e = e + 1) begin
+            assign s_axis_tready[e] = in_ok && (cur == e);
+        end
+    endgenerate
+
+    // lanes past in_bytes do not carry cells
+    wire [BUS_WIDTH - 1 : 0] in_cells_data;
+    genvar b;
+    generate
+        for (b = 0; b < BYTES; b = b + 1) begin
+            assign in_cells_data[b*8 +: 8] = (b < in_bytes) ? in_data[b*8 +: 8] : 8'd0;
+        end
+    endgenerate
+
+    reg [BUF_BITS - 1 : 0]              next_buf;
+    reg [$clog2(2 * BYTES + 1) - 1 : 0] next_cnt;
+    reg [COUNT_WIDTH - 1 : 0]           taken;
+
+    always @(posedge clk) begin
+        if (!rstn || start) begin
+            cur           <= 0;
+            cell_buf      <= 0;
+            cell_cnt      <= 0;
+            in_cells      <= 0;
+            m_axis_tdata  <= 0;
+            m_axis_tbytes <= 0;
+            m_axis_tlast  <= 1'b0;
+            m_axis_tvalid <= 1'b0;
+        end
+        else begin
+            next_buf = cell_buf;
+            next_cnt = cell_cnt;
+
+            if (m_axis_tready)
+                m_axis_tvalid <= 1'b0;
+
+            // 1. output word : full, or the end of the frame
+            if (emit) begin
+                taken = (cell_cnt < BYTES) ? cell_cnt : BYTES;
+                m_axis_tdata  <= cell_buf[BUS_WIDTH - 1 : 0];
+                m_axis_tbytes <= taken;
+                m_axis_tlast  <= all_in && (cell_cnt <= BYTES);
+                m_axis_tvalid <= 1'b1;
+                next_buf = cell_buf >> (taken * 8);
+                next_cnt = cell_cnt - taken;
+                if (all_in && cell_cnt <= BYTES)
+                    in_cells <= 0;   // frame done, the next one starts on engine 0
+            end
+
+            // 2. input word of the current engine, appended behind the cells left in the buffer
+            if (in_fire) begin
+                next_buf = next_buf | ({{BUS_WIDTH{1'b0}}, in_cells_data} << (next_cnt * 8));
+                next_cnt = next_cnt + in_bytes;
+                in_cells <= in_cells + in_bytes;
+                if (in_cells + in_bytes == frame_cells)
+                    cur <= 0;
+                else if (in_last)
+                    cur <= (cur == last_engine) ? 0 : cur + 1;
+            end
+
+            cell_buf <= next_buf;
+            cell_cnt <= next_cnt;
+        end
+    end
+
+endmodule
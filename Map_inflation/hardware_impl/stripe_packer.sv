@@ -0,0 +1,101 @@
+`timescale 1ns/1ps
+
+// Output stage of a window engine in the multi-engine build (engine_core.v) : the results of a
+// stripe are saturated to one byte costs and packed BUS_WIDTH/8 per word (first cell in the low
+// byte) into the output buffer. The row of the stripe (cfg_row_cells results) ends on a word of
+// its own : that word carries m_axis_tlast and may hold fewer cells (m_axis_tbytes). The buffer
+// lets the engine go on with its next rows while the merger drains the stripes left of it.
+module stripe_packer #(
+    parameter RESULT_WIDTH = 20,
+    parameter BUS_WIDTH    = 32,   // output word : BUS_WIDTH/8 costs
+    parameter OUT_DEPTH    = 512   // output buffer words (power of 2)
+)(
+    input  clk,
+    input  rstn,
+    input  clear,                  // drops the row in progress and the buffered words
+
+    input  [15 : 0]             cfg_row_cells,   // results per row of the stripe
+
+    // AXI Stream Slave Interface (results of the engine)
+    input  [RESULT_WIDTH - 1 : 0] s_axis_tdata,
+    input                       s_axis_tvalid,
+    output                      s_axis_tready,
+
+    // AXI Stream Master Interface (packed costs of the stripe, to the merger)
+    output [BUS_WIDTH - 1 : 0]  m_axis_tdata,
+    output [$clog2(BUS_WIDTH / 8 + 1) - 1 : 0] m_axis_tbytes,
+    output                      m_axis_tlast,    // last word of a row of the stripe
+    output                      m_axis_tvalid,
+    input                       m_axis_tready,
+
+    output                      idle             // no cell in the packer or the buffer
+);
+
+    localparam BYTES       = BUS_WIDTH / 8;
+    localparam COUNT_WIDTH = $clog2(BYTES + 1);
+    localparam WORD_WIDTH  = 1 + COUNT_WIDTH + BUS_WIDTH;      // {last, bytes, cells}
+    localparam BUF_PTR     = $clog2(OUT_DEPTH);
+    localparam [RESULT_WIDTH - 1 : 0] MAX_COST = 8'hFF;
+
+    // Word being packed
+    reg  [BUS_WIDTH - 1 : 0]    pack_data;
+    reg  [COUNT_WIDTH - 1 : 0]  pack_cnt;
+    reg  [15 : 0]               col;        // column of the next result in the row of the stripe
+
+    wire buf_ready;
+    wire [BUF_PTR : 0] buf_level;
+
+    wire [7 : 0] cost    = (s_axis_tdata > MAX_COST) ? 8'hFF : s_axis_tdata[7 : 0];
+    wire         in_fire = s_axis_tvalid && s_axis_tready;
+    wire         row_end = (col == cfg_row_cells - 1);
+    wire         wr_word = in_fire && ((pack_cnt == BYTES - 1) || row_end);
+    wire [BUS_WIDTH - 1 : 0] word_data = pack_data | ({{(BUS_WIDTH - 8){1'b0}}, cost} << (pack_cnt * 8));
+
+    assign s_axis_tready = buf_ready;
+    assign idle          = (pack_cnt == 0) && (buf_level == 0);
+
+    // 1. Packing
+    always @(posedge clk) begin
+        if (!rstn || clear) begin
+            pack_data <= 0;
+            pack_cnt  <= 0;
+            col       <= 0;
+        end
+        else if (in_fire) begin
+            col <= row_end ? 16'd0 : col + 1;
+            if (wr_word) begin
+                pack_data <= 0;
+                pack_cnt  <= 0;
+            end else begin
+                pack_data <= word_data;
+                pack_cnt  <= pack_cnt + 1;
+            end
+        end
+    end
+
+    // 2. Output buffer (block RAM, first word shown on m_axis)
+    fifo_fwft #(
+        .DATAWIDTH(WORD_WIDTH),
+        .DEPTH(OUT_DEPTH),
+        .PTR_WIDTH(BUF_PTR),
+        .MEMORY_TYPE("block")
+    ) out_fifo (
+        .clk(clk),
+        .rstn(rstn && !clear),
+
+        .s_tvalid(wr_word),
+        .s_tdata({row_end, pack_cnt + 1'b1, word_data}),
+        .s_tready(buf_ready),
+
+        .m_tready(m_axis_tready),
+        .m_tdata({m_axis_tlast, m_axis_tbytes, m_axis_tdata}),
+        .m_tvalid(m_axis_tvalid),
+
+        .prog_full_thresh(OUT_DEPTH),
+        .prog_empty_thresh({(BUF_PTR + 1){1'b0}}),
+        .almost_full(),
+        .almost_empty(),
+        .level(buf_level)
+    );
+
+endmodule
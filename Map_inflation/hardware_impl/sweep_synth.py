@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""Design-space sweep of top.v with open-source synthesis (Yosys synth_xilinx), and a Pareto report.
+
+    python3 sweep_synth.py [--array 5,9,13] [--depth 4,16] [--engines 1,2] [--datapath pe,dsp,dsp_pack]
+                           [--jobs N] [--out sweep]
+
+Every point of the grid is synthesized for a 7-series part (the sources are the ones script2.tcl reads)
+with its parameters set by chparam. Yosys gives the cell counts (LUT, FF, DSP48, BRAM) and the longest
+combinational path in cells (ltp), turned into an fmax estimate :
+    fmax = 1000 / (ns_overhead + ns_per_level * levels) MHz
+with constants for a -2 speed grade (clock-to-out, setup and one LUT plus its net per level). The
+throughput at the radius that fills the array comes from perf_model.py, so
+    Mcells/s = fmax * cells per cycle.
+A point is on the Pareto front when no other point has at least its throughput with no more LUT, FF
+and DSP48, and is better in one of them. The results go to <out>/sweep.csv and <out>/pareto.md, the
+Yosys logs to <out>/<point>/.
+No Vivado is needed : the figures are estimates to pick candidates, the timing closure of a
+candidate still comes from script.tcl.
+Unverified : the sweep has only been run against a stand-in yosys that prints canned statistics, never
+against a real Yosys on this design, so no Pareto report has been produced yet. The parsing of the
+stat / ltp output, the fmax constants and the chparam flow all need a first real run before the
+figures are used.
+"""
+
+import argparse
+import csv
+import itertools
+import math
+import os
+import re
+import shutil
+import subprocess
+import sys
+from concurrent.futures import ThreadPoolExecutor
+
+import perf_model
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+def sources():
+    """RTL files of the synthesis run, from the read_verilog lines of script2.tcl."""
+    files = []
+    with open(os.path.join(HERE, "script2.tcl")) as f:
+        for line in f:
+            match = re.match(r"\s*read_verilog\s+(-sv\s+)?\S*?/\.\./(\S+)", line)
+            if match:
+                files.append((bool(match.group(1)), os.path.join(HERE, match.group(2))))
+    return files
+
+
+def point_name(point):
+    return "k%d_d%d_e%d_%s" % (point["array"], point["depth"], point["engines"], point["datapath"])
+
+
+def yosys_script(point, files):
+    params = {
+        "KERNEL_SIZE": point["array"],
+        "DEPTH": point["depth"],
+        "PTR_WIDTH": max(1, int(math.log2(point["depth"]))),
+        "NUM_ENGINES": point["engines"],
+        "USE_DSP_ROWS": int(point["datapath"] != "pe"),
+        "DSP_PACK": int(point["datapath"] == "dsp_pack"),
+    }
+    lines = ["read_verilog -defer %s%s" % ("-sv " if sv else "", path) for sv, path in files]
+    lines.append("chparam %s top" % " ".join("-set %s %d" % item for item in params.items()))
+    lines.append("synth_xilinx -family xc7 -top top -flatten")
+    lines.append("tee -o stat.txt stat")
+    lines.append("tee -o ltp.txt ltp -noff")
+    return "\n".join(lines) + "\n"
+
+
+def parse_stat(text):
+    cells = {}
+    for line in text.splitlines():
+        match = re.match(r"\s+([A-Z][A-Z0-9_]+)\s+(\d+)\s*$", line)
+        if match:
+            cells[match.group(1)] = cells.get(match.group(1), 0) + int(match.group(2))
+    lut = sum(n for c, n in cells.items() if re.match(r"LUT\d$", c))
+    lutram = sum(n for c, n in cells.items() if c.startswith(("SRL", "RAM32", "RAM64", "RAM128", "RAM256")))
+    ff = sum(n for c, n in cells.items() if c in ("FDRE", "FDSE", "FDCE", "FDPE"))
+    dsp = cells.get("DSP48E1", 0)
+    bram = cells.get("RAMB36E1", 0) + cells.get("RAMB18E1", 0) / 2.0
+    return {"LUT": lut + lutram, "FF": ff, "DSP48": dsp, "BRAM36": bram}
+
+
+def parse_ltp(text):
+    match = re.search(r"length=(\d+)", text)
+    return int(match.group(1)) if match else None
+
+
+def run_point(point, args, files):
+    name = point_name(point)
+    work = os.path.join(args.out, name)
+    os.makedirs(work, exist_ok=True)
+    with open(os.path.join(work, "synth.ys"), "w") as f:
+        f.write(yosys_script(point, files))
+
+    result = dict(point, name=name)
+    process = subprocess.run([args.yosys, "-q", "-l", "yosys.log", "-s", "synth.ys"], cwd=work,
+                             capture_output=True, text=True)
+    if process.returncode != 0:
+        result["error"] = (process.stderr.strip().splitlines() or ["yosys failed"])[-1]
+        return result
+
+    with open(os.path.join(work, "stat.txt")) as f:
+        result.update(parse_stat(f.read()))
+    with open(os.path.join(work, "ltp.txt")) as f:
+        levels = parse_ltp(f.read())
+    result["levels"] = levels
+    result["fmax"] = 1000.0 / (args.ns_overhead + args.ns_per_level * levels) if levels else float("nan")
+
+    frame = argparse.Namespace(array=point["array"], radius=(point["array"] - 1) // 2, width=args.width,
+                               height=args.height, bus=32, depth=point["depth"], engines=point["engines"],
+                               engine_in_depth=512, dsp_rows=point["datapath"] != "pe",
+                               dsp_pack=point["datapath"] == "dsp_pack", border=args.border,
+                               in_duty=1.0, out_duty=1.0)
+    result["cells_per_cycle"] = perf_model.model(frame)["cells_per_cycle"]
+    result["mcells"] = result["fmax"] * result["cells_per_cycle"]
+    return result
+
+
+def pareto(results):
+    """Marks the points no other point dominates (throughput up, LUT / FF / DSP48 down)."""
+    for a in results:
+        a["pareto"] = not any(
+            b is not a and b["mcells"] >= a["mcells"] and b["LUT"] <= a["LUT"] and b["FF"] <= a["FF"] and
+            b["DSP48"] <= a["DSP48"] and (b["mcells"] > a["mcells"] or b["LUT"] < a["LUT"] or
+                                          b["FF"] < a["FF"] or b["DSP48"] < a["DSP48"])
+            for b in results)
+
+
+def int_list(text):
+    return [int(v) for v in text.split(",")]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--array", type=int_list, default=[5, 9, 13], help="KERNEL_SIZE values")
+    parser.add_argument("--depth", type=int_list, default=[4, 16], help="DEPTH values (input FIFOs)")
+    parser.add_argument("--engines", type=int_list, default=[1, 2], help="NUM_ENGINES values")
+    parser.add_argument("--datapath", default="pe,dsp,dsp_pack",
+                        help="pe (PEs and adder trees), dsp (USE_DSP_ROWS), dsp_pack (USE_DSP_ROWS + DSP_PACK)")
+    parser.add_argument("--width", type=int, default=200, help="frame of the throughput figure")
+    parser.add_argument("--height", type=int, default=200)
+    parser.add_argument("--border", choices=["zero", "replicate", "none"], default="none")
+    parser.add_argument("--ns-overhead", type=float, default=1.2, help="clock-to-out + setup + clock skew, ns")
+    parser.add_argument("--ns-per-level", type=float, default=0.55, help="LUT + net delay per logic level, ns")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count() or 1)
+    parser.add_argument("--yosys", default="yosys")
+    parser.add_argument("--out", default=os.path.join(HERE, "sweep"))
+    args = parser.parse_args()
+
+    if shutil.which(args.yosys) is None:
+        sys.exit("%s not found" % args.yosys)
+    args.out = os.path.abspath(args.out)
+    files = sources()
+    datapaths = args.datapath.split(",")
+    points = [{"array": a, "depth": d, "engines": e, "datapath": p}
+              for a, d, e, p in itertools.product(args.array, args.depth, args.engines, datapaths)]
+
+    with ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        results = list(pool.map(lambda point: run_point(point, args, files), points))
+
+    failed = [r for r in results if "error" in r]
+    done = [r for r in results if "error" not in r]
+    for r in failed:
+        print("%s : %s" % (r["name"], r["error"]))
+    if not done:
+        sys.exit("no point synthesized")
+    pareto(done)
+    done.sort(key=lambda r: -r["mcells"])
+
+    columns = ["name", "array", "depth", "engines", "datapath", "LUT", "FF", "DSP48", "BRAM36", "levels", "fmax",
+               "cells_per_cycle", "mcells", "pareto"]
+    with open(os.path.join(args.out, "sweep.csv"), "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=columns, extrasaction="ignore")
+        writer.writeheader()
+        writer.writerows(done)
+
+    table = ["| point | LUT | FF | DSP48 | BRAM36 | levels | fmax (MHz) | cells/cycle | Mcells/s | Pareto |",
+             "|---|---:|---:|---:|---:|---:|---:|---:|---:|:---:|"]
+    for r in done:
+        table.append("| %s | %d | %d | %d | %g | %s | %.0f | %.3f | %.1f | %s |" %
+                     (r["name"], r["LUT"], r["FF"], r["DSP48"], r["BRAM36"], r["levels"], r["fmax"],
+                      r["cells_per_cycle"], r["mcells"], "*" if r["pareto"] else ""))
+    header = ("# Synthesis sweep of top.v\n\nYosys synth_xilinx (xc7) estimates, throughput on a %dx%d frame "
+              "(%s border) from perf_model.py, fmax = 1000 / (%.2f + %.2f * levels) MHz.\n\n"
+              "Unverified estimates : neither the fmax constants nor perf_model.py have been checked against "
+              "Vivado or simulation.\n\n" %
+              (args.width, args.height, args.border, args.ns_overhead, args.ns_per_level))
+    with open(os.path.join(args.out, "pareto.md"), "w") as f:
+        f.write(header + "\n".join(table) + "\n")
+
+    print("\n".join(table))
+    print("\n%d points, %d on the Pareto front, %d failed : %s" %
+          (len(done), sum(r["pareto"] for r in done), len(failed), os.path.join(args.out, "pareto.md")))
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
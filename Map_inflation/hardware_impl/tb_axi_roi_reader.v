@@ -0,0 +1,196 @@
+`timescale 1ns/1ps
+
+module tb_axi_roi_reader;
+
+    // Parameters
+    localparam BUS_WIDTH   = 32;
+    localparam MAX_BURST   = 4;
+    localparam MEM_BYTES   = 8192;
+    localparam PERIOD      = 4;
+
+    // ROI : 10 x 3 cells, rows 64 bytes apart, the first row crosses the 4 KB page at 0x1000
+    localparam ROI_BASE    = 32'h0000_0FF8;
+    localparam ROI_STRIDE  = 64;
+    localparam ROI_WIDTH   = 10;
+    localparam ROI_HEIGHT  = 3;
+
+    reg clk = 0;
+    reg rstn;
+
+    always #(PERIOD/2) clk = ~clk;
+
+    // DUT signals
+    reg         start;
+    wire        busy;
+    wire        error;
+    wire [31:0] m_axi_araddr;
+    wire [7:0]  m_axi_arlen;
+    wire [2:0]  m_axi_arsize;
+    wire [1:0]  m_axi_arburst;
+    wire        m_axi_arvalid;
+    reg         m_axi_arready;
+    reg  [31:0] m_axi_rdata;
+    reg  [1:0]  m_axi_rresp;
+    reg         m_axi_rlast;
+    reg         m_axi_rvalid;
+    wire        m_axi_rready;
+    wire [31:0] m_axis_tdata;
+    wire [2:0]  m_axis_tbytes;
+    wire        m_axis_tlast;
+    wire        m_axis_tvalid;
+    reg         m_axis_tready;
+
+    // memory model
+    reg [7:0]  mem [0:MEM_BYTES-1];
+    reg [31:0] burst_addr [0:15];
+    reg [7:0]  burst_len  [0:15];
+    integer    ar_head, ar_tail, beat;
+
+    integer errors;
+    integer cell, row, col, b, k;
+
+    axi_roi_reader #(
+        .ADDR_WIDTH(32),
+        .BUS_WIDTH(BUS_WIDTH),
+        .MAX_BURST_LEN(MAX_BURST),
+        .MAX_OUTSTANDING(2),
+        .FIFO_DEPTH(2 * MAX_BURST)
+    ) dut (
+        .clk(clk),
+        .rstn(rstn),
+        .start(start),
+        .cfg_base(ROI_BASE),
+        .cfg_stride(ROI_STRIDE),
+        .cfg_width(ROI_WIDTH[15:0]),
+        .cfg_height(ROI_HEIGHT[15:0]),
+        .busy(busy),
+        .error(error),
+        .m_axi_araddr(m_axi_araddr),
+        .m_axi_arlen(m_axi_arlen),
+        .m_axi_arsize(m_axi_arsize),
+        .m_axi_arburst(m_axi_arburst),
+        .m_axi_arvalid(m_axi_arvalid),
+        .m_axi_arready(m_axi_arready),
+        .m_axi_rdata(m_axi_rdata),
+        .m_axi_rresp(m_axi_rresp),
+        .m_axi_rlast(m_axi_rlast),
+        .m_axi_rvalid(m_axi_rvalid),
+        .m_axi_rready(m_axi_rready),
+        .m_axis_tdata(m_axis_tdata),
+        .m_axis_tbytes(m_axis_tbytes),
+        .m_axis_tlast(m_axis_tlast),
+        .m_axis_tvalid(m_axis_tvalid),
+        .m_axis_tready(m_axis_tready)
+    );
+
+    // ----------------------------------------------------
+    // AXI4 read slave : queues the bursts, answers them in order
+    // ----------------------------------------------------
+    always @(posedge clk) begin
+        if (!rstn) begin
+            m_axi_arready <= 1'b0;
+            m_axi_rvalid  <= 1'b0;
+            m_axi_rlast   <= 1'b0;
+            m_axi_rresp   <= 2'b00;
+            m_axi_rdata   <= 0;
+            ar_head = 0;
+            ar_tail = 0;
+            beat    = 0;
+        end
+        else begin
+            m_axi_arready <= ($random % 4) != 0;
+            if (m_axi_arvalid && m_axi_arready) begin
+                if (((m_axi_araddr & 12'hFFF) + (m_axi_arlen + 1) * 4) > 4096) begin
+                    $display("%0t ERROR: burst at %0h crosses a 4 KB page", $time, m_axi_araddr);
+                    errors = errors + 1;
+                end
+                burst_addr[ar_tail % 16] = m_axi_araddr;
+                burst_len[ar_tail % 16]  = m_axi_arlen;
+                ar_tail = ar_tail + 1;
+            end
+
+            if (m_axi_rvalid && m_axi_rready) begin
+                m_axi_rvalid <= 1'b0;
+                if (m_axi_rlast) begin
+                    ar_head = ar_head + 1;
+                    beat    = 0;
+                end else
+                    beat = beat + 1;
+            end
+
+            if ((!m_axi_rvalid || m_axi_rready) && ar_head != ar_tail && ($random % 3) != 0) begin
+                for (b = 0; b < 4; b = b + 1)
+                    m_axi_rdata[b*8 +: 8] <= mem[burst_addr[ar_head % 16] + beat*4 + b];
+                m_axi_rlast  <= (beat == burst_len[ar_head % 16]);
+                m_axi_rvalid <= 1'b1;
+            end
+        end
+    end
+
+    // ----------------------------------------------------
+    // Stream checker : cells must come out in ROI order
+    // ----------------------------------------------------
+    always @(posedge clk) begin
+        if (rstn && m_axis_tvalid && m_axis_tready) begin
+            for (k = 0; k < m_axis_tbytes; k = k + 1) begin
+                row = cell / ROI_WIDTH;
+                col = cell % ROI_WIDTH;
+                if (m_axis_tdata[31 - k*8 -: 8] !== mem[ROI_BASE + row*ROI_STRIDE + col]) begin
+                    $display("%0t ERROR: cell (%0d,%0d) = %0h, expected %0h", $time, row, col,
+                             m_axis_tdata[31 - k*8 -: 8], mem[ROI_BASE + row*ROI_STRIDE + col]);
+                    errors = errors + 1;
+                end
+                cell = cell + 1;
+            end
+            if (m_axis_tlast !== (cell % ROI_WIDTH == 0)) begin
+                $display("%0t ERROR: tlast = %b after %0d cells", $time, m_axis_tlast, cell);
+                errors = errors + 1;
+            end
+        end
+        m_axis_tready <= ($random % 5) != 0;
+    end
+
+    // a burst is only requested once its beats fit in the read FIFO : RREADY never holds the memory
+    always @(posedge clk) begin
+        if (rstn && m_axi_rvalid && !m_axi_rready) begin
+            $display("%0t ERROR: RREADY low with read data waiting", $time);
+            errors = errors + 1;
+        end
+    end
+
+    initial begin
+        errors = 0;
+        cell = 0;
+        rstn = 0;
+        start = 0;
+        m_axis_tready = 0;
+        for (b = 0; b < MEM_BYTES; b = b + 1)
+            mem[b] = b * 7 + 3;
+
+        repeat (5) @(posedge clk);
+        rstn <= 1;
+        repeat (2) @(posedge clk);
+
+        start <= 1'b1;
+        @(posedge clk);
+        start <= 1'b0;
+        @(posedge clk);
+        while (busy) @(posedge clk);
+
+        if (cell != ROI_WIDTH * ROI_HEIGHT) begin
+            $display("%0t ERROR: %0d cells received, expected %0d", $time, cell, ROI_WIDTH * ROI_HEIGHT);
+            errors = errors + 1;
+        end
+        if (error) begin
+            $display("%0t ERROR: read error flagged", $time);
+            errors = errors + 1;
+        end
+
+        if (errors == 0)
+            $display("\n*** ALL TESTS PASSED! ***\n");
+
+        #100;
+        $finish;
+    end
+
+endmodule
@@ -0,0 +1,200 @@
+`timescale 1ns/1ps
+
+module tb_axi_roi_writer;
+
+    // Parameters
+    localparam BUS_WIDTH   = 32;
+    localparam CELL_WIDTH  = 12;
+    localparam MAX_BURST   = 4;
+    localparam MEM_BYTES   = 8192;
+    localparam PERIOD      = 4;
+
+    // ROI : 7 x 4 cells, rows 60 bytes apart, the second row crosses the 4 KB page at 0x1000
+    localparam ROI_BASE    = 32'h0000_0FC0;
+    localparam ROI_STRIDE  = 60;
+    localparam ROI_WIDTH   = 7;
+    localparam ROI_HEIGHT  = 4;
+    localparam SENTINEL    = 8'hEE;
+
+    reg clk = 0;
+    reg rstn;
+
+    always #(PERIOD/2) clk = ~clk;
+
+    // DUT signals
+    reg         start;
+    wire        busy;
+    wire        done;
+    wire        error;
+    reg  [CELL_WIDTH-1:0] s_axis_tdata;
+    reg         s_axis_tvalid;
+    wire        s_axis_tready;
+    wire [31:0] m_axi_awaddr;
+    wire [7:0]  m_axi_awlen;
+    wire [2:0]  m_axi_awsize;
+    wire [1:0]  m_axi_awburst;
+    wire        m_axi_awvalid;
+    reg         m_axi_awready;
+    wire [31:0] m_axi_wdata;
+    wire [3:0]  m_axi_wstrb;
+    wire        m_axi_wlast;
+    wire        m_axi_wvalid;
+    wire        m_axi_wready;
+    reg  [1:0]  m_axi_bresp;
+    reg         m_axi_bvalid;
+    wire        m_axi_bready;
+
+    // memory model
+    reg [7:0]  mem [0:MEM_BYTES-1];
+    reg [31:0] burst_addr [0:15];
+    reg [7:0]  burst_len  [0:15];
+    integer    aw_head, aw_tail, beat, b_pending;
+
+    integer errors;
+    integer cell, row, col, b;
+    reg [CELL_WIDTH-1:0] value;
+    reg [7:0] expected;
+
+    axi_roi_writer #(
+        .ADDR_WIDTH(32),
+        .BUS_WIDTH(BUS_WIDTH),
+        .CELL_WIDTH(CELL_WIDTH),
+        .MAX_BURST_LEN(MAX_BURST),
+        .MAX_OUTSTANDING(2)
+    ) dut (
+        .clk(clk),
+        .rstn(rstn),
+        .start(start),
+        .cfg_base(ROI_BASE),
+        .cfg_stride(ROI_STRIDE),
+        .cfg_width(ROI_WIDTH[15:0]),
+        .cfg_height(ROI_HEIGHT[15:0]),
+        .busy(busy),
+        .done(done),
+        .error(error),
+        .s_axis_tdata(s_axis_tdata),
+        .s_axis_tvalid(s_axis_tvalid),
+        .s_axis_tready(s_axis_tready),
+        .m_axi_awaddr(m_axi_awaddr),
+        .m_axi_awlen(m_axi_awlen),
+        .m_axi_awsize(m_axi_awsize),
+        .m_axi_awburst(m_axi_awburst),
+        .m_axi_awvalid(m_axi_awvalid),
+        .m_axi_awready(m_axi_awready),
+        .m_axi_wdata(m_axi_wdata),
+        .m_axi_wstrb(m_axi_wstrb),
+        .m_axi_wlast(m_axi_wlast),
+        .m_axi_wvalid(m_axi_wvalid),
+        .m_axi_wready(m_axi_wready),
+        .m_axi_bresp(m_axi_bresp),
+        .m_axi_bvalid(m_axi_bvalid),
+        .m_axi_bready(m_axi_bready)
+    );
+
+    // ----------------------------------------------------
+    // AXI4 write slave : data is only taken once its burst address is known
+    // ----------------------------------------------------
+    assign m_axi_wready = (aw_head != aw_tail);
+
+    always @(posedge clk) begin
+        if (!rstn) begin
+            m_axi_awready <= 1'b0;
+            m_axi_bvalid  <= 1'b0;
+            m_axi_bresp   <= 2'b00;
+            aw_head   = 0;
+            aw_tail   = 0;
+            beat      = 0;
+            b_pending = 0;
+        end
+        else begin
+            if (m_axi_wvalid && m_axi_wready) begin
+                for (b = 0; b < 4; b = b + 1)
+                    if (m_axi_wstrb[b])
+                        mem[burst_addr[aw_head % 16] + beat*4 + b] = m_axi_wdata[b*8 +: 8];
+                if (m_axi_wlast !== (beat == burst_len[aw_head % 16])) begin
+                    $display("%0t ERROR: wlast = %b on beat %0d of a %0d beat burst", $time, m_axi_wlast, beat, burst_len[aw_head % 16] + 1);
+                    errors = errors + 1;
+                end
+                if (m_axi_wlast) begin
+                    aw_head   = aw_head + 1;
+                    beat      = 0;
+                    b_pending = b_pending + 1;
+                end else
+                    beat = beat + 1;
+            end
+
+            m_axi_awready <= ($random % 4) != 0;
+            if (m_axi_awvalid && m_axi_awready) begin
+                if (((m_axi_awaddr & 12'hFFF) + (m_axi_awlen + 1) * 4) > 4096) begin
+                    $display("%0t ERROR: burst at %0h crosses a 4 KB page", $time, m_axi_awaddr);
+                    errors = errors + 1;
+                end
+                burst_addr[aw_tail % 16] = m_axi_awaddr;
+                burst_len[aw_tail % 16]  = m_axi_awlen;
+                aw_tail = aw_tail + 1;
+            end
+
+            if (m_axi_bvalid && m_axi_bready)
+                m_axi_bvalid <= 1'b0;
+            else if (!m_axi_bvalid && b_pending != 0) begin
+                m_axi_bvalid <= 1'b1;
+                b_pending = b_pending - 1;
+            end
+        end
+    end
+
+    initial begin
+        errors = 0;
+        rstn = 0;
+        start = 0;
+        s_axis_tdata = 0;
+        s_axis_tvalid = 0;
+        for (b = 0; b < MEM_BYTES; b = b + 1)
+            mem[b] = SENTINEL;
+
+        repeat (5) @(posedge clk);
+        rstn <= 1;
+        repeat (2) @(posedge clk);
+
+        start <= 1'b1;
+        @(posedge clk);
+        start <= 1'b0;
+
+        // results : cell n = 37*n, so the later ones saturate
+        for (cell = 0; cell < ROI_WIDTH * ROI_HEIGHT; cell = cell + 1) begin
+            s_axis_tdata  <= cell * 37;
+            s_axis_tvalid <= 1'b1;
+            @(posedge clk);
+            while (!s_axis_tready) @(posedge clk);
+            s_axis_tvalid <= 1'b0;
+            repeat ($urandom % 2) @(posedge clk);
+        end
+
+        while (!done) @(posedge clk);
+        @(posedge clk);
+
+        // every ROI cell written, the bytes around the rows untouched
+        for (row = 0; row < ROI_HEIGHT; row = row + 1) begin
+            for (col = 0; col < ROI_WIDTH + 1; col = col + 1) begin
+                value = (row * ROI_WIDTH + col) * 37;
+                expected = (col == ROI_WIDTH) ? SENTINEL : ((value > 255) ? 8'hFF : value[7:0]);
+                if (mem[ROI_BASE + row*ROI_STRIDE + col] !== expected) begin
+                    $display("%0t ERROR: mem (%0d,%0d) = %0h, expected %0h", $time, row, col,
+                             mem[ROI_BASE + row*ROI_STRIDE + col], expected);
+                    errors = errors + 1;
+                end
+            end
+        end
+        if (busy || error) begin
+            $display("%0t ERROR: busy = %b, error = %b after done", $time, busy, error);
+            errors = errors + 1;
+        end
+
+        if (errors == 0)
+            $display("\n*** ALL TESTS PASSED! ***\n");
+
+        #100;
+        $finish;
+    end
+
+endmodule
@@ -8,7 +8,7 @@ module tb_axim_reg;
     localparam PERIOD = 4; // 250 MHz
     localparam NUM_TESTS = 10;
 
-    
+
     //------------ DUT SIGNALS---------------------------
     reg clk=0;
     reg rstn;
@@ -18,28 +18,49 @@ module tb_axim_reg;
     wire                    s_axi_awready;
     // AXI Write Data Channel
     reg [DATA_WIDTH-1:0]    s_axi_wdata;
+    reg [DATA_WIDTH/8-1:0]  s_axi_wstrb;
     reg                     s_axi_wvalid;
     wire                    s_axi_wready;
     // AXI Write Response Channel
     wire [1:0]              s_axi_bresp;
     wire                    s_axi_bvalid;
     reg                     s_axi_bready;
-    // Output Register
-    wire [DATA_WIDTH-1:0]   output_reg;
+    // AXI Read Address Channel
+    reg [ADDRESS_WIDTH-1:0] s_axi_araddr;
+    reg                     s_axi_arvalid;
+    wire                    s_axi_arready;
+    // AXI Read Data Channel
+    wire [DATA_WIDTH-1:0]   s_axi_rdata;
+    wire [1:0]              s_axi_rresp;
+    wire                    s_axi_rvalid;
+    reg                     s_axi_rready;
+    // Control / status
+    wire                    ctrl_start;
+    wire                    ctrl_stop;
+    wire [15:0]             cfg_frame_width;
+    wire [15:0]             cfg_frame_height;
+    wire [3:0]              cfg_radius;
+    wire                    cfg_mode;
+    reg                     status_busy;
+    reg                     frame_done;
+    reg                     kernel_ready;
+    wire                    irq;
 
     //-----------------TEST DATA ARRAYS--------------------
     reg [ADDRESS_WIDTH-1:0] test_addresses [0:NUM_TESTS-1];
     reg [DATA_WIDTH-1:0]    test_data [0:NUM_TESTS-1];
     reg [1:0]               expected_resp [0:NUM_TESTS-1];
-    reg [DATA_WIDTH-1:0]    expected_output [0:NUM_TESTS-1];
+    reg [DATA_WIDTH-1:0]    expected_output [0:NUM_TESTS-1]; // value read back after the write
 
     reg [NUM_TESTS:0] errors, passed, i;
 
-  
+
     //---------------DUT INSTANTIATION-------------------------
     axim_reg #(
         .ADDRESS_WIDTH(ADDRESS_WIDTH),
-        .DATA_WIDTH(DATA_WIDTH)
+        .DATA_WIDTH(DATA_WIDTH),
+        .RADIUS_WIDTH(4),
+        .RADIUS_RESET(6)
     ) dut (
         .clk(clk),
         .rstn(rstn),
@@ -49,83 +70,116 @@ module tb_axim_reg;
         .s_axi_awready(s_axi_awready),
         // Write Data Channel
         .s_axi_wdata(s_axi_wdata),
+        .s_axi_wstrb(s_axi_wstrb),
         .s_axi_wvalid(s_axi_wvalid),
         .s_axi_wready(s_axi_wready),
         // Write Response Channel
         .s_axi_bresp(s_axi_bresp),
         .s_axi_bvalid(s_axi_bvalid),
         .s_axi_bready(s_axi_bready),
-        // Output Register
-        .output_reg(output_reg)
+        // Read Address Channel
+        .s_axi_araddr(s_axi_araddr),
+        .s_axi_arvalid(s_axi_arvalid),
+        .s_axi_arready(s_axi_arready),
+        // Read Data Channel
+        .s_axi_rdata(s_axi_rdata),
+        .s_axi_rresp(s_axi_rresp),
+        .s_axi_rvalid(s_axi_rvalid),
+        .s_axi_rready(s_axi_rready),
+        // Control / status
+        .ctrl_start(ctrl_start),
+        .ctrl_stop(ctrl_stop),
+        .cfg_frame_width(cfg_frame_width),
+        .cfg_frame_height(cfg_frame_height),
+        .cfg_radius(cfg_radius),
+        .cfg_mode(cfg_mode),
+        .status_busy(status_busy),
+        .status_loading(1'b0),
+        .status_shadow_pending(1'b0),
+        .status_kgen_busy(1'b0),
+        .frame_done(frame_done),
+        .kernel_ready(kernel_ready),
+        .dma_rd_busy(1'b0),
+        .dma_wr_busy(1'b1),
+        .dma_rd_error(1'b0),
+        .dma_wr_error(1'b0),
+        .perf_cycles(32'd1000),
+        .perf_active(32'd800),
+        .perf_out_stall(32'd50),
+        .perf_in_starved(32'd100),
+        .perf_weight_load(32'd20),
+        .perf_xbar_idle(32'd30),
+        .perf_fifo_hwm(9'b100_011_010),   // FIFO0 = 2, FIFO1 = 3, FIFO2 = 4
+        .irq(irq)
     );
 
     //------------CLOCK GENERATION-----------------
     always #(PERIOD/2) clk = ~clk;
-    
+
 
     // ----------------------------------------------------
     // INITIALIZE TEST VECTORS
     // ----------------------------------------------------
     initial begin
-        // Test case 0: Valid write address 0 , data = 100
-        test_addresses[0] = 32'h0000_0000;
-        test_data[0] = 32'd100;  // 
+        // Test case 0: FRAME_WIDTH = 100
+        test_addresses[0] = 32'h0000_0008;
+        test_data[0] = 32'd100;
         expected_resp[0] = 2'b00; // OKAY
         expected_output[0] = 32'd100;
 
-        // Test case 1: Valid write address, data = 250
-        test_addresses[1] = 32'h0000_0000;
+        // Test case 1: FRAME_HEIGHT = 250
+        test_addresses[1] = 32'h0000_000C;
         test_data[1] = 32'd250;
         expected_resp[1] = 2'b00; // OKAY
         expected_output[1] = 32'd250;
 
-        // Test case 2: Invalid address (non-zero) , data = 500
-        test_addresses[2] = 32'h0000_0004;
+        // Test case 2: Invalid address (past the map)
+        test_addresses[2] = 32'h0000_0034;
         test_data[2] = 32'd500;
         expected_resp[2] = 2'b10; // error
-        expected_output[2] = 32'd250; // Should not change
+        expected_output[2] = 32'd0;
 
-        // Test case 3: Valid address , data = 750
-        test_addresses[3] = 32'h0000_0000; 
-        test_data[3] = 32'd750;
+        // Test case 3: RADIUS = 3
+        test_addresses[3] = 32'h0000_0010;
+        test_data[3] = 32'd3;
         expected_resp[3] = 2'b00; // OKAY
-        expected_output[3] = 32'd750;
+        expected_output[3] = 32'd3;
 
-        // Test case 4: Invalid address  , data = 333
-        test_addresses[4] = 32'h0000_FFFF;
+        // Test case 4: Invalid address (unaligned)
+        test_addresses[4] = 32'h0000_0009;
         test_data[4] = 32'd333;
         expected_resp[4] = 2'b10; // error
-        expected_output[4] = 32'd750; // Should not change
+        expected_output[4] = 32'd0;
 
-        // Test case 5: All 1
-        test_addresses[5] = 32'h0000_0000;
-        test_data[5] = 32'd1;
+        // Test case 5: MODE = inflation, bit-packed input, run-length output, frame streaming, replicated border
+        test_addresses[5] = 32'h0000_0014;
+        test_data[5] = 32'hFF;
         expected_resp[5] = 2'b00; // OKAY
-        expected_output[5] = 32'd1;
+        expected_output[5] = 32'h3F;
 
-        // Test case 6: All 0
-        test_addresses[6] = 32'h0000_0000;
-        test_data[6] = 32'd0;
+        // Test case 6: FRAME_WIDTH is only 16 bits wide
+        test_addresses[6] = 32'h0000_0008;
+        test_data[6] = 32'hFFFF_FFFF;
         expected_resp[6] = 2'b00; // OKAY
-        expected_output[6] = 32'd0;
+        expected_output[6] = 32'h0000_FFFF;
 
-        // Test case 7: Valid address, data = 555
-        test_addresses[7] = 32'h0000_0000;
-        test_data[7] = 32'd555;
+        // Test case 7: IRQ_ENABLE
+        test_addresses[7] = 32'h0000_0018;
+        test_data[7] = 32'd1;
         expected_resp[7] = 2'b00; // OKAY
-        expected_output[7] = 32'd555;
+        expected_output[7] = 32'd1;
 
-        // Test case 8: Invalid address , data = 888
+        // Test case 8: Invalid address (outside the register window)
         test_addresses[8] = 32'h1234_5678;
         test_data[8] = 32'd888;
         expected_resp[8] = 2'b10; // error
-        expected_output[8] = 32'd555; // 
+        expected_output[8] = 32'd0;
 
-        // Test case 9: valid write
-        test_addresses[9] = 32'h0000_0000;
+        // Test case 9: VERSION is read only
+        test_addresses[9] = 32'h0000_0020;
         test_data[9] = 32'd42;
         expected_resp[9] = 2'b00; // OKAY
-        expected_output[9] = 32'd42;
+        expected_output[9] = 32'h0001_0000;
     end
 
     // ----------------------------------------------------
@@ -135,58 +189,68 @@ module tb_axim_reg;
         input [ADDRESS_WIDTH-1:0] addr;
         input [DATA_WIDTH-1:0] data;
         input [1:0] exp_resp;
-        input [DATA_WIDTH-1:0] exp_output;
         begin
-            // Start address phase
+            // Address and data phases start together
             @(posedge clk);
             s_axi_awaddr <= addr;
             s_axi_awvalid <= 1'b1;
-
-            // Wait for address ready
-            wait (s_axi_awready)
-	    @(posedge clk);
-            s_axi_awvalid <= 1'b0;
-
-            // Start data phase
 	    s_axi_wdata <= data;
+            s_axi_wstrb <= {DATA_WIDTH/8{1'b1}};
             s_axi_wvalid <= 1'b1;
-            
-            // Wait for data ready
-            
-            wait (s_axi_wready)
-	    @(posedge clk);
+            s_axi_bready <= 1'b1;
+
+            // Wait for address/data ready
+            @(posedge clk);
+            while (!s_axi_awready) @(posedge clk);
+            s_axi_awvalid <= 1'b0;
             s_axi_wvalid <= 1'b0;
 
             // Wait for response
-            s_axi_bready <= 1'b1;
-            wait (s_axi_bvalid)
-            
-            // Response received
-           // @(posedge clk);
-           // s_axi_bready = 1'b0;
-
-	 // repeat(2) @(posedge clk);
+            @(posedge clk);
+            while (!s_axi_bvalid) @(posedge clk);
 
 	  // Check response
             if (s_axi_bresp !== exp_resp) begin
-                $display("%0t ERROR: Response mismatch! Got %b, expected %b", $time, s_axi_bresp, exp_resp);
+                $display("%0t ERROR: Write response mismatch! Got %b, expected %b", $time, s_axi_bresp, exp_resp);
                 errors = errors + 1;
             end else begin
-                $display(" %0t PASS: Response = %b", $time, s_axi_bresp);
+                $display(" %0t PASS: Write response = %b", $time, s_axi_bresp);
             end
 
-            // Check output register
-            if (output_reg !== exp_output) begin
-                $display("%0t ERROR: Output mismatch! Got %0d, expected %0d", $time, output_reg, exp_output);
+           s_axi_bready <= 1'b0;
+        end
+    endtask
+
+    // ----------------------------------------------------
+    // AXI READ TRANSACTION TASK
+    // ----------------------------------------------------
+    task axi_read;
+        input [ADDRESS_WIDTH-1:0] addr;
+        input [1:0] exp_resp;
+        input [DATA_WIDTH-1:0] exp_data;
+        begin
+            @(posedge clk);
+            s_axi_araddr <= addr;
+            s_axi_arvalid <= 1'b1;
+            s_axi_rready <= 1'b1;
+
+            @(posedge clk);
+            while (!s_axi_arready) @(posedge clk);
+            s_axi_arvalid <= 1'b0;
+
+            @(posedge clk);
+            while (!s_axi_rvalid) @(posedge clk);
+
+            if (s_axi_rresp !== exp_resp || s_axi_rdata !== exp_data) begin
+                $display("%0t ERROR: Read mismatch! Got %0h (%b), expected %0h (%b)", $time, s_axi_rdata, s_axi_rresp, exp_data, exp_resp);
                 errors = errors + 1;
             end else begin
-                $display("%0t  PASS: Output = %0d", $time, output_reg);
+                $display("%0t  PASS: Read = %0h", $time, s_axi_rdata);
                 passed = passed + 1;
             end
 
-           @(posedge clk);
-           s_axi_bready <= 1'b0;
-           repeat(2) @(posedge clk);
+            s_axi_rready <= 1'b0;
+            repeat(2) @(posedge clk);
         end
     endtask
 
@@ -199,8 +263,15 @@ module tb_axim_reg;
         s_axi_awaddr = 0;
         s_axi_awvalid = 0;
         s_axi_wdata = 0;
+        s_axi_wstrb = 0;
         s_axi_wvalid = 0;
         s_axi_bready = 0;
+        s_axi_araddr = 0;
+        s_axi_arvalid = 0;
+        s_axi_rready = 0;
+        status_busy = 0;
+        frame_done = 0;
+        kernel_ready = 0;
         errors = 0;
         passed = 0;
 
@@ -209,17 +280,83 @@ module tb_axim_reg;
         rstn = 1;
         repeat (5) @(posedge clk);
 
-        // Run all test cases
-	// Run all test cases
+        // Reset value of the radius
+        axi_read(32'h0000_0010, 2'b00, 32'd6);
+
+	// Run all test cases : write, then read back
         for (i = 0; i < NUM_TESTS; i = i + 1) begin
-            axi_write(test_addresses[i], test_data[i],  expected_resp[i], expected_output[i]);
+            axi_write(test_addresses[i], test_data[i],  expected_resp[i]);
+            axi_read(test_addresses[i], expected_resp[i], expected_output[i]);
+        end
+
+        // Frame done event : DONE status, interrupt, then write one to clear
+        status_busy = 1;
+        @(posedge clk);
+        frame_done <= 1'b1;
+        @(posedge clk);
+        frame_done <= 1'b0;
+        status_busy <= 1'b0;
+        @(posedge clk);
+        if (!irq) begin
+            $display("%0t ERROR: no interrupt after frame done", $time);
+            errors = errors + 1;
         end
-       /*
-        $display("========================================");
-        $display("Total tests: %0d", NUM_TESTS);
-        $display("Passed:      %0d", passed);
-        $display("Failed:      %0d", errors);
-        */
+        axi_read(32'h0000_0004, 2'b00, 32'h2);       // STATUS.DONE
+        axi_write(32'h0000_001C, 32'h1, 2'b00);      // IRQ_STATUS W1C
+        axi_read(32'h0000_001C, 2'b00, 32'h0);
+        if (irq) begin
+            $display("%0t ERROR: interrupt still high after clear", $time);
+            errors = errors + 1;
+        end
+
+        // Kernel ready event : latched while masked, raises the interrupt once enabled
+        @(posedge clk);
+        kernel_ready <= 1'b1;
+        @(posedge clk);
+        kernel_ready <= 1'b0;
+        @(posedge clk);
+        if (irq) begin
+            $display("%0t ERROR: kernel ready interrupt not masked", $time);
+            errors = errors + 1;
+        end
+        axi_read(32'h0000_001C, 2'b00, 32'h2);
+        axi_write(32'h0000_0018, 32'h3, 2'b00);      // IRQ_ENABLE : frame done and kernel ready
+        if (!irq) begin
+            $display("%0t ERROR: no interrupt after kernel ready", $time);
+            errors = errors + 1;
+        end
+        axi_write(32'h0000_001C, 32'h2, 2'b00);
+        axi_read(32'h0000_001C, 2'b00, 32'h0);
+        if (irq) begin
+            $display("%0t ERROR: kernel ready interrupt still high after clear", $time);
+            errors = errors + 1;
+        end
+
+        // Performance counter registers
+        axi_read(32'h0000_0044, 2'b00, 32'd800);     // PERF_ACTIVE
+        axi_read(32'h0000_0048, 2'b00, 32'd50);      // PERF_OUT_STALL
+        axi_read(32'h0000_0064, 2'b00, 32'd3);       // PERF_FIFO_HWM[1]
+        axi_read(32'h0000_006C, 2'b10, 32'd0);       // past the last FIFO
+
+        // CONFIG : 3x3 array, one engine, 8 bit costs (read only)
+        axi_read(32'h0000_0024, 2'b00, 32'h0008_0103);
+
+        // Kernel generator parameters : reset values, then Q16.16 read back
+        axi_read(32'h0000_0028, 2'b00, 32'h000A_0000);   // KGEN_SCALE = 10.0
+        axi_read(32'h0000_0030, 2'b00, 32'h0000_0CCD);   // KGEN_RESOLUTION = 0.05
+        axi_write(32'h0000_002C, 32'h0000_4000, 2'b00);  // KGEN_INSCRIBED = 0.25
+        axi_read(32'h0000_002C, 2'b00, 32'h0000_4000);
+
+        // ROI DMA registers
+        axi_write(32'h0000_00A8, 32'h8000_0100, 2'b00);  // SRC_ADDR
+        axi_read(32'h0000_00A8, 2'b00, 32'h8000_0100);
+        axi_write(32'h0000_00B0, 32'h0001_0040, 2'b00);  // SRC_WIDTH is only 16 bits wide
+        axi_read(32'h0000_00B0, 2'b00, 32'h0000_0040);
+        axi_write(32'h0000_00A0, 32'h3, 2'b00);          // DMA_CTRL : read and write enabled
+        axi_read(32'h0000_00A0, 2'b00, 32'h3);
+        axi_read(32'h0000_00A4, 2'b00, 32'h2);           // DMA_STATUS.WRITE_BUSY
+        axi_read(32'h0000_00C0, 2'b10, 32'd0);           // past the DMA registers
+
         if (errors == 0) begin
             $display("\n*** ALL TESTS PASSED! ***\n");
         end
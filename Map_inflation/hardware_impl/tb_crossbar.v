@@ -29,6 +29,7 @@ module tb_crossbar;
     )  DUT (
         .clk(clk),
         .rstn(rstn),
+        .cfg_kernel_size(KERNEL_SIZE),
         .s_axis_tvalid(s_axis_tvalid),
         .s_axis_tdata(s_axis_tdata),
         .s_axis_tready(s_axis_tready),
@@ -0,0 +1,164 @@
+`timescale 1ns/1ps
+
+module tb_dsp_row;
+
+  // Parameters
+  localparam KERNEL_SIZE  = 5;
+  localparam DATA_WIDTH   = 8;
+  localparam WEIGHT_WIDTH = 8;
+  localparam SUM_WIDTH    = DATA_WIDTH + WEIGHT_WIDTH + $clog2(KERNEL_SIZE);
+  localparam NUM_RESULTS  = 100;   // results of every row in every phase
+  localparam PERIOD       = 4;
+
+  reg clk = 0;
+  reg rstn;
+
+  always #(PERIOD/2) clk = ~clk;
+
+  integer errors;
+  integer phase;
+  integer i;
+
+  // phases : {kernel size, mode, centre row}
+  reg  [2:0] cfg_kernel_size;
+  reg        max_mode;
+  reg        centre_row;
+  reg  [WEIGHT_WIDTH * KERNEL_SIZE - 1 : 0] weights;   // symmetric inside the runtime kernel
+  reg        run;
+  reg        done_0, done_1;
+
+  // Two rows : 0 one DSP per column, 1 two columns per DSP (pre-adder)
+  genvar g;
+  generate
+    for (g = 0; g < 2; g = g + 1) begin : gen_dut
+      // steps from pixels_in to row_out
+      localparam LATENCY = g ? (KERNEL_SIZE + 1) / 2 + 3 : KERNEL_SIZE + 2;
+
+      reg                                    en;
+      reg  [DATA_WIDTH * KERNEL_SIZE - 1 : 0] pixels_in;
+      wire [SUM_WIDTH - 1 : 0]               row_out;
+
+      reg  [SUM_WIDTH - 1 : 0] expected [0:NUM_RESULTS + LATENCY - 1];
+      reg  [SUM_WIDTH - 1 : 0] value;
+      reg                      check;
+      integer pushed, popped, c;
+
+      dsp_row #(
+        .KERNEL_SIZE(KERNEL_SIZE),
+        .DATA_WIDTH(DATA_WIDTH),
+        .WEIGHT_WIDTH(WEIGHT_WIDTH),
+        .DSP_PACK(g)
+      ) dut (
+        .clk(clk),
+        .rstn(rstn),
+        .en({LATENCY{en}}),   // every stage of the chain steps together here
+        .cfg_kernel_size(cfg_kernel_size),
+        .max_mode(max_mode),
+        .centre_row(centre_row),
+        .pixels_in(pixels_in),
+        .weights(weights),
+        .row_out(row_out)
+      );
+
+      always @(posedge clk) begin
+        if (!rstn || !run) begin
+          en        <= 1'b0;
+          pixels_in <= 0;
+          check     = 1'b0;
+          pushed = 0;
+          popped = 0;
+        end
+        else begin
+          // row_out moved on the last step : the sample LATENCY - 1 steps before it
+          if (check) begin
+            if (row_out !== expected[popped]) begin
+              $display("%0t ERROR: row %0d, k = %0d, mode %b : result %0d = %0d, expected %0d",
+                       $time, g, cfg_kernel_size, max_mode, popped, row_out, expected[popped]);
+              errors = errors + 1;
+            end
+            popped = popped + 1;
+            check  = 1'b0;
+          end
+
+          // the model of the sample taken on this step
+          if (en) begin
+            value = 0;
+            for (c = 0; c < cfg_kernel_size; c = c + 1) begin
+              if (max_mode) begin
+                if (pixels_in[c*DATA_WIDTH +: DATA_WIDTH] == 254 && weights[c*WEIGHT_WIDTH +: WEIGHT_WIDTH] > value)
+                  value = weights[c*WEIGHT_WIDTH +: WEIGHT_WIDTH];
+                // the cost of the centre cell is the floor
+                if (centre_row && c == (cfg_kernel_size - 1) / 2 && pixels_in[c*DATA_WIDTH +: DATA_WIDTH] > value)
+                  value = pixels_in[c*DATA_WIDTH +: DATA_WIDTH];
+              end
+              else
+                value = value + pixels_in[c*DATA_WIDTH +: DATA_WIDTH] * weights[c*WEIGHT_WIDTH +: WEIGHT_WIDTH];
+            end
+            expected[pushed] = value;
+            pushed = pushed + 1;
+            check  = (pushed >= LATENCY);
+          end
+
+          // random pixels (lethal ones too) on random steps, LATENCY - 1 more steps to drain the chain
+          en <= (pushed < NUM_RESULTS + LATENCY - 1) && (($random % 3) == 0);
+          for (c = 0; c < KERNEL_SIZE; c = c + 1)
+            pixels_in[c*DATA_WIDTH +: DATA_WIDTH] <= (($random % 4) == 0) ? 8'd254 : $random;
+        end
+      end
+    end
+  endgenerate
+
+  always @(posedge clk) begin
+    done_0 <= run && (gen_dut[0].popped == NUM_RESULTS);
+    done_1 <= run && (gen_dut[1].popped == NUM_RESULTS);
+  end
+
+  initial begin
+    errors = 0;
+    rstn = 0;
+    run = 0;
+    cfg_kernel_size = KERNEL_SIZE;
+    max_mode = 0;
+    centre_row = 0;
+    weights = 0;
+    repeat (5) @(posedge clk);
+    rstn <= 1;
+
+    // 0, 1 : full kernel, 2, 3 : 3x3 (sum, max), 4, 5 : max on the centre row (full kernel, 3x3)
+    for (phase = 0; phase < 6; phase = phase + 1) begin
+      cfg_kernel_size <= (phase < 2 || phase == 4) ? KERNEL_SIZE : 3;
+      max_mode        <= phase[0] || phase[2];
+      centre_row      <= phase[2];
+      @(posedge clk);
+      // weights symmetric inside the kernel, random outside (masked)
+      for (i = 0; i < KERNEL_SIZE; i = i + 1)
+        weights[i*WEIGHT_WIDTH +: WEIGHT_WIDTH] = $random;
+      for (i = 0; i < cfg_kernel_size / 2; i = i + 1)
+        weights[(cfg_kernel_size - 1 - i)*WEIGHT_WIDTH +: WEIGHT_WIDTH] = weights[i*WEIGHT_WIDTH +: WEIGHT_WIDTH];
+      run <= 1'b1;
+      @(posedge clk);
+
+      i = 0;
+      while (!(done_0 && done_1) && i < 40 * NUM_RESULTS) begin
+        @(posedge clk);
+        i = i + 1;
+      end
+      if (i == 40 * NUM_RESULTS) begin
+        $display("%0t ERROR: timeout in phase %0d", $time, phase);
+        errors = errors + 1;
+      end
+      else
+        $display("%0t PASS: phase %0d (k = %0d, mode %b, centre row %b)", $time, phase, cfg_kernel_size, max_mode, centre_row);
+
+      run <= 1'b0;
+      repeat (2) @(posedge clk);
+    end
+
+    if (errors == 0)
+      $display("\n*** ALL TESTS PASSED! ***\n");
+
+    #100;
+    $finish;
+  end
+
+endmodule
@@ -0,0 +1,182 @@
+`timescale 1ns/1ps
+
+module tb_fifo_async;
+
+  // Parameters
+  localparam DATAWIDTH = 16;
+  localparam PTR_WIDTH = 3;     // 8 words
+  localparam NUM_WORDS = 500;   // words pushed through every FIFO
+  localparam NUM_BUS   = 20;    // values sent through cdc_bus
+  localparam PERIOD    = 4;
+  localparam FAST      = 3;     // second clock, not a multiple of PERIOD
+
+  reg clk = 0;
+  reg fast_clk = 0;
+  reg rstn;
+  reg fast_rstn;
+
+  always #(PERIOD/2) clk = ~clk;
+  always #(FAST/2.0) fast_clk = ~fast_clk;
+
+  integer errors;
+  integer cycles;
+
+  // Two FIFOs : 0 writes on clk and reads on fast_clk, 1 the other way round
+  genvar g;
+  generate
+    for (g = 0; g < 2; g = g + 1) begin : gen_dut
+      wire wclk  = (g == 0) ? clk  : fast_clk;
+      wire rclk  = (g == 0) ? fast_clk : clk;
+      wire wrstn = (g == 0) ? rstn : fast_rstn;
+      wire rrstn = (g == 0) ? fast_rstn : rstn;
+
+      reg                  s_tvalid;
+      reg  [DATAWIDTH-1:0] s_tdata;
+      wire                 s_tready;
+      wire                 s_empty;
+      reg                  m_tready;
+      wire [DATAWIDTH-1:0] m_tdata;
+      wire                 m_tvalid;
+
+      integer wr_count, rd_count;
+
+      fifo_async #(
+        .DATAWIDTH(DATAWIDTH),
+        .PTR_WIDTH(PTR_WIDTH)
+      ) dut (
+        .s_clk(wclk),
+        .s_rstn(wrstn),
+        .s_tvalid(s_tvalid),
+        .s_tdata(s_tdata),
+        .s_tready(s_tready),
+        .s_empty(s_empty),
+        .m_clk(rclk),
+        .m_rstn(rrstn),
+        .m_tready(m_tready),
+        .m_tdata(m_tdata),
+        .m_tvalid(m_tvalid)
+      );
+
+      // words are 0, 1, 2 ... pushed in random bursts
+      always @(posedge wclk) begin
+        if (!wrstn) begin
+          s_tvalid <= 1'b0;
+          s_tdata  <= 0;
+          wr_count = 0;
+        end
+        else begin
+          if (s_tvalid && s_tready)
+            wr_count = wr_count + 1;
+          if (wr_count - rd_count > (1 << PTR_WIDTH)) begin
+            $display("%0t ERROR: FIFO %0d holds %0d words", $time, g, wr_count - rd_count);
+            errors = errors + 1;
+          end
+          if (!s_tvalid || s_tready) begin
+            s_tvalid <= (wr_count < NUM_WORDS) && (($random % 4) != 0);
+            s_tdata  <= wr_count;
+          end
+        end
+      end
+
+      // they must come out in order
+      always @(posedge rclk) begin
+        if (!rrstn) begin
+          m_tready <= 1'b0;
+          rd_count = 0;
+        end
+        else begin
+          if (m_tvalid && m_tready) begin
+            if (m_tdata !== rd_count[DATAWIDTH-1:0]) begin
+              $display("%0t ERROR: FIFO %0d read %0d, expected %0d", $time, g, m_tdata, rd_count);
+              errors = errors + 1;
+            end
+            rd_count = rd_count + 1;
+          end
+          m_tready <= ($random % 3) != 0;
+        end
+      end
+    end
+  endgenerate
+
+  // cdc_bus : clk -> fast_clk, every value must arrive once and in order
+  reg  [31:0] bus_data;
+  reg         bus_send;
+  wire        bus_busy;
+  wire [31:0] bus_out;
+  wire        bus_valid;
+  integer     bus_sent, bus_recv;
+
+  cdc_bus #(.WIDTH(32)) bus_dut (
+    .src_clk(clk),
+    .src_rstn(rstn),
+    .src_data(bus_data),
+    .src_send(bus_send),
+    .src_busy(bus_busy),
+    .dst_clk(fast_clk),
+    .dst_rstn(fast_rstn),
+    .dst_data(bus_out),
+    .dst_valid(bus_valid)
+  );
+
+  always @(posedge clk) begin
+    if (!rstn) begin
+      bus_send <= 1'b0;
+      bus_data <= 0;
+      bus_sent = 0;
+    end
+    else begin
+      if (bus_send && !bus_busy)
+        bus_sent = bus_sent + 1;
+      bus_send <= (bus_sent < NUM_BUS) && (($random % 2) == 0);
+      bus_data <= 32'hA000_0000 + bus_sent;
+    end
+  end
+
+  always @(posedge fast_clk) begin
+    if (!fast_rstn)
+      bus_recv = 0;
+    else if (bus_valid) begin
+      if (bus_out !== 32'hA000_0000 + bus_recv) begin
+        $display("%0t ERROR: cdc_bus value %h, expected %h", $time, bus_out, 32'hA000_0000 + bus_recv);
+        errors = errors + 1;
+      end
+      bus_recv = bus_recv + 1;
+    end
+  end
+
+  initial begin
+    errors = 0;
+    rstn = 0;
+    fast_rstn = 0;
+    repeat (5) @(posedge clk);
+    rstn <= 1;
+    @(posedge fast_clk);
+    fast_rstn <= 1;
+
+    cycles = 0;
+    while (!(gen_dut[0].rd_count == NUM_WORDS && gen_dut[1].rd_count == NUM_WORDS && bus_recv == NUM_BUS) &&
+           cycles < 20 * NUM_WORDS) begin
+      @(posedge clk);
+      cycles = cycles + 1;
+    end
+    if (cycles == 20 * NUM_WORDS) begin
+      $display("%0t ERROR: timeout (%0d, %0d words, %0d values)", $time,
+               gen_dut[0].rd_count, gen_dut[1].rd_count, bus_recv);
+      errors = errors + 1;
+    end
+
+    // everything read : the write sides must see it
+    repeat (4) @(posedge clk);
+    if (!gen_dut[0].s_empty || !gen_dut[1].s_empty) begin
+      $display("%0t ERROR: s_empty low after the last read", $time);
+      errors = errors + 1;
+    end
+
+    if (errors == 0)
+      $display("\n*** ALL TESTS PASSED! ***\n");
+
+    #100;
+    $finish;
+  end
+
+endmodule
@@ -0,0 +1,150 @@
+`timescale 1ns/1ps
+
+module tb_fifo_fwft;
+
+  // Parameters
+  localparam DATAWIDTH = 16;
+  localparam NUM_WORDS = 600;   // words pushed through every FIFO
+  localparam PERIOD    = 4;
+
+  reg clk = 0;
+  reg rstn;
+
+  always #(PERIOD/2) clk = ~clk;
+
+  integer errors;
+  integer cycles;
+  reg     done_0, done_1, done_2;
+
+  // Three members of the family :
+  //   0 : 16 words in SRL, registered output
+  //   1 : 64 words in block RAM, registered output
+  //   2 : 32 words in LUT RAM, memory register only
+  genvar g;
+  generate
+    for (g = 0; g < 3; g = g + 1) begin : gen_dut
+      localparam DEPTH     = (g == 0) ? 16 : (g == 1) ? 64 : 32;
+      localparam PTR_WIDTH = $clog2(DEPTH);
+      localparam MEM_TYPE  = (g == 0) ? "srl" : (g == 1) ? "block" : "distributed";
+      localparam FULL_TH   = DEPTH - 4;
+      localparam EMPTY_TH  = 2;
+
+      reg                  s_tvalid;
+      reg  [DATAWIDTH-1:0] s_tdata;
+      wire                 s_tready;
+      reg                  m_tready;
+      wire [DATAWIDTH-1:0] m_tdata;
+      wire                 m_tvalid;
+      wire                 almost_full;
+      wire                 almost_empty;
+      wire [PTR_WIDTH:0]   level;
+
+      integer wr_count, rd_count, occupancy;
+      reg     phase;   // 0 : fill faster than drain, 1 : drain faster than fill
+
+      fifo_fwft #(
+        .DATAWIDTH(DATAWIDTH),
+        .DEPTH(DEPTH),
+        .PTR_WIDTH(PTR_WIDTH),
+        .MEMORY_TYPE(MEM_TYPE),
+        .OUTPUT_REG(g != 2)
+      ) dut (
+        .clk(clk),
+        .rstn(rstn),
+        .s_tvalid(s_tvalid),
+        .s_tdata(s_tdata),
+        .s_tready(s_tready),
+        .m_tready(m_tready),
+        .m_tdata(m_tdata),
+        .m_tvalid(m_tvalid),
+        .prog_full_thresh(FULL_TH),
+        .prog_empty_thresh(EMPTY_TH),
+        .almost_full(almost_full),
+        .almost_empty(almost_empty),
+        .level(level)
+      );
+
+      // words are 0, 1, 2 ... : they must come out in order, and level / flags follow the occupancy
+      always @(posedge clk) begin
+        if (!rstn) begin
+          s_tvalid  <= 1'b0;
+          s_tdata   <= 0;
+          m_tready  <= 1'b0;
+          wr_count  = 0;
+          rd_count  = 0;
+          occupancy = 0;
+          phase     = 0;
+        end
+        else begin
+          if (level !== occupancy) begin
+            $display("%0t ERROR: FIFO %0d level = %0d, expected %0d", $time, g, level, occupancy);
+            errors = errors + 1;
+          end
+          if (almost_full !== (occupancy >= FULL_TH) || almost_empty !== (occupancy <= EMPTY_TH)) begin
+            $display("%0t ERROR: FIFO %0d flags af = %b ae = %b with %0d words", $time, g, almost_full, almost_empty, occupancy);
+            errors = errors + 1;
+          end
+          if (s_tready !== (occupancy < DEPTH)) begin
+            $display("%0t ERROR: FIFO %0d s_tready = %b with %0d words", $time, g, s_tready, occupancy);
+            errors = errors + 1;
+          end
+
+          if (s_tvalid && s_tready) begin
+            wr_count  = wr_count + 1;
+            occupancy = occupancy + 1;
+          end
+          if (m_tvalid && m_tready) begin
+            if (m_tdata !== rd_count[DATAWIDTH-1:0]) begin
+              $display("%0t ERROR: FIFO %0d read %0d, expected %0d", $time, g, m_tdata, rd_count);
+              errors = errors + 1;
+            end
+            rd_count  = rd_count + 1;
+            occupancy = occupancy - 1;
+          end
+
+          if (occupancy == DEPTH)
+            phase = 1;
+          else if (occupancy == 0)
+            phase = 0;
+
+          // bursts in, bursts out, and both full rate at times
+          if (!s_tvalid || s_tready) begin
+            s_tvalid <= (wr_count < NUM_WORDS) && (phase ? (($random % 3) == 0) : (($random % 8) != 0));
+            s_tdata  <= wr_count;
+          end
+          m_tready <= phase ? (($random % 8) != 0) : (($random % 3) == 0);
+        end
+      end
+    end
+  endgenerate
+
+  always @(posedge clk) begin
+    done_0 <= (gen_dut[0].rd_count == NUM_WORDS);
+    done_1 <= (gen_dut[1].rd_count == NUM_WORDS);
+    done_2 <= (gen_dut[2].rd_count == NUM_WORDS);
+  end
+
+  initial begin
+    errors = 0;
+    rstn = 0;
+    repeat (5) @(posedge clk);
+    rstn <= 1;
+
+    cycles = 0;
+    while (!(done_0 && done_1 && done_2) && cycles < 20 * NUM_WORDS) begin
+      @(posedge clk);
+      cycles = cycles + 1;
+    end
+    if (cycles == 20 * NUM_WORDS) begin
+      $display("%0t ERROR: timeout", $time);
+      errors = errors + 1;
+    end
+
+    if (errors == 0)
+      $display("\n*** ALL TESTS PASSED! ***\n");
+
+    #100;
+    $finish;
+  end
+
+endmodule
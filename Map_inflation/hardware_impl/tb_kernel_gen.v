@@ -0,0 +1,208 @@
+`timescale 1ns/1ps
+
+module tb_kernel_gen;
+
+  // Parameters
+  localparam KERNEL_SIZE  = 9;
+  localparam WEIGHT_WIDTH = 8;
+  localparam BUS_WIDTH    = 32;
+  localparam LANES        = BUS_WIDTH / WEIGHT_WIDTH;
+  localparam PERIOD       = 4;
+
+  reg clk = 0;
+  reg rstn;
+
+  always #(PERIOD/2) clk = ~clk;
+
+  // DUT signals
+  reg                                     start;
+  reg  [$clog2(KERNEL_SIZE + 1) - 1 : 0]  cfg_kernel_size;
+  reg  [31:0]                             cfg_scale;
+  reg  [31:0]                             cfg_inscribed;
+  reg  [31:0]                             cfg_resolution;
+  wire                                    busy;
+  wire [BUS_WIDTH - 1 : 0]                m_axis_tdata;
+  wire                                    m_axis_tvalid;
+  reg                                     m_axis_tready;
+
+  reg  [7:0] kernel [0 : KERNEL_SIZE * KERNEL_SIZE - 1];
+  integer errors;
+  integer phase, i, cycles;
+  integer beats, cells, row, col, k, r;
+  integer expected, reference;
+  real    distance;
+
+  kernel_gen #(
+    .KERNEL_SIZE(KERNEL_SIZE),
+    .WEIGHT_WIDTH(WEIGHT_WIDTH),
+    .BUS_WIDTH(BUS_WIDTH)
+  ) dut (
+    .clk(clk),
+    .rstn(rstn),
+    .start(start),
+    .cfg_kernel_size(cfg_kernel_size),
+    .cfg_scale(cfg_scale),
+    .cfg_inscribed(cfg_inscribed),
+    .cfg_resolution(cfg_resolution),
+    .busy(busy),
+    .m_axis_tdata(m_axis_tdata),
+    .m_axis_tvalid(m_axis_tvalid),
+    .m_axis_tready(m_axis_tready)
+  );
+
+  // Bit exact model (software_impl/host/kernel_gen.c)
+  function [16:0] exp2_lut;
+    input integer i;
+    begin
+      exp2_lut = $rtoi(65536.0 * (2.0 ** (-i / 32.0)) + 0.5);
+    end
+  endfunction
+
+  function integer model_cost;
+    input integer dx, dy, radius;
+    input [31:0] scale, inscribed, resolution;
+    reg [31:0] d2, root, trial, excess;
+    reg [63:0] scale_l2e, dist, y, n, mant;
+    integer b, f, idx, t;
+    begin
+      d2 = dx * dx + dy * dy;
+      if (d2 > radius * radius)
+        model_cost = 0;
+      else begin
+        root = 0;
+        for (b = 15; b >= 0; b = b - 1) begin
+          trial = root | (1 << b);
+          if (trial * trial <= (d2 << 16))
+            root = trial;
+        end
+        dist = (resolution * root) >> 8;
+        if (dist <= inscribed)
+          model_cost = 254;
+        else begin
+          scale_l2e = (scale * 64'd94548) >> 16;
+          if (scale_l2e > 64'hFFFF_FFFF) scale_l2e = 64'hFFFF_FFFF;
+          excess = (dist - inscribed > 64'hFFFF_FFFF) ? 32'hFFFF_FFFF : dist - inscribed;
+          y = (scale_l2e * excess) >> 16;
+          n = y >> 16;
+          if (n >= 8)
+            model_cost = 0;
+          else begin
+            f    = y[15:0];
+            idx  = f >> 11;
+            t    = f & 11'h7FF;
+            mant = exp2_lut(idx) - (((exp2_lut(idx) - exp2_lut(idx + 1)) * t) >> 11);
+            model_cost = (253 * mant) >> (16 + n);
+          end
+        end
+      end
+    end
+  endfunction
+
+  // weights : row-major, MSB first, zero padding after the last one
+  always @(posedge clk) begin
+    if (!rstn || start) begin
+      m_axis_tready <= 1'b0;
+      beats = 0;
+      cells = 0;
+    end
+    else begin
+      if (m_axis_tvalid && m_axis_tready) begin
+        for (i = 0; i < LANES; i = i + 1) begin
+          if (cells < k * k)
+            kernel[cells] = m_axis_tdata[BUS_WIDTH - 1 - i*WEIGHT_WIDTH -: WEIGHT_WIDTH];
+          else if (m_axis_tdata[BUS_WIDTH - 1 - i*WEIGHT_WIDTH -: WEIGHT_WIDTH] !== 0) begin
+            $display("%0t ERROR: phase %0d padding lane %0d = %0d", $time, phase, i,
+                     m_axis_tdata[BUS_WIDTH - 1 - i*WEIGHT_WIDTH -: WEIGHT_WIDTH]);
+            errors = errors + 1;
+          end
+          cells = cells + 1;
+        end
+        beats = beats + 1;
+      end
+      m_axis_tready <= ($random % 3) != 0;
+    end
+  end
+
+  initial begin
+    errors = 0;
+    rstn = 0;
+    start = 0;
+    k = KERNEL_SIZE;
+    cfg_kernel_size = KERNEL_SIZE;
+    cfg_scale = 0;
+    cfg_inscribed = 0;
+    cfg_resolution = 0;
+    repeat (5) @(posedge clk);
+    rstn <= 1;
+    repeat (2) @(posedge clk);
+
+    // phases : {k, scale, inscribed radius, resolution}, Q16.16
+    //   0 : 9x9, 10.0, 0.1 m, 0.05 m     1 : 5x5, 3.5, 0, 0.1 m
+    //   2 : 9x9, 0.5, 0.3 m, 0.05 m (lethal up to 6 cells, beyond the radius)   3 : 1x1 (the centre only)
+    for (phase = 0; phase < 4; phase = phase + 1) begin
+      case (phase)
+        0: begin k = 9; cfg_scale <= 32'h000A_0000; cfg_inscribed <= 32'h0000_199A; cfg_resolution <= 32'h0000_0CCD; end
+        1: begin k = 5; cfg_scale <= 32'h0003_8000; cfg_inscribed <= 32'h0000_0000; cfg_resolution <= 32'h0000_199A; end
+        2: begin k = 9; cfg_scale <= 32'h0000_8000; cfg_inscribed <= 32'h0000_4CCD; cfg_resolution <= 32'h0000_0CCD; end
+        default: begin k = 1; cfg_scale <= 32'h000A_0000; cfg_inscribed <= 32'h0000_0000; cfg_resolution <= 32'h0000_0CCD; end
+      endcase
+      r = (k - 1) / 2;
+      cfg_kernel_size <= k;
+      start <= 1'b1;
+      @(posedge clk);
+      start <= 1'b0;
+      @(posedge clk);
+
+      cycles = 0;
+      while (busy && cycles < 5000) begin
+        @(posedge clk);
+        cycles = cycles + 1;
+      end
+
+      if (cycles == 5000) begin
+        $display("%0t ERROR: timeout in phase %0d", $time, phase);
+        errors = errors + 1;
+      end
+      else if (beats != (k * k + LANES - 1) / LANES) begin
+        $display("%0t ERROR: phase %0d, %0d transfers", $time, phase, beats);
+        errors = errors + 1;
+      end
+      else begin
+        // against the bit exact model, and within one unit of the float kernel_compute()
+        // (off the inscribed radius, where the distance is truncated)
+        for (row = 0; row < k; row = row + 1)
+          for (col = 0; col < k; col = col + 1) begin
+            expected = model_cost(col - r, row - r, r, cfg_scale, cfg_inscribed, cfg_resolution);
+            if (kernel[row * k + col] !== expected) begin
+              $display("%0t ERROR: phase %0d weight (%0d, %0d) = %0d, expected %0d",
+                       $time, phase, row, col, kernel[row * k + col], expected);
+              errors = errors + 1;
+            end
+
+            distance = (cfg_resolution / 65536.0) * $sqrt((col - r) * (col - r) + (row - r) * (row - r));
+            if ((col - r) * (col - r) + (row - r) * (row - r) > r * r)
+              reference = 0;
+            else if (distance <= cfg_inscribed / 65536.0)
+              reference = 254;
+            else
+              reference = $rtoi(253.0 * $exp(-(cfg_scale / 65536.0) * (distance - cfg_inscribed / 65536.0)));
+            if (expected != 254 && reference != 254 && (expected - reference > 1 || reference - expected > 1)) begin
+              $display("%0t ERROR: phase %0d weight (%0d, %0d) = %0d, kernel_compute %0d",
+                       $time, phase, row, col, expected, reference);
+              errors = errors + 1;
+            end
+          end
+        $display("%0t PASS: phase %0d (%0dx%0d kernel in %0d cycles)", $time, phase, k, k, cycles);
+      end
+
+      repeat (2) @(posedge clk);
+    end
+
+    if (errors == 0)
+      $display("\n*** ALL TESTS PASSED! ***\n");
+
+    #100;
+    $finish;
+  end
+
+endmodule
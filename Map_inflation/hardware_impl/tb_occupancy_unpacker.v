@@ -0,0 +1,152 @@
+`timescale 1ns/1ps
+
+module tb_occupancy_unpacker;
+
+    // Parameters
+    localparam DATA_WIDTH  = 8;
+    localparam BUS_WIDTH   = 32;
+    localparam NUM_BEATS   = 4;
+    localparam PERIOD      = 4;
+
+    reg clk = 0;
+    reg rstn;
+
+    always #(PERIOD/2) clk = ~clk;
+
+    // DUT signals
+    reg  [15 : 0]             cfg_width;
+    reg                       start;
+    reg  [BUS_WIDTH - 1 : 0]  s_axis_tdata;
+    reg                       s_axis_tvalid;
+    wire                      s_axis_tready;
+    reg                       m_axis_tready;
+    wire [BUS_WIDTH - 1 : 0]  m_axis_tdata;
+    wire                      m_axis_tvalid;
+    wire                      idle;
+
+    localparam CELLS = BUS_WIDTH / DATA_WIDTH;   // cells per output word
+
+    reg  [BUS_WIDTH - 1 : 0]  beats [0 : NUM_BEATS - 1];
+    reg  [BUS_WIDTH - 1 : 0]  expected;
+    integer errors;
+    integer words;      // words checked so far
+    integer cell;       // first cell of the next word in the stream
+    integer col;        // its column in the row
+    integer i, p, n, expected_words;
+
+    occupancy_unpacker #(
+        .DATA_WIDTH(DATA_WIDTH),
+        .BUS_WIDTH(BUS_WIDTH),
+        .LETHAL_COST(254)
+    ) dut (
+        .clk(clk),
+        .rstn(rstn),
+        .cfg_width(cfg_width),
+        .start(start),
+        .s_axis_tdata(s_axis_tdata),
+        .s_axis_tvalid(s_axis_tvalid),
+        .s_axis_tready(s_axis_tready),
+        .m_axis_tready(m_axis_tready),
+        .m_axis_tdata(m_axis_tdata),
+        .m_axis_tvalid(m_axis_tvalid),
+        .idle(idle)
+    );
+
+    // cell n of the packed stream
+    function cell_bit;
+        input integer n;
+        begin
+            cell_bit = beats[n / BUS_WIDTH][BUS_WIDTH - 1 - (n % BUS_WIDTH)];
+        end
+    endfunction
+
+    // every word holds the next cells of its row (CELLS, or what is left of the row), the lanes past them stay at 0
+    always @(posedge clk) begin
+        if (rstn && m_axis_tvalid && m_axis_tready) begin
+            n = (cfg_width - col < CELLS) ? cfg_width - col : CELLS;
+            for (p = 0; p < CELLS; p = p + 1)
+                expected[BUS_WIDTH - 1 - p*DATA_WIDTH -: DATA_WIDTH] =
+                    (p < n && cell_bit(cell + p)) ? 8'd254 : 8'd0;
+            if (m_axis_tdata !== expected) begin
+                $display("%0t ERROR: word %0d (column %0d) = %h, expected %h", $time, words, col, m_axis_tdata, expected);
+                errors = errors + 1;
+            end else
+                $display("%0t PASS: word %0d (column %0d) = %h", $time, words, col, m_axis_tdata);
+            words = words + 1;
+            cell  = cell + n;
+            col   = (col + n == cfg_width) ? 0 : col + n;
+        end
+        m_axis_tready <= ($random % 3) != 0;
+    end
+
+    task run_frame;
+        input [15 : 0] width;
+        begin
+            cfg_width <= width;
+            start <= 1'b1;
+            @(posedge clk);
+            start <= 1'b0;
+            words = 0;
+            cell  = 0;
+            col   = 0;
+
+            for (i = 0; i < NUM_BEATS; i = i + 1) begin
+                s_axis_tdata  <= beats[i];
+                s_axis_tvalid <= 1'b1;
+                @(posedge clk);
+                while (!s_axis_tready) @(posedge clk);
+                s_axis_tvalid <= 1'b0;
+            end
+            repeat (200) @(posedge clk);
+
+            // the words of the stream, up to the first one the leftover bits cannot fill
+            expected_words = 0;
+            p = 0;
+            n = 0;
+            for (i = 0; i < NUM_BEATS * BUS_WIDTH; i = i + n) begin
+                n = (width - p < CELLS) ? width - p : CELLS;
+                if (i + n <= NUM_BEATS * BUS_WIDTH) begin
+                    expected_words = expected_words + 1;
+                    p = (p + n == width) ? 0 : p + n;
+                end
+            end
+            if (words != expected_words || !idle) begin
+                $display("%0t ERROR: %0d words with %0d cells per row, expected %0d", $time, words, width, expected_words);
+                errors = errors + 1;
+            end
+        end
+    endtask
+
+    initial begin
+        errors = 0;
+        words = 0;
+        cell = 0;
+        col = 0;
+        rstn = 0;
+        start = 0;
+        cfg_width = 10;
+        s_axis_tdata = 0;
+        s_axis_tvalid = 0;
+        m_axis_tready = 0;
+        beats[0] = 32'hF0F0_1234;
+        beats[1] = 32'h8000_0001;
+        beats[2] = 32'hDEAD_BEEF;
+        beats[3] = 32'h5555_AAAA;
+
+        repeat (5) @(posedge clk);
+        rstn <= 1;
+        @(posedge clk);
+
+        run_frame(10);  // rows end in the middle of a word
+        run_frame(8);   // two full words per row
+        run_frame(3);   // one short word per row
+        run_frame(33);  // rows longer than a transfer
+
+        if (errors == 0)
+            $display("\n*** ALL TESTS PASSED! ***\n");
+
+        #100;
+        $finish;
+    end
+
+endmodule
@@ -13,7 +13,6 @@ module tb_pe;
     reg pe_en;
     reg  [DATA_WIDTH-1:0]   pe_input;
     reg  [WEIGHT_WIDTH-1:0] pe_weight;
-    wire [DATA_WIDTH-1:0] pe_pixel_out;
     wire [TOTAL_WIDTH-1:0] pe_output;
 
     reg [TOTAL_WIDTH:0] vec;
@@ -25,7 +24,6 @@ module tb_pe;
     reg [WEIGHT_WIDTH-1:0] pe_weight_mem  [0:NUM_TESTS-1];  // array for the pe_weight values
 
    // Output values store in arrays
-   reg [DATA_WIDTH-1:0] pe_pixel_out_mem [0:NUM_TESTS-1]; // array for pixel out values.
    reg [TOTAL_WIDTH-1:0] pe_output_mem   [0:NUM_TESTS-1];   // array pe_output computed
    reg [TOTAL_WIDTH-1:0] expected_mem      [0:NUM_TESTS-1];   // array for expected_output computed
 
@@ -41,7 +39,8 @@ module tb_pe;
         .pe_input(pe_input),
         .pe_weight(pe_weight),
         .pe_en(pe_en),
-        .pe_pixel_out(pe_pixel_out),
+        .max_mode(1'b0),          // product mode
+        .own_cell(1'b0),
         .pe_output(pe_output)
     );
 
@@ -88,14 +87,13 @@ module tb_pe;
 	 
 	     pe_output_mem[idx] = pe_output;
     	     expected_mem[idx]  = verification_mult(pe_input, pe_weight);
-	     pe_pixel_out_mem[idx] = pe_pixel_out;
              idx = idx + 1;
 
 	end
 
         for (idx = 0; idx < NUM_TESTS; idx = idx + 1) begin
 
-	    $display( "%0t Values @%0d: input=%0d pixel_out = %0d weight=%0d | got=%0d exp=%0d", $time, idx, pe_input_mem[idx], pe_pixel_out_mem[idx], pe_weight_mem[idx], pe_output_mem[idx], expected_mem[idx] );
+	    $display( "%0t Values @%0d: input=%0d weight=%0d | got=%0d exp=%0d", $time, idx, pe_input_mem[idx], pe_weight_mem[idx], pe_output_mem[idx], expected_mem[idx] );
    	    if (pe_output_mem[idx] !== expected_mem[idx]) begin
                $display( "%0t MISMATCH @%0d: input=%0d weight=%0d | got=%0d exp=%0d", $time, idx, pe_input_mem[idx], pe_weight_mem[idx], pe_output_mem[idx], expected_mem[idx] );
                errors = errors + 1;
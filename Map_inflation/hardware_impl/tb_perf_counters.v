@@ -0,0 +1,120 @@
+`timescale 1ns/1ps
+
+module tb_perf_counters;
+
+    // Parameters
+    localparam NUM_FIFOS   = 3;
+    localparam LEVEL_WIDTH = 3;
+    localparam PERIOD      = 4;
+
+    reg clk = 0;
+    reg rstn;
+
+    always #(PERIOD/2) clk = ~clk;
+
+    // DUT signals
+    reg  snapshot;
+    reg  clear;
+    reg  ev_active;
+    reg  ev_out_stall;
+    reg  ev_in_starved;
+    reg  ev_weight_load;
+    reg  ev_xbar_idle;
+    reg  [NUM_FIFOS*LEVEL_WIDTH-1:0] fifo_level;
+
+    wire [31:0] snap_cycles;
+    wire [31:0] snap_active;
+    wire [31:0] snap_out_stall;
+    wire [31:0] snap_in_starved;
+    wire [31:0] snap_weight_load;
+    wire [31:0] snap_xbar_idle;
+    wire [NUM_FIFOS*LEVEL_WIDTH-1:0] snap_fifo_hwm;
+
+    integer errors;
+    integer i;
+
+    perf_counters #(
+        .NUM_FIFOS(NUM_FIFOS),
+        .LEVEL_WIDTH(LEVEL_WIDTH),
+        .COUNT_WIDTH(32)
+    ) dut (
+        .clk(clk),
+        .rstn(rstn),
+        .snapshot(snapshot),
+        .clear(clear),
+        .ev_active(ev_active),
+        .ev_out_stall(ev_out_stall),
+        .ev_in_starved(ev_in_starved),
+        .ev_weight_load(ev_weight_load),
+        .ev_xbar_idle(ev_xbar_idle),
+        .fifo_level(fifo_level),
+        .snap_cycles(snap_cycles),
+        .snap_active(snap_active),
+        .snap_out_stall(snap_out_stall),
+        .snap_in_starved(snap_in_starved),
+        .snap_weight_load(snap_weight_load),
+        .snap_xbar_idle(snap_xbar_idle),
+        .snap_fifo_hwm(snap_fifo_hwm)
+    );
+
+    task check;
+        input [31:0] got;
+        input [31:0] expected;
+        input [8*16-1:0] name;
+        begin
+            if (got !== expected) begin
+                $display("%0t ERROR: %0s = %0d, expected %0d", $time, name, got, expected);
+                errors = errors + 1;
+            end else
+                $display("%0t PASS: %0s = %0d", $time, name, got);
+        end
+    endtask
+
+    initial begin
+        errors = 0;
+        rstn = 0;
+        snapshot = 0;
+        clear = 0;
+        ev_active = 0;
+        ev_out_stall = 0;
+        ev_in_starved = 0;
+        ev_weight_load = 0;
+        ev_xbar_idle = 0;
+        fifo_level = 0;
+
+        repeat (5) @(posedge clk);
+        rstn <= 1;
+
+        // clear, then 10 cycles : active every cycle, stall every other cycle
+        @(posedge clk);
+        clear <= 1'b1;
+        @(posedge clk);
+        clear <= 1'b0;
+        for (i = 0; i < 10; i = i + 1) begin
+            ev_active    <= 1'b1;
+            ev_out_stall <= i[0];
+            fifo_level   <= {3'd1, 3'd4, 3'd2};   // FIFO2 = 1, FIFO1 = 4, FIFO0 = 2
+            @(posedge clk);
+        end
+        ev_active    <= 1'b0;
+        ev_out_stall <= 1'b0;
+        fifo_level   <= 0;
+        snapshot     <= 1'b1;
+        @(posedge clk);
+        snapshot     <= 1'b0;
+
+        // the snapshot must not move while the counters keep running
+        repeat (5) @(posedge clk);
+        check(snap_active, 10, "active");
+        check(snap_out_stall, 5, "out_stall");
+        check(snap_cycles, 10, "cycles");
+        check(snap_fifo_hwm, {3'd1, 3'd4, 3'd2}, "fifo_hwm");
+
+        if (errors == 0)
+            $display("\n*** ALL TESTS PASSED! ***\n");
+
+        #100;
+        $finish;
+    end
+
+endmodule
@@ -0,0 +1,221 @@
+`timescale 1ns/1ps
+
+module tb_stripe_dispatcher;
+
+    // Parameters
+    localparam NUM_ENGINES  = 3;
+    localparam KERNEL_SIZE  = 3;
+    localparam BUS_WIDTH    = 32;   // 4 cells per word
+    localparam NUM_ROWS     = 3;
+    localparam MAX_WORDS    = 4;    // words of one engine in one row, at most
+    localparam PERIOD       = 4;
+
+    reg clk = 0;
+    reg rstn;
+
+    always #(PERIOD/2) clk = ~clk;
+
+    // DUT signals
+    reg                         start;
+    reg  [15:0]                 cfg_width;
+    reg                         cfg_border;
+    reg  [BUS_WIDTH-1:0]        s_axis_tdata;
+    reg                         s_axis_tvalid;
+    wire                        s_axis_tready;
+    wire [BUS_WIDTH-1:0]        m_axis_tdata;
+    wire [NUM_ENGINES-1:0]      m_axis_tvalid;
+    reg  [NUM_ENGINES-1:0]      m_axis_tready;
+    wire [NUM_ENGINES*16-1:0]   stripe_in_width;
+    wire [NUM_ENGINES*3-1:0]    stripe_in_skip;
+    wire [NUM_ENGINES*16-1:0]   stripe_cells;
+    wire [NUM_ENGINES-1:0]      stripe_border_left;
+    wire [NUM_ENGINES-1:0]      stripe_border_right;
+    wire [1:0]                  last_engine;
+    wire [15:0]                 desc_rows;
+    wire                        desc_border_top;
+    wire                        desc_border_bottom;
+    wire [NUM_ENGINES-1:0]      desc_valid;
+    reg  [NUM_ENGINES-1:0]      desc_ready;
+
+    // expected stripes of the frame : {in_width, skip, cells, left, right} and the words of a row (first cell)
+    integer exp_width [0:NUM_ENGINES-1];
+    integer exp_skip  [0:NUM_ENGINES-1];
+    integer exp_cells [0:NUM_ENGINES-1];
+    integer exp_last;
+    integer exp_words [0:NUM_ENGINES-1][0:MAX_WORDS-1];
+    integer num_words [0:NUM_ENGINES-1];
+    integer seen      [0:NUM_ENGINES-1];   // words received
+    integer descs     [0:NUM_ENGINES-1];   // descriptors received
+
+    integer errors;
+    integer i, e, r, frame, in_width;
+
+    stripe_dispatcher #(
+        .NUM_ENGINES(NUM_ENGINES),
+        .KERNEL_SIZE(KERNEL_SIZE),
+        .BUS_WIDTH(BUS_WIDTH)
+    ) dut (
+        .clk(clk),
+        .rstn(rstn),
+        .start(start),
+        .abort(1'b0),
+        .cfg_kernel_size(2'd3),
+        .cfg_width(cfg_width),
+        .cfg_height(16'd3),
+        .cfg_border(cfg_border),
+        .s_axis_tdata(s_axis_tdata),
+        .s_axis_tvalid(s_axis_tvalid),
+        .s_axis_tready(s_axis_tready),
+        .m_axis_tdata(m_axis_tdata),
+        .m_axis_tvalid(m_axis_tvalid),
+        .m_axis_tready(m_axis_tready),
+        .stripe_in_width(stripe_in_width),
+        .stripe_in_skip(stripe_in_skip),
+        .stripe_cells(stripe_cells),
+        .stripe_border_left(stripe_border_left),
+        .stripe_border_right(stripe_border_right),
+        .last_engine(last_engine),
+        .desc_rows(desc_rows),
+        .desc_border_top(desc_border_top),
+        .desc_border_bottom(desc_border_bottom),
+        .desc_valid(desc_valid),
+        .desc_ready(desc_ready)
+    );
+
+    // stripe of engine eng : input columns first .. end_col - 1, cells results per row
+    task set_stripe;
+        input integer eng;
+        input integer first;
+        input integer end_col;
+        input integer cells;
+        begin
+            exp_width[eng] = end_col - first;
+            exp_skip[eng]  = first % 4;
+            exp_cells[eng] = cells;
+            num_words[eng] = 0;
+            for (i = 0; i < in_width; i = i + 4)
+                if (i < end_col && i + 4 > first) begin
+                    exp_words[eng][num_words[eng]] = i;
+                    num_words[eng] = num_words[eng] + 1;
+                end
+        end
+    endtask
+
+    // every engine : one descriptor (the whole frame, after the geometry), then its words of every row in order
+    always @(posedge clk) begin
+        if (rstn) begin
+            for (e = 0; e < NUM_ENGINES; e = e + 1) begin
+                if (desc_valid[e]) begin
+                    if (!desc_ready[e])
+                        ;
+                    else if (descs[e] != 0 || seen[e] != 0 || num_words[e] == 0 ||
+                             desc_rows !== (cfg_border ? NUM_ROWS : NUM_ROWS + 2) ||
+                             desc_border_top !== cfg_border || desc_border_bottom !== cfg_border ||
+                             stripe_in_width[e*16 +: 16] !== exp_width[e] || stripe_in_skip[e*3 +: 3] !== exp_skip[e] ||
+                             stripe_cells[e*16 +: 16] !== exp_cells[e] || stripe_border_left[e] !== (cfg_border && e == 0) ||
+                             stripe_border_right[e] !== (cfg_border && e == exp_last) || last_engine !== exp_last) begin
+                        $display("%0t ERROR: engine %0d descriptor : rows %0d, width %0d skip %0d cells %0d left %b right %b last %0d",
+                                 $time, e, desc_rows, stripe_in_width[e*16 +: 16], stripe_in_skip[e*3 +: 3],
+                                 stripe_cells[e*16 +: 16], stripe_border_left[e], stripe_border_right[e], last_engine);
+                        errors = errors + 1;
+                    end
+                    else
+                        $display("%0t PASS: engine %0d descriptor, %0d input cells per row", $time, e, exp_width[e]);
+                    if (desc_ready[e])
+                        descs[e] = descs[e] + 1;
+                end
+                if (m_axis_tvalid[e] && m_axis_tready[e]) begin
+                    if (descs[e] != 1 || num_words[e] == 0 ||
+                        m_axis_tdata !== (seen[e] / num_words[e]) * 256 + exp_words[e][seen[e] % num_words[e]]) begin
+                        $display("%0t ERROR: engine %0d got word %h at word %0d", $time, e, m_axis_tdata, seen[e]);
+                        errors = errors + 1;
+                    end
+                    seen[e] = seen[e] + 1;
+                end
+            end
+        end
+        m_axis_tready <= $random;
+        desc_ready    <= $random;
+    end
+
+    initial begin
+        errors = 0;
+        rstn = 0;
+        start = 0;
+        cfg_width = 10;
+        cfg_border = 1;
+        s_axis_tdata = 0;
+        s_axis_tvalid = 0;
+        m_axis_tready = 0;
+        desc_ready = 0;
+        for (e = 0; e < NUM_ENGINES; e = e + 1) begin
+            seen[e]  = 0;
+            descs[e] = 0;
+        end
+
+        repeat (5) @(posedge clk);
+        rstn <= 1;
+        @(posedge clk);
+
+        for (frame = 0; frame < 3; frame = frame + 1) begin
+            // 0 : 10 cells, border    : stripes of 4 cells, columns 0-4, 3-8 and 7-9
+            // 1 : 10 cells, pre-padded : 12 input cells, columns 0-5, 4-9 and 8-11
+            // 2 : 2 cells, border     : stripes of 1 cell, engine 2 idle
+            cfg_width  = (frame == 2) ? 2 : 10;
+            cfg_border = (frame != 1);
+            in_width   = cfg_border ? cfg_width : cfg_width + 2;
+            if (frame == 0) begin
+                exp_last = 2;
+                set_stripe(0, 0, 5, 4);
+                set_stripe(1, 3, 9, 4);
+                set_stripe(2, 7, 10, 2);
+            end
+            else if (frame == 1) begin
+                exp_last = 2;
+                set_stripe(0, 0, 6, 4);
+                set_stripe(1, 4, 10, 4);
+                set_stripe(2, 8, 12, 2);
+            end
+            else begin
+                exp_last = 1;
+                set_stripe(0, 0, 2, 1);
+                set_stripe(1, 0, 2, 1);
+                num_words[2] = 0;
+            end
+            for (e = 0; e < NUM_ENGINES; e = e + 1) begin
+                seen[e]  = 0;
+                descs[e] = 0;
+            end
+
+            start <= 1'b1;
+            @(posedge clk);
+            start <= 1'b0;
+            for (r = 0; r < (cfg_border ? NUM_ROWS : NUM_ROWS + 2); r = r + 1) begin
+                for (i = 0; i < in_width; i = i + 4) begin
+                    s_axis_tdata  <= r * 256 + i;
+                    s_axis_tvalid <= 1'b1;
+                    @(posedge clk);
+                    while (!s_axis_tready) @(posedge clk);
+                    s_axis_tvalid <= 1'b0;
+                end
+            end
+            repeat (10) @(posedge clk);
+
+            for (e = 0; e < NUM_ENGINES; e = e + 1) begin
+                if (seen[e] != (cfg_border ? NUM_ROWS : NUM_ROWS + 2) * num_words[e] || descs[e] != (num_words[e] != 0)) begin
+                    $display("%0t ERROR: frame %0d, engine %0d : %0d words, %0d descriptors", $time, frame, e, seen[e], descs[e]);
+                    errors = errors + 1;
+                end
+                else
+                    $display("%0t PASS: frame %0d, engine %0d : %0d words", $time, frame, e, seen[e]);
+            end
+        end
+
+        if (errors == 0)
+            $display("\n*** ALL TESTS PASSED! ***\n");
+
+        #100;
+        $finish;
+    end
+
+endmodule
@@ -0,0 +1,144 @@
+`timescale 1ns/1ps
+
+module tb_stripe_merger;
+
+    // Parameters
+    localparam NUM_ENGINES = 3;    // engine 2 idle : a map narrower than three stripes
+    localparam BUS_WIDTH   = 32;
+    localparam FRAME_CELLS = 14;   // row parts of 7, 5 and 2 cells
+    localparam NUM_WORDS   = 3;    // words of one engine in one frame, at most
+    localparam PERIOD      = 4;
+
+    reg clk = 0;
+    reg rstn;
+
+    always #(PERIOD/2) clk = ~clk;
+
+    // DUT signals
+    reg                                 start;
+    wire [NUM_ENGINES*BUS_WIDTH-1:0]    s_axis_tdata;
+    wire [NUM_ENGINES*3-1:0]            s_axis_tbytes;
+    wire [NUM_ENGINES-1:0]              s_axis_tlast;
+    wire [NUM_ENGINES-1:0]              s_axis_tvalid;
+    wire [NUM_ENGINES-1:0]              s_axis_tready;
+    wire [BUS_WIDTH-1:0]                m_axis_tdata;
+    wire [2:0]                          m_axis_tbytes;
+    wire                                m_axis_tlast;
+    wire                                m_axis_tvalid;
+    reg                                 m_axis_tready;
+
+    // words of every engine in one frame : {last, bytes, cells}
+    reg  [BUS_WIDTH+3:0] words [0:NUM_ENGINES-1][0:NUM_WORDS-1];
+    integer              num_words [0:NUM_ENGINES-1];
+    integer              sent      [0:NUM_ENGINES-1];
+    reg  [NUM_ENGINES-1:0] gap;     // random holes in the engine streams
+
+    integer errors;
+    integer cell;       // next cell expected on the output
+    integer frames;
+    integer e, b;
+
+    stripe_merger #(
+        .NUM_ENGINES(NUM_ENGINES),
+        .BUS_WIDTH(BUS_WIDTH)
+    ) dut (
+        .clk(clk),
+        .rstn(rstn),
+        .start(start),
+        .frame_cells(FRAME_CELLS),
+        .last_engine(2'd1),
+        .s_axis_tdata(s_axis_tdata),
+        .s_axis_tbytes(s_axis_tbytes),
+        .s_axis_tlast(s_axis_tlast),
+        .s_axis_tvalid(s_axis_tvalid),
+        .s_axis_tready(s_axis_tready),
+        .m_axis_tdata(m_axis_tdata),
+        .m_axis_tbytes(m_axis_tbytes),
+        .m_axis_tlast(m_axis_tlast),
+        .m_axis_tvalid(m_axis_tvalid),
+        .m_axis_tready(m_axis_tready)
+    );
+
+    // engine models : their words of two frames, with holes
+    genvar g;
+    generate
+        for (g = 0; g < NUM_ENGINES; g = g + 1) begin
+            wire [BUS_WIDTH+3:0] word = words[g][sent[g] % num_words[g]];
+            assign s_axis_tvalid[g] = rstn && !gap[g] && (sent[g] < 2 * num_words[g]);
+            assign {s_axis_tlast[g], s_axis_tbytes[g*3 +: 3], s_axis_tdata[g*BUS_WIDTH +: BUS_WIDTH]} = word;
+        end
+    endgenerate
+
+    // the output must be the cells 0x10, 0x11, ... in order, full words until the end of the frame
+    always @(posedge clk) begin
+        if (rstn) begin
+            for (e = 0; e < NUM_ENGINES; e = e + 1)
+                if (s_axis_tvalid[e] && s_axis_tready[e])
+                    sent[e] = sent[e] + 1;
+
+            if (m_axis_tvalid && m_axis_tready) begin
+                if (m_axis_tlast !== (cell + m_axis_tbytes == FRAME_CELLS) ||
+                    (!m_axis_tlast && m_axis_tbytes != BUS_WIDTH / 8)) begin
+                    $display("%0t ERROR: word at cell %0d : %0d cells, last = %b", $time, cell, m_axis_tbytes, m_axis_tlast);
+                    errors = errors + 1;
+                end
+                for (b = 0; b < m_axis_tbytes; b = b + 1) begin
+                    if (m_axis_tdata[b*8 +: 8] !== 8'h10 + cell + b) begin
+                        $display("%0t ERROR: cell %0d = %h", $time, cell + b, m_axis_tdata[b*8 +: 8]);
+                        errors = errors + 1;
+                    end
+                end
+                $display("%0t PASS: word %h, %0d cells", $time, m_axis_tdata, m_axis_tbytes);
+                cell = cell + m_axis_tbytes;
+                if (m_axis_tlast) begin
+                    cell = 0;
+                    frames = frames + 1;
+                end
+            end
+        end
+        m_axis_tready <= ($random % 3) != 0;
+        gap           <= $random;
+    end
+
+    initial begin
+        errors = 0;
+        cell = 0;
+        frames = 0;
+        rstn = 0;
+        start = 0;
+        m_axis_tready = 0;
+        gap = 0;
+
+        // row 0 : cells 0-6 (engine 0), cells 7-11 (engine 1), row 1 : cells 12-13 (engine 0)
+        words[0][0] = {1'b0, 3'd4, 32'h1312_1110};
+        words[0][1] = {1'b1, 3'd3, 32'h0016_1514};
+        words[0][2] = {1'b1, 3'd2, 32'h0000_1D1C};
+        num_words[0] = 3;
+        words[1][0] = {1'b0, 3'd4, 32'h1A19_1817};
+        words[1][1] = {1'b1, 3'd1, 32'hEEEE_EE1B};   // lanes past the cell count are ignored
+        num_words[1] = 2;
+        num_words[2] = 0;
+        for (e = 0; e < NUM_ENGINES; e = e + 1)
+            sent[e] = 0;
+
+        repeat (5) @(posedge clk);
+        rstn <= 1;
+        start <= 1'b1;
+        @(posedge clk);
+        start <= 1'b0;
+
+        repeat (200) @(posedge clk);
+
+        if (frames != 2) begin
+            $display("%0t ERROR: %0d frames, expected 2", $time, frames);
+            errors = errors + 1;
+        end
+
+        if (errors == 0)
+            $display("\n*** ALL TESTS PASSED! ***\n");
+
+        #100;
+        $finish;
+    end
+
+endmodule
@@ -9,16 +9,19 @@ module tb_top2;
     parameter DEPTH        = 8;
     parameter PTR_WIDTH    = 3;
     parameter BUS_WIDTH    = 32;
+    parameter DUAL_CLOCK   = 0;  // 1 : engine on core_clk (run with -generic_top DUAL_CLOCK=1)
     
     localparam PERIOD = 4; //250 MHZ
+    localparam CORE_PERIOD = 3; // core clock, only used with DUAL_CLOCK
     // Calculated parameters
     localparam SUM_WIDTH      = DATA_WIDTH + WEIGHT_WIDTH + $clog2(KERNEL_SIZE);
-    localparam DATAOUT_WIDTH  = SUM_WIDTH ;
+    localparam DATAOUT_WIDTH  = BUS_WIDTH; // m_axis carries one byte costs zero extended to the bus
     localparam WEIGHTIN_WIDTH = WEIGHT_WIDTH * KERNEL_SIZE * KERNEL_SIZE;
    // localparam NUM_WEIGHT_TRANSFERS = (WEIGHTIN_WIDTH + BUS_WIDTH - 1) / BUS_WIDTH;
     
     
     reg clk=0;
+    reg core_clk=0;
     reg rstn;
     
     // Input
@@ -29,7 +32,62 @@ module tb_top2;
     // Output
     reg                      m_axis_tready;
     wire [DATAOUT_WIDTH-1:0] m_axis_tdata;
+    wire [5:0]               m_axis_tuser;
+    wire                     m_axis_tlast;
     wire                     m_axis_tvalid;
+
+    // AXI4-Lite control
+    reg  [11:0]              s_axi_awaddr;
+    reg                      s_axi_awvalid;
+    wire                     s_axi_awready;
+    reg  [31:0]              s_axi_wdata;
+    reg                      s_axi_wvalid;
+    wire                     s_axi_wready;
+    wire [1:0]               s_axi_bresp;
+    wire                     s_axi_bvalid;
+    reg                      s_axi_bready;
+    wire                     irq;
+
+    // AXI4 master (ROI DMA) and the memory behind it
+    localparam MEM_BYTES  = 4096;
+    localparam ROI_WIDTH  = 6;
+    localparam ROI_HEIGHT = 4;
+    localparam SRC_BASE   = 32'h0000_0100;
+    localparam DST_BASE   = 32'h0000_0400;
+    localparam ROI_STRIDE = 16;
+    localparam SENTINEL   = 8'hEE;
+
+    wire [31:0]              m_axi_araddr;
+    wire [7:0]               m_axi_arlen;
+    wire                     m_axi_arvalid;
+    reg                      m_axi_arready;
+    reg  [BUS_WIDTH-1:0]     m_axi_rdata;
+    reg                      m_axi_rlast;
+    reg                      m_axi_rvalid;
+    wire                     m_axi_rready;
+    wire [31:0]              m_axi_awaddr;
+    wire [7:0]               m_axi_awlen;
+    wire                     m_axi_awvalid;
+    reg                      m_axi_awready;
+    wire [BUS_WIDTH-1:0]     m_axi_wdata;
+    wire [BUS_WIDTH/8-1:0]   m_axi_wstrb;
+    wire                     m_axi_wlast;
+    wire                     m_axi_wvalid;
+    wire                     m_axi_wready;
+    reg                      m_axi_bvalid;
+    wire                     m_axi_bready;
+
+    reg  [7:0]  mem [0:MEM_BYTES-1];
+    reg  [31:0] rd_addr [0:15];
+    reg  [7:0]  rd_len  [0:15];
+    reg  [31:0] wr_addr [0:15];
+    reg  [7:0]  wr_len  [0:15];
+    integer     ar_head, ar_tail, rd_beat, aw_head, aw_tail, wr_beat, b_pending, b;
+
+    integer errors;
+    integer results;    // m_axis results of the first frame
+    integer x, y;
+    reg [7:0] expected;
     
     // DUT
     top #(
@@ -38,15 +96,67 @@ module tb_top2;
         .WEIGHT_WIDTH(WEIGHT_WIDTH),
         .DEPTH(DEPTH),
         .PTR_WIDTH(PTR_WIDTH),
-        .BUS_WIDTH(BUS_WIDTH)
+        .BUS_WIDTH(BUS_WIDTH),
+        .DUAL_CLOCK(DUAL_CLOCK)
     ) DUT (
         .clk(clk),
         .rstn(rstn),
+        .core_clk(core_clk),
+        .s_axi_awaddr(s_axi_awaddr),
+        .s_axi_awvalid(s_axi_awvalid),
+        .s_axi_awready(s_axi_awready),
+        .s_axi_wdata(s_axi_wdata),
+        .s_axi_wstrb(4'hF),
+        .s_axi_wvalid(s_axi_wvalid),
+        .s_axi_wready(s_axi_wready),
+        .s_axi_bresp(s_axi_bresp),
+        .s_axi_bvalid(s_axi_bvalid),
+        .s_axi_bready(s_axi_bready),
+        .s_axi_araddr(12'h000),              // no register read in this test
+        .s_axi_arvalid(1'b0),
+        .s_axi_arready(),
+        .s_axi_rdata(),
+        .s_axi_rresp(),
+        .s_axi_rvalid(),
+        .s_axi_rready(1'b1),
+        .irq(irq),
+        .m_axi_araddr(m_axi_araddr),
+        .m_axi_arlen(m_axi_arlen),
+        .m_axi_arsize(),
+        .m_axi_arburst(),
+        .m_axi_arvalid(m_axi_arvalid),
+        .m_axi_arready(m_axi_arready),
+        .m_axi_rdata(m_axi_rdata),
+        .m_axi_rresp(2'b00),
+        .m_axi_rlast(m_axi_rlast),
+        .m_axi_rvalid(m_axi_rvalid),
+        .m_axi_rready(m_axi_rready),
+        .m_axi_awaddr(m_axi_awaddr),
+        .m_axi_awlen(m_axi_awlen),
+        .m_axi_awsize(),
+        .m_axi_awburst(),
+        .m_axi_awvalid(m_axi_awvalid),
+        .m_axi_awready(m_axi_awready),
+        .m_axi_wdata(m_axi_wdata),
+        .m_axi_wstrb(m_axi_wstrb),
+        .m_axi_wlast(m_axi_wlast),
+        .m_axi_wvalid(m_axi_wvalid),
+        .m_axi_wready(m_axi_wready),
+        .m_axi_bresp(2'b00),
+        .m_axi_bvalid(m_axi_bvalid),
+        .m_axi_bready(m_axi_bready),
+        .s_axis_wgt_tdata({BUS_WIDTH{1'b0}}), // no kernel reload in this test
+        .s_axis_wgt_tvalid(1'b0),
+        .s_axis_wgt_tready(),
         .s_axis_tdata(s_axis_tdata),
+        .s_axis_tuser(5'b0),
+        .s_axis_tlast(1'b0),
         .s_axis_tvalid(s_axis_tvalid),
         .s_axis_tready(s_axis_tready),
         .m_axis_tready(m_axis_tready),
         .m_axis_tdata(m_axis_tdata),
+        .m_axis_tuser(m_axis_tuser),
+        .m_axis_tlast(m_axis_tlast),
         .m_axis_tvalid(m_axis_tvalid)
     );
     
@@ -55,26 +165,189 @@ module tb_top2;
    
     // --------------Clock Generation --------------------------------
     always #(PERIOD/2) clk = ~clk;
+    always #(CORE_PERIOD/2.0) core_clk = ~core_clk;
+
+    // AXI4-Lite register write (address and data presented together)
+    task axil_write;
+        input [11:0] addr;
+        input [31:0] data;
+        begin
+            @(posedge clk);
+            s_axi_awaddr  <= addr;
+            s_axi_awvalid <= 1'b1;
+            s_axi_wdata   <= data;
+            s_axi_wvalid  <= 1'b1;
+            s_axi_bready  <= 1'b1;
+            wait (s_axi_awready);
+            @(posedge clk);
+            s_axi_awvalid <= 1'b0;
+            s_axi_wvalid  <= 1'b0;
+            wait (s_axi_bvalid);
+            @(posedge clk);
+            s_axi_bready  <= 1'b0;
+        end
+    endtask
+
+    // weight w(r, c) of the kernel loaded below : 1 .. 9 row by row, PE(r, c) sees cell (x + c - 1, y + r - 1)
+    function integer weight_rc;
+        input integer r;
+        input integer c;
+        begin
+            weight_rc = r * 3 + c + 1;
+        end
+    endfunction
+
+    // frame 1 : cell (x, y) = 3y + x + 1, zero border, convolution saturated to a byte
+    function [7:0] conv_expected;
+        input integer x;
+        input integer y;
+        integer r, c, sum;
+        begin
+            sum = 0;
+            for (r = 0; r < 3; r = r + 1)
+                for (c = 0; c < 3; c = c + 1)
+                    if (x + c - 1 >= 0 && x + c - 1 < 3 && y + r - 1 >= 0 && y + r - 1 < 3)
+                        sum = sum + weight_rc(r, c) * (3 * (y + r - 1) + (x + c - 1) + 1);
+            conv_expected = (sum > 255) ? 8'hFF : sum;
+        end
+    endfunction
+
+    // frame 2 : inflation of the source ROI, the own cost or the weight of a lethal neighbour
+    function [7:0] inflate_expected;
+        input integer x;
+        input integer y;
+        integer r, c, cost;
+        begin
+            cost = mem[SRC_BASE + y * ROI_STRIDE + x];
+            for (r = 0; r < 3; r = r + 1)
+                for (c = 0; c < 3; c = c + 1)
+                    if (x + c - 1 >= 0 && x + c - 1 < ROI_WIDTH && y + r - 1 >= 0 && y + r - 1 < ROI_HEIGHT &&
+                        mem[SRC_BASE + (y + r - 1) * ROI_STRIDE + x + c - 1] == 254 && weight_rc(r, c) > cost)
+                        cost = weight_rc(r, c);
+            inflate_expected = cost;
+        end
+    endfunction
+
+    // ----------------------------------------------------
+    // AXI4 read slave : answers the bursts in order, first byte of a beat in its low byte
+    // ----------------------------------------------------
+    always @(posedge clk) begin
+        if (!rstn) begin
+            m_axi_arready <= 1'b0;
+            m_axi_rvalid  <= 1'b0;
+            m_axi_rlast   <= 1'b0;
+            m_axi_rdata   <= 0;
+            ar_head = 0;
+            ar_tail = 0;
+            rd_beat = 0;
+        end
+        else begin
+            m_axi_arready <= ($random % 4) != 0;
+            if (m_axi_arvalid && m_axi_arready) begin
+                rd_addr[ar_tail % 16] = m_axi_araddr;
+                rd_len[ar_tail % 16]  = m_axi_arlen;
+                ar_tail = ar_tail + 1;
+            end
+
+            if (m_axi_rvalid && m_axi_rready) begin
+                m_axi_rvalid <= 1'b0;
+                if (m_axi_rlast) begin
+                    ar_head = ar_head + 1;
+                    rd_beat = 0;
+                end else
+                    rd_beat = rd_beat + 1;
+            end
+
+            if ((!m_axi_rvalid || m_axi_rready) && ar_head != ar_tail) begin
+                for (b = 0; b < BUS_WIDTH / 8; b = b + 1)
+                    m_axi_rdata[b*8 +: 8] <= mem[rd_addr[ar_head % 16] + rd_beat * (BUS_WIDTH / 8) + b];
+                m_axi_rlast  <= (rd_beat == rd_len[ar_head % 16]);
+                m_axi_rvalid <= 1'b1;
+            end
+        end
+    end
+
+    // ----------------------------------------------------
+    // AXI4 write slave : data is taken once its burst address is known
+    // ----------------------------------------------------
+    assign m_axi_wready = (aw_head != aw_tail);
+
+    always @(posedge clk) begin
+        if (!rstn) begin
+            m_axi_awready <= 1'b0;
+            m_axi_bvalid  <= 1'b0;
+            aw_head   = 0;
+            aw_tail   = 0;
+            wr_beat   = 0;
+            b_pending = 0;
+        end
+        else begin
+            if (m_axi_wvalid && m_axi_wready) begin
+                for (b = 0; b < BUS_WIDTH / 8; b = b + 1)
+                    if (m_axi_wstrb[b])
+                        mem[wr_addr[aw_head % 16] + wr_beat * (BUS_WIDTH / 8) + b] = m_axi_wdata[b*8 +: 8];
+                if (m_axi_wlast) begin
+                    aw_head   = aw_head + 1;
+                    wr_beat   = 0;
+                    b_pending = b_pending + 1;
+                end else
+                    wr_beat = wr_beat + 1;
+            end
+
+            m_axi_awready <= ($random % 4) != 0;
+            if (m_axi_awvalid && m_axi_awready) begin
+                wr_addr[aw_tail % 16] = m_axi_awaddr;
+                wr_len[aw_tail % 16]  = m_axi_awlen;
+                aw_tail = aw_tail + 1;
+            end
+
+            if (m_axi_bvalid && m_axi_bready)
+                m_axi_bvalid <= 1'b0;
+            else if (!m_axi_bvalid && b_pending != 0) begin
+                m_axi_bvalid <= 1'b1;
+                b_pending = b_pending - 1;
+            end
+        end
+    end
     
     initial begin
-       /*
-       1 2 3     10 11 12     (1*10 + 2*13 + 3*16) , (1*11 + 2*14 + 3*17) (1*12+ 2*15 + 3*18) 
-       4 5 6  *  13 14 15   = (4*10 + 5*13 + 6*16) , (4*11 + 5*14 + 6*17) (4*12+ 5*15 + 6*18) 
-       7 8 9     16 17 18     (7*10 + 8*13 + 9*16) , (7*11 + 8*14 + 9*17) (7*12+ 8*15 + 9*18)
-       
-       1 2 3     10 11 12     84 , 90, 96         dataOut(0,0) = 84 , dataOut(0,1)(1,0) = 90__201  dataOut(0,2)(1,1)(2,0) = 96__216__318
-       4 5 6  *  13 14 15   = 201 , 216, 231      dataOut(.,.)(1,2)(2,1) = xx_  , dataOut(0,1)(1,0) =   dataOut(0,2)(1,1)(2,0) = 
-       7 8 9     16 17 18     318 , 342, 366
-       */
-       
+       // Frame 1 : 3x3 kernel (weights 1 .. 9), 3 rows of 3 cells on s_axis with the border generated on chip,
+       // convolution mode, the results on m_axis (saturated to a byte)
+       // Frame 2 : the same kernel, inflation mode, a 6x4 map read from the source ROI and the inflated costs
+       // written to the destination ROI
+       errors = 0;
+       results = 0;
+       for (b = 0; b < MEM_BYTES; b = b + 1)
+           mem[b] = SENTINEL;
+       for (y = 0; y < ROI_HEIGHT; y = y + 1)
+           for (x = 0; x < ROI_WIDTH; x = x + 1)
+               mem[SRC_BASE + y * ROI_STRIDE + x] = 0;
+       mem[SRC_BASE + 1 * ROI_STRIDE + 1] = 254;   // lethal obstacles
+       mem[SRC_BASE + 2 * ROI_STRIDE + 4] = 254;
+       mem[SRC_BASE + 0 * ROI_STRIDE + 5] = 100;   // costs above the inflation around them
+       mem[SRC_BASE + 3 * ROI_STRIDE + 2] = 7;
+
        rstn = 0;
        s_axis_tdata = 0;
        s_axis_tvalid = 0;
+       s_axi_awaddr = 0;
+       s_axi_awvalid = 0;
+       s_axi_wdata = 0;
+       s_axi_wvalid = 0;
+       s_axi_bready = 0;
       
        
        repeat(5) @(posedge clk);
        rstn = 1;
        repeat(2) @(posedge clk);
+
+       // 3x3 kernel, 3 rows of 3 outputs, convolution mode, frame done interrupt
+       axil_write(12'h010, (KERNEL_SIZE - 1) / 2); // RADIUS
+       axil_write(12'h008, 3);                     // FRAME_WIDTH
+       axil_write(12'h00C, 3);                     // FRAME_HEIGHT
+       axil_write(12'h014, 32'h10);                // MODE : convolution, border generation
+       axil_write(12'h018, 1);                     // IRQ_ENABLE
+       axil_write(12'h000, 1);                     // CTRL.START
        m_axis_tready = 1;
        @(posedge clk);
        
@@ -110,9 +383,8 @@ module tb_top2;
        //repeat(2) @(posedge clk); // Gap between weights and data
        repeat(4) @(posedge clk);
        
-       // send data   
-       //s_axis_tdata  = 32'h0a_0d_10_0b; // 10,13,16,11 first transfer data
-       s_axis_tdata  = 32'h0a_0d_10_00;   // 10,13,16 first row data
+       // send data : one row per transfer
+       s_axis_tdata  = 32'h01_02_03_00;   // 1,2,3 first row data
        s_axis_tvalid = 1'b1;    
        @(posedge clk);   
        wait(s_axis_tready);
@@ -120,8 +392,7 @@ module tb_top2;
        s_axis_tvalid = 1'b0;
        @(posedge clk);
        
-       //s_axis_tdata  = 32'h0e_11_0c_0f; // 14,17,12,15 second transfer data
-       s_axis_tdata  = 32'h0b_0e_11_00; // 11,14,17 second row data
+       s_axis_tdata  = 32'h04_05_06_00; // 4,5,6 second row data
        s_axis_tvalid = 1'b1;    
        @(posedge clk);   
        wait(s_axis_tready);
@@ -129,8 +400,7 @@ module tb_top2;
        s_axis_tvalid = 1'b0;
        @(posedge clk);
        
-       //s_axis_tdata = 32'b00000000_00000000_00000000_00010010;   // 18 third data transfer
-       s_axis_tdata  = 32'h0c_0f_12_00;
+       s_axis_tdata  = 32'h07_08_09_00; // 7,8,9 third row data
        s_axis_tvalid = 1'b1;    
        @(posedge clk);   
        wait(s_axis_tready);
@@ -138,24 +408,64 @@ module tb_top2;
        s_axis_tvalid = 1'b0;
        @(posedge clk);
        
-     /* repeat(1000) begin
+       #1000;
+       if (results != 9) begin
+           $display("%0t ERROR: %0d results in frame 1, expected 9", $time, results);
+           errors = errors + 1;
+       end
+
+       // Frame 2 : ROI DMA in and out
+       axil_write(12'h01C, 1);                     // IRQ_STATUS : frame 1 done acknowledged
+       axil_write(12'h008, ROI_WIDTH);             // FRAME_WIDTH
+       axil_write(12'h00C, ROI_HEIGHT);            // FRAME_HEIGHT
+       axil_write(12'h014, 32'h11);                // MODE : inflation, border generation
+       axil_write(12'h0A8, SRC_BASE);              // SRC_ADDR
+       axil_write(12'h0AC, ROI_STRIDE);            // SRC_STRIDE
+       axil_write(12'h0B0, ROI_WIDTH);             // SRC_WIDTH : the input rows are the map rows (MODE bit4)
+       axil_write(12'h0B4, ROI_HEIGHT);            // SRC_HEIGHT
+       axil_write(12'h0B8, DST_BASE);              // DST_ADDR
+       axil_write(12'h0BC, ROI_STRIDE);            // DST_STRIDE
+       axil_write(12'h0A0, 3);                     // DMA_CTRL : READ_EN, WRITE_EN
+       axil_write(12'h000, 1);                     // CTRL.START
+       for (b = 0; b < 2000 && !irq; b = b + 1)
            @(posedge clk);
-           if (m_axis_tvalid && m_axis_tready) begin
-               $display("%0t | VALID OUTPUT: %0d", $time, m_axis_tdata);
+       if (!irq) begin
+           $display("%0t ERROR: no frame done interrupt for the ROI frame", $time);
+           errors = errors + 1;
+       end
+
+       // every destination cell inflated, the byte after every row untouched
+       for (y = 0; y < ROI_HEIGHT; y = y + 1)
+           for (x = 0; x <= ROI_WIDTH; x = x + 1) begin
+               expected = (x == ROI_WIDTH) ? SENTINEL : inflate_expected(x, y);
+               if (mem[DST_BASE + y * ROI_STRIDE + x] !== expected) begin
+                   $display("%0t ERROR: destination (%0d,%0d) = %0d, expected %0d", $time, x, y,
+                            mem[DST_BASE + y * ROI_STRIDE + x], expected);
+                   errors = errors + 1;
+               end
            end
-       end 
-       */
-       #1000;
-        
-        $finish;
+
+       if (errors == 0)
+           $display("\n*** ALL TESTS PASSED! ***\n");
+       $finish;
        
     end
     
    always @(posedge clk) begin
         if (m_axis_tvalid && m_axis_tready) begin
-            $display("Time=%0t | Output Handshake! Result=%d (decimal:%0d)", $time, m_axis_tdata, m_axis_tdata);
+            $display("Time=%0t | Output Handshake! Result=%d (decimal:%0d) sof=%b eol=%b last=%b", $time, m_axis_tdata, m_axis_tdata,
+                     m_axis_tuser[0], m_axis_tuser[1], m_axis_tlast);
+            if (m_axis_tdata !== conv_expected(results % 3, results / 3)) begin
+                $display("%0t ERROR: result %0d, expected %0d", $time, m_axis_tdata, conv_expected(results % 3, results / 3));
+                errors = errors + 1;
+            end
+            results = results + 1;
         end
     end 
+
+   always @(posedge irq) begin
+        $display("Time=%0t | Frame done interrupt", $time);
+   end
     
     
     
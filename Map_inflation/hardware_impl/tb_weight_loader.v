@@ -8,6 +8,7 @@ module tb_weight_loader;
     localparam WEIGHT_WIDTH = 8;
     localparam BUS_WIDTH    = 32;
     localparam NUM_ITERS    = 5;
+    localparam MAX_KERNEL   = 4;   // synthesized array size
     localparam MAX_BITS     = 128; // 4*4*8
     localparam PERIOD = 4;
 
@@ -21,23 +22,37 @@ module tb_weight_loader;
     reg                  s_axis_tvalid;
     wire                 s_axis_tready;
     wire                 loading;
+    reg  [BUS_WIDTH-1:0] s_axis_wgt_tdata;
+    reg                  s_axis_wgt_tvalid;
+    wire                 s_axis_wgt_tready;
+    reg                  frame_boundary;
+    wire                 shadow_pending;
+    wire [2:0]           kernel_size_out;
     wire [MAX_BITS-1:0]  weights_out;
+    reg  [2:0]           cfg_kernel_size;
 
-    // DUT (Fixed kernel = 4)
+    // DUT (4x4 array, runtime kernel from 1 to 4)
     weight_loader #(
-        .KERNEL_SIZE(4),
+        .KERNEL_SIZE(MAX_KERNEL),
         .WEIGHT_WIDTH(WEIGHT_WIDTH),
         .BUS_WIDTH(BUS_WIDTH)
     ) dut (
         .clk(clk),
         .rstn(rstn),
+        .cfg_kernel_size(cfg_kernel_size),
 	//inputs
         .s_axis_tdata(s_axis_tdata),
         .s_axis_tvalid(s_axis_tvalid),
         .s_axis_tready(s_axis_tready),
+        .s_axis_wgt_tdata(s_axis_wgt_tdata),
+        .s_axis_wgt_tvalid(s_axis_wgt_tvalid),
+        .s_axis_wgt_tready(s_axis_wgt_tready),
+        .frame_boundary(frame_boundary),
 	//outputs
         .weights_out(weights_out),
-        .loading(loading)
+        .kernel_size_out(kernel_size_out),
+        .loading(loading),
+        .shadow_pending(shadow_pending)
     );
 
     // AXI send task
@@ -54,23 +69,34 @@ module tb_weight_loader;
         end
     endtask
 
+    // AXI send task on the side channel
+    task send_shadow;
+        input [BUS_WIDTH-1:0] data;
+        begin
+            @(posedge clk);
+            s_axis_wgt_tdata  <= data;
+            s_axis_wgt_tvalid <= 1'b1;
+	    wait(s_axis_wgt_tready);
+            @(posedge clk);
+            s_axis_wgt_tvalid <= 1'b0;
+            s_axis_wgt_tdata  <= {BUS_WIDTH{1'bx}};
+        end
+    endtask
+
     // Test task
     task run_test;
         input integer KERNEL_SIZE;
 
-        integer iter, beat, bit_i;
-        integer REQUIRED_BITS;
+        integer iter, beat, lane, r, c;
         integer USED_TRANSFERS;
-        integer TOTAL_TRANSFERS;
-        integer dst_bit;
+        integer byte_idx;
+        reg [WEIGHT_WIDTH-1:0] stream_bytes [0:MAX_KERNEL*MAX_KERNEL-1];
         reg [MAX_BITS-1:0] expected;
         reg [BUS_WIDTH-1:0] payload;
         reg error;
 
         begin
-            REQUIRED_BITS   = KERNEL_SIZE*KERNEL_SIZE*WEIGHT_WIDTH;
-            USED_TRANSFERS  = (REQUIRED_BITS + BUS_WIDTH - 1)/BUS_WIDTH;
-            TOTAL_TRANSFERS = MAX_BITS / BUS_WIDTH; // always 4 because of the MAX_BITS value
+            USED_TRANSFERS  = (KERNEL_SIZE*KERNEL_SIZE*WEIGHT_WIDTH + BUS_WIDTH - 1)/BUS_WIDTH;
 
             $display("Testing KERNEL_SIZE = %0d", KERNEL_SIZE);
 
@@ -78,6 +104,7 @@ module tb_weight_loader;
                 expected = 0;
 
                 s_axis_tvalid = 0;
+                cfg_kernel_size = KERNEL_SIZE;
                 rstn = 0;
                 repeat (5) @(posedge clk);
                 rstn = 1;
@@ -86,31 +113,27 @@ module tb_weight_loader;
                 // Wait for loader
                 wait (loading);
 
-                // Send transfers
-                for (beat = 0; beat < TOTAL_TRANSFERS; beat = beat + 1) begin
-                    if (beat < USED_TRANSFERS)
-                        payload = $random;
-                    else
-                        payload = 0;
-
-                    // Ordered reference model (MSB-first)
-                    for (bit_i = 0; bit_i < BUS_WIDTH; bit_i = bit_i + 1) begin
-                   dst_bit = MAX_BITS - 1 - beat*BUS_WIDTH - bit_i;
-                        if (dst_bit >= 0)
-                            expected[dst_bit] = payload[BUS_WIDTH-1-bit_i];
+                // Send only the transfers needed by the runtime kernel
+                for (beat = 0; beat < USED_TRANSFERS; beat = beat + 1) begin
+                    payload = $random;
+                    for (lane = 0; lane < BUS_WIDTH/WEIGHT_WIDTH; lane = lane + 1) begin
+                        byte_idx = beat*(BUS_WIDTH/WEIGHT_WIDTH) + lane;
+                        if (byte_idx < KERNEL_SIZE*KERNEL_SIZE)
+                            stream_bytes[byte_idx] = payload[BUS_WIDTH-1-lane*WEIGHT_WIDTH -: WEIGHT_WIDTH]; // MSB first
                     end
                     send_data(payload);
                 end
 
+                // Reference model : kernel (r,c) lands on PE (r,c) of the MAX_KERNEL array, the rest stays 0
+                for (r = 0; r < KERNEL_SIZE; r = r + 1)
+                    for (c = 0; c < KERNEL_SIZE; c = c + 1)
+                        expected[(r*MAX_KERNEL + c)*WEIGHT_WIDTH +: WEIGHT_WIDTH] = stream_bytes[r*KERNEL_SIZE + c];
+
                 // Wait for completion
                 wait (!loading);
                 repeat (2) @(posedge clk);
 
-                error = 0;
-                for (bit_i = 0; bit_i < REQUIRED_BITS; bit_i = bit_i + 1) begin
-                    if (weights_out[bit_i] !== expected[bit_i])
-                        error = 1;
-                end
+                error = (weights_out !== expected);
 
                 if (error) begin
                     $display("FAIL | K=%0d | iter=%0d", KERNEL_SIZE, iter);
@@ -126,13 +149,56 @@ module tb_weight_loader;
         end
     endtask
 
+    // Shadow bank test : reload a 2x2 kernel while a 4x4 kernel is active,
+    // the active weights must only change on the frame boundary
+    task run_shadow_test;
+        reg [MAX_BITS-1:0] before;
+        reg [MAX_BITS-1:0] expected;
+        begin
+            $display("Testing shadow bank reload");
+            before = weights_out;
+
+            cfg_kernel_size = 2;
+            send_shadow(32'h11_22_33_44);
+            wait (shadow_pending);
+            repeat (4) @(posedge clk);
+
+            if (weights_out !== before || kernel_size_out !== 3'd4)
+                $display("FAIL | shadow | active bank changed before the frame boundary");
+            else
+                $display("PASS | shadow | active bank kept until the frame boundary");
+
+            @(posedge clk);
+            frame_boundary <= 1'b1;
+            @(posedge clk);
+            frame_boundary <= 1'b0;
+            repeat (2) @(posedge clk);
+
+            expected = 0;
+            expected[(0*MAX_KERNEL + 0)*WEIGHT_WIDTH +: WEIGHT_WIDTH] = 8'h11;
+            expected[(0*MAX_KERNEL + 1)*WEIGHT_WIDTH +: WEIGHT_WIDTH] = 8'h22;
+            expected[(1*MAX_KERNEL + 0)*WEIGHT_WIDTH +: WEIGHT_WIDTH] = 8'h33;
+            expected[(1*MAX_KERNEL + 1)*WEIGHT_WIDTH +: WEIGHT_WIDTH] = 8'h44;
+
+            if (weights_out !== expected || kernel_size_out !== 3'd2 || shadow_pending)
+                $display("FAIL | shadow | Expected = %h Got = %h", expected, weights_out);
+            else
+                $display("PASS | shadow | swapped on the frame boundary");
+        end
+    endtask
+
     // Test Sequence
     initial begin
+        s_axis_wgt_tvalid = 0;
+        s_axis_wgt_tdata  = 0;
+        frame_boundary    = 0;
+
 
+        run_test(1);
         run_test(2);
         run_test(3);
-        run_test(4);
-	run_test(5);
+	run_test(4);
+        run_shadow_test;
 
         #200;
         $finish;
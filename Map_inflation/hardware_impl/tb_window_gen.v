@@ -0,0 +1,212 @@
+`timescale 1ns/1ps
+
+module tb_window_gen;
+
+    // Parameters
+    localparam KERNEL_SIZE = 5;
+    localparam DATA_WIDTH  = 8;
+    localparam MAX_WIDTH   = 16;
+    localparam PERIOD      = 4;
+
+    reg clk = 0;
+    reg rstn;
+
+    always #(PERIOD/2) clk = ~clk;
+
+    // DUT signals
+    reg                         start;
+    wire                        busy;
+    reg  [2:0]                  cfg_kernel_size;
+    reg  [15:0]                 cfg_in_width;
+    reg  [15:0]                 cfg_in_height;
+    reg                         cfg_border_left;
+    reg                         cfg_border_right;
+    reg                         cfg_border_top;
+    reg                         cfg_border_bottom;
+    reg                         cfg_replicate;
+    reg  [DATA_WIDTH-1:0]       s_axis_tdata;
+    reg                         s_axis_tvalid;
+    wire                        s_axis_tready;
+    wire [KERNEL_SIZE*KERNEL_SIZE*DATA_WIDTH-1:0] m_axis_tdata;
+    wire                        m_axis_tlast;
+    wire                        m_axis_tvalid;
+    reg                         m_axis_tready;
+
+    integer errors;
+    integer windows;    // windows checked in the run
+    integer out_w, out_h, pad;
+    integer i, x, y;
+    integer run;
+
+    window_gen #(
+        .KERNEL_SIZE(KERNEL_SIZE),
+        .DATA_WIDTH(DATA_WIDTH),
+        .MAX_WIDTH(MAX_WIDTH)
+    ) dut (
+        .clk(clk),
+        .rstn(rstn),
+        .start(start),
+        .abort(1'b0),
+        .busy(busy),
+        .cfg_kernel_size(cfg_kernel_size),
+        .cfg_in_width(cfg_in_width),
+        .cfg_in_height(cfg_in_height),
+        .cfg_border_left(cfg_border_left),
+        .cfg_border_right(cfg_border_right),
+        .cfg_border_top(cfg_border_top),
+        .cfg_border_bottom(cfg_border_bottom),
+        .cfg_replicate(cfg_replicate),
+        .s_axis_tdata(s_axis_tdata),
+        .s_axis_tvalid(s_axis_tvalid),
+        .s_axis_tready(s_axis_tready),
+        .m_axis_tdata(m_axis_tdata),
+        .m_axis_tlast(m_axis_tlast),
+        .m_axis_tvalid(m_axis_tvalid),
+        .m_axis_tready(m_axis_tready),
+        .step(),
+        .step_idle()
+    );
+
+    // input cell (x, y), never 0 so a misplaced border shows
+    function [DATA_WIDTH-1:0] in_cell;
+        input integer x;
+        input integer y;
+        begin
+            in_cell = y * 16 + x + 1;
+        end
+    endfunction
+
+    // cell (x, y) of the input, with the border of the run outside it
+    function [DATA_WIDTH-1:0] border_cell;
+        input integer x;
+        input integer y;
+        integer cx, cy;
+        begin
+            cx = (x < 0) ? 0 : (x >= cfg_in_width) ? cfg_in_width - 1 : x;
+            cy = (y < 0) ? 0 : (y >= cfg_in_height) ? cfg_in_height - 1 : y;
+            border_cell = (cx == x && cy == y) || cfg_replicate ? in_cell(cx, cy) : 0;
+        end
+    endfunction
+
+    // window of result (ox, oy) : centred on the input cell (ox, oy) with a border on the left / top,
+    // (ox + pad, oy + pad) in an input that holds them already, zeros past the runtime kernel
+    function [KERNEL_SIZE*KERNEL_SIZE*DATA_WIDTH-1:0] window;
+        input integer ox;
+        input integer oy;
+        integer r, c, cx, cy;
+        begin
+            window = 0;
+            cx = cfg_border_left ? ox : ox + pad;
+            cy = cfg_border_top ? oy : oy + pad;
+            for (r = 0; r < cfg_kernel_size; r = r + 1)
+                for (c = 0; c < cfg_kernel_size; c = c + 1)
+                    window[(r * KERNEL_SIZE + c) * DATA_WIDTH +: DATA_WIDTH] = border_cell(cx + c - pad, cy + r - pad);
+        end
+    endfunction
+
+    // every window in raster order, tlast on the last one
+    always @(posedge clk) begin
+        if (rstn && m_axis_tvalid && m_axis_tready) begin
+            x = windows % out_w;
+            y = windows / out_w;
+            if (m_axis_tdata !== window(x, y) || m_axis_tlast !== (windows == out_w * out_h - 1)) begin
+                $display("%0t ERROR: run %0d, window (%0d, %0d) = %h last %b, expected %h",
+                         $time, run, x, y, m_axis_tdata, m_axis_tlast, window(x, y));
+                errors = errors + 1;
+            end
+            windows = windows + 1;
+        end
+        m_axis_tready <= ($random % 4) != 0;
+    end
+
+    task run_frame;
+        input integer ksize;
+        input integer width;
+        input integer height;
+        input integer left;
+        input integer right;
+        input integer top;
+        input integer bottom;
+        input integer replicate;
+        begin
+            cfg_kernel_size   <= ksize;
+            cfg_in_width      <= width;
+            cfg_in_height     <= height;
+            cfg_border_left   <= left;
+            cfg_border_right  <= right;
+            cfg_border_top    <= top;
+            cfg_border_bottom <= bottom;
+            cfg_replicate     <= replicate;
+            pad   = (ksize - 1) / 2;
+            out_w = width  + (left + right - 2) * pad;
+            out_h = height + (top + bottom - 2) * pad;
+            windows = 0;
+            @(posedge clk);
+            start <= 1'b1;
+            @(posedge clk);
+            start <= 1'b0;
+
+            for (i = 0; i < width * height; i = i + 1) begin
+                s_axis_tdata  <= in_cell(i % width, i / width);
+                s_axis_tvalid <= ($random % 3) != 0;
+                @(posedge clk);
+                while (!(s_axis_tvalid && s_axis_tready)) begin
+                    s_axis_tvalid <= 1'b1;
+                    @(posedge clk);
+                end
+                s_axis_tvalid <= 1'b0;
+            end
+            while (busy) @(posedge clk);
+            repeat (20) @(posedge clk);
+
+            if (windows != out_w * out_h) begin
+                $display("%0t ERROR: run %0d, %0d windows, expected %0d", $time, run, windows, out_w * out_h);
+                errors = errors + 1;
+            end
+            else
+                $display("%0t PASS: run %0d, %0d windows of %0dx%0d", $time, run, windows, ksize, ksize);
+            run = run + 1;
+        end
+    endtask
+
+    initial begin
+        errors = 0;
+        windows = 0;
+        out_w = 1;
+        out_h = 1;
+        pad = 0;
+        run = 0;
+        rstn = 0;
+        start = 0;
+        cfg_kernel_size = 3;
+        cfg_in_width = 0;
+        cfg_in_height = 0;
+        cfg_border_left = 0;
+        cfg_border_right = 0;
+        cfg_border_top = 0;
+        cfg_border_bottom = 0;
+        cfg_replicate = 0;
+        s_axis_tdata = 0;
+        s_axis_tvalid = 0;
+        m_axis_tready = 0;
+
+        repeat (5) @(posedge clk);
+        rstn <= 1;
+        @(posedge clk);
+
+        //        k  width height  L  R  T  B  replicate
+        run_frame(3, 6,    4,      1, 1, 1, 1, 0);   // zero border on every side
+        run_frame(5, 7,    5,      1, 1, 1, 1, 1);   // replicate border, full array
+        run_frame(3, 8,    6,      0, 0, 0, 0, 0);   // pre-padded map
+        run_frame(5, 9,    5,      1, 0, 1, 1, 0);   // left stripe : halo columns on the right
+        run_frame(5, 9,    6,      0, 1, 1, 1, 1);   // right stripe : halo columns on the left
+        run_frame(1, 4,    3,      1, 1, 1, 1, 0);   // 1x1 kernel
+
+        if (errors == 0)
+            $display("\n*** ALL TESTS PASSED! ***\n");
+
+        #100;
+        $finish;
+    end
+
+endmodule
@@ -1,81 +1,522 @@
 `timescale 1ns/1ps
 
 module top #(
-    parameter KERNEL_SIZE  = 3, // 16x16 Matrix
+    parameter KERNEL_SIZE  = 13, // size of the synthesized PE array (13x13 : radius 6 at 5 cm), smaller kernels are selected at runtime
     parameter DATA_WIDTH   = 8,
     parameter WEIGHT_WIDTH = 8,
     parameter DEPTH        = 4, // FIFO depth
     parameter PTR_WIDTH    = 2,   // clog2(4)
-    parameter BUS_WIDTH = 32  //the data bus width
+    parameter BUS_WIDTH = 32,  //the data bus width
+    parameter AXIL_ADDR_WIDTH = 12,  // 4 KB register window
+    parameter AXI_ADDR_WIDTH  = 32,  // address width of the AXI4 master
+    parameter MAX_BURST_LEN   = 16,  // beats per AXI4 burst
+    parameter NUM_ENGINES     = 1,   // window engines working on column stripes of the frame (see stripe_dispatcher.sv)
+    parameter ENGINE_IN_DEPTH = 512, // input buffer of an engine, in words : one row of its stripe at least
+    parameter ENGINE_OUT_DEPTH = 512, // output buffer of an engine, in words of BUS_WIDTH/8 costs
+    parameter DUAL_CLOCK      = 0,   // 1 : the window engine(s) run on core_clk, async FIFOs to the clk (interface) domain
+    parameter USE_DSP_ROWS    = 0,   // 1 : PE array rows on DSP48 cascades (see dsp_row.v)
+    parameter DSP_PACK        = 0,   // with USE_DSP_ROWS : two columns per DSP, left/right symmetric kernels only
+    parameter TAG_WIDTH       = 4,   // frame tag carried from s_axis_tuser to m_axis_tuser
+    parameter MAX_WIDTH       = 2048 // longest input row (line buffers of window_gen.sv)
 )(
-    input  clk,
+    input  clk,      // interface clock : AXI ports, registers, DMA, input unpacking and output encoding
     input  rstn,
+    input  core_clk, // compute core clock (unused when DUAL_CLOCK = 0)
+
+    // AXI4-Lite Slave Interface (control/status registers, see axim_reg.sv for the map)
+    input   [AXIL_ADDR_WIDTH - 1 : 0]         s_axi_awaddr,
+    input                                     s_axi_awvalid,
+    output                                    s_axi_awready,
+    input   [31 : 0]                          s_axi_wdata,
+    input   [3 : 0]                           s_axi_wstrb,
+    input                                     s_axi_wvalid,
+    output                                    s_axi_wready,
+    output  [1 : 0]                           s_axi_bresp,
+    output                                    s_axi_bvalid,
+    input                                     s_axi_bready,
+    input   [AXIL_ADDR_WIDTH - 1 : 0]         s_axi_araddr,
+    input                                     s_axi_arvalid,
+    output                                    s_axi_arready,
+    output  [31 : 0]                          s_axi_rdata,
+    output  [1 : 0]                           s_axi_rresp,
+    output                                    s_axi_rvalid,
+    input                                     s_axi_rready,
+    output                                    irq,
+
+    // AXI4 Master Interface (ROI read from / write to the costmap in memory, enabled by DMA_CTRL)
+    output  [AXI_ADDR_WIDTH - 1 : 0]          m_axi_araddr,
+    output  [7 : 0]                           m_axi_arlen,
+    output  [2 : 0]                           m_axi_arsize,
+    output  [1 : 0]                           m_axi_arburst,
+    output                                    m_axi_arvalid,
+    input                                     m_axi_arready,
+    input   [BUS_WIDTH - 1 : 0]               m_axi_rdata,
+    input   [1 : 0]                           m_axi_rresp,
+    input                                     m_axi_rlast,
+    input                                     m_axi_rvalid,
+    output                                    m_axi_rready,
+    output  [AXI_ADDR_WIDTH - 1 : 0]          m_axi_awaddr,
+    output  [7 : 0]                           m_axi_awlen,
+    output  [2 : 0]                           m_axi_awsize,
+    output  [1 : 0]                           m_axi_awburst,
+    output                                    m_axi_awvalid,
+    input                                     m_axi_awready,
+    output  [BUS_WIDTH - 1 : 0]               m_axi_wdata,
+    output  [BUS_WIDTH / 8 - 1 : 0]           m_axi_wstrb,
+    output                                    m_axi_wlast,
+    output                                    m_axi_wvalid,
+    input                                     m_axi_wready,
+    input   [1 : 0]                           m_axi_bresp,
+    input                                     m_axi_bvalid,
+    output                                    m_axi_bready,
+
+    // AXI Stream Slave Interface (weight side channel : next kernel, swapped in at a frame boundary)
+    input   [BUS_WIDTH - 1 : 0]               s_axis_wgt_tdata,
+    input                                     s_axis_wgt_tvalid,
+    output                                    s_axis_wgt_tready,
 
     // AXI Stream Slave Interface
+    // With frame streaming (MODE bit3) a frame goes from the transfer with s_axis_tuser[0] (start of frame,
+    // s_axis_tuser[TAG_WIDTH:1] its tag) to the one with s_axis_tlast, otherwise both are ignored
+    // s_axis carries the input rows, every row starts on a new transfer, first cell in the MSBs : with border
+    // generation (MODE bit4) the map rows, otherwise the map padded by RADIUS cells on every side (see engine_core.v)
     input   [BUS_WIDTH - 1 : 0]               s_axis_tdata,
+    input   [TAG_WIDTH : 0]                   s_axis_tuser,
+    input                                     s_axis_tlast,
     input                                     s_axis_tvalid,
     output                                    s_axis_tready,
-    // AXI Stream Master Interface
+    // AXI Stream Master Interface (one cost per transfer, or run-length tokens, see rle_encoder.sv)
+    // With NUM_ENGINES > 1 and plain output, every transfer holds BUS_WIDTH/8 one byte costs, first cell
+    // in the low byte (the last transfer of a frame is zero padded)
+    // m_axis_tlast : last transfer of a frame, m_axis_tuser : bit0 start of frame, bit1 end of a line
+    // (FRAME_WIDTH cells, one result per transfer only), bits TAG_WIDTH+1:2 tag of the frame
     input                                     m_axis_tready,
-    output [(DATA_WIDTH+WEIGHT_WIDTH+ $clog2(KERNEL_SIZE)) -1 :0]  m_axis_tdata,
-   // output  [BUS_WIDTH - 1 : 0]               m_axis_tdata,
+   // output [(DATA_WIDTH+WEIGHT_WIDTH+ $clog2(KERNEL_SIZE)) -1 :0]  m_axis_tdata,
+    output  [BUS_WIDTH - 1 : 0]               m_axis_tdata,
+    output  [TAG_WIDTH + 1 : 0]               m_axis_tuser,
+    output                                    m_axis_tlast,
     output                                    m_axis_tvalid
 );
     //localparam DATAOUT_WIDTH = (DATA_WIDTH+WEIGHT_WIDTH+KERNEL_SIZE) * KERNEL_SIZE;  // size of the dataOut produces by the pe_wrapper.
-    localparam DATAIN_WIDTH = DATA_WIDTH * KERNEL_SIZE ;  // size of the dataIn of the pe_wrapper
     localparam WEIGHTIN_WIDTH = WEIGHT_WIDTH * KERNEL_SIZE * KERNEL_SIZE;   // size of the input weights 
-    localparam TOTAL_BYTES = KERNEL_SIZE * KERNEL_SIZE;  // each weight is on 8 bits(1byte). So the total byte of a weight bus is equal to the kernel  dimension : KERNEL_SIZE * KERNEL_SIZE
-    localparam ADDER_LATENCY    = 3; // Adder latency: 3 cycles
-    localparam CROSSBAR_LATENCY = 2; // crossbar latency Input reg + Output reg
-    localparam TOTAL_DONE_DELAY = (2 * KERNEL_SIZE) + ADDER_LATENCY + CROSSBAR_LATENCY; // KERNEL_SIZE : latency of The last pixel needs to reach the very last PE
-                                                                                       // KERNEL_SIZE : the last row might have to wait for the other rows to be "read" before its final pixel can exit
+    localparam KSIZE_WIDTH = $clog2(KERNEL_SIZE + 1);  // width of the runtime kernel size
+    localparam RESULT_WIDTH = DATA_WIDTH + WEIGHT_WIDTH + $clog2(KERNEL_SIZE * KERNEL_SIZE);  // width of one engine result
+    localparam COUNT_WIDTH = $clog2(BUS_WIDTH / 8 + 1);  // cells in a packed word
+
+    // Register file outputs
+    wire        ctrl_start;
+    wire        ctrl_stop;
+    wire [15:0] cfg_frame_width;
+    wire [15:0] cfg_frame_height;
+    wire [KSIZE_WIDTH - 1 : 0] cfg_radius; // the active kernel is (2*cfg_radius + 1) x (2*cfg_radius + 1), clamped to KERNEL_SIZE.
+                                           // It is sampled when a kernel is loaded and switches together with its weights.
+    wire        cfg_mode;
+    wire        cfg_packed_input; // 1 : one bit per cell on the data input (change it between frames only)
+    wire        cfg_rle_output;   // 1 : run-length tokens on m_axis (change it between frames only)
+    wire        cfg_stream_frames; // 1 : back-to-back frames delimited by s_axis_tuser / s_axis_tlast
+    wire        cfg_border;       // 1 : the map comes unpadded, the border is generated on chip (window_gen.sv)
+    wire        cfg_border_replicate; // border policy : 0 zeros, 1 copies of the edge cells
+    wire        perf_snapshot;
+    wire        perf_clear;
+    wire        kgen_start;           // compute the kernel on chip (see kernel_gen.sv)
+    wire [31:0] cfg_kgen_scale;       // Q16.16 kernel parameters
+    wire [31:0] cfg_kgen_inscribed;
+    wire [31:0] cfg_kgen_resolution;
+    wire        dma_rd_en;
+    wire        dma_wr_en;
+    wire [31:0] cfg_src_addr;
+    wire [31:0] cfg_src_stride;
+    wire [15:0] cfg_src_width;
+    wire [15:0] cfg_src_height;
+    wire [31:0] cfg_dst_addr;
+    wire [31:0] cfg_dst_stride;
+
+    // Performance counters (snapshot values)
+    wire [31:0] perf_cycles;
+    wire [31:0] perf_active;
+    wire [31:0] perf_out_stall;
+    wire [31:0] perf_in_starved;
+    wire [31:0] perf_weight_load;
+    wire [31:0] perf_xbar_idle;
+    wire [PTR_WIDTH : 0] fifo_level;      // input FIFO of the (first) window engine
+    wire [PTR_WIDTH : 0] perf_fifo_hwm;
+    wire step_idle;                       // window position without a result
+
+    // ROI DMA : the source ROI replaces s_axis, the results go to the destination ROI instead of m_axis
+    wire        dma_rd_busy;
+    wire        dma_rd_error;
+    wire        dma_wr_busy;
+    wire        dma_wr_done;
+    wire        dma_wr_error;
+    wire [BUS_WIDTH - 1 : 0] roi_tdata;
+    wire [$clog2(BUS_WIDTH / 8 + 1) - 1 : 0] roi_tbytes;
+    wire        roi_tlast;
+    wire        roi_tvalid;
+    wire        roi_tready;
+    wire        writer_ready;
 
     // Weight loader signals
     wire weight_loader_ready;
     wire is_loading_weights;
     wire weights_loaded;
+    wire shadow_weights_pending;
     wire [WEIGHTIN_WIDTH - 1 : 0] flat_weights;
+
+    // Kernel generator : while it runs, its weights take the place of the ones from s_axis (first
+    // kernel after reset) or from the side channel (shadow bank)
+    wire                     kgen_busy;
+    wire [BUS_WIDTH - 1 : 0] kgen_tdata;
+    wire                     kgen_tvalid;
+    wire                     loader_wgt_ready;
+    wire                     kgen_tready = is_loading_weights ? weight_loader_ready : loader_wgt_ready;
+    reg                      kernel_busy_d;   // a kernel load (generated or from s_axis) in progress, last cycle
+    wire                     kernel_ready = kernel_busy_d && !kgen_busy && !is_loading_weights;
+
+    // Engine input (s_axis or the source ROI) and output (m_axis or the destination ROI)
+    // The source ROI rows are the input rows : they start on a new beat each, like the rows on s_axis
+    wire                        in_open;   // s_axis is inside a frame (always, without frame streaming)
+    wire [BUS_WIDTH - 1 : 0]    in_tdata  = dma_rd_en ? roi_tdata  : s_axis_tdata;
+    wire                        in_tvalid = dma_rd_en ? roi_tvalid : (s_axis_tvalid && in_open);
+    wire [RESULT_WIDTH - 1 : 0] cell_tdata;    // one cell per transfer out of the core
+    wire                        cell_tvalid;
+    wire                        cell_tready;
+    wire [RESULT_WIDTH - 1 : 0] out_tdata;
+    wire                        out_tvalid;
+    wire                        encoder_ready;
+    wire [BUS_WIDTH - 1 : 0]    encoder_tdata;
+    wire                        encoder_tlast;
+    wire                        encoder_tvalid;
+    wire                        out_tready = dma_wr_en ? writer_ready : encoder_ready;
+
+    // Multi-engine output : packed costs in raster order, straight to m_axis for the plain output,
+    // one cell at a time (out_tdata) for the run-length encoder and the destination ROI
+    wire                        wide_out = (NUM_ENGINES > 1) && !cfg_rle_output && !dma_wr_en;
+    wire [BUS_WIDTH - 1 : 0]    merged_tdata;
+    wire [$clog2(BUS_WIDTH / 8 + 1) - 1 : 0] merged_tbytes;
+    wire                        merged_tlast;
+    wire                        merged_tvalid;
+    wire                        merged_tready;
+
+    // Frame control : a frame is running from START until FRAME_WIDTH * FRAME_HEIGHT cells left the engine (or STOP),
+    // with the destination ROI it ends when the last write is acknowledged
+    reg         running;
+    reg  [31:0] out_count;
+    wire [31:0] frame_cells = cfg_frame_width * cfg_frame_height;
+    wire        out_fire    = out_tvalid && out_tready;
+    wire        frame_done  = running && (dma_wr_en ? dma_wr_done :
+                                          wide_out  ? (merged_tvalid && m_axis_tready && merged_tlast) :
+                                                      (out_fire && (out_count == frame_cells - 1)));
+
+    // Frame streaming : after START, frame after frame is taken from s_axis until STOP. A start of frame
+    // waits one cycle (frame_start, the per-frame resets) and is held while a new kernel waits for the
+    // frames in flight to leave, or while TAG_DEPTH frames are in flight. The occupancy unpacker must have
+    // handed over the last row of the previous frame (it restarts on every start of frame), and with
+    // NUM_ENGINES > 1 the stripe dispatcher and merger work on one frame at a time, so there the previous
+    // frame must have left first. Transfers
+    // between the last transfer of a frame and the next start of frame are dropped. The frame tags follow
+    // the frames in order in a small FIFO, from the input to the last transfer of the output.
+    localparam TAG_DEPTH = 4;
+
+    reg                      in_frame;
+    reg  [TAG_WIDTH - 1 : 0] frame_count;   // tag of the frames started by START
+    reg  [15:0]              out_col;
+    reg                      out_sof;
+    wire                     tag_ready;
+    wire [TAG_WIDTH - 1 : 0] stream_tag;
+    wire                     stream_in   = cfg_stream_frames && running && !is_loading_weights && !dma_rd_en;
+    wire                     tag_valid;
+    wire                     m_axis_fire = m_axis_tvalid && m_axis_tready;
+    wire                     occupancy_idle;
+    wire                     sof_clear   = (!cfg_packed_input || occupancy_idle) && (NUM_ENGINES == 1 || !tag_valid);
+    wire                     tag_pop     = dma_wr_en ? frame_done : (m_axis_fire && m_axis_tlast);
+    // Frame boundary of the whole pipeline : a frame starts while no other one is in flight (the last
+    // result of the previous frame has left, and the tag of a streamed frame pops with it). The shadow
+    // bank is swapped in on that start, so every window of a frame meets the same weights and kernel
+    // size. START restarts everything, it is always one.
+    wire                     frame_gap   = !running || (cfg_stream_frames && !in_frame && !tag_valid);
+    wire                     sof_start   = stream_in && !in_frame && s_axis_tvalid && s_axis_tuser[0] &&
+                                           (!shadow_weights_pending || frame_gap) && tag_ready && sof_clear;
+    wire                     in_drop     = stream_in && !in_frame && !s_axis_tuser[0];
+    wire                     frame_start = ctrl_start || sof_start;
+    wire                     pipe_start  = ctrl_start || (sof_start && frame_gap);
+    wire [TAG_WIDTH - 1 : 0] out_tag     = cfg_stream_frames ? stream_tag : frame_count;
+
+    assign in_open = !cfg_stream_frames || in_frame;
+
+    always @(posedge clk) begin
+        if (!rstn || ctrl_start || ctrl_stop)
+            in_frame <= 1'b0;
+        else if (sof_start)
+            in_frame <= 1'b1;
+        else if (s_axis_tvalid && s_axis_tready && s_axis_tlast && in_frame)
+            in_frame <= 1'b0;
+    end
+
+    always @(posedge clk) begin
+        if (!rstn) begin
+            frame_count <= 0;
+            out_col     <= 0;
+            out_sof     <= 1'b1;
+        end
+        else begin
+            if (tag_pop && !cfg_stream_frames)
+                frame_count <= frame_count + 1;
+
+            if (ctrl_start || frame_done || (out_fire && out_col == cfg_frame_width - 1))
+                out_col <= 0;
+            else if (out_fire)
+                out_col <= out_col + 1;
+
+            if (ctrl_start)
+                out_sof <= 1'b1;
+            else if (m_axis_fire)
+                out_sof <= m_axis_tlast;
+        end
+    end
+
+    fifo_fwft #(
+        .DATAWIDTH(TAG_WIDTH),
+        .DEPTH(TAG_DEPTH),
+        .PTR_WIDTH($clog2(TAG_DEPTH)),
+        .MEMORY_TYPE("srl")
+    ) tag_fifo_inst (
+        .clk(clk),
+        .rstn(rstn && !ctrl_start && !ctrl_stop),
+        .s_tvalid(sof_start),
+        .s_tdata(s_axis_tuser[TAG_WIDTH : 1]),
+        .s_tready(tag_ready),
+        .m_tready(tag_pop),
+        .m_tdata(stream_tag),
+        .m_tvalid(tag_valid),
+        .prog_full_thresh(TAG_DEPTH),
+        .prog_empty_thresh({($clog2(TAG_DEPTH) + 1){1'b0}}),
+        .almost_full(),
+        .almost_empty(),
+        .level()
+    );
+
+    // Runtime kernel size : requested one (registered so the radius decode stays off the datapath)
+    // and the one of the weights currently in the PEs
+    reg  [KSIZE_WIDTH - 1 : 0] requested_kernel_size;
+    wire [KSIZE_WIDTH - 1 : 0] active_kernel_size;
     
-     // Data accumulator signals (32-bit to full row)
-    wire accumulator_ready;
-    wire [(KERNEL_SIZE * DATA_WIDTH) - 1 : 0] accumulated_row;
-    wire accumulated_valid;
+    // Cells per input row : the map row, or with a pre-padded map the row and its padding
+    wire [15:0] in_width = cfg_border ? cfg_frame_width : cfg_frame_width + (active_kernel_size - 1);
+
+    // Occupancy unpacker signals (one bit per cell to input rows of one byte per cell)
+    wire occupancy_ready;
+    wire [BUS_WIDTH - 1 : 0] occupancy_tdata;
+    wire occupancy_valid;
+
+    // Input rows of the engine(s), straight from the input or from the occupancy unpacker
+    wire engine_in_ready;
+    wire in_ready = cfg_packed_input ? occupancy_ready : engine_in_ready;
+    wire [BUS_WIDTH - 1 : 0] engine_in_tdata = cfg_packed_input ? occupancy_tdata : in_tdata;
+    wire engine_in_valid = cfg_packed_input ? occupancy_valid : (in_tvalid && running && !is_loading_weights);
     
-    // pe_wrapper signals
-    wire unpacker_ready;
-    wire [(KERNEL_SIZE * DATA_WIDTH) - 1 : 0] fifo_m_tdata;
-    wire [KERNEL_SIZE - 1 : 0] fifo_m_tvalid;
-    wire [KERNEL_SIZE - 1 : 0] fifo_m_tready;
-    wire ready_pe_wrapper;
+    // Window engine(s) signals (results in the clk domain)
+    wire engines_active;  // window position stepped (performance counter event)
+    wire ctrl_abort = ctrl_start || ctrl_stop;   // drops the frames in the core
+    wire [BUS_WIDTH - 1 : 0]   core_tdata;
+    wire [COUNT_WIDTH - 1 : 0] core_tbytes;
+    wire                       core_tlast;
+    wire                       core_tvalid;
+    wire                       core_tready;
    // wire pe_done;
    // wire [DATAOUT_WIDTH - 1 : 0] pe_dataout;
 
     // output FIFO signals
     //wire output_fifo_ready;
-    wire [(WEIGHT_WIDTH * KERNEL_SIZE * KERNEL_SIZE) - 1 : 0] weight_for_pe;// Define the correctly ordered weight bus
 
     // During weight loading: route input to weight loader
-    // During streaming: route input to data accumulator
-    assign s_axis_tready = is_loading_weights ? weight_loader_ready : accumulator_ready;
+    // During streaming: route input to the engine(s)
+    // Pixels are only accepted while a frame is running
+    // (the source ROI takes the place of s_axis once the weights are loaded)
+    assign roi_tready    = in_ready && running && !is_loading_weights;
+    assign s_axis_tready = is_loading_weights ? (weight_loader_ready && !kgen_busy) :
+                           ((in_ready && running && !dma_rd_en && in_open) || in_drop);
 
+    assign m_axis_tvalid = wide_out ? merged_tvalid : (encoder_tvalid && !dma_wr_en);
+    assign m_axis_tdata  = wide_out ? merged_tdata  : encoder_tdata;
+    assign m_axis_tlast  = wide_out ? merged_tlast  : encoder_tlast;
+    assign m_axis_tuser  = {out_tag, !wide_out && !cfg_rle_output && (out_col == cfg_frame_width - 1), out_sof};
 
-    // FULLY PIPELINED: PE processes whenever data is available
-    wire pe_en = (&fifo_m_tvalid || pipe_flushing ) && ready_pe_wrapper && m_axis_tready; 
-    
-       
-         //to put weights in the right order : Reverse the byte order 
-	genvar b;
-	generate
-	    for (b = 0; b < (KERNEL_SIZE * KERNEL_SIZE); b = b + 1) begin 
-		assign weight_for_pe[b*WEIGHT_WIDTH +: WEIGHT_WIDTH] = flat_weights[(TOTAL_BYTES - 1 - b)*WEIGHT_WIDTH +: WEIGHT_WIDTH]; //weigth to assign to pe
-	    end
-	endgenerate
-    
-    // Read from all FIFOs simultaneously when PE processes
-    assign fifo_m_tready = {KERNEL_SIZE{pe_en}};
+
+    // radius -> kernel size (2r+1), clamped to the synthesized array
+    always @(posedge clk) begin
+        if (!rstn)
+            requested_kernel_size <= KERNEL_SIZE;
+        else if ((2 * cfg_radius + 1) > KERNEL_SIZE)
+            requested_kernel_size <= KERNEL_SIZE;
+        else
+            requested_kernel_size <= 2 * cfg_radius + 1;
+    end
+
+    always @(posedge clk) begin
+        if (!rstn) begin
+            running   <= 1'b0;
+            out_count <= 0;
+        end
+        else if (ctrl_start) begin
+            running   <= 1'b1;
+            out_count <= 0;
+        end
+        else if (ctrl_stop || (frame_done && !cfg_stream_frames)) begin
+            running   <= 1'b0;
+            out_count <= 0;
+        end
+        else if (frame_done) begin
+            out_count <= 0;   // frame streaming : the next frame may already be in the pipeline
+        end
+        else if (running && out_fire) begin
+            out_count <= out_count + 1;
+        end
+    end
+
+    // End of a kernel load (KERNEL_READY interrupt)
+    always @(posedge clk) begin
+        if (!rstn)
+            kernel_busy_d <= 1'b0;
+        else
+            kernel_busy_d <= kgen_busy || is_loading_weights;
+    end
 
 
-    // 1. FSM fpr  Weight Loader
+    // 0. AXI4-Lite control/status registers
+    axim_reg #(
+        .ADDRESS_WIDTH(AXIL_ADDR_WIDTH),
+        .DATA_WIDTH(32),
+        .RADIUS_WIDTH(KSIZE_WIDTH),
+        .RADIUS_RESET((KERNEL_SIZE - 1) / 2),
+        .ARRAY_SIZE(KERNEL_SIZE),
+        .NUM_ENGINES(NUM_ENGINES),
+        .NUM_FIFOS(1),
+        .LEVEL_WIDTH(PTR_WIDTH + 1)
+    ) regs_inst (
+        .clk(clk),
+        .rstn(rstn),
+
+        .s_axi_awaddr(s_axi_awaddr),
+        .s_axi_awvalid(s_axi_awvalid),
+        .s_axi_awready(s_axi_awready),
+        .s_axi_wdata(s_axi_wdata),
+        .s_axi_wstrb(s_axi_wstrb),
+        .s_axi_wvalid(s_axi_wvalid),
+        .s_axi_wready(s_axi_wready),
+        .s_axi_bresp(s_axi_bresp),
+        .s_axi_bvalid(s_axi_bvalid),
+        .s_axi_bready(s_axi_bready),
+        .s_axi_araddr(s_axi_araddr),
+        .s_axi_arvalid(s_axi_arvalid),
+        .s_axi_arready(s_axi_arready),
+        .s_axi_rdata(s_axi_rdata),
+        .s_axi_rresp(s_axi_rresp),
+        .s_axi_rvalid(s_axi_rvalid),
+        .s_axi_rready(s_axi_rready),
+
+        // Control
+        .ctrl_start(ctrl_start),
+        .ctrl_stop(ctrl_stop),
+        .cfg_frame_width(cfg_frame_width),
+        .cfg_frame_height(cfg_frame_height),
+        .cfg_radius(cfg_radius),
+        .cfg_mode(cfg_mode),
+        .cfg_packed_input(cfg_packed_input),
+        .cfg_rle_output(cfg_rle_output),
+        .cfg_stream_frames(cfg_stream_frames),
+        .cfg_border(cfg_border),
+        .cfg_border_replicate(cfg_border_replicate),
+        .perf_snapshot(perf_snapshot),
+        .perf_clear(perf_clear),
+        .kgen_start(kgen_start),
+        .cfg_kgen_scale(cfg_kgen_scale),
+        .cfg_kgen_inscribed(cfg_kgen_inscribed),
+        .cfg_kgen_resolution(cfg_kgen_resolution),
+        .dma_rd_en(dma_rd_en),
+        .dma_wr_en(dma_wr_en),
+        .cfg_src_addr(cfg_src_addr),
+        .cfg_src_stride(cfg_src_stride),
+        .cfg_src_width(cfg_src_width),
+        .cfg_src_height(cfg_src_height),
+        .cfg_dst_addr(cfg_dst_addr),
+        .cfg_dst_stride(cfg_dst_stride),
+
+        // Status
+        .status_busy(running),
+        .status_loading(is_loading_weights),
+        .status_shadow_pending(shadow_weights_pending),
+        .status_kgen_busy(kgen_busy),
+        .frame_done(frame_done),
+        .kernel_ready(kernel_ready),
+        .dma_rd_busy(dma_rd_busy),
+        .dma_wr_busy(dma_wr_busy),
+        .dma_rd_error(dma_rd_error),
+        .dma_wr_error(dma_wr_error),
+
+        // Performance counters
+        .perf_cycles(perf_cycles),
+        .perf_active(perf_active),
+        .perf_out_stall(perf_out_stall),
+        .perf_in_starved(perf_in_starved),
+        .perf_weight_load(perf_weight_load),
+        .perf_xbar_idle(perf_xbar_idle),
+        .perf_fifo_hwm(perf_fifo_hwm),
+
+        .irq(irq)
+    );
+
+    // 0b. Performance counters
+    perf_counters #(
+        .NUM_FIFOS(1),
+        .LEVEL_WIDTH(PTR_WIDTH + 1),
+        .COUNT_WIDTH(32)
+    ) perf_inst (
+        .clk(clk),
+        .rstn(rstn),
+        .snapshot(perf_snapshot),
+        .clear(perf_clear),
+
+        // events
+        .ev_active(engines_active),
+        .ev_out_stall(wide_out ? (merged_tvalid && !m_axis_tready) : (out_tvalid && !out_tready)),
+        .ev_in_starved(running && !is_loading_weights && in_ready && !in_tvalid),
+        .ev_weight_load(is_loading_weights || kgen_busy || (s_axis_wgt_tvalid && s_axis_wgt_tready)),
+        .ev_xbar_idle(step_idle),
+        .fifo_level(fifo_level),
+
+        // snapshot values
+        .snap_cycles(perf_cycles),
+        .snap_active(perf_active),
+        .snap_out_stall(perf_out_stall),
+        .snap_in_starved(perf_in_starved),
+        .snap_weight_load(perf_weight_load),
+        .snap_xbar_idle(perf_xbar_idle),
+        .snap_fifo_hwm(perf_fifo_hwm)
+    );
+
+
+    // 1. Kernel generator (RADIUS and the KGEN_* registers)
+    kernel_gen #(
+        .KERNEL_SIZE(KERNEL_SIZE),
+        .WEIGHT_WIDTH(WEIGHT_WIDTH),
+        .BUS_WIDTH(BUS_WIDTH)
+    ) kernel_gen_inst (
+        .clk(clk),
+        .rstn(rstn),
+        .start(kgen_start),
+        .cfg_kernel_size(requested_kernel_size),
+        .cfg_scale(cfg_kgen_scale),
+        .cfg_inscribed(cfg_kgen_inscribed),
+        .cfg_resolution(cfg_kgen_resolution),
+        .busy(kgen_busy),
+        .m_axis_tdata(kgen_tdata),
+        .m_axis_tvalid(kgen_tvalid),
+        .m_axis_tready(kgen_tready)
+    );
+
+    assign s_axis_wgt_tready = loader_wgt_ready && !kgen_busy;
+
+    // 1b. FSM fpr  Weight Loader
     weight_loader #(
         .KERNEL_SIZE(KERNEL_SIZE),
         .WEIGHT_WIDTH(WEIGHT_WIDTH),
@@ -83,106 +524,480 @@ module top #(
     ) weight_loader_inst (
         .clk(clk),
         .rstn(rstn),
+        .cfg_kernel_size(requested_kernel_size),
         
         // Input interface
-        .s_axis_tdata(s_axis_tdata),
-        .s_axis_tvalid(s_axis_tvalid),
+        .s_axis_tdata(kgen_busy ? kgen_tdata : s_axis_tdata),
+        .s_axis_tvalid(kgen_busy ? kgen_tvalid : s_axis_tvalid),
         .s_axis_tready(weight_loader_ready),
+
+        // Side channel for the shadow bank
+        .s_axis_wgt_tdata(kgen_busy ? kgen_tdata : s_axis_wgt_tdata),
+        .s_axis_wgt_tvalid(kgen_busy ? kgen_tvalid : s_axis_wgt_tvalid),
+        .s_axis_wgt_tready(loader_wgt_ready),
+        .frame_boundary(pipe_start),
         
         // Weight output
         .weights_out(flat_weights),
+        .kernel_size_out(active_kernel_size),
         
         // Status
-        .loading(is_loading_weights)
+        .loading(is_loading_weights),
+        .shadow_pending(shadow_weights_pending)
        // .done_loading(weights_loaded)
     );
     
     
     
-    // 2. Data Accumulator (32-bit to full row)
-    // Converts multiple 32-bit transfers into one full row of KERNEL_SIZE pixels
-    data_accumulator #(
-        .KERNEL_SIZE(KERNEL_SIZE),
+    // 2. Occupancy unpacker (bit-packed input : 32 cells per 32-bit transfer to input rows of one byte per cell)
+    occupancy_unpacker #(
         .DATA_WIDTH(DATA_WIDTH),
         .BUS_WIDTH(BUS_WIDTH)
-    ) accumulator_inst (
+    ) occupancy_inst (
         .clk(clk),
         .rstn(rstn),
-        
-        // Enable only when NOT loading weights
-        .enable(!is_loading_weights),
-        
-        // Slave interface (only active when not loading weights)
-        .s_axis_tdata(s_axis_tdata),
-        .s_axis_tvalid(s_axis_tvalid),
-        //.s_axis_tvalid(!is_loading_weights && s_axis_tvalid),
-        .s_axis_tready(accumulator_ready),
-        
-        // Master interface (full row output)
-        .m_axis_tready(unpacker_ready),
-        .m_axis_tdata(accumulated_row),
-        .m_axis_tvalid(accumulated_valid)
+        .cfg_width(in_width),
+        .start(frame_start),
+
+        // Slave interface (the weights never go through it)
+        .s_axis_tdata(in_tdata),
+        .s_axis_tvalid(in_tvalid && running && cfg_packed_input && !is_loading_weights),
+        .s_axis_tready(occupancy_ready),
+
+        // Master interface (input rows)
+        .m_axis_tready(engine_in_ready && cfg_packed_input),
+        .m_axis_tdata(occupancy_tdata),
+        .m_axis_tvalid(occupancy_valid),
+        .idle(occupancy_idle)
     );
 
+    // 3. Compute core : window engine(s), on core_clk with DUAL_CLOCK
+    generate
+        if (DUAL_CLOCK) begin : gen_dual_clock
+            localparam CDC_PTR_WIDTH = 4;   // 16 words in each async FIFO
+            localparam LEVEL_WIDTH   = PTR_WIDTH + 1;
+            // {abort toggle, frame toggle, width, height, border, replicate, kernel size, mode, weights}
+            localparam CFG_WIDTH     = 2 + 16 + 16 + 2 + KSIZE_WIDTH + 1 + WEIGHTIN_WIDTH;
+            localparam WORD_WIDTH    = (NUM_ENGINES > 1) ? 1 + COUNT_WIDTH + BUS_WIDTH : 1 + RESULT_WIDTH;
 
-     // 3. Data Unpacker with Input FIFOs
-    axis_unpack_data #(
-        .KERNEL_SIZE(KERNEL_SIZE),
-        .DATA_WIDTH(DATA_WIDTH),
-        .DEPTH(DEPTH),
-        .PTR_WIDTH(PTR_WIDTH)
-    ) unpacker (
+            wire core_rstn;
+
+            // Interface side : the configuration is sent as one bundle after every change (and the frame
+            // start and the abort as toggles in it). No word enters the core while a bundle is on its way,
+            // so the rows of a frame always meet the configuration of that frame.
+            reg  frame_toggle;
+            reg  abort_toggle;
+            reg  cfg_dirty;
+            reg  loading_d;
+            reg  shadow_pending_d;
+            reg  mode_d;
+            wire cfg_busy;
+            wire cfg_event   = frame_start || ctrl_abort || (loading_d && !is_loading_weights) ||
+                               (shadow_pending_d && !shadow_weights_pending) || (mode_d != cfg_mode);
+            wire cfg_pending = cfg_event || cfg_dirty || cfg_busy;
+            wire word_ready;
+
+            assign engine_in_ready = word_ready && !cfg_pending;
+
+            always @(posedge clk) begin
+                if (!rstn) begin
+                    frame_toggle     <= 1'b0;
+                    abort_toggle     <= 1'b0;
+                    cfg_dirty        <= 1'b1;   // first bundle right after reset
+                    loading_d        <= 1'b0;
+                    shadow_pending_d <= 1'b0;
+                    mode_d           <= 1'b0;
+                end
+                else begin
+                    loading_d        <= is_loading_weights;
+                    shadow_pending_d <= shadow_weights_pending;
+                    mode_d           <= cfg_mode;
+                    if (frame_start)
+                        frame_toggle <= ~frame_toggle;
+                    if (ctrl_abort)
+                        abort_toggle <= ~abort_toggle;
+                    if (cfg_event)
+                        cfg_dirty <= 1'b1;
+                    else if (!cfg_busy)
+                        cfg_dirty <= 1'b0;   // sent this cycle
+                end
+            end
+
+            // Core side
+            wire [CFG_WIDTH - 1 : 0] core_cfg;
+            wire core_cfg_valid;
+            reg  core_toggle;
+            reg  core_abort_toggle;
+            wire core_start = core_cfg_valid && (core_cfg[CFG_WIDTH - 2] != core_toggle);
+            wire core_abort = core_cfg_valid && (core_cfg[CFG_WIDTH - 1] != core_abort_toggle);
+
+            wire [BUS_WIDTH - 1 : 0] core_in_tdata;
+            wire core_in_tvalid;
+            wire core_in_tready;
+            wire [BUS_WIDTH - 1 : 0] core_m_tdata;
+            wire [COUNT_WIDTH - 1 : 0] core_m_tbytes;
+            wire core_m_tlast;
+            wire core_m_tvalid;
+            wire core_m_tready;
+            wire [WORD_WIDTH - 1 : 0] core_word;
+            wire [WORD_WIDTH - 1 : 0] iface_word;
+            wire core_active;
+            wire core_step_idle;
+            wire [LEVEL_WIDTH - 1 : 0] core_fifo_level;
+
+            // status registered in the core domain before it crosses
+            reg  core_active_r;
+            reg  core_step_idle_r;
+
+            always @(posedge core_clk) begin
+                if (!core_rstn) begin
+                    core_toggle       <= 1'b0;
+                    core_abort_toggle <= 1'b0;
+                    core_active_r     <= 1'b0;
+                    core_step_idle_r  <= 1'b0;
+                end
+                else begin
+                    if (core_cfg_valid) begin
+                        core_toggle       <= core_cfg[CFG_WIDTH - 2];
+                        core_abort_toggle <= core_cfg[CFG_WIDTH - 1];
+                    end
+                    core_active_r    <= core_active;
+                    core_step_idle_r <= core_step_idle;
+                end
+            end
+
+            // 3a. Reset and configuration into the core domain
+            cdc_sync #(.WIDTH(1)) core_rstn_sync (
+                .dst_clk(core_clk),
+                .dst_rstn(1'b1),
+                .src_data(rstn),
+                .dst_data(core_rstn)
+            );
+
+            cdc_bus #(.WIDTH(CFG_WIDTH)) cfg_cdc (
+                .src_clk(clk),
+                .src_rstn(rstn),
+                .src_data({abort_toggle, frame_toggle, cfg_frame_width, cfg_frame_height, cfg_border,
+                           cfg_border_replicate, active_kernel_size, cfg_mode, flat_weights}),
+                .src_send(cfg_dirty && !cfg_event),
+                .src_busy(cfg_busy),
+                .dst_clk(core_clk),
+                .dst_rstn(core_rstn),
+                .dst_data(core_cfg),
+                .dst_valid(core_cfg_valid)
+            );
+
+            // 3b. Input rows into the core, results out of it
+            fifo_async #(
+                .DATAWIDTH(BUS_WIDTH),
+                .PTR_WIDTH(CDC_PTR_WIDTH)
+            ) word_cdc (
+                .s_clk(clk),
+                .s_rstn(rstn),
+                .s_tvalid(engine_in_valid && !cfg_pending),
+                .s_tdata(engine_in_tdata),
+                .s_tready(word_ready),
+                .s_empty(),
+                .m_clk(core_clk),
+                .m_rstn(core_rstn),
+                .m_tready(core_in_tready),
+                .m_tdata(core_in_tdata),
+                .m_tvalid(core_in_tvalid)
+            );
+
+            if (NUM_ENGINES > 1) begin : gen_word_cdc
+                assign core_word = {core_m_tlast, core_m_tbytes, core_m_tdata};
+                assign {core_tlast, core_tbytes, core_tdata} = iface_word;
+            end
+            else begin : gen_cell_cdc
+                assign core_word   = {core_m_tlast, core_m_tdata[RESULT_WIDTH - 1 : 0]};
+                assign core_tdata  = {{(BUS_WIDTH - RESULT_WIDTH){1'b0}}, iface_word[RESULT_WIDTH - 1 : 0]};
+                assign core_tbytes = 1;
+                assign core_tlast  = iface_word[RESULT_WIDTH];
+            end
+
+            fifo_async #(
+                .DATAWIDTH(WORD_WIDTH),
+                .PTR_WIDTH(CDC_PTR_WIDTH)
+            ) result_cdc (
+                .s_clk(core_clk),
+                .s_rstn(core_rstn),
+                .s_tvalid(core_m_tvalid),
+                .s_tdata(core_word),
+                .s_tready(core_m_tready),
+                .s_empty(),
+                .m_clk(clk),
+                .m_rstn(rstn),
+                .m_tready(core_tready),
+                .m_tdata(iface_word),
+                .m_tvalid(core_tvalid)
+            );
+
+            // 3c. Status back to the interface domain (the FIFO level moves by one : gray coded)
+            cdc_sync #(.WIDTH(2)) status_sync (
+                .dst_clk(clk),
+                .dst_rstn(rstn),
+                .src_data({core_active_r, core_step_idle_r}),
+                .dst_data({engines_active, step_idle})
+            );
+
+            reg  [LEVEL_WIDTH - 1 : 0] level_gray;
+            wire [LEVEL_WIDTH - 1 : 0] level_gray_s;
+            reg  [LEVEL_WIDTH - 1 : 0] level_s;
+            integer b;
+
+            always @(posedge core_clk) begin
+                if (!core_rstn)
+                    level_gray <= 0;
+                else
+                    level_gray <= core_fifo_level ^ (core_fifo_level >> 1);
+            end
+
+            cdc_sync #(.WIDTH(LEVEL_WIDTH)) level_sync (
+                .dst_clk(clk),
+                .dst_rstn(rstn),
+                .src_data(level_gray),
+                .dst_data(level_gray_s)
+            );
+
+            always @(*) begin
+                level_s[LEVEL_WIDTH - 1] = level_gray_s[LEVEL_WIDTH - 1];
+                for (b = LEVEL_WIDTH - 2; b >= 0; b = b - 1)
+                    level_s[b] = level_s[b + 1] ^ level_gray_s[b];
+            end
+
+            assign fifo_level = level_s;
+
+            // 3d. Window engine(s)
+            engine_core #(
+                .KERNEL_SIZE(KERNEL_SIZE),
+                .DATA_WIDTH(DATA_WIDTH),
+                .WEIGHT_WIDTH(WEIGHT_WIDTH),
+                .DEPTH(DEPTH),
+                .PTR_WIDTH(PTR_WIDTH),
+                .BUS_WIDTH(BUS_WIDTH),
+                .NUM_ENGINES(NUM_ENGINES),
+                .ENGINE_IN_DEPTH(ENGINE_IN_DEPTH),
+                .ENGINE_OUT_DEPTH(ENGINE_OUT_DEPTH),
+                .MAX_WIDTH(MAX_WIDTH),
+                .USE_DSP_ROWS(USE_DSP_ROWS),
+                .DSP_PACK(DSP_PACK)
+            ) core_inst (
+                .clk(core_clk),
+                .rstn(core_rstn),
+                .start(core_start),
+                .abort(core_abort),
+
+                .cfg_width(core_cfg[CFG_WIDTH - 3 -: 16]),
+                .cfg_height(core_cfg[CFG_WIDTH - 19 -: 16]),
+                .cfg_border(core_cfg[WEIGHTIN_WIDTH + 1 + KSIZE_WIDTH + 1]),
+                .cfg_replicate(core_cfg[WEIGHTIN_WIDTH + 1 + KSIZE_WIDTH]),
+                .cfg_kernel_size(core_cfg[WEIGHTIN_WIDTH + 1 +: KSIZE_WIDTH]),
+                .cfg_mode(core_cfg[WEIGHTIN_WIDTH]),
+                .weightsIn(core_cfg[WEIGHTIN_WIDTH - 1 : 0]),
+
+                .s_axis_tdata(core_in_tdata),
+                .s_axis_tvalid(core_in_tvalid),
+                .s_axis_tready(core_in_tready),
+
+                .m_axis_tdata(core_m_tdata),
+                .m_axis_tbytes(core_m_tbytes),
+                .m_axis_tlast(core_m_tlast),
+                .m_axis_tvalid(core_m_tvalid),
+                .m_axis_tready(core_m_tready),
+
+                .busy(),
+                .active(core_active),
+                .step_idle(core_step_idle),
+                .fifo_level(core_fifo_level)
+            );
+        end
+        else begin : gen_single_clock
+            engine_core #(
+                .KERNEL_SIZE(KERNEL_SIZE),
+                .DATA_WIDTH(DATA_WIDTH),
+                .WEIGHT_WIDTH(WEIGHT_WIDTH),
+                .DEPTH(DEPTH),
+                .PTR_WIDTH(PTR_WIDTH),
+                .BUS_WIDTH(BUS_WIDTH),
+                .NUM_ENGINES(NUM_ENGINES),
+                .ENGINE_IN_DEPTH(ENGINE_IN_DEPTH),
+                .ENGINE_OUT_DEPTH(ENGINE_OUT_DEPTH),
+                .MAX_WIDTH(MAX_WIDTH),
+                .USE_DSP_ROWS(USE_DSP_ROWS),
+                .DSP_PACK(DSP_PACK)
+            ) core_inst (
+                .clk(clk),
+                .rstn(rstn),
+                .start(frame_start),
+                .abort(ctrl_abort),
+
+                .cfg_width(cfg_frame_width),
+                .cfg_height(cfg_frame_height),
+                .cfg_border(cfg_border),
+                .cfg_replicate(cfg_border_replicate),
+                .cfg_kernel_size(active_kernel_size),
+                .cfg_mode(cfg_mode),
+                .weightsIn(flat_weights),
+
+                .s_axis_tdata(engine_in_tdata),
+                .s_axis_tvalid(engine_in_valid),
+                .s_axis_tready(engine_in_ready),
+
+                .m_axis_tdata(core_tdata),
+                .m_axis_tbytes(core_tbytes),
+                .m_axis_tlast(core_tlast),
+                .m_axis_tvalid(core_tvalid),
+                .m_axis_tready(core_tready),
+
+                .busy(),
+                .active(engines_active),
+                .step_idle(step_idle),
+                .fifo_level(fifo_level)
+            );
+        end
+    endgenerate
+
+    // 3e. Core results -> cells (cell_tdata) and packed costs (merged, NUM_ENGINES > 1). A cell is the
+    //     result saturated to one byte cost in both builds (the stripe packers saturate with several
+    //     engines), so the plain output, the encoder and the destination ROI see the same costs
+    //     (CONFIG COST_WIDTH)
+    generate
+        if (NUM_ENGINES == 1) begin : gen_single_engine
+            wire [RESULT_WIDTH - 1 : 0] result = core_tdata[RESULT_WIDTH - 1 : 0];
+
+            assign cell_tdata    = (result > 8'hFF) ? 8'hFF : result;
+            assign cell_tvalid   = core_tvalid;
+            assign core_tready   = cell_tready;
+            assign merged_tdata  = 0;
+            assign merged_tbytes = 0;
+            assign merged_tlast  = 1'b0;
+            assign merged_tvalid = 1'b0;
+        end
+        else begin : gen_multi_engine
+            // cell of the merged word handed to the encoder or the destination ROI
+            reg  [COUNT_WIDTH - 1 : 0] cell_sel;
+            wire last_cell = (cell_sel == merged_tbytes - 1);
+
+            assign merged_tdata  = core_tdata;
+            assign merged_tbytes = core_tbytes;
+            assign merged_tlast  = core_tlast;
+            assign merged_tvalid = core_tvalid;
+            assign core_tready   = merged_tready;
+
+            assign cell_tdata    = {{(RESULT_WIDTH - 8){1'b0}}, merged_tdata[cell_sel * 8 +: 8]};
+            assign cell_tvalid   = merged_tvalid && !wide_out;
+            assign merged_tready = wide_out ? m_axis_tready : (cell_tready && last_cell);
+
+            always @(posedge clk) begin
+                if (!rstn || frame_start)
+                    cell_sel <= 0;
+                else if (cell_tvalid && cell_tready)
+                    cell_sel <= last_cell ? 0 : cell_sel + 1;
+            end
+        end
+    endgenerate
+
+    // 3f. Cells of the map
+    assign out_tdata   = cell_tdata;
+    assign out_tvalid  = cell_tvalid;
+    assign cell_tready = out_tready;
+
+    // 4. Output encoder (run-length tokens for the stream output, the destination ROI always gets plain cells)
+    rle_encoder #(
+        .IN_WIDTH(RESULT_WIDTH),
+        .VALUE_WIDTH(DATA_WIDTH),
+        .OUT_WIDTH(BUS_WIDTH)
+    ) rle_encoder_inst (
         .clk(clk),
         .rstn(rstn),
-        
-        // Slave interface (receives full rows from accumulator)
-        .s_axis_tdata(accumulated_row),
-        .s_axis_tvalid(accumulated_valid),
-        .s_axis_tready(unpacker_ready),
-        
-        // Master interface to PE
-        .m_axis_tready(fifo_m_tready),
-        .m_axis_tdata(fifo_m_tdata),
-        .m_axis_tvalid(fifo_m_tvalid)
-    );
+        .enable(cfg_rle_output),
 
+        .s_axis_tdata(out_tdata),
+        .s_axis_tlast(out_count == frame_cells - 1),
+        .s_axis_tvalid(out_tvalid && !dma_wr_en),
+        .s_axis_tready(encoder_ready),
 
-    // 4. PE Wrapper
-    pe_wrapper #(
-        .KERNEL_SIZE(KERNEL_SIZE),
-        .DATA_WIDTH(DATA_WIDTH),
-        .WEIGHT_WIDTH(WEIGHT_WIDTH)
-    ) pe_engine (
+        .m_axis_tdata(encoder_tdata),
+        .m_axis_tlast(encoder_tlast),
+        .m_axis_tvalid(encoder_tvalid),
+        .m_axis_tready(m_axis_tready)
+    );
+
+    // 5. ROI DMA : source ROI reader (front end) and destination ROI writer (back end)
+    axi_roi_reader #(
+        .ADDR_WIDTH(AXI_ADDR_WIDTH),
+        .BUS_WIDTH(BUS_WIDTH),
+        .MAX_BURST_LEN(MAX_BURST_LEN)
+    ) roi_reader_inst (
         .clk(clk),
         .rstn(rstn),
 
-	// control
-        .en(pe_en),
-        .ready(ready_pe_wrapper),
+        .start(ctrl_start && dma_rd_en),
+        .cfg_base(cfg_src_addr),
+        .cfg_stride(cfg_src_stride),
+        .cfg_width(cfg_src_width),
+        .cfg_height(cfg_src_height),
+        .busy(dma_rd_busy),
+        .error(dma_rd_error),
 
-	//Data inputs
-        .dataIn(fifo_m_tdata),
-        .weightsIn(weight_for_pe),
+        .m_axi_araddr(m_axi_araddr),
+        .m_axi_arlen(m_axi_arlen),
+        .m_axi_arsize(m_axi_arsize),
+        .m_axi_arburst(m_axi_arburst),
+        .m_axi_arvalid(m_axi_arvalid),
+        .m_axi_arready(m_axi_arready),
+        .m_axi_rdata(m_axi_rdata),
+        .m_axi_rresp(m_axi_rresp),
+        .m_axi_rlast(m_axi_rlast),
+        .m_axi_rvalid(m_axi_rvalid),
+        .m_axi_rready(m_axi_rready),
 
-	// Data outputs inerface
-        .m_axis_tready(m_axis_tready),
-        .m_axis_tdata(m_axis_tdata),
-        .m_axis_tvalid(m_axis_tvalid)
+        .m_axis_tdata(roi_tdata),
+        .m_axis_tbytes(roi_tbytes),
+        .m_axis_tlast(roi_tlast),
+        .m_axis_tvalid(roi_tvalid),
+        .m_axis_tready(roi_tready)
     );
-    
-        // This module "holds" the high signal for TOTAL_DONE_DELAY cycles
-    // after the FIFO goes empty.
-    delay #(
-        .LATENCY(TOTAL_DONE_DELAY), 
-        .WIDTH(1)
-    ) flush_delay_inst (
+
+    axi_roi_writer #(
+        .ADDR_WIDTH(AXI_ADDR_WIDTH),
+        .BUS_WIDTH(BUS_WIDTH),
+        .CELL_WIDTH(RESULT_WIDTH),
+        .MAX_BURST_LEN(MAX_BURST_LEN)
+    ) roi_writer_inst (
         .clk(clk),
         .rstn(rstn),
-        .dataIn(&fifo_m_tvalid), 
-        .dataOut(pipe_flushing)
+
+        .start(ctrl_start && dma_wr_en),
+        .cfg_base(cfg_dst_addr),
+        .cfg_stride(cfg_dst_stride),
+        .cfg_width(cfg_frame_width),
+        .cfg_height(cfg_frame_height),
+        .busy(dma_wr_busy),
+        .done(dma_wr_done),
+        .error(dma_wr_error),
+
+        .s_axis_tdata(out_tdata),
+        .s_axis_tvalid(out_tvalid && dma_wr_en),
+        .s_axis_tready(writer_ready),
+
+        .m_axi_awaddr(m_axi_awaddr),
+        .m_axi_awlen(m_axi_awlen),
+        .m_axi_awsize(m_axi_awsize),
+        .m_axi_awburst(m_axi_awburst),
+        .m_axi_awvalid(m_axi_awvalid),
+        .m_axi_awready(m_axi_awready),
+        .m_axi_wdata(m_axi_wdata),
+        .m_axi_wstrb(m_axi_wstrb),
+        .m_axi_wlast(m_axi_wlast),
+        .m_axi_wvalid(m_axi_wvalid),
+        .m_axi_wready(m_axi_wready),
+        .m_axi_bresp(m_axi_bresp),
+        .m_axi_bvalid(m_axi_bvalid),
+        .m_axi_bready(m_axi_bready)
     );
     
-   
    /* 
     // 5.output FIFO
     fifo_axis #(
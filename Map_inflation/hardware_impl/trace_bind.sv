@@ -0,0 +1,31 @@
+`timescale 1ns/1ps
+
+// Simulation only : attaches the handshake monitors (axis_trace.sv) to every instance of the
+// modules below, from the input of top to its output, in the order trace_report.py expects :
+//     s_axis   : map rows / lines into top
+//     words    : input words into the FIFO of a window engine (level : words in the FIFO)
+//     cells    : row serializer -> window generator, one cell per transfer
+//     windows  : window generator -> PE array
+//     results  : PE array output
+//     m_axis   : results out of top
+// With several engines every one of them has its own words .. results traces.
+// The bind statements sit in the compilation unit : compile this file with the design, no
+// extra top level is needed, and run with +trace.
+
+bind top axis_trace #(.LANES(1)) trace_s_axis (
+    .clk(clk), .valid(s_axis_tvalid), .ready(s_axis_tready), .level(32'd0));
+
+bind top axis_trace #(.LANES(1)) trace_m_axis (
+    .clk(clk), .valid(m_axis_tvalid), .ready(m_axis_tready), .level(32'd0));
+
+bind window_engine axis_trace #(.LANES(1)) trace_words (
+    .clk(clk), .valid(s_axis_tvalid), .ready(s_axis_tready), .level({{(31 - PTR_WIDTH){1'b0}}, fifo_level}));
+
+bind row_serializer axis_trace #(.LANES(1)) trace_cells (
+    .clk(clk), .valid(m_axis_tvalid), .ready(m_axis_tready), .level(32'd0));
+
+bind window_gen axis_trace #(.LANES(1)) trace_windows (
+    .clk(clk), .valid(m_axis_tvalid), .ready(m_axis_tready), .level(32'd0));
+
+bind pe_wrapper axis_trace #(.LANES(1)) trace_results (
+    .clk(clk), .valid(m_axis_tvalid), .ready(m_axis_tready), .level(32'd0));
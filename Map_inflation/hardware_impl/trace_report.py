@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+"""Stall attribution and occupancy timelines from the handshake traces of axis_trace.sv.
+
+    python3 trace_report.py *.trc [--buckets N] [--csv timeline.csv]
+
+Every trace file holds the {valid, ready, level} changes of one interface (see axis_trace.sv).
+On every cycle an interface is
+    busy    : a transfer (valid and ready on a lane),
+    stalled : valid without ready (the consumer holds it back),
+    starved : ready without valid (the producer has nothing),
+    idle    : neither.
+The interfaces are put in pipeline order (s_axis, words, cells, windows, results, m_axis). A stage
+between two interfaces is blamed on the cycles where the interface before it is stalled and the one
+after it is not : the back-pressure starts there. A stalled m_axis is blamed on the consumer of the
+results, a starved s_axis on the producer of the maps.
+Unverified : not yet run on the traces of a simulation of top.v (the monitors have not run either).
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+TRACE_MAGIC = 0x41545231
+ORDER = ["s_axis", "words", "cells", "windows", "results", "m_axis"]
+STATES = ["busy", "stalled", "starved", "idle"]
+
+
+class Channel:
+    def __init__(self, path):
+        self.path = path
+        self.instance = os.path.basename(path)[:-len(".trc")] if path.endswith(".trc") else os.path.basename(path)
+        leaf = self.instance.split(".")[-1]
+        self.kind = leaf[len("trace_"):] if leaf.startswith("trace_") else leaf
+        self.events = []   # (cycle, state, level)
+        self.read()
+
+    def read(self):
+        with open(self.path, "rb") as f:
+            data = f.read()
+        if len(data) < 12:
+            raise ValueError("%s : no header" % self.path)
+        for endian in "<>":
+            if struct.unpack_from(endian + "I", data, 0)[0] == TRACE_MAGIC:
+                break
+        else:
+            raise ValueError("%s : not a trace file" % self.path)
+        self.lanes = struct.unpack_from(endian + "I", data, 4)[0]
+        for offset in range(12, len(data) - 15, 16):
+            cycle, valid, ready, level = struct.unpack_from(endian + "4I", data, offset)
+            self.events.append((cycle, state_of(valid, ready), level))
+
+
+def state_of(valid, ready):
+    if valid & ready:
+        return 0
+    if valid:
+        return 1
+    if ready:
+        return 2
+    return 3
+
+
+def pipeline(channels):
+    """Channels in pipeline order, names made unique with their parent instance when needed."""
+    kinds = {}
+    for ch in channels:
+        kinds.setdefault(ch.kind, []).append(ch)
+    for same in kinds.values():
+        if len(same) > 1:
+            for ch in same:
+                parts = ch.instance.split(".")
+                ch.kind_label = "%s(%s)" % (ch.kind, parts[-2] if len(parts) > 1 else ch.instance)
+        else:
+            same[0].kind_label = same[0].kind
+    rank = {k: i for i, k in enumerate(ORDER)}
+    return sorted(channels, key=lambda ch: (rank.get(ch.kind, len(ORDER)), ch.instance))
+
+
+def sweep(channels, start, end):
+    """Yields (cycle, next cycle, states, levels) for every stretch without any change."""
+    merged = []
+    for index, ch in enumerate(channels):
+        for cycle, state, level in ch.events:
+            merged.append((cycle, index, state, level))
+    merged.sort()
+
+    states = [3] * len(channels)
+    levels = [0] * len(channels)
+    position = 0
+    cycle = start
+    while cycle < end:
+        while position < len(merged) and merged[position][0] <= cycle:
+            _, index, state, level = merged[position]
+            states[index] = state
+            levels[index] = level
+            position += 1
+        following = merged[position][0] if position < len(merged) else end
+        following = min(max(following, cycle + 1), end)
+        yield cycle, following, states, levels
+        cycle = following
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("traces", nargs="+", help="trace files (*.trc)")
+    parser.add_argument("--buckets", type=int, default=0, help="occupancy timeline in N time buckets")
+    parser.add_argument("--csv", help="write the timeline of every interface (cycle, state, level) to this file")
+    args = parser.parse_args()
+
+    channels = pipeline([Channel(path) for path in args.traces])
+    channels = [ch for ch in channels if ch.events]
+    if not channels:
+        sys.exit("no events in the traces")
+
+    start = min(ch.events[0][0] for ch in channels)
+    end = max(ch.events[-1][0] for ch in channels) + 1
+    total = end - start
+
+    time_in = [[0] * len(STATES) for _ in channels]
+    level_sum = [0] * len(channels)
+    level_max = [0] * len(channels)
+    blame = {}
+    buckets = [[0] * len(channels) for _ in range(args.buckets)]
+    names = [ch.kind_label for ch in channels]
+
+    for cycle, following, states, levels in sweep(channels, start, end):
+        length = following - cycle
+        for i in range(len(channels)):
+            time_in[i][states[i]] += length
+            level_sum[i] += levels[i] * length
+            level_max[i] = max(level_max[i], levels[i])
+
+        # back-pressure starts after the last stalled interface of a run of stalled ones
+        for i in range(len(channels) - 1):
+            if states[i] == 1 and states[i + 1] != 1:
+                stage = "%s -> %s" % (names[i], names[i + 1])
+                blame[stage] = blame.get(stage, 0) + length
+        if states[-1] == 1:
+            blame["consumer of %s" % names[-1]] = blame.get("consumer of %s" % names[-1], 0) + length
+        if states[0] == 2:
+            blame["producer of %s" % names[0]] = blame.get("producer of %s" % names[0], 0) + length
+
+        for b in range(args.buckets):
+            lo = start + total * b // args.buckets
+            hi = start + total * (b + 1) // args.buckets
+            overlap = min(hi, following) - max(lo, cycle)
+            if overlap > 0:
+                for i in range(len(channels)):
+                    buckets[b][i] += levels[i] * overlap
+
+    print("%d cycles (%d .. %d), %d interfaces" % (total, start, end - 1, len(channels)))
+    print()
+    print("%-22s %5s %8s %8s %8s %8s %10s %6s" % ("interface", "lanes", "busy", "stalled", "starved", "idle",
+                                                   "mean level", "max"))
+    for i, ch in enumerate(channels):
+        shares = ["%7.1f%%" % (100.0 * t / total) for t in time_in[i]]
+        print("%-22s %5d %s %10.2f %6d" % (names[i], ch.lanes, " ".join(shares), level_sum[i] / total, level_max[i]))
+
+    print()
+    print("stall attribution (share of the cycles)")
+    for stage, cycles in sorted(blame.items(), key=lambda item: -item[1]):
+        print("  %-40s %7.1f%%" % (stage, 100.0 * cycles / total))
+    if not blame:
+        print("  no stall")
+
+    if args.buckets:
+        print()
+        print("occupancy timeline (mean level per bucket)")
+        print("%-12s" % "cycle" + "".join("%12s" % n[:11] for n in names))
+        for b in range(args.buckets):
+            lo = start + total * b // args.buckets
+            hi = start + total * (b + 1) // args.buckets
+            width = max(hi - lo, 1)
+            print("%-12d" % lo + "".join("%12.2f" % (buckets[b][i] / width) for i in range(len(channels))))
+
+    if args.csv:
+        with open(args.csv, "w") as f:
+            f.write("cycle,interface,state,level\n")
+            for i, ch in enumerate(channels):
+                for cycle, state, level in ch.events:
+                    f.write("%d,%s,%s,%d\n" % (cycle, names[i], STATES[state], level))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,115 @@
+// Pipelined use of the accelerator library (software_impl/host/inflate.h) on the simulation
+// backend : the maps are generated while the previous frames run on the Verilator model, up to
+// --depth frames in flight, and every result is checked against the CPU engine (cpu_inflate.h).
+//
+//   ./obj_async_top/async_top [--width W] [--height H] [--radius R] [--frames N] [--depth D] [--seed S]
+//
+// Prints the failures, the time spent waiting for results, and the frame rate and stage occupancy
+// of the library (inflate_print_stats) : --depth 1 gives the serial load / compute / store flow.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "cpu_inflate.h"
+#include "inflate.h"
+#include "kernel_gen.h"
+#include "top_driver.h"
+
+static void usage(const char *prog)
+{
+    std::fprintf(stderr, "usage: %s [--width W] [--height H] [--radius R] [--frames N] [--depth D] [--seed S]\n",
+                 prog);
+}
+
+int main(int argc, char **argv)
+{
+    inflate_params_t params = {64, 64, 3, 1, 0, 10.0f, 0.1f, 0.05f};
+    int      frames = 16;
+    int      depth  = INFLATE_QUEUE_DEPTH;
+    uint64_t seed   = 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        if (arg == "--width")
+            params.width = std::atoi(argv[++i]);
+        else if (arg == "--height")
+            params.height = std::atoi(argv[++i]);
+        else if (arg == "--radius")
+            params.radius = std::atoi(argv[++i]);
+        else if (arg == "--frames")
+            frames = std::atoi(argv[++i]);
+        else if (arg == "--depth")
+            depth = std::min(std::max(std::atoi(argv[++i]), 1), INFLATE_QUEUE_DEPTH);
+        else if (arg == "--seed")
+            seed = std::strtoull(argv[++i], nullptr, 0);
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    inflate_dev_t *dev = inflate_open_sim(seed);
+    if (!dev) {
+        std::fprintf(stderr, "cannot open the simulation backend\n");
+        return 1;
+    }
+
+    // CPU engine : same parameters and kernel for every frame
+    const size_t cells = static_cast<size_t>(params.width) * params.height;
+    const int    k     = 2 * params.radius + 1;
+    std::vector<uint8_t> kernel(static_cast<size_t>(k) * k);
+    kgen_kernel(params.radius, KGEN_FIXED(params.cost_scaling_factor), KGEN_FIXED(params.inscribed_radius),
+                KGEN_FIXED(params.resolution), kernel.data());
+
+    std::mt19937_64 rng(seed);
+    std::vector<std::vector<uint8_t>> maps(frames), outs(frames, std::vector<uint8_t>(cells));
+    std::vector<inflate_ticket_t>     tickets(frames);
+    std::vector<uint8_t>              expected(cells);
+    int    failures = 0;
+    double waited   = 0.0;
+    auto   start    = std::chrono::steady_clock::now();
+
+    for (int f = 0; f < frames + depth; f++) {
+        // frame f is prepared and queued while the ones before it run
+        if (f < frames) {
+            maps[f]    = cluttered_map(params.width, params.height, 1 + static_cast<int>(cells / 200), 3, rng);
+            tickets[f] = inflate_submit(dev, maps[f].data(), outs[f].data(), &params);
+            if (tickets[f] < 0) {
+                std::fprintf(stderr, "frame %d : submit error %lld\n", f, static_cast<long long>(tickets[f]));
+                failures++;
+            }
+        }
+
+        int done = f - depth + 1;
+        if (done < 0 || done >= frames || tickets[done] < 0)
+            continue;
+        auto wait_start = std::chrono::steady_clock::now();
+        int  status     = inflate_wait(dev, tickets[done], -1);
+        waited += std::chrono::duration<double>(std::chrono::steady_clock::now() - wait_start).count();
+
+        cpu_inflate_rows(maps[done].data(), expected.data(), params.width, params.height, 0, params.height,
+                         params.radius, kernel.data(), params.inflation, params.replicate);
+        size_t mismatches = 0;
+        for (size_t i = 0; status == 0 && i < cells; i++)
+            mismatches += outs[done][i] != expected[i];
+        if (status || mismatches) {
+            std::printf("FAIL frame %d : status %d, %zu mismatches\n", done, status, mismatches);
+            failures++;
+        }
+    }
+    inflate_stats_t stats;
+    inflate_get_stats(dev, &stats);
+    inflate_close(dev);
+
+    double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%d frames of %dx%d, radius %d, %d in flight : %.2f s, %.2f s waiting for results, %d failures\n",
+                frames, params.width, params.height, params.radius, depth, total, waited, failures);
+    inflate_print_stats(stdout, &stats);
+    return failures ? 1 : 0;
+}
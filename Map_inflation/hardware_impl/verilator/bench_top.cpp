@@ -0,0 +1,128 @@
+// Throughput benchmark of the Verilator model of top.v : streams random cluttered maps as
+// back-to-back frames with the given s_axis_tvalid / m_axis_tready duty cycles and reports
+// cycles per output cell, PE array utilisation and latency.
+//
+//   ./obj_bench_top/bench_top --width 128 --height 128 --radius 6 --frames 4 --in-duty 1.0 --out-duty 0.5
+//
+// --csv prints one line (header with --csv-header) for sweeps. Built with TRACE=1, +trace writes
+// the handshake traces of trace_bind.sv (python3 ../trace_report.py *.trc).
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "top_driver.h"
+
+static void usage(const char *prog)
+{
+    std::fprintf(stderr,
+                 "usage: %s [--width W] [--height H] [--radius R] [--frames N] [--conv]\n"
+                 "          [--in-duty P] [--out-duty P] [--clusters N] [--seed S] [--csv] [--csv-header]\n",
+                 prog);
+}
+
+int main(int argc, char **argv)
+{
+    RunConfig cfg;
+    int       frames   = 2;
+    int       clusters = 20;
+    uint64_t  seed     = 1;
+    bool      csv      = false;
+    bool      header   = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (arg[0] == '+')              continue;   // simulator plusargs
+        if (arg == "--conv")            { cfg.inflation = false; continue; }
+        if (arg == "--csv")             { csv = true; continue; }
+        if (arg == "--csv-header")      { header = true; continue; }
+        if (!value || arg.compare(0, 2, "--") != 0) {
+            usage(argv[0]);
+            return 2;
+        }
+        if      (arg == "--width")    cfg.width    = std::atoi(value);
+        else if (arg == "--height")   cfg.height   = std::atoi(value);
+        else if (arg == "--radius")   cfg.radius   = std::atoi(value);
+        else if (arg == "--frames")   frames       = std::atoi(value);
+        else if (arg == "--in-duty")  cfg.in_duty  = std::atof(value);
+        else if (arg == "--out-duty") cfg.out_duty = std::atof(value);
+        else if (arg == "--clusters") clusters     = std::atoi(value);
+        else if (arg == "--seed")     seed         = std::strtoull(value, nullptr, 0);
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+    if (cfg.width < 1 || cfg.height < 1 || cfg.radius < 0 || frames < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    // frames of the run
+    std::mt19937_64 rng(seed);
+    std::vector<std::vector<uint8_t>> maps;
+    for (int f = 0; f < frames; f++)
+        maps.push_back(cluttered_map(cfg.width, cfg.height, clusters, 3, rng));
+
+    TopDriver dut(seed, argc, argv);
+    dut.reset();
+
+    uint32_t config     = dut.read(regs::CONFIG);
+    int      array_size = config & 0xFF;
+    if (2 * cfg.radius + 1 > array_size)
+        std::fprintf(stderr, "radius %d clamped to the %dx%d array\n", cfg.radius, array_size, array_size);
+
+    if (!dut.configure(cfg)) {
+        std::fprintf(stderr, "kernel generation did not finish\n");
+        return 1;
+    }
+
+    std::vector<std::vector<uint32_t>> results;
+    auto     wall_start = std::chrono::steady_clock::now();
+    uint64_t sim_start  = dut.cycle();
+    RunStats stats      = dut.run(cfg, maps, results);
+    double   wall       = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    uint64_t sim_cycles = dut.cycle() - sim_start;
+
+    double cells       = static_cast<double>(stats.out_cells);
+    double cpc         = cells ? stats.cycles / cells : 0.0;
+    double utilisation = stats.perf_cycles ? static_cast<double>(stats.perf_active) / stats.perf_cycles : 0.0;
+    double out_stall   = stats.perf_cycles ? static_cast<double>(stats.perf_out_stall) / stats.perf_cycles : 0.0;
+    double in_starved  = stats.perf_cycles ? static_cast<double>(stats.perf_in_starved) / stats.perf_cycles : 0.0;
+    double latency     = static_cast<double>(stats.frame_latency) / frames;
+
+    if (header)
+        std::printf("array,width,height,radius,frames,in_duty,out_duty,cycles,cells,cycles_per_cell,"
+                    "utilisation,out_stall,in_starved,first_latency,frame_latency,errors\n");
+    if (csv) {
+        std::printf("%d,%d,%d,%d,%d,%.3f,%.3f,%llu,%llu,%.4f,%.4f,%.4f,%.4f,%llu,%.1f,%d\n",
+                    array_size, cfg.width, cfg.height, cfg.radius, frames, cfg.in_duty, cfg.out_duty,
+                    static_cast<unsigned long long>(stats.cycles), static_cast<unsigned long long>(stats.out_cells),
+                    cpc, utilisation, out_stall, in_starved,
+                    static_cast<unsigned long long>(stats.first_latency), latency, stats.errors);
+    }
+    else {
+        std::printf("=== top : %dx%d array, %d frames of %dx%d, radius %d, %s ===\n", array_size, array_size,
+                    frames, cfg.width, cfg.height, cfg.radius, cfg.inflation ? "inflation" : "convolution");
+        std::printf("duty cycles         : s_axis_tvalid %.2f, m_axis_tready %.2f\n", cfg.in_duty, cfg.out_duty);
+        std::printf("cycles              : %llu (%llu input transfers, %llu results)\n",
+                    static_cast<unsigned long long>(stats.cycles), static_cast<unsigned long long>(stats.in_beats),
+                    static_cast<unsigned long long>(stats.out_cells));
+        std::printf("cycles per cell     : %.3f\n", cpc);
+        std::printf("PE array active     : %.1f %% of the cycles\n", 100.0 * utilisation);
+        std::printf("output stalled      : %.1f %%\n", 100.0 * out_stall);
+        std::printf("input starved       : %.1f %%\n", 100.0 * in_starved);
+        std::printf("idle positions      : %u\n", stats.perf_xbar_idle);
+        std::printf("latency             : %llu cycles to the first result, %.0f per frame\n",
+                    static_cast<unsigned long long>(stats.first_latency), latency);
+        std::printf("simulation speed    : %.0f cycles/s\n", wall > 0.0 ? sim_cycles / wall : 0.0);
+        if (stats.errors)
+            std::printf("errors              : %d\n", stats.errors);
+    }
+
+    return stats.errors ? 1 : 0;
+}
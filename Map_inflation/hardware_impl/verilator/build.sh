@@ -0,0 +1,31 @@
+#!/bin/sh
+
+# Verilator model of top.v with one of the drivers : bench_top (throughput benchmark, default),
+# regress_top (randomised regression against inflation_random.c, see regress.sh) or async_top (the host
+# library of software_impl/host/inflate.h on its simulation backend, inflate_sim.cpp).
+# The executable lands in obj_<driver>/<driver>. Parameters of top can be overridden :
+#     ./build.sh bench_top -GKERNEL_SIZE=9
+#     ./build.sh regress_top -GNUM_ENGINES=4     (the drivers unpack the costs of a multi-engine build)
+# TRACE=1 adds the handshake monitors (trace_bind.sv) : run the driver with +trace for the .trc files.
+# Unverified : the model and its drivers (bench_top, regress_top, async_top) have not been built with a
+# real Verilator yet, so expect a first round of build fixes ; no benchmark or regression result exists.
+
+cd "$(dirname "$0")"
+DRIVER=bench_top
+case "$1" in
+    -*|"") ;;
+    *) DRIVER=$1; shift ;;
+esac
+HOST="$(pwd)/../../software_impl/host"
+TRACE_FILES=
+[ -n "$TRACE" ] && TRACE_FILES="../axis_trace.sv ../trace_bind.sv"
+
+verilator --cc --exe --build -j 0 -O3 \
+    --x-assign fast --x-initial fast \
+    -Wno-fatal -Wno-lint -Wno-style \
+    --timescale 1ns/1ps --top-module top \
+    -y .. +libext+.v+.sv \
+    -CFLAGS "-O2 -std=c++17 -I$HOST -I$HOST/.. -DINFLATION_NO_MAIN" -LDFLAGS -pthread \
+    --Mdir obj_$DRIVER \
+    "$@" ../top.v $TRACE_FILES $DRIVER.cpp inflate_sim.cpp \
+    "$HOST/kernel_gen.c" "$HOST/cpu_inflate.c" "$HOST/inflate.c" "$HOST/../inflation_random.c" -o $DRIVER
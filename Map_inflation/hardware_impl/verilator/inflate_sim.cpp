@@ -0,0 +1,97 @@
+// Simulation backend of the accelerator library (software_impl/host/inflate.h) : every frame runs
+// through the Verilator model of top.v with TopDriver, on the worker thread of the library. The
+// kernel is generated on chip again only when the parameters change (inflate.c calls configure),
+// results are saturated to one byte like axi_roi_writer.sv does on the board. The slots are host
+// buffers and the model runs in wait(), so the stage times give the cost of the copies against
+// the simulation itself.
+#include <algorithm>
+#include <cerrno>
+#include <vector>
+
+#include "inflate.h"
+#include "kernel_gen.h"
+#include "top_driver.h"
+
+namespace {
+
+struct SimBackend {
+    explicit SimBackend(uint64_t seed) : driver(seed) { driver.reset(); }
+
+    TopDriver driver;
+    RunConfig cfg;
+    bool      configured = false;   // configure() done, START pending for the first frame
+    std::vector<std::vector<uint8_t>>  maps[INFLATE_SLOTS];      // one frame per slot
+    std::vector<std::vector<uint32_t>> results[INFLATE_SLOTS];
+};
+
+int sim_configure(void *ctx, const inflate_params_t *params)
+{
+    SimBackend *sim = static_cast<SimBackend *>(ctx);
+
+    sim->cfg.width      = params->width;
+    sim->cfg.height     = params->height;
+    sim->cfg.radius     = params->radius;
+    sim->cfg.inflation  = params->inflation != 0;
+    sim->cfg.replicate  = params->replicate != 0;
+    sim->cfg.scale      = KGEN_FIXED(params->cost_scaling_factor);
+    sim->cfg.inscribed  = KGEN_FIXED(params->inscribed_radius);
+    sim->cfg.resolution = KGEN_FIXED(params->resolution);
+    sim->configured     = sim->driver.configure(sim->cfg);
+    return sim->configured ? 0 : -ETIMEDOUT;
+}
+
+int sim_load(void *ctx, int slot, const uint8_t *map, const inflate_params_t *params)
+{
+    SimBackend *sim = static_cast<SimBackend *>(ctx);
+    const size_t cells = static_cast<size_t>(params->width) * params->height;
+
+    sim->maps[slot].assign(1, std::vector<uint8_t>(map, map + cells));
+    return 0;
+}
+
+int sim_start(void *ctx, int slot, const inflate_params_t *params)
+{
+    SimBackend *sim = static_cast<SimBackend *>(ctx);
+
+    (void)slot;
+    (void)params;
+    // run() stops the engine after the frame : START again for the next ones
+    if (!sim->configured)
+        sim->driver.write(regs::CTRL, regs::CTRL_START);
+    sim->configured = false;
+    return 0;
+}
+
+int sim_wait(void *ctx, int slot, const inflate_params_t *params)
+{
+    SimBackend *sim = static_cast<SimBackend *>(ctx);
+    const size_t cells = static_cast<size_t>(params->width) * params->height;
+
+    RunStats stats = sim->driver.run(sim->cfg, sim->maps[slot], sim->results[slot]);
+    return (stats.errors || sim->results[slot][0].size() != cells) ? -EIO : 0;
+}
+
+int sim_store(void *ctx, int slot, uint8_t *out, const inflate_params_t *params)
+{
+    SimBackend *sim = static_cast<SimBackend *>(ctx);
+    const std::vector<uint32_t> &results = sim->results[slot][0];
+
+    (void)params;
+    for (size_t i = 0; i < results.size(); i++)
+        out[i] = static_cast<uint8_t>(std::min<uint32_t>(results[i], 255));
+    return 0;
+}
+
+void sim_close(void *ctx)
+{
+    delete static_cast<SimBackend *>(ctx);
+}
+
+}  // namespace
+
+extern "C" inflate_dev_t *inflate_open_sim(uint64_t seed)
+{
+    inflate_backend_t backend = {"sim",    sim_configure, sim_load,  sim_start,
+                                 sim_wait, sim_store,     sim_close, new SimBackend(seed)};
+    return inflate_open(&backend);
+}
@@ -0,0 +1,36 @@
+#!/bin/sh
+
+# Randomised regression of top.v against the reference inflation (inflation_random.c), one regress_top instance per core
+#     ./regress.sh [cases] [first seed]        (JOBS=n to change the number of instances)
+# The logs of the shards are kept in regress_logs/, the failing seeds are listed at the end.
+# Not run yet : regress_top has not been built with a real Verilator (see build.sh).
+
+cd "$(dirname "$0")"
+CASES=${1:-1000}
+FIRST=${2:-1}
+JOBS=${JOBS:-$(nproc)}
+
+if [ ! -x obj_regress_top/regress_top ] || [ -n "$REBUILD" ]; then
+    ./build.sh regress_top > build_regress.log 2>&1 || { tail -20 build_regress.log; exit 1; }
+fi
+
+rm -rf regress_logs
+mkdir regress_logs
+PER=$(( (CASES + JOBS - 1) / JOBS ))
+START=$(date +%s)
+
+i=0
+while [ $((i * PER)) -lt "$CASES" ]; do
+    COUNT=$PER
+    [ $(( (i + 1) * PER )) -gt "$CASES" ] && COUNT=$((CASES - i * PER))
+    ./obj_regress_top/regress_top --first $((FIRST + i * PER)) --count $COUNT > regress_logs/shard_$i.log 2>&1 &
+    i=$((i + 1))
+done
+wait
+
+grep -h "^FAIL" regress_logs/*.log
+FAILED=$(grep -h "^FAIL" regress_logs/*.log | wc -l)
+DONE=$(grep -h "^seeds" regress_logs/*.log | wc -l)
+echo "$CASES cases in $i shards ($DONE finished), $FAILED failures, $(( $(date +%s) - START )) s"
+
+[ "$FAILED" -eq 0 ] && [ "$DONE" -eq "$i" ]
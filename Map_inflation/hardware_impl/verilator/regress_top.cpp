@@ -0,0 +1,214 @@
+// Randomised regression of the Verilator model of top.v against the reference inflation of
+// software_impl/inflation_random.c. Every seed is one case : random frame geometry, radius, kernel
+// parameters, mode, border policy and s_axis / m_axis duty cycles, then a few maps streamed back to
+// back from reset. A map is a frame cut out of a generate_random_cluttered_costmap() map, away from
+// its edges : the cells around the frame are overwritten with its border (zeros or the replicated
+// edge cells), so map_inflation_compute() over the whole map gives the results of the frame.
+//   - inflation : within KGEN_TOLERANCE of map_inflation_compute() (the kernel of kernel_gen.sv
+//     follows the float one of kernel_compute()),
+//   - convolution : exactly the weighted sum of the same window with the kernel of kernel_gen.c,
+//     saturated to a byte.
+// Builds with several engines are regressed as well (their costs come packed, see top_driver.h).
+//
+//   ./obj_regress_top/regress_top --first 1 --count 200
+//
+// One line per failing case (FAIL seed ...), with the settings to replay it, and a summary line.
+// regress.sh runs one instance per core on consecutive seed ranges.
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "top_driver.h"
+
+#include "inflation_random.h"
+extern "C" {
+#include "kernel_gen.h"
+}
+
+constexpr int KGEN_TOLERANCE = 2;   // 253 vs 254 * exp, truncation, distance near the inscribed radius
+constexpr int MAX_FRAME_W    = 96;
+constexpr int MAX_FRAME_H    = 48;
+
+struct Case {
+    RunConfig cfg;
+    int       frames   = 1;
+    int       clusters = 1;
+};
+
+static Case random_case(uint64_t seed, int array_size)
+{
+    static const double duties[]      = {1.0, 0.8, 0.5, 0.2};
+    static const double resolutions[] = {0.025, 0.05, 0.1};
+    std::mt19937_64 rng(seed);
+    Case c;
+    const int radius = static_cast<int>(rng() % ((array_size - 1) / 2 + 1));
+
+    c.cfg.radius     = radius;
+    c.cfg.width      = 1 + static_cast<int>(rng() % std::min(MAX_FRAME_W, W - 2 * radius));
+    c.cfg.height     = 1 + static_cast<int>(rng() % std::min(MAX_FRAME_H, H - 2 * radius));
+    c.cfg.inflation  = (rng() % 4) != 0;
+    c.cfg.replicate  = (rng() % 2) != 0;
+    c.cfg.scale      = KGEN_FIXED(0.25f + static_cast<float>(rng() % 1000) / 100.0f);
+    c.cfg.inscribed  = KGEN_FIXED(static_cast<float>(rng() % 400) / 1000.0f);
+    c.cfg.resolution = KGEN_FIXED(static_cast<float>(resolutions[rng() % 3]));
+    c.cfg.in_duty    = duties[rng() % 4];
+    c.cfg.out_duty   = duties[rng() % 4];
+    c.frames         = 1 + static_cast<int>(rng() % 3);
+    c.clusters       = 1 + W * H / 200;
+    return c;
+}
+
+// Frame of the reference map : the cells at (radius, radius) in it. Everything else in the map becomes
+// the border of the frame, so the reference gives the frame results for both border policies.
+static std::vector<uint8_t> cut_frame(int costmap[H][W], const RunConfig &cfg)
+{
+    const int r = cfg.radius;
+    std::vector<uint8_t> frame(static_cast<size_t>(cfg.width) * cfg.height);
+
+    for (int y = 0; y < cfg.height; y++)
+        for (int x = 0; x < cfg.width; x++)
+            frame[static_cast<size_t>(y) * cfg.width + x] = static_cast<uint8_t>(costmap[y + r][x + r]);
+
+    for (int y = 0; y < H; y++)
+        for (int x = 0; x < W; x++) {
+            int fx = x - r, fy = y - r;
+            if (fx >= 0 && fx < cfg.width && fy >= 0 && fy < cfg.height)
+                continue;
+            fx = std::min(std::max(fx, 0), cfg.width - 1);
+            fy = std::min(std::max(fy, 0), cfg.height - 1);
+            costmap[y][x] = cfg.replicate ? frame[static_cast<size_t>(fy) * cfg.width + fx] : 0;
+        }
+    return frame;
+}
+
+// Convolution of the frame (map_inflation_compute() has the inflation only) : weighted sum of the
+// window around every cell, border included, saturated to a byte
+static void convolve(int costmap[H][W], const RunConfig &cfg, const std::vector<uint8_t> &kernel,
+                     std::vector<uint32_t> &expected)
+{
+    const int r = cfg.radius;
+    const int k = 2 * r + 1;
+
+    for (int y = 0; y < cfg.height; y++)
+        for (int x = 0; x < cfg.width; x++) {
+            uint32_t sum = 0;
+            for (int dy = -r; dy <= r; dy++)
+                for (int dx = -r; dx <= r; dx++)
+                    sum += static_cast<uint32_t>(costmap[y + r + dy][x + r + dx]) * kernel[(dy + r) * k + dx + r];
+            expected[static_cast<size_t>(y) * cfg.width + x] = std::min<uint32_t>(sum, 255);
+        }
+}
+
+static void usage(const char *prog)
+{
+    std::fprintf(stderr, "usage: %s [--first S] [--count N] [--verbose]\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t first   = 1;
+    uint64_t count   = 100;
+    bool     verbose = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--verbose")
+            verbose = true;
+        else if (arg == "--first" && i + 1 < argc)
+            first = std::strtoull(argv[++i], nullptr, 0);
+        else if (arg == "--count" && i + 1 < argc)
+            count = std::strtoull(argv[++i], nullptr, 0);
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    int      failures = 0;
+    uint64_t cells    = 0;
+
+    for (uint64_t seed = first; seed < first + count; seed++) {
+        TopDriver dut(seed);
+        dut.reset();
+
+        uint32_t config     = dut.read(regs::CONFIG);
+        int      array_size = config & 0xFF;
+
+        Case       c   = random_case(seed, array_size);
+        RunConfig &cfg = c.cfg;
+        int        k   = 2 * cfg.radius + 1;
+
+        // reference maps : the frame streamed to the DUT, the map around it holding its border
+        static int   costmap[H][W];
+        static float inflated[H][W];
+        std::vector<std::vector<uint8_t>>  maps;
+        std::vector<std::vector<uint32_t>> expected(c.frames,
+                                                    std::vector<uint32_t>(static_cast<size_t>(cfg.width) * cfg.height));
+        std::vector<uint8_t> kernel(static_cast<size_t>(k) * k);
+        kgen_kernel(cfg.radius, cfg.scale, cfg.inscribed, cfg.resolution, kernel.data());
+
+        srand(static_cast<unsigned>(seed));
+        for (int f = 0; f < c.frames; f++) {
+            generate_random_cluttered_costmap(costmap, c.clusters, 3);
+            maps.push_back(cut_frame(costmap, cfg));
+            if (!cfg.inflation) {
+                convolve(costmap, cfg, kernel, expected[f]);
+                continue;
+            }
+            map_inflation_compute(costmap, cfg.scale / 65536.0f, cfg.radius, cfg.inscribed / 65536.0f,
+                                  cfg.resolution / 65536.0f, inflated);
+            for (int y = 0; y < cfg.height; y++)
+                for (int x = 0; x < cfg.width; x++)
+                    expected[f][static_cast<size_t>(y) * cfg.width + x] =
+                        static_cast<uint32_t>(std::lround(inflated[y + cfg.radius][x + cfg.radius]));
+        }
+
+        std::vector<std::vector<uint32_t>> results;
+        int  mismatches = 0;
+        bool loaded     = dut.configure(cfg);
+        RunStats stats;
+        if (loaded)
+            stats = dut.run(cfg, maps, results);
+
+        const int tolerance = cfg.inflation ? KGEN_TOLERANCE : 0;
+        for (int f = 0; loaded && f < c.frames; f++) {
+            if (results[f].size() != expected[f].size()) {
+                mismatches++;
+                if (verbose)
+                    std::printf("  frame %d : %zu results, expected %zu\n", f, results[f].size(), expected[f].size());
+                continue;
+            }
+            for (size_t i = 0; i < expected[f].size(); i++) {
+                uint32_t result = results[f][i];
+                if (std::abs(static_cast<int>(result) - static_cast<int>(expected[f][i])) > tolerance) {
+                    if (verbose && mismatches < 8)
+                        std::printf("  frame %d cell (%zu, %zu) : %u, expected %u\n", f, i % cfg.width,
+                                    i / cfg.width, result, expected[f][i]);
+                    mismatches++;
+                }
+            }
+            cells += expected[f].size();
+        }
+
+        if (!loaded || mismatches || stats.errors) {
+            failures++;
+            std::printf("FAIL seed %llu : %dx%d, %d frames, radius %d, %s, %s border, scale 0x%08X inscribed 0x%08X "
+                        "resolution 0x%08X, duty %.1f/%.1f : %s%d mismatches, %d framing errors\n",
+                        static_cast<unsigned long long>(seed), cfg.width, cfg.height, c.frames, cfg.radius,
+                        cfg.inflation ? "inflation" : "convolution", cfg.replicate ? "replicated" : "zero",
+                        cfg.scale, cfg.inscribed, cfg.resolution, cfg.in_duty, cfg.out_duty,
+                        loaded ? "" : "kernel not loaded, ", mismatches, stats.errors);
+        }
+        else if (verbose)
+            std::printf("pass seed %llu : %dx%d, %d frames, radius %d, %llu cycles\n",
+                        static_cast<unsigned long long>(seed), cfg.width, cfg.height, c.frames, cfg.radius,
+                        static_cast<unsigned long long>(stats.cycles));
+    }
+
+    std::printf("seeds %llu..%llu : %llu cases, %llu cells, %d failures\n", static_cast<unsigned long long>(first),
+                static_cast<unsigned long long>(first + count - 1), static_cast<unsigned long long>(count),
+                static_cast<unsigned long long>(cells), failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,365 @@
+// Cycle accurate driver of the Verilator model of top.v : clock and reset, AXI4-Lite register
+// accesses, and whole frames streamed through s_axis / m_axis with random valid / ready duty cycles.
+// The maps are sent unpadded (MODE bit4, the border is generated on chip) as back-to-back frames
+// (MODE bit3, start of frame on s_axis_tuser[0], end on s_axis_tlast), so every frame gives
+// FRAME_WIDTH x FRAME_HEIGHT results : one per m_axis transfer, or BUS_WIDTH/8 one byte costs per
+// transfer in a build with several engines (CONFIG.NUM_ENGINES > 1), unpacked here.
+#ifndef TOP_DRIVER_H
+#define TOP_DRIVER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "Vtop.h"
+#include "verilated.h"
+
+// Register map (see axim_reg.sv)
+namespace regs {
+constexpr uint32_t CTRL             = 0x00;
+constexpr uint32_t STATUS           = 0x04;
+constexpr uint32_t FRAME_WIDTH      = 0x08;
+constexpr uint32_t FRAME_HEIGHT     = 0x0C;
+constexpr uint32_t RADIUS           = 0x10;
+constexpr uint32_t MODE             = 0x14;
+constexpr uint32_t CONFIG           = 0x24;
+constexpr uint32_t KGEN_SCALE       = 0x28;
+constexpr uint32_t KGEN_INSCRIBED   = 0x2C;
+constexpr uint32_t KGEN_RESOLUTION  = 0x30;
+constexpr uint32_t PERF_CYCLES      = 0x40;
+constexpr uint32_t PERF_ACTIVE      = 0x44;
+constexpr uint32_t PERF_OUT_STALL   = 0x48;
+constexpr uint32_t PERF_IN_STARVED  = 0x4C;
+constexpr uint32_t PERF_WEIGHT_LOAD = 0x50;
+constexpr uint32_t PERF_XBAR_IDLE   = 0x54;
+
+constexpr uint32_t CTRL_START         = 1u << 0;
+constexpr uint32_t CTRL_STOP          = 1u << 1;
+constexpr uint32_t CTRL_PERF_SNAPSHOT = 1u << 2;
+constexpr uint32_t CTRL_PERF_CLEAR    = 1u << 3;
+constexpr uint32_t CTRL_KGEN_START    = 1u << 4;
+
+constexpr uint32_t STATUS_LOADING   = 1u << 2;
+constexpr uint32_t STATUS_KGEN_BUSY = 1u << 4;
+
+constexpr uint32_t MODE_INFLATION = 1u << 0;
+constexpr uint32_t MODE_STREAM    = 1u << 3;
+constexpr uint32_t MODE_BORDER    = 1u << 4;
+constexpr uint32_t MODE_REPLICATE = 1u << 5;
+}  // namespace regs
+
+constexpr int      BUS_BYTES    = 4;      // BUS_WIDTH = 32
+constexpr uint8_t  LETHAL       = 254;
+constexpr uint64_t STALL_LIMIT  = 200000; // cycles without any transfer before a run is declared hung
+
+// Kernel parameters (Q16.16, see kernel_gen.sv) and frame geometry of a run
+struct RunConfig {
+    int      width      = 64;
+    int      height     = 64;
+    int      radius     = 3;
+    bool     inflation  = true;     // MODE bit0 : max of the weights of the lethal neighbours
+    bool     replicate  = false;    // MODE bit5 : border of repeated edge cells instead of zeros
+    uint32_t scale      = 0x000A0000;   // 10.0
+    uint32_t inscribed  = 0x00001999;   // 0.1 m
+    uint32_t resolution = 0x00000CCD;   // 0.05 m
+    double   in_duty    = 1.0;      // probability of s_axis_tvalid on a free cycle
+    double   out_duty   = 1.0;      // probability of m_axis_tready on a cycle
+};
+
+// Results of a run
+struct RunStats {
+    uint64_t cycles         = 0;    // first input transfer to the last output transfer
+    uint64_t in_beats       = 0;
+    uint64_t out_cells      = 0;
+    uint64_t first_latency  = 0;    // start of the first frame in -> its first result out
+    uint64_t frame_latency  = 0;    // start of frame in -> last result out, sum over the frames
+    uint32_t perf_cycles    = 0;    // hardware counters (PERF_*), snapshot at the end of the run
+    uint32_t perf_active    = 0;
+    uint32_t perf_out_stall = 0;
+    uint32_t perf_in_starved = 0;
+    uint32_t perf_xbar_idle = 0;
+    int      errors         = 0;    // framing errors (tuser / tlast), hangs
+};
+
+// Cluttered costmap of generate_random_cluttered_costmap() (inflation_random.c) : round clusters
+// of lethal cells on free space
+inline std::vector<uint8_t> cluttered_map(int width, int height, int num_clusters, int max_radius,
+                                          std::mt19937_64 &rng)
+{
+    std::vector<uint8_t> map(static_cast<size_t>(width) * height, 0);
+
+    for (int c = 0; c < num_clusters; c++) {
+        int cx     = static_cast<int>(rng() % width);
+        int cy     = static_cast<int>(rng() % height);
+        int radius = 1 + static_cast<int>(rng() % max_radius);
+
+        for (int dy = -radius; dy <= radius; dy++)
+            for (int dx = -radius; dx <= radius; dx++) {
+                int nx = cx + dx;
+                int ny = cy + dy;
+                if (dx * dx + dy * dy <= radius * radius && nx >= 0 && nx < width && ny >= 0 && ny < height)
+                    map[static_cast<size_t>(ny) * width + nx] = LETHAL;
+            }
+    }
+    return map;
+}
+
+class TopDriver {
+public:
+    // argc / argv : simulator plusargs (+trace for the handshake monitors of trace_bind.sv)
+    explicit TopDriver(uint64_t seed, int argc = 0, char **argv = nullptr)
+        : ctx_(new VerilatedContext), rng_(seed)
+    {
+        ctx_->randSeed(static_cast<int>(seed));
+        if (argv)
+            ctx_->commandArgs(argc, argv);
+        top_.reset(new Vtop(ctx_.get()));
+        top_->clk = 0;
+        top_->core_clk = 0;
+        top_->rstn = 0;
+        idle_inputs();
+        top_->eval();
+    }
+
+    ~TopDriver() { top_->final(); }
+
+    Vtop &top() { return *top_; }
+    uint64_t cycle() const { return cycle_; }
+
+    // one clk cycle (core_clk runs with clk, DUAL_CLOCK = 0 or a 1:1 ratio)
+    void tick()
+    {
+        top_->clk = 1;
+        top_->core_clk = 1;
+        top_->eval();
+        top_->clk = 0;
+        top_->core_clk = 0;
+        top_->eval();
+        cycle_++;
+    }
+
+    void reset()
+    {
+        top_->rstn = 0;
+        for (int i = 0; i < 10; i++)
+            tick();
+        top_->rstn = 1;
+        for (int i = 0; i < 5; i++)
+            tick();
+    }
+
+    // AXI4-Lite write : address and data together, then the response
+    void write(uint32_t addr, uint32_t data)
+    {
+        top_->s_axi_awaddr  = addr;
+        top_->s_axi_awvalid = 1;
+        top_->s_axi_wdata   = data;
+        top_->s_axi_wstrb   = 0xF;
+        top_->s_axi_wvalid  = 1;
+        top_->s_axi_bready  = 1;
+        top_->eval();
+        while (!top_->s_axi_awready) {
+            tick();
+            top_->eval();
+        }
+        tick();
+        top_->s_axi_awvalid = 0;
+        top_->s_axi_wvalid  = 0;
+        top_->eval();
+        while (!top_->s_axi_bvalid) {
+            tick();
+            top_->eval();
+        }
+        tick();
+        top_->s_axi_bready = 0;
+    }
+
+    uint32_t read(uint32_t addr)
+    {
+        top_->s_axi_araddr  = addr;
+        top_->s_axi_arvalid = 1;
+        top_->s_axi_rready  = 1;
+        top_->eval();
+        while (!top_->s_axi_arready) {
+            tick();
+            top_->eval();
+        }
+        tick();
+        top_->s_axi_arvalid = 0;
+        top_->eval();
+        while (!top_->s_axi_rvalid) {
+            tick();
+            top_->eval();
+        }
+        uint32_t data = top_->s_axi_rdata;
+        tick();
+        top_->s_axi_rready = 0;
+        return data;
+    }
+
+    // Frame geometry, mode and the kernel computed on chip, then START
+    bool configure(const RunConfig &cfg)
+    {
+        write(regs::RADIUS, cfg.radius);
+        write(regs::FRAME_WIDTH, cfg.width);
+        write(regs::FRAME_HEIGHT, cfg.height);
+        write(regs::MODE, (cfg.inflation ? regs::MODE_INFLATION : 0) | (cfg.replicate ? regs::MODE_REPLICATE : 0) |
+                              regs::MODE_STREAM | regs::MODE_BORDER);
+        write(regs::KGEN_SCALE, cfg.scale);
+        write(regs::KGEN_INSCRIBED, cfg.inscribed);
+        write(regs::KGEN_RESOLUTION, cfg.resolution);
+        write(regs::CTRL, regs::CTRL_KGEN_START);
+
+        uint64_t start = cycle_;
+        while (read(regs::STATUS) & (regs::STATUS_KGEN_BUSY | regs::STATUS_LOADING)) {
+            if (cycle_ - start > STALL_LIMIT)
+                return false;
+        }
+        write(regs::CTRL, regs::CTRL_START | regs::CTRL_PERF_CLEAR);
+        return true;
+    }
+
+    // Streams the maps as back-to-back frames and collects their results (one vector per frame)
+    RunStats run(const RunConfig &cfg, const std::vector<std::vector<uint8_t>> &maps,
+                 std::vector<std::vector<uint32_t>> &results)
+    {
+        RunStats stats;
+        const bool   packed      = ((read(regs::CONFIG) >> 8) & 0xFF) > 1;   // costs packed by the stripe merger
+        std::uniform_real_distribution<double> coin(0.0, 1.0);
+        const int    row_beats   = (cfg.width + BUS_BYTES - 1) / BUS_BYTES;
+        const size_t frame_beats = static_cast<size_t>(row_beats) * cfg.height;
+        const size_t frame_cells = static_cast<size_t>(cfg.width) * cfg.height;
+
+        results.assign(maps.size(), std::vector<uint32_t>());
+
+        size_t   in_frame = 0, in_beat = 0;      // next input transfer
+        size_t   out_frame = 0;
+        bool     in_valid = false;
+        uint64_t first_in = 0, last_fire = cycle_;
+        std::vector<uint64_t> sof_cycle(maps.size(), 0);
+
+        while (out_frame < maps.size()) {
+            // next input beat : every row starts on a new beat, first cell in the MSBs
+            if (!in_valid && in_frame < maps.size() && coin(rng_) < cfg.in_duty) {
+                const std::vector<uint8_t> &map = maps[in_frame];
+                int row = static_cast<int>(in_beat / row_beats);
+                int col = static_cast<int>(in_beat % row_beats) * BUS_BYTES;
+                uint32_t data = 0;
+                for (int i = 0; i < BUS_BYTES; i++) {
+                    uint8_t cell = (col + i < cfg.width) ? map[static_cast<size_t>(row) * cfg.width + col + i] : 0;
+                    data |= static_cast<uint32_t>(cell) << (8 * (BUS_BYTES - 1 - i));
+                }
+                top_->s_axis_tdata  = data;
+                top_->s_axis_tuser  = (in_beat == 0) ? (((in_frame & 0xF) << 1) | 1) : 0;
+                top_->s_axis_tlast  = (in_beat == frame_beats - 1);
+                in_valid = true;
+            }
+            top_->s_axis_tvalid = in_valid;
+            top_->m_axis_tready = coin(rng_) < cfg.out_duty;
+            top_->eval();
+
+            bool in_fire  = in_valid && top_->s_axis_tready;
+            bool out_fire = top_->m_axis_tvalid && top_->m_axis_tready;
+
+            if (in_fire) {
+                if (stats.in_beats == 0)
+                    first_in = cycle_;
+                if (in_beat == 0)
+                    sof_cycle[in_frame] = cycle_;
+                stats.in_beats++;
+                in_valid = false;
+                if (++in_beat == frame_beats) {
+                    in_beat = 0;
+                    in_frame++;
+                }
+            }
+
+            if (out_fire) {
+                std::vector<uint32_t> &frame = results[out_frame];
+                bool   sof   = top_->m_axis_tuser & 1;
+                bool   last  = top_->m_axis_tlast;
+                size_t cells = packed ? std::min<size_t>(BUS_BYTES, frame_cells - frame.size()) : 1;
+
+                if (sof != frame.empty() || last != (frame.size() + cells == frame_cells)) {
+                    std::fprintf(stderr, "frame %zu cell %zu : sof %d last %d\n", out_frame, frame.size(), sof, last);
+                    stats.errors++;
+                }
+                if (stats.out_cells == 0)
+                    stats.first_latency = cycle_ - sof_cycle[0];
+                if (packed) {
+                    for (size_t i = 0; i < cells; i++)
+                        frame.push_back((top_->m_axis_tdata >> (8 * i)) & 0xFF);
+                } else
+                    frame.push_back(top_->m_axis_tdata);
+                stats.out_cells += cells;
+                if (last || frame.size() == frame_cells) {
+                    stats.frame_latency += cycle_ - sof_cycle[out_frame];
+                    out_frame++;
+                }
+            }
+
+            if (in_fire || out_fire)
+                last_fire = cycle_;
+            else if (cycle_ - last_fire > STALL_LIMIT) {
+                std::fprintf(stderr, "no transfer for %llu cycles (frame %zu in, %zu out)\n",
+                             static_cast<unsigned long long>(STALL_LIMIT), in_frame, out_frame);
+                stats.errors++;
+                break;
+            }
+            tick();
+        }
+
+        top_->s_axis_tvalid = 0;
+        top_->m_axis_tready = 0;
+        stats.cycles = cycle_ - first_in;
+
+        write(regs::CTRL, regs::CTRL_PERF_SNAPSHOT);
+        stats.perf_cycles     = read(regs::PERF_CYCLES);
+        stats.perf_active     = read(regs::PERF_ACTIVE);
+        stats.perf_out_stall  = read(regs::PERF_OUT_STALL);
+        stats.perf_in_starved = read(regs::PERF_IN_STARVED);
+        stats.perf_xbar_idle  = read(regs::PERF_XBAR_IDLE);
+        write(regs::CTRL, regs::CTRL_STOP);
+        return stats;
+    }
+
+private:
+    void idle_inputs()
+    {
+        top_->s_axi_awaddr = 0;
+        top_->s_axi_awvalid = 0;
+        top_->s_axi_wdata = 0;
+        top_->s_axi_wstrb = 0;
+        top_->s_axi_wvalid = 0;
+        top_->s_axi_bready = 0;
+        top_->s_axi_araddr = 0;
+        top_->s_axi_arvalid = 0;
+        top_->s_axi_rready = 0;
+        top_->m_axi_arready = 0;
+        top_->m_axi_rdata = 0;
+        top_->m_axi_rresp = 0;
+        top_->m_axi_rlast = 0;
+        top_->m_axi_rvalid = 0;
+        top_->m_axi_awready = 0;
+        top_->m_axi_wready = 0;
+        top_->m_axi_bresp = 0;
+        top_->m_axi_bvalid = 0;
+        top_->s_axis_wgt_tdata = 0;
+        top_->s_axis_wgt_tvalid = 0;
+        top_->s_axis_tdata = 0;
+        top_->s_axis_tuser = 0;
+        top_->s_axis_tlast = 0;
+        top_->s_axis_tvalid = 0;
+        top_->m_axis_tready = 0;
+    }
+
+    std::unique_ptr<VerilatedContext> ctx_;
+    std::unique_ptr<Vtop>             top_;
+    std::mt19937_64                   rng_;
+    uint64_t                          cycle_ = 0;
+};
+
+#endif  // TOP_DRIVER_H
@@ -1,35 +1,58 @@
 `timescale 1ns/1ps
 
 module weight_loader #(
-    parameter KERNEL_SIZE  = 16,
+    parameter KERNEL_SIZE  = 16,  // size of the synthesized (maximum) PE array
     parameter WEIGHT_WIDTH = 8,
     parameter BUS_WIDTH    = 32
 )(
     input  clk,
     input  rstn,
-    
-    // AXI Stream Slave Interface (Weight input)
+
+    // Runtime kernel size (1..KERNEL_SIZE): only cfg_kernel_size * cfg_kernel_size weights are streamed.
+    // It is sampled on the first transfer of each load and travels with the weights it was loaded for.
+    input  [$clog2(KERNEL_SIZE + 1) - 1 : 0] cfg_kernel_size,
+
+    // AXI Stream Slave Interface (Weight input after reset, shared with the data stream)
     input  [BUS_WIDTH - 1 : 0]  s_axis_tdata,
     input                       s_axis_tvalid,
     output                      s_axis_tready,
-    
-    // Weight output interface
+
+    // AXI Stream Slave Interface (side channel : loads the shadow bank while the data stream is running)
+    input  [BUS_WIDTH - 1 : 0]  s_axis_wgt_tdata,
+    input                       s_axis_wgt_tvalid,
+    output                      s_axis_wgt_tready,
+
+    // Shadow bank -> active bank swap : one cycle pulse when a frame starts with no other frame in
+    // flight (top.v pipe_start), the first line of that frame meets the new bank
+    input                       frame_boundary,
+
+    // Weight output interface : weight of PE(r,c) is at index (r*KERNEL_SIZE + c)
     output [(WEIGHT_WIDTH * KERNEL_SIZE * KERNEL_SIZE) - 1 : 0] weights_out,
-    
+    output reg [$clog2(KERNEL_SIZE + 1) - 1 : 0] kernel_size_out, // kernel size the active bank was loaded for
+
     // Status outputs
-    output loading     // High during when weight are Currently loading
+    output loading,       // High during when weight are Currently loading
+    output shadow_pending // High when a complete shadow bank waits for the next frame boundary
 );
 
     // Local Parameters
-    localparam REQUIRED_BITS  = KERNEL_SIZE * KERNEL_SIZE * WEIGHT_WIDTH; // this is the total number of bits required for the entire weigths_out signal
-    localparam NUM_TRANSFERS  = (REQUIRED_BITS + BUS_WIDTH - 1) / BUS_WIDTH; // Calculate how many full transfers we need (Rounding Up)
-    localparam PADDED_SIZE    = NUM_TRANSFERS * BUS_WIDTH;  // this is the total number of bits send after all the transfer done
+    localparam NUM_WEIGHTS    = KERNEL_SIZE * KERNEL_SIZE;
+    localparam LANES          = BUS_WIDTH / WEIGHT_WIDTH; // number of weights carried by one transfer
     /*localparam LOAD_WEIGHTS = 1'b0;
     localparam IDLE         = 1'b1;*/
 
     // Internal Signals
-    reg [PADDED_SIZE - 1 : 0] weight_storage;
-    integer transfer_counter; //to count the number of transfer done
+    // The weight banks are laid out like the PE array, so a kernel smaller than KERNEL_SIZE only fills
+    // its top-left corner and the unused PEs keep a zero weight.
+    reg [WEIGHT_WIDTH - 1 : 0] weight_bank [0 : NUM_WEIGHTS - 1];   // active bank, seen by the PEs
+    reg [WEIGHT_WIDTH - 1 : 0] shadow_bank [0 : NUM_WEIGHTS - 1];   // next bank, filled by the side channel
+    reg [$clog2(KERNEL_SIZE + 1) - 1 : 0] shadow_kernel_size;
+    reg shadow_full;
+    reg [$clog2(KERNEL_SIZE + 1) - 1 : 0] wr_row; // kernel row of the first weight of the next transfer
+    reg [$clog2(KERNEL_SIZE + 1) - 1 : 0] wr_col; // kernel column of the first weight of the next transfer
+    reg [$clog2(KERNEL_SIZE + 1) - 1 : 0] load_kernel_size; // kernel size sampled on the first transfer
+    integer l, n;
+    integer lane_row, lane_col;
     //reg state;
 
     // State definition
@@ -39,38 +62,105 @@ module weight_loader #(
     // FSM State Outputs
     assign loading = (state == LOAD_WEIGHTS); // the loading is high as far as we are in the LOAD WEIGHTs state, otherwise, it goes low.
     assign s_axis_tready = loading;  // Only accept data when loading
-    //assign weights_out = weight_storage[REQUIRED_BITS - 1 : 0]; // Slice only the required bits for the output, ignoring the padding at the top
-    assign weights_out = weight_storage[PADDED_SIZE - 1 : PADDED_SIZE - REQUIRED_BITS];
+    assign s_axis_wgt_tready = !loading && !shadow_full; // the shadow bank is busy until it is swapped in
+    assign shadow_pending = shadow_full;
+
+    // One loader serves both banks : the data stream after reset, the side channel afterwards
+    wire                     ld_fire  = loading ? (s_axis_tvalid && s_axis_tready) : (s_axis_wgt_tvalid && s_axis_wgt_tready);
+    wire [BUS_WIDTH - 1 : 0] ld_tdata = loading ? s_axis_tdata : s_axis_wgt_tdata;
+    wire [$clog2(KERNEL_SIZE + 1) - 1 : 0] ld_kernel_size = (wr_row == 0 && wr_col == 0) ? cfg_kernel_size : load_kernel_size;
+
+    genvar b;
+    generate
+        for (b = 0; b < NUM_WEIGHTS; b = b + 1) begin
+            assign weights_out[b*WEIGHT_WIDTH +: WEIGHT_WIDTH] = weight_bank[b];
+        end
+    endgenerate
 
     // Weight Loading FSM
     always @(posedge clk) begin
         if (!rstn) begin
             state <= LOAD_WEIGHTS;
-            transfer_counter <= 0;
-            weight_storage <= {PADDED_SIZE{1'b0}};
+            wr_row <= 0;
+            wr_col <= 0;
+            load_kernel_size <= KERNEL_SIZE;
+            kernel_size_out <= KERNEL_SIZE;
+            shadow_kernel_size <= KERNEL_SIZE;
+            shadow_full <= 1'b0;
+            for (n = 0; n < NUM_WEIGHTS; n = n + 1) begin
+                weight_bank[n] <= {WEIGHT_WIDTH{1'b0}};
+                shadow_bank[n] <= {WEIGHT_WIDTH{1'b0}};
+            end
         end else begin
-            
+
+            if (ld_fire) begin
+                load_kernel_size <= ld_kernel_size;
+
+                // A new load starts from a clean bank, so the PEs outside a smaller kernel get a zero weight
+                if (wr_row == 0 && wr_col == 0) begin
+                    for (n = 0; n < NUM_WEIGHTS; n = n + 1) begin
+                        if (loading)
+                            weight_bank[n] <= {WEIGHT_WIDTH{1'b0}};
+                        else
+                            shadow_bank[n] <= {WEIGHT_WIDTH{1'b0}};
+                    end
+                end
+
+                // Scatter the weights of this transfer (MSB first) into the bank,
+                // walking the ld_kernel_size x ld_kernel_size kernel in row-major order
+                lane_row = wr_row;
+                lane_col = wr_col;
+                for (l = 0; l < LANES; l = l + 1) begin
+                    if (lane_row < ld_kernel_size) begin
+                        if (loading)
+                            weight_bank[lane_row*KERNEL_SIZE + lane_col] <= ld_tdata[BUS_WIDTH - 1 - l*WEIGHT_WIDTH -: WEIGHT_WIDTH];
+                        else
+                            shadow_bank[lane_row*KERNEL_SIZE + lane_col] <= ld_tdata[BUS_WIDTH - 1 - l*WEIGHT_WIDTH -: WEIGHT_WIDTH];
+                    end
+                    if (lane_col == ld_kernel_size - 1) begin
+                        lane_col = 0;
+                        lane_row = lane_row + 1;
+                    end else begin
+                        lane_col = lane_col + 1;
+                    end
+                end
+
+                // Check if all weights loaded (the padding of the last transfer is dropped)
+                if (lane_row >= ld_kernel_size) begin
+                    wr_row <= 0;
+                    wr_col <= 0;
+                    if (loading)
+                        kernel_size_out <= ld_kernel_size;
+                    else begin
+                        shadow_kernel_size <= ld_kernel_size;
+                        shadow_full <= 1'b1;
+                    end
+                end else begin
+                    wr_row <= lane_row;
+                    wr_col <= lane_col;
+                end
+            end
+
+            // Atomic swap : the whole bank and its kernel size change on the same clock edge
+            else if (shadow_full && frame_boundary) begin
+                for (n = 0; n < NUM_WEIGHTS; n = n + 1)
+                    weight_bank[n] <= shadow_bank[n];
+                kernel_size_out <= shadow_kernel_size;
+                shadow_full <= 1'b0;
+            end
+
             case (state)
                 LOAD_WEIGHTS: begin
-                    if (s_axis_tvalid && s_axis_tready) begin
-
-                        // Shift the whole register and insert new data at the bottom
-                        weight_storage <= {weight_storage[PADDED_SIZE-BUS_WIDTH-1 : 0], s_axis_tdata};
-                        // Check if all weights loaded
-                        if (transfer_counter == NUM_TRANSFERS - 1) begin
-                            state <= IDLE;
-                            transfer_counter <= 0;
-                        end else begin
-                            transfer_counter <= transfer_counter + 1;
-                        end
-                    end
+                    // Leave once the last transfer of the first kernel is in
+                    if (ld_fire && lane_row >= ld_kernel_size)
+                        state <= IDLE;
                 end
-                
+
                 IDLE: begin
-                    // Stay idle after loading completes
+                    // Later kernels only go through the shadow bank
                     state <= IDLE;
                 end
-                
+
                 default: state <= LOAD_WEIGHTS;
             endcase
         end
@@ -0,0 +1,191 @@
+`timescale 1ns/1ps
+
+// One window engine : input FIFO, row serializer, 2-D window generator and PE array, one result
+// per cell of its run. engine_core.v runs the frame on one engine (one run per frame) or cuts it
+// into column stripes for NUM_ENGINES of them (stripe_dispatcher.sv), one run per frame either way.
+// Every run comes with a descriptor : input rows of the run and the borders to generate above /
+// below them, the columns of the engine and its left / right border are set by the cfg_ inputs.
+// A run starts on the window generator as soon as the previous one has stepped its last position,
+// the windows of both may be in the PE array together. m_axis_tlast marks the last result of a run.
+module window_engine #(
+    parameter KERNEL_SIZE  = 3,    // size of the synthesized (maximum) PE array
+    parameter DATA_WIDTH   = 8,
+    parameter WEIGHT_WIDTH = 8,
+    parameter DEPTH        = 4,    // input FIFO depth (words)
+    parameter PTR_WIDTH    = 2,    // clog2(DEPTH)
+    parameter FIFO_MEMORY  = "srl",
+    parameter BUS_WIDTH    = 32,   // input word : BUS_WIDTH/8 cells
+    parameter MAX_WIDTH    = 2048, // longest input row (line buffers of window_gen.sv)
+    parameter USE_DSP_ROWS = 0,    // PE array rows on DSP48 cascades (dsp_row.v)
+    parameter DSP_PACK     = 0
+)(
+    input  clk,
+    input  rstn,
+    input  abort,                  // drops the runs and the words in the engine
+
+    // Configuration, shared by all the engines
+    input  [15 : 0]             cfg_in_width,    // cells per input row of the engine
+    input  [$clog2(BUS_WIDTH / DATA_WIDTH + 1) - 1 : 0] cfg_in_skip,   // cells ahead of them in the first word of a row
+    input                       cfg_border_left, // generate the border left of the first column
+    input                       cfg_border_right,
+    input                       cfg_replicate,
+    input  [$clog2(KERNEL_SIZE + 1) - 1 : 0] cfg_kernel_size,
+    input                       cfg_mode,
+    input  [(WEIGHT_WIDTH * KERNEL_SIZE * KERNEL_SIZE) - 1 : 0] weightsIn,
+
+    // Run descriptor
+    input  [15 : 0]             desc_rows,           // input rows of the run
+    input                       desc_border_top,     // generate the border above the first row
+    input                       desc_border_bottom,  // generate the border below the last row
+    input                       desc_valid,
+    output                      desc_ready,
+
+    // AXI Stream Slave Interface (input rows, every row starts on a new word, first cell in the MSBs)
+    input  [BUS_WIDTH - 1 : 0]  s_axis_tdata,
+    input                       s_axis_tvalid,
+    output                      s_axis_tready,
+
+    // AXI Stream Master Interface (one result per cell)
+    output [(DATA_WIDTH + WEIGHT_WIDTH + $clog2(KERNEL_SIZE * KERNEL_SIZE)) - 1 : 0] m_axis_tdata,
+    output                      m_axis_tlast,   // last result of the run
+    output                      m_axis_tvalid,
+    input                       m_axis_tready,
+
+    // Status
+    output                      busy,           // a word, a run or a result is still in the engine
+    output                      step,           // window position stepped (performance counter event)
+    output                      step_idle,      // ... without a result (border or halo position)
+    output [PTR_WIDTH : 0]      fifo_level
+);
+
+    localparam WINDOW_WIDTH = KERNEL_SIZE * KERNEL_SIZE * DATA_WIDTH;
+
+    // Input FIFO -> serializer
+    wire [BUS_WIDTH - 1 : 0]  word_tdata;
+    wire                      word_tvalid;
+    wire                      word_tready;
+
+    // Serializer -> window generator
+    wire [DATA_WIDTH - 1 : 0] cell_tdata;
+    wire                      cell_tvalid;
+    wire                      cell_tready;
+    wire                      serializer_idle;
+
+    // Window generator -> PE array
+    wire [WINDOW_WIDTH - 1 : 0] win_tdata;
+    wire                      win_tlast;
+    wire                      win_tvalid;
+    wire                      win_tready;
+    wire                      window_busy;
+    wire                      pe_idle;
+
+    assign desc_ready = !window_busy && !abort;
+    assign busy       = (fifo_level != 0) || !serializer_idle || window_busy || win_tvalid || !pe_idle;
+
+    // 1. Input FIFO
+    fifo_fwft #(
+        .DATAWIDTH(BUS_WIDTH),
+        .DEPTH(DEPTH),
+        .PTR_WIDTH(PTR_WIDTH),
+        .MEMORY_TYPE(FIFO_MEMORY)
+    ) in_fifo (
+        .clk(clk),
+        .rstn(rstn && !abort),
+
+        .s_tvalid(s_axis_tvalid),
+        .s_tdata(s_axis_tdata),
+        .s_tready(s_axis_tready),
+
+        .m_tready(word_tready),
+        .m_tdata(word_tdata),
+        .m_tvalid(word_tvalid),
+
+        .prog_full_thresh(DEPTH),
+        .prog_empty_thresh({(PTR_WIDTH + 1){1'b0}}),
+        .almost_full(),
+        .almost_empty(),
+        .level(fifo_level)
+    );
+
+    // 2. Words -> cells
+    row_serializer #(
+        .DATA_WIDTH(DATA_WIDTH),
+        .BUS_WIDTH(BUS_WIDTH)
+    ) serializer_inst (
+        .clk(clk),
+        .rstn(rstn),
+        .clear(abort),
+        .cfg_width(cfg_in_width),
+        .cfg_skip(cfg_in_skip),
+
+        .s_axis_tdata(word_tdata),
+        .s_axis_tvalid(word_tvalid),
+        .s_axis_tready(word_tready),
+
+        .m_axis_tdata(cell_tdata),
+        .m_axis_tvalid(cell_tvalid),
+        .m_axis_tready(cell_tready),
+        .idle(serializer_idle)
+    );
+
+    // 3. Cells -> windows
+    window_gen #(
+        .KERNEL_SIZE(KERNEL_SIZE),
+        .DATA_WIDTH(DATA_WIDTH),
+        .MAX_WIDTH(MAX_WIDTH)
+    ) window_inst (
+        .clk(clk),
+        .rstn(rstn),
+        .start(desc_valid),
+        .abort(abort),
+        .busy(window_busy),
+
+        .cfg_kernel_size(cfg_kernel_size),
+        .cfg_in_width(cfg_in_width),
+        .cfg_in_height(desc_rows),
+        .cfg_border_left(cfg_border_left),
+        .cfg_border_right(cfg_border_right),
+        .cfg_border_top(desc_border_top),
+        .cfg_border_bottom(desc_border_bottom),
+        .cfg_replicate(cfg_replicate),
+
+        .s_axis_tdata(cell_tdata),
+        .s_axis_tvalid(cell_tvalid),
+        .s_axis_tready(cell_tready),
+
+        .m_axis_tdata(win_tdata),
+        .m_axis_tlast(win_tlast),
+        .m_axis_tvalid(win_tvalid),
+        .m_axis_tready(win_tready),
+
+        .step(step),
+        .step_idle(step_idle)
+    );
+
+    // 4. Windows -> results
+    pe_wrapper #(
+        .KERNEL_SIZE(KERNEL_SIZE),
+        .DATA_WIDTH(DATA_WIDTH),
+        .WEIGHT_WIDTH(WEIGHT_WIDTH),
+        .USE_DSP_ROWS(USE_DSP_ROWS),
+        .DSP_PACK(DSP_PACK)
+    ) pe_engine (
+        .clk(clk),
+        .rstn(rstn && !abort),
+        .cfg_kernel_size(cfg_kernel_size),
+        .cfg_mode(cfg_mode),
+        .weightsIn(weightsIn),  // the loader already orders the weights like the PE array
+
+        .s_axis_tdata(win_tdata),
+        .s_axis_tlast(win_tlast),
+        .s_axis_tvalid(win_tvalid),
+        .s_axis_tready(win_tready),
+
+        .m_axis_tready(m_axis_tready),
+        .m_axis_tdata(m_axis_tdata),
+        .m_axis_tlast(m_axis_tlast),
+        .m_axis_tvalid(m_axis_tvalid),
+        .idle(pe_idle)
+    );
+
+endmodule
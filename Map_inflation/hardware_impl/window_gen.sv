@@ -0,0 +1,246 @@
+`timescale 1ns/1ps
+
+// 2-D window generator of a window engine : the input rows come one cell per transfer, and every
+// position of the run gives the cfg_kernel_size x cfg_kernel_size window around one cell, so the PE
+// array sees the same centred window as map_inflation_compute() (inflation_random.c).
+//     - k - 1 line buffers (block RAM, MAX_WIDTH cells) hold the rows above the current one. They
+//       are cascaded : at column x, buffer r takes what buffer r + 1 held there, and the last one
+//       takes the new cell, so buffer r always holds row y - (k - 1) + r and no rotation is needed.
+//     - the window register W[r][c] (top-left k x k corner of KERNEL_SIZE x KERNEL_SIZE) shifts one
+//       column left per position, the column of the line buffers and the new cell enters at c = k - 1.
+//       Cell (r, c) is at dy = r - pad, dx = c - pad from the centre (pad = (k - 1) / 2), the
+//       weight of PE(r, c) in weight_loader.sv.
+//     - border (cfg_border_left / right / top / bottom) : the positions run pad columns past the
+//       end of every row and pad rows past the last one, the cells outside the input are
+//       zeros or, with cfg_replicate, the nearest edge cell. The rows above the first one are
+//       written into the line buffers with the first row, the rows below the last one are fed
+//       into them as zeros or copies of the last row, the columns left and right are filled in
+//       the window register.
+//     - without a border on a side, the input already holds the cells the windows need there
+//       (a pre-padded map, or the halo columns of a stripe) : the first window is emitted 2 * pad
+//       positions in instead of pad.
+// A run is started by start (ignored while busy, the configuration is sampled on it) and gives
+// one window per cell of (in_width + border) x (in_height + borders) - leads, m_axis_tlast on the last
+// one. The next run may start as soon as busy drops, while the last windows are still in the
+// pipeline. Every stage has its valid/ready : a stall on m_axis only holds the stages behind it.
+// The input rows must hold cfg_kernel_size cells at least without a left/right border.
+module window_gen #(
+    parameter KERNEL_SIZE = 3,      // size of the synthesized (maximum) window
+    parameter DATA_WIDTH  = 8,
+    parameter MAX_WIDTH   = 2048    // longest input row (line buffer depth)
+)(
+    input  clk,
+    input  rstn,
+    input  start,                   // one cycle pulse : a run begins with the configuration below
+    input  abort,                   // drops the run in progress and the windows in flight
+    output busy,                    // positions of the current run still to be stepped
+
+    input  [$clog2(KERNEL_SIZE + 1) - 1 : 0] cfg_kernel_size,   // odd, 1..KERNEL_SIZE
+    input  [15 : 0]             cfg_in_width,      // cells per input row
+    input  [15 : 0]             cfg_in_height,     // input rows
+    input                       cfg_border_left,   // generate the border left of the first column
+    input                       cfg_border_right,  // generate the border right of the last column
+    input                       cfg_border_top,    // generate the border above the first row
+    input                       cfg_border_bottom, // generate the border below the last row
+    input                       cfg_replicate,     // border cells : 0 zeros, 1 nearest edge cell
+
+    // AXI Stream Slave Interface (input rows, one cell per transfer)
+    input  [DATA_WIDTH - 1 : 0] s_axis_tdata,
+    input                       s_axis_tvalid,
+    output                      s_axis_tready,
+
+    // AXI Stream Master Interface (windows, cell (r, c) at (r * KERNEL_SIZE + c) * DATA_WIDTH)
+    output [KERNEL_SIZE * KERNEL_SIZE * DATA_WIDTH - 1 : 0] m_axis_tdata,
+    output reg                  m_axis_tlast,      // last window of the run
+    output reg                  m_axis_tvalid,
+    input                       m_axis_tready,
+
+    // Performance counter events
+    output                      step,              // a position was stepped
+    output                      step_idle          // ... that gives no window (border or halo position)
+);
+
+    localparam KSIZE_W = $clog2(KERNEL_SIZE + 1);
+    localparam ADDR_W  = (MAX_WIDTH > 1) ? $clog2(MAX_WIDTH) : 1;
+    localparam BUFFERS = (KERNEL_SIZE > 1) ? KERNEL_SIZE - 1 : 1;
+
+    wire [KSIZE_W - 1 : 0] pad = (cfg_kernel_size - 1) >> 1;
+
+    // Run, sampled on start
+    reg                    active;
+    reg  [15 : 0]          in_w;
+    reg  [15 : 0]          in_h;
+    reg  [16 : 0]          pos_w;      // positions per row, in_w + right border
+    reg  [16 : 0]          pos_h;      // rows of positions, in_h + bottom border
+    reg  [KSIZE_W : 0]     lead_x;     // first position with a window
+    reg  [KSIZE_W : 0]     lead_y;
+    reg                    top_border;
+
+    // Stage A : position, line buffer read
+    reg  [16 : 0]          px;
+    reg  [16 : 0]          py;
+
+    // Stage B : line buffer column and the cell of the position
+    reg                    b_valid;
+    reg  [DATA_WIDTH - 1 : 0] b_cell;
+    reg  [ADDR_W - 1 : 0]  b_addr;
+    reg                    b_col_in;    // input column : line buffer column, written back
+    reg                    b_row_in;    // input row : b_cell is the new cell
+    reg                    b_first;     // first row under a generated top border
+    reg                    b_left;      // first position of a row
+    reg                    b_emit;
+    reg                    b_last;
+
+    wire need_in   = (px < in_w) && (py < in_h);
+    wire consume_b = b_valid && (!m_axis_tvalid || m_axis_tready);
+    wire b_free    = !b_valid || consume_b;
+    wire a_go      = active && b_free && (!need_in || s_axis_tvalid);
+    wire a_emit    = (px >= lead_x) && (py >= lead_y);
+    wire a_row_end = (px == pos_w - 1);
+    wire a_last    = a_row_end && (py == pos_h - 1);
+
+    assign busy          = active;
+    assign s_axis_tready = active && b_free && need_in;
+    assign step          = a_go;
+    assign step_idle     = a_go && !a_emit;
+
+    // 1. Stage A : run and positions
+    always @(posedge clk) begin
+        if (!rstn || abort) begin
+            active     <= 1'b0;
+            in_w       <= 0;
+            in_h       <= 0;
+            pos_w      <= 0;
+            pos_h      <= 0;
+            lead_x     <= 0;
+            lead_y     <= 0;
+            top_border <= 1'b0;
+            px         <= 0;
+            py         <= 0;
+        end
+        else if (start && !active) begin
+            active     <= 1'b1;
+            in_w       <= cfg_in_width;
+            in_h       <= cfg_in_height;
+            pos_w      <= cfg_in_width  + (cfg_border_right  ? pad : 0);
+            pos_h      <= cfg_in_height + (cfg_border_bottom ? pad : 0);
+            lead_x     <= cfg_border_left ? pad : 2 * pad;
+            lead_y     <= cfg_border_top ? pad : 2 * pad;
+            top_border <= cfg_border_top;
+            px         <= 0;
+            py         <= 0;
+        end
+        else if (a_go) begin
+            px <= a_row_end ? 0 : px + 1;
+            if (a_row_end)
+                py <= py + 1;
+            if (a_last)
+                active <= 1'b0;
+        end
+    end
+
+    always @(posedge clk) begin
+        if (!rstn || abort)
+            b_valid <= 1'b0;
+        else if (a_go)
+            b_valid <= 1'b1;
+        else if (consume_b)
+            b_valid <= 1'b0;
+
+        if (a_go) begin
+            b_cell   <= need_in ? s_axis_tdata : {DATA_WIDTH{1'b0}};
+            b_addr   <= px[ADDR_W - 1 : 0];
+            b_col_in <= (px < in_w);
+            b_row_in <= (py < in_h);
+            b_first  <= top_border && (py == 0);
+            b_left   <= (px == 0);
+            b_emit   <= a_emit;
+            b_last   <= a_last;
+        end
+    end
+
+    // 2. Line buffers : read in stage A, the column shifted one buffer up written back in stage B
+    wire [DATA_WIDTH - 1 : 0] q   [0 : BUFFERS - 1];
+    reg  [DATA_WIDTH - 1 : 0] col [0 : KERNEL_SIZE - 1];   // column entering the window
+
+    genvar r, c;
+    generate
+        for (r = 0; r < BUFFERS; r = r + 1) begin : gen_line
+            (* ram_style = "block" *) reg [DATA_WIDTH - 1 : 0] line_buf [0 : MAX_WIDTH - 1];
+            reg [DATA_WIDTH - 1 : 0] rd_q;
+
+            always @(posedge clk) begin
+                if (a_go && (px < in_w))
+                    rd_q <= line_buf[px[ADDR_W - 1 : 0]];
+                if (consume_b && b_col_in && (r < cfg_kernel_size - 1))
+                    line_buf[b_addr] <= col[r + 1];
+            end
+
+            assign q[r] = rd_q;
+        end
+    endgenerate
+
+    // 3. Stage B : column of the position, with the rows above and below the input substituted
+    //    (row y - (k - 1) + r of the input at row r, the new cell at k - 1)
+    integer i;
+
+    always @(*) begin
+        for (i = 0; i < KERNEL_SIZE; i = i + 1) begin
+            if (i > cfg_kernel_size - 1)
+                col[i] = {DATA_WIDTH{1'b0}};
+            else if (i == cfg_kernel_size - 1)
+                // below the last row : a zero, or the last row again (in the last buffer)
+                col[i] = b_row_in ? b_cell : (cfg_replicate && i > 0) ? q[(i > 0) ? i - 1 : 0] : {DATA_WIDTH{1'b0}};
+            else if (b_first)
+                // above the first row : a zero, or the first row
+                col[i] = cfg_replicate ? b_cell : {DATA_WIDTH{1'b0}};
+            else
+                col[i] = q[i];
+        end
+    end
+
+    // 4. Window register : one column in per position, the left and right border filled in
+    reg [DATA_WIDTH - 1 : 0] win [0 : KERNEL_SIZE - 1][0 : KERNEL_SIZE - 1];
+
+    generate
+        for (r = 0; r < KERNEL_SIZE; r = r + 1) begin : gen_win_row
+            // right of the last column : a zero, or the last column again
+            wire [DATA_WIDTH - 1 : 0] new_cell = b_col_in ? col[r] : cfg_replicate ? win[r][cfg_kernel_size - 1] : {DATA_WIDTH{1'b0}};
+
+            for (c = 0; c < KERNEL_SIZE; c = c + 1) begin : gen_win_col
+                always @(posedge clk) begin
+                    if (!rstn)
+                        win[r][c] <= {DATA_WIDTH{1'b0}};
+                    else if (consume_b) begin
+                        if (r >= cfg_kernel_size || c >= cfg_kernel_size)
+                            win[r][c] <= {DATA_WIDTH{1'b0}};
+                        else if (c == cfg_kernel_size - 1)
+                            win[r][c] <= new_cell;
+                        else if (b_left)
+                            // left of the first column : zeros, or the first column
+                            win[r][c] <= cfg_replicate ? new_cell : {DATA_WIDTH{1'b0}};
+                        else
+                            win[r][c] <= win[r][(c < KERNEL_SIZE - 1) ? c + 1 : c];
+                    end
+                end
+
+                assign m_axis_tdata[(r * KERNEL_SIZE + c) * DATA_WIDTH +: DATA_WIDTH] = win[r][c];
+            end
+        end
+    endgenerate
+
+    // 5. Output : the window register holds the window of the last position taken from stage B
+    always @(posedge clk) begin
+        if (!rstn || abort) begin
+            m_axis_tvalid <= 1'b0;
+            m_axis_tlast  <= 1'b0;
+        end
+        else if (consume_b) begin
+            m_axis_tvalid <= b_emit;
+            m_axis_tlast  <= b_last;
+        end
+        else if (m_axis_tready)
+            m_axis_tvalid <= 1'b0;
+    end
+
+endmodule
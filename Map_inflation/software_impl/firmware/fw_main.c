@@ -0,0 +1,122 @@
+/*
+ * MicroBlaze firmware of the accelerator: FW_FRAMES frames of a generated
+ * map through inflate_fw.c, up to FW_BUFFERS in flight. The frame done
+ * interrupt starts the next frame, the main loop only fills and retires
+ * buffers and prints the time of every frame on the AXI timer: the wait in
+ * the queue (start - submit) and the time on the accelerator, DMA
+ * included (done - start).
+ *
+ * A Vitis application of the platform (standalone BSP with axi_intc and
+ * axi_timer, like vitis_ws_testIP) builds it with, in UserConfig.cmake:
+ *   USER_COMPILE_SOURCES      fw_main.c inflate_fw.c inflate_hal_xil.c platform.c
+ *   USER_INCLUDE_DIRECTORIES  software_impl/firmware software_impl/host
+ *   USER_COMPILE_DEFINITIONS  INFLATE_BASEADDR=<register window> INFLATE_IRQ_ID=<intc input>
+ * The DMA masters of the accelerator must reach the buffers: the local
+ * memory of the MicroBlaze is not on AXI, so FW_BUFFER_BASE gives the
+ * address of a memory they share (DDR or AXI BRAM), FW_BUFFERS *
+ * 2 * FW_STRIDE * FW_HEIGHT bytes.
+ */
+#include <stdint.h>
+
+#include "inflate_fw.h"
+#include "inflate_hal_xil.h"
+#include "kernel_gen.h"
+#include "platform.h"
+#include "xil_printf.h"
+
+#ifndef FW_WIDTH
+#define FW_WIDTH       64
+#endif
+#ifndef FW_HEIGHT
+#define FW_HEIGHT      64
+#endif
+#ifndef FW_RADIUS
+#define FW_RADIUS      3
+#endif
+#ifndef FW_FRAMES
+#define FW_FRAMES      32
+#endif
+#ifndef FW_BUFFER_BASE
+#define FW_BUFFER_BASE 0x80000000       /* DDR of the MIG */
+#endif
+
+#define FW_BUFFERS     (INFLATE_FW_DEPTH / 2)
+#define FW_STRIDE      ((FW_WIDTH + 31) & ~31)   /* rows and ROIs on whole cache lines */
+#define FW_ROI         (FW_STRIDE * FW_HEIGHT)
+#define FW_TIMEOUT_US  100000
+
+static inflate_hal_t      hal;
+static inflate_fw_t       fw;
+static inflate_fw_frame_t frames[FW_BUFFERS];
+
+/* A few obstacles (lethal cells) moving from frame to frame */
+static void fill_map(uint8_t *map, int frame)
+{
+    uint32_t seed = 0x9E3779B9u * (uint32_t)(frame + 1);
+
+    for (int y = 0; y < FW_HEIGHT; y++)
+        for (int x = 0; x < FW_WIDTH; x++)
+            map[y * FW_STRIDE + x] = 0;
+    for (int i = 0; i < FW_WIDTH * FW_HEIGHT / 200 + 1; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        map[(seed >> 8) % FW_HEIGHT * FW_STRIDE + (seed >> 20) % FW_WIDTH] = KGEN_LETHAL;
+    }
+}
+
+int main(void)
+{
+    uint8_t            *buffers = (uint8_t *)FW_BUFFER_BASE;
+    inflate_fw_config_t cfg     = {
+        FW_WIDTH, FW_HEIGHT, FW_STRIDE, FW_STRIDE, FW_RADIUS, 1, 0,
+        KGEN_FIXED(10.0f), KGEN_FIXED(0.1f), KGEN_FIXED(0.05f), FW_TIMEOUT_US,
+    };
+    int submitted = 0, retired = 0, failures = 0;
+    int status;
+
+    init_platform();
+    if ((status = inflate_hal_xil_init(&hal, inflate_fw_isr, &fw)) != 0 ||
+        (status = inflate_fw_init(&fw, &hal)) != 0 ||
+        (status = inflate_fw_configure(&fw, &cfg)) != 0) {
+        xil_printf("accelerator setup failed : %d\r\n", status);
+        cleanup_platform();
+        return 1;
+    }
+    xil_printf("%d frames of %dx%d, radius %d, %d in flight\r\n", FW_FRAMES, FW_WIDTH, FW_HEIGHT, FW_RADIUS,
+               FW_BUFFERS);
+
+    while (retired < FW_FRAMES) {
+        /* free buffers refilled and queued, the accelerator runs meanwhile */
+        while (submitted < FW_FRAMES && inflate_fw_pending(&fw) < FW_BUFFERS) {
+            inflate_fw_frame_t *frame = &frames[submitted % FW_BUFFERS];
+            uint8_t            *src   = buffers + 2 * FW_ROI * (submitted % FW_BUFFERS);
+
+            fill_map(src, submitted);
+            frame->src = src;
+            frame->dst = src + FW_ROI;
+            if ((status = inflate_fw_submit(&fw, frame)) != 0) {
+                xil_printf("frame %d : submit error %d\r\n", submitted, status);
+                cleanup_platform();
+                return 1;
+            }
+            submitted++;
+        }
+
+        inflate_fw_frame_t *frame = inflate_fw_next_done(&fw);
+        if (!frame) {
+            /* nothing to do until the next interrupt */
+            inflate_fw_watchdog(&fw);
+            continue;
+        }
+        failures += frame->status != 0;
+        xil_printf("frame %d : status %d, queued %d us, ran %d us\r\n", retired, frame->status,
+                   (int)inflate_fw_ticks_to_us(&fw, frame->t_start - frame->t_submit),
+                   (int)inflate_fw_ticks_to_us(&fw, frame->t_done - frame->t_start));
+        retired++;
+    }
+
+    xil_printf("%d frames, %d failures, %d DMA errors, %d timeouts, %d spurious interrupts, busy %d us\r\n",
+               (int)fw.stats.frames, failures, (int)fw.stats.errors, (int)fw.stats.timeouts,
+               (int)fw.stats.spurious, (int)inflate_fw_ticks_to_us(&fw, fw.stats.busy));
+    cleanup_platform();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,191 @@
+#include "inflate_fw.h"
+#include "inflate_regs.h"
+
+#include <errno.h>
+#include <string.h>
+
+#define SLOT(count) ((count) & (INFLATE_FW_DEPTH - 1))
+
+static uint32_t reg_read(const inflate_fw_t *fw, uint32_t offset)
+{
+    return fw->hal->reg_read(fw->hal->ctx, offset);
+}
+
+static void reg_write(const inflate_fw_t *fw, uint32_t offset, uint32_t value)
+{
+    fw->hal->reg_write(fw->hal->ctx, offset, value);
+}
+
+/* Next queued frame on the accelerator, interrupt masked or in the handler */
+static void start_next(inflate_fw_t *fw)
+{
+    inflate_fw_frame_t *frame = fw->ring[SLOT(fw->started)];
+
+    reg_write(fw, INFLATE_REG_SRC_ADDR, fw->hal->dma_addr(fw->hal->ctx, frame->src));
+    reg_write(fw, INFLATE_REG_DST_ADDR, fw->hal->dma_addr(fw->hal->ctx, frame->dst));
+    frame->t_start = fw->hal->ticks(fw->hal->ctx);
+    reg_write(fw, INFLATE_REG_CTRL, INFLATE_CTRL_START);
+    fw->started++;
+}
+
+/* Running frame done with status, the next one started, interrupt masked or in the handler */
+static void complete(inflate_fw_t *fw, uint64_t now, int status)
+{
+    inflate_fw_frame_t *frame = fw->ring[SLOT(fw->done)];
+
+    frame->t_done = now;
+    frame->status = status;
+    /* lines of the destination the CPU may have pulled in while the DMA wrote it */
+    fw->hal->cache_invalidate(fw->hal->ctx, frame->dst, fw->dst_bytes);
+    fw->stats.frames++;
+    fw->stats.errors   += status == -EIO;
+    fw->stats.timeouts += status == -ETIMEDOUT;
+    fw->stats.busy     += now - frame->t_start;
+    fw->done++;
+    if (fw->started != fw->submitted)
+        start_next(fw);
+}
+
+int inflate_fw_init(inflate_fw_t *fw, const inflate_hal_t *hal)
+{
+    if (!hal || hal->timer_hz == 0 || hal->cache_line == 0 || (hal->cache_line & (hal->cache_line - 1)))
+        return -EINVAL;
+
+    memset(fw, 0, sizeof(*fw));
+    fw->hal = hal;
+    reg_write(fw, INFLATE_REG_IRQ_ENABLE, 0);
+    reg_write(fw, INFLATE_REG_CTRL, INFLATE_CTRL_STOP);
+    reg_write(fw, INFLATE_REG_IRQ_STATUS, INFLATE_IRQ_FRAME_DONE);
+    fw->array_size = reg_read(fw, INFLATE_REG_CONFIG) & INFLATE_CONFIG_ARRAY_SIZE;
+    return 0;
+}
+
+int inflate_fw_configure(inflate_fw_t *fw, const inflate_fw_config_t *cfg)
+{
+    const inflate_hal_t *hal  = fw->hal;
+    uint32_t             line = hal->cache_line;
+
+    if (fw->submitted != fw->retired)
+        return -EBUSY;
+    if (cfg->width <= 0 || cfg->height <= 0 || cfg->radius < 0 || 2 * cfg->radius + 1 > fw->array_size ||
+        (cfg->src_stride & 3) || (cfg->dst_stride & 3) ||
+        cfg->src_stride < (uint32_t)cfg->width || cfg->dst_stride < (uint32_t)cfg->width)
+        return -EINVAL;
+
+    fw->configured    = 0;
+    fw->cfg           = *cfg;
+    fw->src_bytes     = (size_t)cfg->src_stride * (cfg->height - 1) + cfg->width;
+    fw->dst_bytes     = ((size_t)cfg->dst_stride * (cfg->height - 1) + cfg->width + line - 1) & ~(size_t)(line - 1);
+    fw->timeout_ticks = (uint64_t)cfg->timeout_us * hal->timer_hz / 1000000;
+
+    reg_write(fw, INFLATE_REG_IRQ_ENABLE, 0);
+    reg_write(fw, INFLATE_REG_CTRL, INFLATE_CTRL_STOP);
+    reg_write(fw, INFLATE_REG_RADIUS, cfg->radius);
+    reg_write(fw, INFLATE_REG_FRAME_WIDTH, cfg->width);
+    reg_write(fw, INFLATE_REG_FRAME_HEIGHT, cfg->height);
+    reg_write(fw, INFLATE_REG_MODE, (cfg->inflation ? INFLATE_MODE_INFLATION : 0) | INFLATE_MODE_BORDER |
+                                    (cfg->replicate ? INFLATE_MODE_REPLICATE : 0));
+    reg_write(fw, INFLATE_REG_SRC_STRIDE, cfg->src_stride);
+    reg_write(fw, INFLATE_REG_SRC_WIDTH, cfg->width);
+    reg_write(fw, INFLATE_REG_SRC_HEIGHT, cfg->height);
+    reg_write(fw, INFLATE_REG_DST_STRIDE, cfg->dst_stride);
+    reg_write(fw, INFLATE_REG_DMA_CTRL, INFLATE_DMA_READ_EN | INFLATE_DMA_WRITE_EN);
+
+    /* the kernel load takes a few hundred cycles, once per configuration */
+    reg_write(fw, INFLATE_REG_KGEN_SCALE, cfg->scale);
+    reg_write(fw, INFLATE_REG_KGEN_INSCRIBED, cfg->inscribed);
+    reg_write(fw, INFLATE_REG_KGEN_RESOLUTION, cfg->resolution);
+    reg_write(fw, INFLATE_REG_CTRL, INFLATE_CTRL_KGEN_START);
+    for (int i = 0; reg_read(fw, INFLATE_REG_STATUS) & (INFLATE_STATUS_KGEN_BUSY | INFLATE_STATUS_LOADING); i++)
+        if (i == INFLATE_FW_KGEN_POLLS)
+            return -ETIMEDOUT;
+
+    reg_write(fw, INFLATE_REG_IRQ_STATUS, INFLATE_IRQ_FRAME_DONE);
+    reg_write(fw, INFLATE_REG_IRQ_ENABLE, INFLATE_IRQ_FRAME_DONE);
+    fw->configured = 1;
+    return 0;
+}
+
+int inflate_fw_submit(inflate_fw_t *fw, inflate_fw_frame_t *frame)
+{
+    const inflate_hal_t *hal = fw->hal;
+
+    if (!fw->configured || ((uintptr_t)frame->src & 3) || ((uintptr_t)frame->dst & ((hal->cache_line - 1) | 3)))
+        return -EINVAL;
+    if (fw->submitted - fw->retired == INFLATE_FW_DEPTH)
+        return -EBUSY;
+
+    /*
+     * the map out of the cache for the read DMA, no dirty line of the
+     * destination left to be evicted over the results
+     */
+    hal->cache_flush(hal->ctx, frame->src, fw->src_bytes);
+    hal->cache_invalidate(hal->ctx, frame->dst, fw->dst_bytes);
+    frame->status   = 0;
+    frame->t_start  = 0;
+    frame->t_done   = 0;
+    frame->t_submit = hal->ticks(hal->ctx);
+
+    uint32_t irq = hal->irq_save(hal->ctx);
+    fw->ring[SLOT(fw->submitted)] = frame;
+    fw->submitted++;
+    if (fw->started == fw->done)
+        start_next(fw);
+    hal->irq_restore(hal->ctx, irq);
+    return 0;
+}
+
+void inflate_fw_isr(void *arg)
+{
+    inflate_fw_t *fw  = (inflate_fw_t *)arg;
+    uint64_t      now = fw->hal->ticks(fw->hal->ctx);
+
+    if (!(reg_read(fw, INFLATE_REG_IRQ_STATUS) & INFLATE_IRQ_FRAME_DONE)) {
+        fw->stats.spurious++;
+        return;
+    }
+    reg_write(fw, INFLATE_REG_IRQ_STATUS, INFLATE_IRQ_FRAME_DONE);
+    if (fw->started == fw->done) {
+        /* nothing running: the watchdog ended the frame first */
+        fw->stats.spurious++;
+        return;
+    }
+    complete(fw, now, (reg_read(fw, INFLATE_REG_DMA_STATUS) & INFLATE_DMA_ERRORS) ? -EIO : 0);
+}
+
+inflate_fw_frame_t *inflate_fw_next_done(inflate_fw_t *fw)
+{
+    if (fw->retired == fw->done)
+        return NULL;
+    return fw->ring[SLOT(fw->retired++)];
+}
+
+uint32_t inflate_fw_pending(const inflate_fw_t *fw)
+{
+    return fw->submitted - fw->retired;
+}
+
+void inflate_fw_watchdog(inflate_fw_t *fw)
+{
+    const inflate_hal_t *hal = fw->hal;
+
+    if (fw->timeout_ticks == 0)
+        return;
+
+    uint32_t irq = hal->irq_save(hal->ctx);
+    if (fw->started != fw->done) {
+        uint64_t now = hal->ticks(hal->ctx);
+        if (now - fw->ring[SLOT(fw->done)]->t_start > fw->timeout_ticks) {
+            /* a frame done racing the STOP must not complete the next frame */
+            reg_write(fw, INFLATE_REG_CTRL, INFLATE_CTRL_STOP);
+            reg_write(fw, INFLATE_REG_IRQ_STATUS, INFLATE_IRQ_FRAME_DONE);
+            complete(fw, now, -ETIMEDOUT);
+        }
+    }
+    hal->irq_restore(hal->ctx, irq);
+}
+
+uint32_t inflate_fw_ticks_to_us(const inflate_fw_t *fw, uint64_t ticks)
+{
+    return (uint32_t)(ticks * 1000000 / fw->hal->timer_hz);
+}
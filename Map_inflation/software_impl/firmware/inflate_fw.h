@@ -0,0 +1,129 @@
+#ifndef INFLATE_FW_H
+#define INFLATE_FW_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "inflate_hal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------- Interrupt driven firmware core ---------------- */
+/*
+ * Frame queue of the accelerator on a bare metal CPU, with the DMA of
+ * top.v (DMA_CTRL READ_EN | WRITE_EN): the main loop submits frames, the
+ * frame done interrupt completes the running one and starts the next, so
+ * the accelerator never waits for the main loop and the main loop never
+ * polls STATUS.
+ *   - the frames live in the buffers of the caller, no copy: submit
+ *     writes back the source ROI from the data cache and drops the lines
+ *     of the destination ROI, the interrupt drops them again once the
+ *     DMA wrote it,
+ *   - each frame gets the timer value at submit, start and done
+ *     (hal->ticks), the wait in the queue and the time on the accelerator,
+ *   - a ring of INFLATE_FW_DEPTH frames, free running counters: the main
+ *     loop owns submitted and retired, the interrupt done, and started
+ *     moves in both, with the interrupt masked (hal->irq_save) in the main
+ *     loop,
+ *   - the geometry and the kernel are the same for every frame, set by
+ *     inflate_fw_configure() with no frame pending,
+ *   - inflate_fw_watchdog() from the main loop ends a frame that ran for
+ *     more than timeout_us (a DMA error gives no frame done).
+ * Nothing allocates: the inflate_fw_t belongs to the caller.
+ */
+#define INFLATE_FW_DEPTH      8          /* frames queued or running, a power of two */
+#define INFLATE_FW_KGEN_POLLS 100000     /* STATUS reads before the kernel load is declared hung */
+
+typedef struct {
+    int      width;                      /* cells per row */
+    int      height;                     /* rows */
+    uint32_t src_stride;                 /* bytes between source rows, multiple of 4, >= width */
+    uint32_t dst_stride;                 /* bytes between destination rows, same */
+    int      radius;                     /* kernel = 2 * radius + 1 cells, up to CONFIG ARRAY_SIZE */
+    int      inflation;                  /* 1 : inflation (max), 0 : convolution */
+    int      replicate;                  /* border : 0 zeros, 1 edge cells repeated */
+    uint32_t scale;                      /* KGEN_SCALE, Q16.16 (KGEN_FIXED() of kernel_gen.h) */
+    uint32_t inscribed;                  /* KGEN_INSCRIBED, Q16.16 */
+    uint32_t resolution;                 /* KGEN_RESOLUTION, Q16.16 */
+    uint32_t timeout_us;                 /* watchdog of a frame, 0 : none */
+} inflate_fw_config_t;
+
+/*
+ * A frame: src and dst at multiples of 4, dst at a multiple of
+ * hal->cache_line and its last line its own (the whole lines of the ROI
+ * are invalidated). The caller keeps it until inflate_fw_next_done()
+ * gives it back.
+ */
+typedef struct {
+    const uint8_t *src;                  /* first cell of the source ROI */
+    uint8_t       *dst;                  /* first cell of the destination ROI */
+    void          *user;
+    uint64_t       t_submit;             /* hal->ticks() values */
+    uint64_t       t_start;
+    uint64_t       t_done;
+    int            status;               /* 0, -EIO (DMA error), -ETIMEDOUT (watchdog) */
+} inflate_fw_frame_t;
+
+typedef struct {
+    uint32_t frames;                     /* frames done */
+    uint32_t errors;                     /* with a DMA error */
+    uint32_t timeouts;                   /* ended by the watchdog */
+    uint32_t spurious;                   /* interrupts with no frame done */
+    uint64_t busy;                       /* ticks with a frame on the accelerator */
+} inflate_fw_stats_t;
+
+typedef struct {
+    const inflate_hal_t *hal;
+    inflate_fw_config_t  cfg;
+    int                  configured;
+    int                  array_size;     /* CONFIG bits 7:0 */
+    size_t               src_bytes;      /* bytes of a source ROI */
+    size_t               dst_bytes;      /* whole cache lines of a destination ROI */
+    uint64_t             timeout_ticks;
+    inflate_fw_frame_t  *ring[INFLATE_FW_DEPTH];
+    volatile uint32_t    submitted;
+    volatile uint32_t    started;
+    volatile uint32_t    done;
+    uint32_t             retired;
+    inflate_fw_stats_t   stats;
+} inflate_fw_t;
+
+/* Stops the accelerator, masks its interrupt, reads its CONFIG. Returns 0 or -EINVAL */
+int inflate_fw_init(inflate_fw_t *fw, const inflate_hal_t *hal);
+
+/*
+ * Geometry, kernel (generated on chip, KGEN_START) and DMA of the next
+ * frames, then the frame done interrupt on. Returns 0, -EBUSY with frames
+ * pending, -EINVAL or -ETIMEDOUT (kernel load hung).
+ */
+int inflate_fw_configure(inflate_fw_t *fw, const inflate_fw_config_t *cfg);
+
+/*
+ * Queues a frame, started at once if the accelerator is idle. Returns 0,
+ * -EBUSY with INFLATE_FW_DEPTH frames not retired, or -EINVAL (not
+ * configured, buffers not aligned).
+ */
+int inflate_fw_submit(inflate_fw_t *fw, inflate_fw_frame_t *frame);
+
+/* Handler of the frame done interrupt, arg is the inflate_fw_t */
+void inflate_fw_isr(void *arg);
+
+/* The oldest frame done and not retired yet, in submit order, or NULL */
+inflate_fw_frame_t *inflate_fw_next_done(inflate_fw_t *fw);
+
+/* Frames submitted and not retired */
+uint32_t inflate_fw_pending(const inflate_fw_t *fw);
+
+/* Ends the running frame with -ETIMEDOUT (STOP) if it ran for more than timeout_us */
+void inflate_fw_watchdog(inflate_fw_t *fw);
+
+/* Timer ticks in us */
+uint32_t inflate_fw_ticks_to_us(const inflate_fw_t *fw, uint64_t ticks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INFLATE_FW_H */
@@ -0,0 +1,50 @@
+#ifndef INFLATE_HAL_H
+#define INFLATE_HAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------- Hardware access of the firmware ---------------- */
+/*
+ * Everything inflate_fw.c needs from the platform, so the same scheduling
+ * code runs on the MicroBlaze (inflate_hal_xil.c: Xil_In32/Xil_Out32, the
+ * data cache of the BSP, the AXI timer and the interrupt controller) and on
+ * a Linux host against a stub device (test_inflate_fw.c):
+ *   reg_read / reg_write : the AXI4-Lite registers of the accelerator,
+ *                          byte offsets of axim_reg.sv,
+ *   dma_addr             : the bus address the DMA masters use for a CPU
+ *                          pointer (the same on the MicroBlaze),
+ *   cache_flush          : writes back the dirty lines of a range, before
+ *                          the DMA reads it,
+ *   cache_invalidate     : drops the lines of a range, before and after the
+ *                          DMA writes it,
+ *   ticks                : free running timer, timer_hz ticks per second,
+ *   irq_save / restore   : masks the interrupt of the accelerator and puts
+ *                          the previous state back, around the code the
+ *                          interrupt handler shares with the main loop.
+ * cache_line is the data cache line in bytes (a power of two, 4 without a
+ * data cache): the invalidated ranges are whole lines.
+ */
+typedef struct {
+    uint32_t (*reg_read)(void *ctx, uint32_t offset);
+    void     (*reg_write)(void *ctx, uint32_t offset, uint32_t value);
+    uint32_t (*dma_addr)(void *ctx, const void *ptr);
+    void     (*cache_flush)(void *ctx, const void *ptr, size_t len);
+    void     (*cache_invalidate)(void *ctx, void *ptr, size_t len);
+    uint64_t (*ticks)(void *ctx);
+    uint32_t (*irq_save)(void *ctx);
+    void     (*irq_restore)(void *ctx, uint32_t state);
+    uint32_t timer_hz;
+    uint32_t cache_line;
+    void    *ctx;
+} inflate_hal_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INFLATE_HAL_H */
@@ -0,0 +1,131 @@
+#include "inflate_hal_xil.h"
+
+#include <errno.h>
+
+#include "mb_interface.h"
+#include "xil_cache.h"
+#include "xil_exception.h"
+#include "xil_io.h"
+#include "xintc.h"
+#include "xparameters.h"
+#include "xtmrctr.h"
+
+/*
+ * The platform of the accelerator: its register window and the input of
+ * the interrupt controller its irq output drives. The test platform of
+ * vitis_ws_testIP has no accelerator yet, so both come from the build
+ * (-DINFLATE_BASEADDR=... -DINFLATE_IRQ_ID=...) until xparameters.h has
+ * them.
+ */
+#ifndef INFLATE_BASEADDR
+#define INFLATE_BASEADDR 0x44A00000     /* first address the Vivado address editor gives */
+#endif
+
+#ifndef INFLATE_IRQ_ID
+#define INFLATE_IRQ_ID   0
+#endif
+
+/*
+ * Alignment of the invalidated ranges: the longest data cache line of the
+ * MicroBlaze (8 words), right for every line length. The Xil_DCache*Range()
+ * calls do nothing in a design without a data cache.
+ */
+#ifndef INFLATE_CACHE_LINE
+#define INFLATE_CACHE_LINE 32
+#endif
+
+#define MSR_IE 0x2u                     /* interrupt enable bit of the MSR */
+
+static XIntc   intc;
+static XTmrCtr timer;
+
+static uint32_t xil_reg_read(void *ctx, uint32_t offset)
+{
+    (void)ctx;
+    return Xil_In32(INFLATE_BASEADDR + offset);
+}
+
+static void xil_reg_write(void *ctx, uint32_t offset, uint32_t value)
+{
+    (void)ctx;
+    Xil_Out32(INFLATE_BASEADDR + offset, value);
+}
+
+/* no MMU: the DMA masters see the addresses of the CPU */
+static uint32_t xil_dma_addr(void *ctx, const void *ptr)
+{
+    (void)ctx;
+    return (uint32_t)(UINTPTR)ptr;
+}
+
+static void xil_cache_flush(void *ctx, const void *ptr, size_t len)
+{
+    (void)ctx;
+    Xil_DCacheFlushRange((UINTPTR)ptr, len);
+}
+
+static void xil_cache_invalidate(void *ctx, void *ptr, size_t len)
+{
+    (void)ctx;
+    Xil_DCacheInvalidateRange((UINTPTR)ptr, len);
+}
+
+/* counter 1 holds the high word in cascade mode, read again if the low word wrapped in between */
+static uint64_t xil_ticks(void *ctx)
+{
+    u32 high, low;
+
+    (void)ctx;
+    do {
+        high = XTmrCtr_GetValue(&timer, 1);
+        low  = XTmrCtr_GetValue(&timer, 0);
+    } while (high != XTmrCtr_GetValue(&timer, 1));
+    return ((uint64_t)high << 32) | low;
+}
+
+static uint32_t xil_irq_save(void *ctx)
+{
+    uint32_t msr = (uint32_t)mfmsr();
+
+    (void)ctx;
+    microblaze_disable_interrupts();
+    return msr & MSR_IE;
+}
+
+static void xil_irq_restore(void *ctx, uint32_t state)
+{
+    (void)ctx;
+    if (state & MSR_IE)
+        microblaze_enable_interrupts();
+}
+
+int inflate_hal_xil_init(inflate_hal_t *hal, void (*isr)(void *arg), void *arg)
+{
+    hal->reg_read         = xil_reg_read;
+    hal->reg_write        = xil_reg_write;
+    hal->dma_addr         = xil_dma_addr;
+    hal->cache_flush      = xil_cache_flush;
+    hal->cache_invalidate = xil_cache_invalidate;
+    hal->ticks            = xil_ticks;
+    hal->irq_save         = xil_irq_save;
+    hal->irq_restore      = xil_irq_restore;
+    hal->timer_hz         = XPAR_XTMRCTR_0_CLOCK_FREQUENCY;
+    hal->cache_line       = INFLATE_CACHE_LINE;
+    hal->ctx              = NULL;
+
+    if (XTmrCtr_Initialize(&timer, XPAR_XTMRCTR_0_BASEADDR) != XST_SUCCESS)
+        return -ENODEV;
+    XTmrCtr_SetOptions(&timer, 0, XTC_CASCADE_MODE_OPTION);
+    XTmrCtr_Start(&timer, 0);
+
+    if (XIntc_Initialize(&intc, XPAR_XINTC_0_BASEADDR) != XST_SUCCESS ||
+        XIntc_Connect(&intc, INFLATE_IRQ_ID, (XInterruptHandler)isr, arg) != XST_SUCCESS ||
+        XIntc_Start(&intc, XIN_REAL_MODE) != XST_SUCCESS)
+        return -ENODEV;
+    XIntc_Enable(&intc, INFLATE_IRQ_ID);
+
+    Xil_ExceptionInit();
+    Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_INT, (Xil_ExceptionHandler)XIntc_InterruptHandler, &intc);
+    Xil_ExceptionEnable();
+    return 0;
+}
@@ -0,0 +1,22 @@
+#ifndef INFLATE_HAL_XIL_H
+#define INFLATE_HAL_XIL_H
+
+#include "inflate_hal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * HAL of the MicroBlaze standalone BSP (inflate_hal_xil.c): starts the AXI
+ * timer as one 64-bit counter (cascade mode), connects isr(arg) to the
+ * interrupt of the accelerator on the AXI interrupt controller and turns
+ * the interrupts of the CPU on. Returns 0 or -ENODEV.
+ */
+int inflate_hal_xil_init(inflate_hal_t *hal, void (*isr)(void *arg), void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INFLATE_HAL_XIL_H */
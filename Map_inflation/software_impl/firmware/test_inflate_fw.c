@@ -0,0 +1,428 @@
+/*
+ * Host test of the firmware core (inflate_fw.c) against a stub device: a
+ * register file that answers like axim_reg.sv, a DMA that adds one to
+ * every cell of the source ROI into the destination ROI when the test
+ * finishes a frame, an interrupt line delivered at once or, masked, on
+ * irq_restore, and a timer the test moves. The stub checks that the
+ * source of a frame was written back from the cache before its START.
+ *
+ *   gcc -std=c99 -Wall -Wextra -I../host -o test_inflate_fw test_inflate_fw.c inflate_fw.c
+ *   ./test_inflate_fw
+ */
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "inflate_fw.h"
+#include "inflate_regs.h"
+
+#define W      20
+#define H      6
+#define STRIDE 32                        /* one cache line per row */
+#define ROI    (STRIDE * H)
+#define LINE   32
+#define FRAMES (2 * INFLATE_FW_DEPTH)
+#define BUS    0x80000000u               /* bus address of mem[0] */
+
+typedef struct {
+    uint32_t       regs[0x100 / 4];
+    uint8_t        mem[2 * FRAMES * ROI] __attribute__((aligned(LINE)));
+    uint64_t       now;
+    int            running;              /* a frame started and not finished */
+    int            starts;
+    int            stops;
+    int            masked;
+    int            kgen_reads;           /* STATUS reads with KGEN_BUSY, -1 : hung */
+    int            instant;              /* frames finish on START */
+    inflate_fw_t  *fw;
+    const uint8_t *flushed[FRAMES];      /* ranges written back, one per source buffer */
+    size_t         flushed_len[FRAMES];
+    const uint8_t *invalidated;          /* last range dropped */
+    size_t         invalidated_len;
+} stub_t;
+
+static int failures;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            printf("FAIL %s:%d : %s\n", __FILE__, __LINE__, #cond);     \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+static void stub_finish(stub_t *stub, int dma_error);
+
+static void stub_irq(stub_t *stub)
+{
+    while (!stub->masked && (stub->regs[INFLATE_REG_IRQ_ENABLE / 4] & stub->regs[INFLATE_REG_IRQ_STATUS / 4])) {
+        stub->masked = 1;                /* the CPU takes the interrupt with the interrupts off */
+        inflate_fw_isr(stub->fw);
+        stub->masked = 0;
+    }
+}
+
+static uint32_t stub_read(void *ctx, uint32_t offset)
+{
+    stub_t *stub = (stub_t *)ctx;
+
+    if (offset == INFLATE_REG_STATUS && stub->kgen_reads) {
+        if (stub->kgen_reads > 0)
+            stub->kgen_reads--;
+        return INFLATE_STATUS_KGEN_BUSY;
+    }
+    return stub->regs[offset / 4];
+}
+
+static void stub_write(void *ctx, uint32_t offset, uint32_t value)
+{
+    stub_t *stub = (stub_t *)ctx;
+
+    if (offset == INFLATE_REG_IRQ_STATUS) {
+        stub->regs[offset / 4] &= ~value;
+        return;
+    }
+    if (offset == INFLATE_REG_CTRL) {
+        if (value & INFLATE_CTRL_START) {
+            const uint8_t *src    = stub->mem + (stub->regs[INFLATE_REG_SRC_ADDR / 4] - BUS);
+            int            buffer = (int)(src - stub->mem) / (2 * ROI);
+
+            CHECK(!stub->running);
+            CHECK(stub->flushed[buffer] == src && stub->flushed_len[buffer] == (size_t)STRIDE * (H - 1) + W);
+            stub->flushed[buffer] = NULL;
+            stub->running = 1;
+            stub->starts++;
+            if (stub->instant)
+                stub_finish(stub, 0);
+        }
+        if (value & INFLATE_CTRL_STOP) {
+            stub->running = 0;
+            stub->stops++;
+        }
+        return;
+    }
+    stub->regs[offset / 4] = value;
+    if (offset == INFLATE_REG_IRQ_ENABLE)
+        stub_irq(stub);
+}
+
+static uint32_t stub_dma_addr(void *ctx, const void *ptr)
+{
+    stub_t *stub = (stub_t *)ctx;
+
+    return BUS + (uint32_t)((const uint8_t *)ptr - stub->mem);
+}
+
+static void stub_flush(void *ctx, const void *ptr, size_t len)
+{
+    stub_t *stub   = (stub_t *)ctx;
+    int     buffer = (int)((const uint8_t *)ptr - stub->mem) / (2 * ROI);
+
+    stub->flushed[buffer]     = (const uint8_t *)ptr;
+    stub->flushed_len[buffer] = len;
+}
+
+static void stub_invalidate(void *ctx, void *ptr, size_t len)
+{
+    stub_t *stub = (stub_t *)ctx;
+
+    stub->invalidated     = (const uint8_t *)ptr;
+    stub->invalidated_len = len;
+}
+
+static uint64_t stub_ticks(void *ctx)
+{
+    return ((stub_t *)ctx)->now;
+}
+
+static uint32_t stub_irq_save(void *ctx)
+{
+    stub_t  *stub = (stub_t *)ctx;
+    uint32_t old  = stub->masked;
+
+    stub->masked = 1;
+    return old;
+}
+
+static void stub_irq_restore(void *ctx, uint32_t state)
+{
+    stub_t *stub = (stub_t *)ctx;
+
+    stub->masked = (int)state;
+    stub_irq(stub);
+}
+
+/* The running frame through the DMA, frame done raised */
+static void stub_finish(stub_t *stub, int dma_error)
+{
+    const uint8_t *src = stub->mem + (stub->regs[INFLATE_REG_SRC_ADDR / 4] - BUS);
+    uint8_t       *dst = stub->mem + (stub->regs[INFLATE_REG_DST_ADDR / 4] - BUS);
+
+    CHECK(stub->running);
+    for (int y = 0; y < H; y++)
+        for (int x = 0; x < W; x++)
+            dst[y * STRIDE + x] = (uint8_t)(src[y * STRIDE + x] + 1);
+    stub->running = 0;
+    stub->now += 100;
+    stub->regs[INFLATE_REG_DMA_STATUS / 4] = dma_error ? (1u << 3) : 0;
+    stub->regs[INFLATE_REG_IRQ_STATUS / 4] |= INFLATE_IRQ_FRAME_DONE;
+    stub_irq(stub);
+}
+
+static stub_t        stub;
+static inflate_hal_t hal;
+static inflate_fw_t  fw;
+
+static const inflate_fw_config_t config = {
+    W, H, STRIDE, STRIDE, 3, 1, 0, 10u << 16, 6554, 3277, 0,
+};
+
+static void setup(void)
+{
+    memset(&stub, 0, sizeof(stub));
+    stub.regs[INFLATE_REG_CONFIG / 4] = 7;
+    stub.fw = &fw;
+    hal.reg_read         = stub_read;
+    hal.reg_write        = stub_write;
+    hal.dma_addr         = stub_dma_addr;
+    hal.cache_flush      = stub_flush;
+    hal.cache_invalidate = stub_invalidate;
+    hal.ticks            = stub_ticks;
+    hal.irq_save         = stub_irq_save;
+    hal.irq_restore      = stub_irq_restore;
+    hal.timer_hz         = 1000000;
+    hal.cache_line       = LINE;
+    hal.ctx              = &stub;
+    CHECK(inflate_fw_init(&fw, &hal) == 0);
+    CHECK(fw.array_size == 7);
+}
+
+/* Frame i in its own buffers, the map a ramp starting at i */
+static void make_frame(inflate_fw_frame_t *frame, int i)
+{
+    uint8_t *src = stub.mem + 2 * ROI * i;
+
+    for (int y = 0; y < H; y++)
+        for (int x = 0; x < W; x++)
+            src[y * STRIDE + x] = (uint8_t)(i + x + y);
+    memset(frame, 0, sizeof(*frame));
+    frame->src = src;
+    frame->dst = src + ROI;
+}
+
+static int frame_ok(const inflate_fw_frame_t *frame, int i)
+{
+    for (int y = 0; y < H; y++)
+        for (int x = 0; x < W; x++)
+            if (frame->dst[y * STRIDE + x] != (uint8_t)(i + x + y + 1))
+                return 0;
+    return 1;
+}
+
+static void test_configure(void)
+{
+    inflate_fw_config_t cfg = config;
+
+    setup();
+    stub.kgen_reads = 10;
+    CHECK(inflate_fw_configure(&fw, &cfg) == 0);
+    CHECK(stub.kgen_reads == 0);
+    CHECK(stub.regs[INFLATE_REG_FRAME_WIDTH / 4] == W && stub.regs[INFLATE_REG_FRAME_HEIGHT / 4] == H);
+    CHECK(stub.regs[INFLATE_REG_SRC_WIDTH / 4] == W && stub.regs[INFLATE_REG_SRC_HEIGHT / 4] == H);
+    CHECK(stub.regs[INFLATE_REG_SRC_STRIDE / 4] == STRIDE && stub.regs[INFLATE_REG_DST_STRIDE / 4] == STRIDE);
+    CHECK(stub.regs[INFLATE_REG_RADIUS / 4] == 3);
+    CHECK(stub.regs[INFLATE_REG_MODE / 4] == (INFLATE_MODE_INFLATION | INFLATE_MODE_BORDER));
+    CHECK(stub.regs[INFLATE_REG_DMA_CTRL / 4] == (INFLATE_DMA_READ_EN | INFLATE_DMA_WRITE_EN));
+    CHECK(stub.regs[INFLATE_REG_KGEN_SCALE / 4] == (10u << 16));
+    CHECK(stub.regs[INFLATE_REG_IRQ_ENABLE / 4] == INFLATE_IRQ_FRAME_DONE);
+    CHECK(fw.dst_bytes == ROI);
+
+    cfg.radius = 4;                      /* 9 cells, the array has 7 */
+    CHECK(inflate_fw_configure(&fw, &cfg) == -EINVAL);
+    cfg = config;
+    cfg.dst_stride = 30;
+    CHECK(inflate_fw_configure(&fw, &cfg) == -EINVAL);
+    cfg = config;
+    cfg.src_stride = 16;
+    CHECK(inflate_fw_configure(&fw, &cfg) == -EINVAL);
+
+    stub.kgen_reads = -1;
+    CHECK(inflate_fw_configure(&fw, &config) == -ETIMEDOUT);
+    stub.kgen_reads = 0;
+
+    inflate_fw_frame_t frame;
+    make_frame(&frame, 0);
+    CHECK(inflate_fw_submit(&fw, &frame) == -EINVAL);   /* the failed configure left it unconfigured */
+}
+
+static void test_queue(void)
+{
+    inflate_fw_frame_t frames[3];
+
+    setup();
+    CHECK(inflate_fw_configure(&fw, &config) == 0);
+    for (int i = 0; i < 3; i++) {
+        make_frame(&frames[i], i);
+        stub.now += 10;
+        CHECK(inflate_fw_submit(&fw, &frames[i]) == 0);
+    }
+    /* the first frame starts at once, the others wait for its interrupt */
+    CHECK(stub.starts == 1);
+    CHECK(stub.regs[INFLATE_REG_SRC_ADDR / 4] == BUS);
+    CHECK(stub.regs[INFLATE_REG_DST_ADDR / 4] == BUS + ROI);
+    CHECK(inflate_fw_next_done(&fw) == NULL);
+    CHECK(inflate_fw_pending(&fw) == 3);
+
+    stub_finish(&stub, 0);
+    CHECK(stub.starts == 2);
+    CHECK(stub.regs[INFLATE_REG_SRC_ADDR / 4] == BUS + 2 * ROI);
+    CHECK(stub.invalidated == frames[0].dst && stub.invalidated_len == ROI);
+    stub_finish(&stub, 0);
+    stub_finish(&stub, 0);
+    CHECK(!stub.running && stub.starts == 3);
+
+    for (int i = 0; i < 3; i++) {
+        inflate_fw_frame_t *frame = inflate_fw_next_done(&fw);
+        CHECK(frame == &frames[i]);
+        if (!frame)
+            return;
+        CHECK(frame->status == 0);
+        CHECK(frame_ok(frame, i));
+        CHECK(frame->t_submit == 10u * (i + 1));
+        /* each frame starts on the interrupt of the one before */
+        CHECK(frame->t_start == (i ? frames[i - 1].t_done : 10));
+        CHECK(frame->t_done == 30 + 100u * (i + 1));
+    }
+    CHECK(inflate_fw_next_done(&fw) == NULL);
+    CHECK(fw.stats.frames == 3 && fw.stats.busy == 320);
+    CHECK(inflate_fw_ticks_to_us(&fw, frames[2].t_done - frames[0].t_submit) == 320);
+}
+
+static void test_full_and_wrap(void)
+{
+    inflate_fw_frame_t frames[FRAMES];
+    int                retired = 0;
+
+    setup();
+    CHECK(inflate_fw_configure(&fw, &config) == 0);
+    /* the counters wrap during the test */
+    fw.submitted = fw.started = fw.done = fw.retired = 0xFFFFFFFAu;
+
+    for (int i = 0; i < INFLATE_FW_DEPTH; i++) {
+        make_frame(&frames[i], i);
+        CHECK(inflate_fw_submit(&fw, &frames[i]) == 0);
+    }
+    make_frame(&frames[INFLATE_FW_DEPTH], INFLATE_FW_DEPTH);
+    CHECK(inflate_fw_submit(&fw, &frames[INFLATE_FW_DEPTH]) == -EBUSY);
+
+    /* done frames still hold their slots until retired */
+    stub_finish(&stub, 0);
+    CHECK(inflate_fw_submit(&fw, &frames[INFLATE_FW_DEPTH]) == -EBUSY);
+    CHECK(inflate_fw_configure(&fw, &config) == -EBUSY);
+
+    for (int next = INFLATE_FW_DEPTH; retired < FRAMES;) {
+        inflate_fw_frame_t *frame = inflate_fw_next_done(&fw);
+        if (frame) {
+            CHECK(frame == &frames[retired]);
+            CHECK(frame->status == 0 && frame_ok(frame, retired));
+            retired++;
+            if (next < FRAMES) {
+                make_frame(&frames[next], next);
+                CHECK(inflate_fw_submit(&fw, &frames[next]) == 0);
+                next++;
+            }
+        } else {
+            stub_finish(&stub, 0);
+        }
+    }
+    CHECK(stub.starts == FRAMES && fw.stats.frames == FRAMES);
+    CHECK(inflate_fw_pending(&fw) == 0);
+}
+
+static void test_errors(void)
+{
+    inflate_fw_config_t cfg = config;
+    inflate_fw_frame_t  frames[3];
+
+    setup();
+    cfg.timeout_us = 500;
+    CHECK(inflate_fw_configure(&fw, &cfg) == 0);
+
+    make_frame(&frames[0], 0);
+    frames[0].dst += 4;                  /* not on a cache line */
+    CHECK(inflate_fw_submit(&fw, &frames[0]) == -EINVAL);
+    make_frame(&frames[0], 0);
+    frames[0].src += 2;                  /* not on a word */
+    CHECK(inflate_fw_submit(&fw, &frames[0]) == -EINVAL);
+
+    for (int i = 0; i < 3; i++) {
+        make_frame(&frames[i], i);
+        CHECK(inflate_fw_submit(&fw, &frames[i]) == 0);
+    }
+
+    /* an interrupt with nothing done */
+    stub.regs[INFLATE_REG_IRQ_STATUS / 4] = 0;
+    inflate_fw_isr(&fw);
+    CHECK(fw.stats.spurious == 1 && inflate_fw_next_done(&fw) == NULL);
+
+    /* DMA error : the frame fails, the next one starts */
+    stub_finish(&stub, 1);
+    CHECK(frames[0].status == -EIO && stub.starts == 2);
+
+    /* watchdog : the frame hangs, STOP, the next one starts */
+    int stops = stub.stops;
+    stub.now += 400;
+    inflate_fw_watchdog(&fw);
+    CHECK(stub.starts == 2 && stub.stops == stops);
+    stub.now += 200;
+    inflate_fw_watchdog(&fw);
+    CHECK(frames[1].status == -ETIMEDOUT && stub.stops == stops + 1 && stub.starts == 3);
+    CHECK(stub.invalidated == frames[1].dst);
+
+    stub_finish(&stub, 0);
+    CHECK(frames[2].status == 0 && frame_ok(&frames[2], 2));
+    CHECK(fw.stats.errors == 1 && fw.stats.timeouts == 1 && fw.stats.frames == 3);
+    for (int i = 0; i < 3; i++)
+        CHECK(inflate_fw_next_done(&fw) == &frames[i]);
+
+    /* a frame done after the watchdog ended every frame completes nothing */
+    stub.regs[INFLATE_REG_IRQ_STATUS / 4] |= INFLATE_IRQ_FRAME_DONE;
+    inflate_fw_isr(&fw);
+    CHECK(fw.stats.spurious == 2 && fw.stats.frames == 3);
+}
+
+/* Frames done as soon as they start: every interrupt in a masked section comes after it */
+static void test_masked(void)
+{
+    inflate_fw_frame_t frames[INFLATE_FW_DEPTH];
+
+    setup();
+    CHECK(inflate_fw_configure(&fw, &config) == 0);
+    stub.instant = 1;
+    for (int i = 0; i < INFLATE_FW_DEPTH; i++) {
+        make_frame(&frames[i], i);
+        CHECK(inflate_fw_submit(&fw, &frames[i]) == 0);
+        CHECK(!stub.masked);
+    }
+    CHECK(stub.starts == INFLATE_FW_DEPTH && fw.stats.frames == INFLATE_FW_DEPTH);
+    for (int i = 0; i < INFLATE_FW_DEPTH; i++) {
+        inflate_fw_frame_t *frame = inflate_fw_next_done(&fw);
+        CHECK(frame == &frames[i] && frame_ok(frame, i));
+    }
+}
+
+int main(void)
+{
+    test_configure();
+    test_queue();
+    test_full_and_wrap();
+    test_errors();
+    test_masked();
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("*** ALL TESTS PASSED! ***\n");
+    return 0;
+}
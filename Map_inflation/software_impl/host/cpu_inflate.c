@@ -0,0 +1,56 @@
+#include "cpu_inflate.h"
+
+#define CPU_LETHAL 254
+
+static int clamp(int v, int lo, int hi)
+{
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+void cpu_inflate_rect(const uint8_t *map, uint8_t *out, int width, int height,
+                      int x0, int x1, int y0, int y1, int radius, const uint8_t *weights,
+                      int inflation, int replicate)
+{
+    const int k = 2 * radius + 1;
+
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            /* inflation starts from the cost of the cell itself */
+            uint32_t acc = inflation ? map[(size_t)y * width + x] : 0;
+
+            for (int dy = -radius; dy <= radius; dy++) {
+                int ny = y + dy;
+                if (ny < 0 || ny >= height) {
+                    if (!replicate)
+                        continue;
+                    ny = clamp(ny, 0, height - 1);
+                }
+                const uint8_t *row = map + (size_t)ny * width;
+                const uint8_t *w   = weights + (size_t)(dy + radius) * k + radius;
+
+                for (int dx = -radius; dx <= radius; dx++) {
+                    int nx = x + dx;
+                    if (nx < 0 || nx >= width) {
+                        if (!replicate)
+                            continue;
+                        nx = clamp(nx, 0, width - 1);
+                    }
+                    if (inflation) {
+                        if (row[nx] == CPU_LETHAL && w[dx] > acc)
+                            acc = w[dx];
+                    }
+                    else
+                        acc += (uint32_t)row[nx] * w[dx];
+                }
+            }
+            out[(size_t)y * width + x] = (uint8_t)(acc > 255 ? 255 : acc);
+        }
+    }
+}
+
+void cpu_inflate_rows(const uint8_t *map, uint8_t *out, int width, int height,
+                      int y0, int y1, int radius, const uint8_t *weights,
+                      int inflation, int replicate)
+{
+    cpu_inflate_rect(map, out, width, height, 0, width, y0, y1, radius, weights, inflation, replicate);
+}
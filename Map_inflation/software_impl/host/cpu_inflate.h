@@ -0,0 +1,39 @@
+#ifndef INFLATE_CPU_INFLATE_H
+#define INFLATE_CPU_INFLATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------- CPU engine ---------------- */
+/*
+ * Window operation of the accelerator on the CPU, for any band of rows of
+ * a width x height map (row-major, one byte per cell): the result of cell
+ * (x, y) is, over the (2r+1) x (2r+1) window centred on it,
+ *   inflation   : max of the cost of the cell itself and of weight[dy][dx]
+ *                 where the cell is lethal (254), as map_inflation_compute()
+ *                 (inflation_random.c) does,
+ *   convolution : sum of cell * weight[dy][dx], saturated to 255
+ *                 (as axi_roi_writer.sv stores it),
+ * with the cells outside the map zero, or the nearest edge cell with
+ * replicate. weights is the kernel of kgen_kernel(), so the results match
+ * the ones of the on-chip kernel. The band reads the rows around it in
+ * place: bands of one map can run on several threads at once.
+ */
+void cpu_inflate_rows(const uint8_t *map, uint8_t *out, int width, int height,
+                      int y0, int y1, int radius, const uint8_t *weights,
+                      int inflation, int replicate);
+
+/* Same, for the columns x0 .. x1 - 1 of the rows y0 .. y1 - 1 only */
+void cpu_inflate_rect(const uint8_t *map, uint8_t *out, int width, int height,
+                      int x0, int x1, int y0, int y1, int radius, const uint8_t *weights,
+                      int inflation, int replicate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INFLATE_CPU_INFLATE_H */
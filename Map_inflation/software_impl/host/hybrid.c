@@ -0,0 +1,305 @@
+#include "hybrid.h"
+#include "cpu_inflate.h"
+#include "inflate_tile.h"
+#include "kernel_gen.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* CPU thread i computes the band of worker i + 1 */
+typedef struct {
+    struct hybrid *hybrid;
+    int            worker;
+} hybrid_thread_t;
+
+struct hybrid {
+    inflate_dev_t   *dev;
+    int              device_error;   /* error that took the accelerator out of the split */
+    int              max_width;
+    int              cpu_threads;
+    pthread_t        threads[HYBRID_MAX_THREADS];
+    hybrid_thread_t  thread_args[HYBRID_MAX_THREADS];
+    pthread_mutex_t  lock;
+    pthread_cond_t   go;             /* a new frame, or stop */
+    pthread_cond_t   done;           /* a CPU band is done */
+    uint64_t         frame;          /* frames given to the threads */
+    int              pending;        /* CPU bands of the frame not done */
+    int              stop;
+
+    /* frame in progress */
+    const uint8_t   *map;
+    uint8_t         *out;
+    inflate_params_t params;
+    uint8_t         *weights;        /* kgen_kernel() of params */
+    int              y0[HYBRID_MAX_THREADS + 1];
+    int              y1[HYBRID_MAX_THREADS + 1];
+    hybrid_worker_t  workers[HYBRID_MAX_THREADS + 1];
+    uint8_t         *band_out;       /* accelerator band, halo included */
+    size_t           band_size;
+};
+
+static double now_s(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+static void cpu_band(hybrid_t *hybrid, int w)
+{
+    const inflate_params_t *p = &hybrid->params;
+
+    cpu_inflate_rows(hybrid->map, hybrid->out, p->width, p->height, hybrid->y0[w], hybrid->y1[w],
+                     p->radius, hybrid->weights, p->inflation, p->replicate);
+}
+
+static void *thread_main(void *arg)
+{
+    hybrid_thread_t *self   = (hybrid_thread_t *)arg;
+    hybrid_t        *hybrid = self->hybrid;
+    int              w      = self->worker;
+    uint64_t         seen   = 0;
+
+    pthread_mutex_lock(&hybrid->lock);
+    for (;;) {
+        while (hybrid->frame == seen && !hybrid->stop)
+            pthread_cond_wait(&hybrid->go, &hybrid->lock);
+        if (hybrid->stop)
+            break;
+        seen = hybrid->frame;
+        pthread_mutex_unlock(&hybrid->lock);
+
+        double start = now_s();
+        if (hybrid->y1[w] > hybrid->y0[w])
+            cpu_band(hybrid, w);
+        double seconds = now_s() - start;
+
+        pthread_mutex_lock(&hybrid->lock);
+        hybrid->workers[w].seconds = seconds;
+        if (--hybrid->pending == 0)
+            pthread_cond_signal(&hybrid->done);
+    }
+    pthread_mutex_unlock(&hybrid->lock);
+    return NULL;
+}
+
+/*
+ * Bands of the next frame: quanta of rows in proportion to the rates,
+ * one at least per worker when there are enough, the remainder to the
+ * largest fractions. A worker never measured counts as the mean of the
+ * others (all equal on the first frame).
+ */
+static void split(hybrid_t *hybrid, int height)
+{
+    int    first   = ((hybrid->dev && !hybrid->device_error) || hybrid->cpu_threads == 0) ? 0 : 1;
+    int    last    = hybrid->cpu_threads;
+    int    count   = last - first + 1;
+    int    quanta  = (height + HYBRID_ROW_QUANTUM - 1) / HYBRID_ROW_QUANTUM;
+    int    given   = 0;
+    double known   = 0.0, total = 0.0;
+    int    measured = 0;
+    double rate[HYBRID_MAX_THREADS + 1], fraction[HYBRID_MAX_THREADS + 1];
+    int    share[HYBRID_MAX_THREADS + 1];
+
+    for (int w = first; w <= last; w++)
+        if (hybrid->workers[w].rate > 0.0) {
+            known += hybrid->workers[w].rate;
+            measured++;
+        }
+    for (int w = first; w <= last; w++) {
+        rate[w] = hybrid->workers[w].rate > 0.0 ? hybrid->workers[w].rate : (measured ? known / measured : 1.0);
+        total  += rate[w];
+    }
+
+    int floor_quanta = quanta >= count ? 1 : 0;
+    int spread       = quanta - floor_quanta * count;
+    for (int w = first; w <= last; w++) {
+        double exact = spread * rate[w] / total;
+        share[w]    = floor_quanta + (int)exact;
+        fraction[w] = exact - (int)exact;
+        given      += share[w];
+    }
+    while (given < quanta) {
+        int best = first;
+        for (int w = first; w <= last; w++)
+            if (fraction[w] > fraction[best])
+                best = w;
+        share[best]++;
+        fraction[best] = -1.0;
+        given++;
+    }
+
+    int y = 0;
+    hybrid->y0[0] = hybrid->y1[0] = 0;
+    for (int w = first; w <= last; w++) {
+        hybrid->y0[w] = y;
+        y += share[w] * HYBRID_ROW_QUANTUM;
+        if (y > height)
+            y = height;
+        hybrid->y1[w] = y;
+    }
+}
+
+/* Top band on the accelerator: its rows and radius rows of halo, the kept rows copied to out */
+static int device_band(hybrid_t *hybrid)
+{
+    const inflate_params_t *p    = &hybrid->params;
+    int                     rows = hybrid->y1[0];
+    inflate_params_t        band = *p;
+    tile_plan_t             plan;
+
+    band.height = rows + p->radius < p->height ? rows + p->radius : p->height;
+    if (tile_plan(&plan, band.width, band.height, band.radius, hybrid->max_width) != 0)
+        return -EINVAL;
+
+    size_t size = (size_t)band.width * band.height;
+    if (size > hybrid->band_size) {
+        uint8_t *grown = (uint8_t *)realloc(hybrid->band_out, size);
+        if (!grown)
+            return -ENOMEM;
+        hybrid->band_out  = grown;
+        hybrid->band_size = size;
+    }
+
+    int status = inflate_tiled(hybrid->dev, hybrid->map, hybrid->band_out, &band, &plan);
+    if (status == 0)
+        memcpy(hybrid->out, hybrid->band_out, (size_t)band.width * rows);
+    return status;
+}
+
+hybrid_t *hybrid_open(inflate_dev_t *dev, int cpu_threads, int max_width)
+{
+    if (cpu_threads < 0 || cpu_threads > HYBRID_MAX_THREADS || (!dev && cpu_threads == 0))
+        return NULL;
+
+    hybrid_t *hybrid = (hybrid_t *)calloc(1, sizeof(*hybrid));
+    if (!hybrid)
+        return NULL;
+    hybrid->dev       = dev;
+    hybrid->max_width = max_width;
+    pthread_mutex_init(&hybrid->lock, NULL);
+    pthread_cond_init(&hybrid->go, NULL);
+    pthread_cond_init(&hybrid->done, NULL);
+
+    for (int i = 0; i < cpu_threads; i++) {
+        hybrid->thread_args[i].hybrid = hybrid;
+        hybrid->thread_args[i].worker = i + 1;
+        if (pthread_create(&hybrid->threads[i], NULL, thread_main, &hybrid->thread_args[i]) != 0) {
+            hybrid_close(hybrid);
+            return NULL;
+        }
+        hybrid->cpu_threads++;
+    }
+    return hybrid;
+}
+
+int hybrid_run(hybrid_t *hybrid, const uint8_t *map, uint8_t *out,
+               const inflate_params_t *params)
+{
+    const inflate_params_t *p = params;
+    int k = 2 * p->radius + 1;
+
+    if (!map || !out || p->width <= 0 || p->height <= 0 || p->radius < 0)
+        return -EINVAL;
+
+    /* kernel of the CPU threads, the one kernel_gen.sv computes */
+    if (!hybrid->weights || hybrid->params.radius != p->radius ||
+        hybrid->params.cost_scaling_factor != p->cost_scaling_factor ||
+        hybrid->params.inscribed_radius != p->inscribed_radius || hybrid->params.resolution != p->resolution) {
+        uint8_t *weights = (uint8_t *)realloc(hybrid->weights, (size_t)k * k);
+        if (!weights)
+            return -ENOMEM;
+        hybrid->weights = weights;
+        kgen_kernel(p->radius, KGEN_FIXED(p->cost_scaling_factor), KGEN_FIXED(p->inscribed_radius),
+                    KGEN_FIXED(p->resolution), weights);
+    }
+    hybrid->map    = map;
+    hybrid->out    = out;
+    hybrid->params = *p;
+    split(hybrid, p->height);
+
+    pthread_mutex_lock(&hybrid->lock);
+    hybrid->pending = hybrid->cpu_threads;
+    hybrid->frame++;
+    pthread_cond_broadcast(&hybrid->go);
+    pthread_mutex_unlock(&hybrid->lock);
+
+    /*
+     * the accelerator band runs on this thread, asleep in inflate_wait() most
+     * of the time (on the CPU once the accelerator failed, if it is alone)
+     */
+    if (hybrid->y1[0] > 0) {
+        double start  = now_s();
+        int    status = hybrid->device_error ? hybrid->device_error : device_band(hybrid);
+        if (status != 0) {
+            hybrid->device_error = status;
+            cpu_band(hybrid, 0);
+        }
+        hybrid->workers[0].seconds = now_s() - start;
+    }
+
+    pthread_mutex_lock(&hybrid->lock);
+    while (hybrid->pending > 0)
+        pthread_cond_wait(&hybrid->done, &hybrid->lock);
+    pthread_mutex_unlock(&hybrid->lock);
+
+    for (int w = 0; w <= hybrid->cpu_threads; w++) {
+        hybrid_worker_t *worker = &hybrid->workers[w];
+        worker->rows = hybrid->y1[w] - hybrid->y0[w];
+        if (worker->rows == 0 || worker->seconds <= 0.0)
+            continue;
+        double rate  = (double)worker->rows * p->width / worker->seconds;
+        worker->rate = worker->rate > 0.0 ? worker->rate + HYBRID_EWMA * (rate - worker->rate) : rate;
+    }
+    if (hybrid->device_error && hybrid->cpu_threads > 0)
+        hybrid->workers[0].rate = 0.0;
+    return 0;
+}
+
+int hybrid_get_workers(hybrid_t *hybrid, hybrid_worker_t *workers, int max)
+{
+    int count = hybrid->cpu_threads + 1 < max ? hybrid->cpu_threads + 1 : max;
+
+    memcpy(workers, hybrid->workers, sizeof(*workers) * count);
+    return count;
+}
+
+void hybrid_print_stats(FILE *out, hybrid_t *hybrid)
+{
+    for (int w = 0; w <= hybrid->cpu_threads; w++) {
+        const hybrid_worker_t *worker = &hybrid->workers[w];
+        if (w == 0 && !hybrid->dev)
+            continue;
+        if (w == 0)
+            fprintf(out, "  accelerator : ");
+        else
+            fprintf(out, "  cpu %-7d : ", w);
+        fprintf(out, "%5d rows, %8.3f ms, %8.2f Mcells/s\n", worker->rows, worker->seconds * 1e3,
+                worker->rate * 1e-6);
+    }
+    if (hybrid->device_error)
+        fprintf(out, "  accelerator left the split : error %d\n", hybrid->device_error);
+}
+
+void hybrid_close(hybrid_t *hybrid)
+{
+    if (!hybrid)
+        return;
+
+    pthread_mutex_lock(&hybrid->lock);
+    hybrid->stop = 1;
+    pthread_cond_broadcast(&hybrid->go);
+    pthread_mutex_unlock(&hybrid->lock);
+    for (int i = 0; i < hybrid->cpu_threads; i++)
+        pthread_join(hybrid->threads[i], NULL);
+
+    pthread_cond_destroy(&hybrid->done);
+    pthread_cond_destroy(&hybrid->go);
+    pthread_mutex_destroy(&hybrid->lock);
+    free(hybrid->weights);
+    free(hybrid->band_out);
+    free(hybrid);
+}
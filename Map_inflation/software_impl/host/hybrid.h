@@ -0,0 +1,68 @@
+#ifndef INFLATE_HYBRID_H
+#define INFLATE_HYBRID_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "inflate.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------- CPU + accelerator co-scheduling ---------------- */
+/*
+ * Every frame is cut into bands of rows, one for the accelerator (the top
+ * one, with radius rows of halo below it, through inflate_tiled()) and one
+ * for every CPU thread (cpu_inflate_rows(), reading the map in place, no
+ * halo). The rows of a worker follow its share of the measured rates:
+ *   rate = cells of its band / seconds, averaged over the frames
+ *          (weight HYBRID_EWMA for the last one),
+ * so a CPU thread slowed down by other processes gets fewer rows on the
+ * next frames. Bands are multiples of HYBRID_ROW_QUANTUM rows (the
+ * accelerator geometry only changes when the rates move by a quantum),
+ * and every worker keeps at least one quantum to stay measured.
+ * The results are the ones of one worker on the whole map. If the
+ * accelerator fails, its band is computed on the CPU and it leaves the
+ * split.
+ */
+#define HYBRID_MAX_THREADS 32
+#define HYBRID_ROW_QUANTUM 8
+#define HYBRID_EWMA        0.25
+
+typedef struct hybrid hybrid_t;
+
+typedef struct {
+    int    rows;                   /* rows of the last frame */
+    double seconds;                /* time of its band on the last frame */
+    double rate;                   /* cells per second, averaged */
+} hybrid_worker_t;
+
+/*
+ * Scheduler on dev (NULL : CPU only) and cpu_threads threads (0 : the
+ * accelerator only). max_width is the row limit of the accelerator for
+ * the column tiling (TILE_DEFAULT_WIDTH).
+ */
+hybrid_t *hybrid_open(inflate_dev_t *dev, int cpu_threads, int max_width);
+
+/* One width x height frame, split between the workers. Returns 0 or -EINVAL */
+int hybrid_run(hybrid_t *hybrid, const uint8_t *map, uint8_t *out,
+               const inflate_params_t *params);
+
+/*
+ * Workers of the last frame: 0 is the accelerator, 1 .. cpu_threads the
+ * CPU threads. Returns their number (at most max).
+ */
+int hybrid_get_workers(hybrid_t *hybrid, hybrid_worker_t *workers, int max);
+
+/* Rows and rate of every worker, and the error that removed the accelerator if any */
+void hybrid_print_stats(FILE *out, hybrid_t *hybrid);
+
+/* Stops the CPU threads (dev stays open) */
+void hybrid_close(hybrid_t *hybrid);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INFLATE_HYBRID_H */
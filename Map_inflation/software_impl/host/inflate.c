@@ -0,0 +1,306 @@
+#include "inflate.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* ---------------- Submission queue ---------------- */
+/*
+ * Ticket t lives in slot t % INFLATE_QUEUE_DEPTH from inflate_submit() to
+ * the inflate_wait() that returns its status. The worker takes the tickets
+ * in order, so a submit waits for the slot of ticket t - INFLATE_QUEUE_DEPTH
+ * to be released.
+ */
+enum { JOB_FREE, JOB_QUEUED, JOB_RUNNING, JOB_DONE };
+
+typedef struct {
+    inflate_ticket_t ticket;
+    int              state;
+    int              status;         /* backend result once JOB_DONE */
+    const uint8_t   *map;
+    uint8_t         *out;
+    inflate_params_t params;
+} inflate_job_t;
+
+struct inflate_dev {
+    inflate_backend_t backend;
+    pthread_t         worker;
+    pthread_mutex_t   lock;
+    pthread_cond_t    changed;       /* any job changed state, or stop */
+    inflate_job_t     jobs[INFLATE_QUEUE_DEPTH];
+    inflate_ticket_t  next_ticket;   /* given to the next submit */
+    inflate_ticket_t  next_run;      /* next ticket for the worker */
+    int               stop;
+    int               configured;    /* the backend holds current */
+    inflate_params_t  current;
+    inflate_stats_t   stats;
+};
+
+static int params_equal(const inflate_params_t *a, const inflate_params_t *b)
+{
+    return a->width == b->width && a->height == b->height && a->radius == b->radius &&
+           a->inflation == b->inflation && a->replicate == b->replicate &&
+           a->cost_scaling_factor == b->cost_scaling_factor &&
+           a->inscribed_radius == b->inscribed_radius && a->resolution == b->resolution;
+}
+
+static double now_s(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+static void account(inflate_dev_t *dev, double *counter, double since)
+{
+    double elapsed = now_s() - since;
+
+    pthread_mutex_lock(&dev->lock);
+    *counter += elapsed;
+    pthread_mutex_unlock(&dev->lock);
+}
+
+/* Next queued ticket, or NULL (nothing queued without block, or stop) */
+static inflate_job_t *take_job(inflate_dev_t *dev, int block)
+{
+    inflate_job_t *job = NULL;
+
+    pthread_mutex_lock(&dev->lock);
+    for (;;) {
+        inflate_job_t *next = &dev->jobs[dev->next_run % INFLATE_QUEUE_DEPTH];
+        if (next->state == JOB_QUEUED && next->ticket == dev->next_run) {
+            next->state = JOB_RUNNING;
+            dev->next_run++;
+            job = next;
+            break;
+        }
+        if (!block || dev->stop)
+            break;
+        pthread_cond_wait(&dev->changed, &dev->lock);
+    }
+    pthread_mutex_unlock(&dev->lock);
+    return job;
+}
+
+static void finish_job(inflate_dev_t *dev, inflate_job_t *job, int status)
+{
+    pthread_mutex_lock(&dev->lock);
+    job->status = status;
+    job->state  = JOB_DONE;
+    if (status == 0)
+        dev->stats.frames++;
+    pthread_cond_broadcast(&dev->changed);
+    pthread_mutex_unlock(&dev->lock);
+}
+
+/* End of the frame on the accelerator, then its results */
+static int wait_job(inflate_dev_t *dev, inflate_job_t *job, int slot, double started)
+{
+    int status = dev->backend.wait(dev->backend.ctx, slot, &job->params);
+    account(dev, &dev->stats.compute, started);
+    return status;
+}
+
+static void store_job(inflate_dev_t *dev, inflate_job_t *job, int slot, int status)
+{
+    if (status == 0) {
+        double since = now_s();
+        status = dev->backend.store(dev->backend.ctx, slot, job->out, &job->params);
+        account(dev, &dev->stats.store, since);
+    }
+    finish_job(dev, job, status);
+}
+
+/*
+ * Two frames in the pipe: the one on the accelerator (running, in the
+ * other slot) and the next one (job, in slot). Every round loads job while
+ * running computes, then starts job and stores running while job computes.
+ */
+static void *worker_main(void *arg)
+{
+    inflate_dev_t *dev     = (inflate_dev_t *)arg;
+    inflate_job_t *running = NULL;
+    int            slot    = 0;
+    double         started = 0.0, busy_since = 0.0;
+
+    for (;;) {
+        inflate_job_t *job = take_job(dev, running == NULL);
+        int status = 0;
+
+        if (!job && !running)
+            break;
+        if (!running)
+            busy_since = now_s();
+
+        /* the kernel is only generated again when the parameters change, on an idle accelerator */
+        if (job && (!dev->configured || !params_equal(&dev->current, &job->params))) {
+            if (running) {
+                store_job(dev, running, slot ^ 1, wait_job(dev, running, slot ^ 1, started));
+                running = NULL;
+            }
+            dev->configured = 0;
+            status = dev->backend.configure(dev->backend.ctx, &job->params);
+            if (status == 0) {
+                dev->current    = job->params;
+                dev->configured = 1;
+            }
+        }
+
+        if (job && status == 0) {
+            double since = now_s();
+            status = dev->backend.load(dev->backend.ctx, slot, job->map, &job->params);
+            account(dev, &dev->stats.load, since);
+        }
+        int running_status = running ? wait_job(dev, running, slot ^ 1, started) : 0;
+        if (job && status == 0) {
+            started = now_s();
+            status  = dev->backend.start(dev->backend.ctx, slot, &job->params);
+        }
+        if (running)
+            store_job(dev, running, slot ^ 1, running_status);
+
+        if (job && status != 0) {
+            finish_job(dev, job, status);
+            job = NULL;
+        }
+        running = job;
+        if (running)
+            slot ^= 1;
+        else
+            account(dev, &dev->stats.busy, busy_since);
+    }
+    return NULL;
+}
+
+inflate_dev_t *inflate_open(const inflate_backend_t *backend)
+{
+    if (!backend || !backend->configure || !backend->load || !backend->start || !backend->wait ||
+        !backend->store)
+        return NULL;
+
+    inflate_dev_t *dev = (inflate_dev_t *)calloc(1, sizeof(*dev));
+    if (!dev) {
+        if (backend->close)
+            backend->close(backend->ctx);
+        return NULL;
+    }
+    dev->backend     = *backend;
+    dev->next_ticket = 1;
+    dev->next_run    = 1;
+    pthread_mutex_init(&dev->lock, NULL);
+    pthread_cond_init(&dev->changed, NULL);
+
+    if (pthread_create(&dev->worker, NULL, worker_main, dev) != 0) {
+        pthread_cond_destroy(&dev->changed);
+        pthread_mutex_destroy(&dev->lock);
+        if (backend->close)
+            backend->close(backend->ctx);
+        free(dev);
+        return NULL;
+    }
+    return dev;
+}
+
+inflate_ticket_t inflate_submit(inflate_dev_t *dev, const uint8_t *map,
+                                uint8_t *out, const inflate_params_t *params)
+{
+    if (!dev || !map || !out || !params || params->width <= 0 || params->height <= 0 ||
+        params->radius < 0)
+        return -EINVAL;
+
+    pthread_mutex_lock(&dev->lock);
+    inflate_ticket_t ticket = dev->next_ticket;
+    inflate_job_t   *job    = &dev->jobs[ticket % INFLATE_QUEUE_DEPTH];
+
+    while (job->state != JOB_FREE && !dev->stop)
+        pthread_cond_wait(&dev->changed, &dev->lock);
+    if (dev->stop) {
+        pthread_mutex_unlock(&dev->lock);
+        return -EPIPE;
+    }
+
+    job->ticket = ticket;
+    job->status = 0;
+    job->map    = map;
+    job->out    = out;
+    job->params = *params;
+    job->state  = JOB_QUEUED;
+    dev->next_ticket++;
+    pthread_cond_broadcast(&dev->changed);
+    pthread_mutex_unlock(&dev->lock);
+    return ticket;
+}
+
+int inflate_wait(inflate_dev_t *dev, inflate_ticket_t ticket, int timeout_ms)
+{
+    if (!dev || ticket <= 0)
+        return -EINVAL;
+
+    struct timespec deadline;
+    if (timeout_ms >= 0) {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec  += timeout_ms / 1000;
+        deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    pthread_mutex_lock(&dev->lock);
+    inflate_job_t *job = &dev->jobs[ticket % INFLATE_QUEUE_DEPTH];
+    int status = 0;
+
+    while (job->ticket == ticket && job->state != JOB_FREE && job->state != JOB_DONE && status == 0) {
+        if (timeout_ms < 0)
+            pthread_cond_wait(&dev->changed, &dev->lock);
+        else
+            status = -pthread_cond_timedwait(&dev->changed, &dev->lock, &deadline);
+    }
+
+    if (job->ticket != ticket || job->state == JOB_FREE)
+        status = -EINVAL;
+    else if (job->state == JOB_DONE) {
+        status     = job->status;
+        job->state = JOB_FREE;
+        pthread_cond_broadcast(&dev->changed);
+    }
+    pthread_mutex_unlock(&dev->lock);
+    return status;
+}
+
+void inflate_get_stats(inflate_dev_t *dev, inflate_stats_t *stats)
+{
+    pthread_mutex_lock(&dev->lock);
+    *stats = dev->stats;
+    pthread_mutex_unlock(&dev->lock);
+}
+
+void inflate_print_stats(FILE *out, const inflate_stats_t *stats)
+{
+    double busy = stats->busy > 0.0 ? stats->busy : 1.0;
+
+    fprintf(out, "%llu frames in %.3f s : %.1f frames/s, occupancy load %.1f%% compute %.1f%% store %.1f%%\n",
+            (unsigned long long)stats->frames, stats->busy, (double)stats->frames / busy,
+            100.0 * stats->load / busy, 100.0 * stats->compute / busy, 100.0 * stats->store / busy);
+}
+
+void inflate_close(inflate_dev_t *dev)
+{
+    if (!dev)
+        return;
+
+    /* the worker leaves once no frame is queued any more */
+    pthread_mutex_lock(&dev->lock);
+    dev->stop = 1;
+    pthread_cond_broadcast(&dev->changed);
+    pthread_mutex_unlock(&dev->lock);
+    pthread_join(dev->worker, NULL);
+
+    if (dev->backend.close)
+        dev->backend.close(dev->backend.ctx);
+    pthread_cond_destroy(&dev->changed);
+    pthread_mutex_destroy(&dev->lock);
+    free(dev);
+}
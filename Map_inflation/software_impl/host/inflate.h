@@ -0,0 +1,135 @@
+#ifndef INFLATE_H
+#define INFLATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------- Accelerator driver ---------------- */
+/*
+ * Asynchronous frame interface of the accelerator: inflate_submit() queues
+ * a map and returns a ticket at once, inflate_wait() blocks until that frame
+ * is done. A worker thread runs the queue on the backend, so the caller
+ * prepares frame N+1 while frame N is in flight, and the completion comes
+ * from the frame done interrupt, never from polling STATUS.
+ *
+ * Backends:
+ *   - inflate_open_uio()  : the board, registers and DMA buffer mapped from
+ *                           a UIO device (inflate_uio.c),
+ *   - inflate_open_sim()  : the Verilator model of top.v
+ *                           (hardware_impl/verilator/inflate_sim.cpp).
+ */
+#define INFLATE_QUEUE_DEPTH 8      /* frames queued or in flight */
+
+typedef struct {
+    int   width;                   /* cells per row */
+    int   height;                  /* rows */
+    int   radius;                  /* inflation radius in cells, clamped to the array */
+    int   inflation;               /* 1 : inflation (max), 0 : convolution */
+    int   replicate;               /* border : 0 zeros, 1 edge cells repeated */
+    float cost_scaling_factor;     /* kernel_compute() parameters */
+    float inscribed_radius;        /* m */
+    float resolution;              /* m per cell */
+} inflate_params_t;
+
+typedef int64_t inflate_ticket_t;
+
+typedef struct inflate_dev inflate_dev_t;
+
+/*
+ * A backend has INFLATE_SLOTS buffer slots, each with the input and the
+ * output of one frame, and runs one frame at a time, on the worker thread
+ * only:
+ *   configure : kernel and frame geometry, called when the parameters
+ *               change (no frame on the accelerator),
+ *   load      : the map into the input buffer of a slot,
+ *   start     : the frame of a slot on the accelerator, returns at once,
+ *   wait      : returns when the frame started is done (interrupt, or the
+ *               simulation),
+ *   store     : the results of a slot to out,
+ *   close     : releases the backend.
+ * All but close return 0 or a negative errno value. The worker loads frame
+ * N+1 and stores frame N-1 while frame N runs, in the other slot.
+ */
+#define INFLATE_SLOTS 2
+
+typedef struct {
+    const char *name;
+    int  (*configure)(void *ctx, const inflate_params_t *params);
+    int  (*load)(void *ctx, int slot, const uint8_t *map, const inflate_params_t *params);
+    int  (*start)(void *ctx, int slot, const inflate_params_t *params);
+    int  (*wait)(void *ctx, int slot, const inflate_params_t *params);
+    int  (*store)(void *ctx, int slot, uint8_t *out, const inflate_params_t *params);
+    void (*close)(void *ctx);
+    void *ctx;
+} inflate_backend_t;
+
+/*
+ * Time spent by the worker, in seconds, since the device was opened:
+ *   busy    : with at least one frame taken from the queue and not done,
+ *   load    : in load() (map to the device buffers),
+ *   compute : frames on the accelerator, start() to the return of wait()
+ *             (an upper bound when the frame ends during a load),
+ *   store   : in store() (results from the device buffers).
+ * frames / busy is the end-to-end frame rate under load, and
+ * load / busy, compute / busy, store / busy the occupancy of the stages.
+ * Overlap shows as load + compute + store > busy.
+ */
+typedef struct {
+    uint64_t frames;
+    double   busy;
+    double   load;
+    double   compute;
+    double   store;
+} inflate_stats_t;
+
+/* Device on a backend (takes ownership of it), NULL on failure */
+inflate_dev_t *inflate_open(const inflate_backend_t *backend);
+
+/*
+ * Board backend: uio is the UIO device of the accelerator ("/dev/uio0"),
+ * its map 0 the register window and map 1 a physically contiguous buffer
+ * for the DMA (reserved memory), at least 2 * INFLATE_SLOTS * max_cells
+ * bytes (rows rounded up to 4 cells).
+ */
+inflate_dev_t *inflate_open_uio(const char *uio, size_t max_cells);
+
+/* Simulation backend (only in programs linked with the Verilator model) */
+inflate_dev_t *inflate_open_sim(uint64_t seed);
+
+/*
+ * Queues a frame: width x height cells of map (row-major, one byte per
+ * cell), results written to out (same size) by the time inflate_wait()
+ * returns. map and out must stay valid until then. Blocks only while
+ * INFLATE_QUEUE_DEPTH frames are pending (submitted and not waited for, so
+ * wait for ticket t before submitting t + INFLATE_QUEUE_DEPTH). Returns the
+ * ticket (> 0) or a negative errno value.
+ */
+inflate_ticket_t inflate_submit(inflate_dev_t *dev, const uint8_t *map,
+                                uint8_t *out, const inflate_params_t *params);
+
+/*
+ * Waits for a frame (timeout_ms < 0 : no timeout). Returns 0, the negative
+ * errno value of the backend for that frame, -ETIMEDOUT, or -EINVAL for an
+ * unknown ticket (or one already waited for).
+ */
+int inflate_wait(inflate_dev_t *dev, inflate_ticket_t ticket, int timeout_ms);
+
+/* Counters since the device was opened */
+void inflate_get_stats(inflate_dev_t *dev, inflate_stats_t *stats);
+
+/* One line: frames, frames per second, occupancy of the stages */
+void inflate_print_stats(FILE *out, const inflate_stats_t *stats);
+
+/* Waits for the pending frames, stops the worker and closes the backend */
+void inflate_close(inflate_dev_t *dev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INFLATE_H */
@@ -0,0 +1,149 @@
+/*
+ * Frame rate of the accelerator on the board, through the UIO backend of
+ * the host library (inflate.h): random cluttered maps, up to --depth frames
+ * in flight (--depth 1 : load, compute and store one after the other).
+ * Maps wider than --max-width go through the column tiling of
+ * inflate_tile.h, one map after the other. With --cpu-threads every map
+ * is split between the accelerator and that many CPU threads (hybrid.h).
+ *
+ *   gcc -O2 -pthread inflate_bench.c inflate.c inflate_tile.c inflate_uio.c hybrid.c cpu_inflate.c \
+ *       kernel_gen.c -lm -o inflate_bench
+ *   ./inflate_bench [--uio /dev/uio0] [--width W] [--height H] [--radius R] [--frames N] [--depth D]
+ *                   [--max-width M] [--cpu-threads N]
+ */
+#include "hybrid.h"
+#include "inflate.h"
+#include "inflate_tile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define LETHAL 254
+
+static double now_s(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+/* Round clusters of lethal cells, like generate_random_cluttered_costmap() (inflation_random.c) */
+static void cluttered_map(uint8_t *map, int width, int height, int num_clusters)
+{
+    memset(map, 0, (size_t)width * height);
+    for (int c = 0; c < num_clusters; c++) {
+        int cx = rand() % width, cy = rand() % height, radius = 1 + rand() % 3;
+        for (int dy = -radius; dy <= radius; dy++)
+            for (int dx = -radius; dx <= radius; dx++) {
+                int nx = cx + dx, ny = cy + dy;
+                if (dx * dx + dy * dy <= radius * radius && nx >= 0 && nx < width && ny >= 0 && ny < height)
+                    map[(size_t)ny * width + nx] = LETHAL;
+            }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    inflate_params_t params = {200, 200, 6, 1, 0, 10.0f, 0.1f, 0.05f};
+    const char *uio    = "/dev/uio0";
+    int         frames = 100;
+    int         depth  = INFLATE_QUEUE_DEPTH;
+    int         max_width = TILE_DEFAULT_WIDTH;
+    int         cpu_threads = 0;
+    int         usage  = argc % 2 == 0;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--uio"))
+            uio = argv[i + 1];
+        else if (!strcmp(argv[i], "--width"))
+            params.width = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--height"))
+            params.height = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--radius"))
+            params.radius = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--frames"))
+            frames = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--depth"))
+            depth = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--max-width"))
+            max_width = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--cpu-threads"))
+            cpu_threads = atoi(argv[i + 1]);
+        else
+            usage = 1;
+    }
+    if (usage || params.width <= 0 || params.height <= 0 || frames <= 0 || depth < 1 ||
+        depth > INFLATE_QUEUE_DEPTH || cpu_threads < 0 || cpu_threads > HYBRID_MAX_THREADS) {
+        fprintf(stderr, "usage: %s [--uio /dev/uioN] [--width W] [--height H] [--radius R] [--frames N] "
+                        "[--depth 1..%d] [--max-width M] [--cpu-threads N]\n", argv[0], INFLATE_QUEUE_DEPTH);
+        return 2;
+    }
+
+    tile_plan_t plan;
+    if (tile_plan(&plan, params.width, params.height, params.radius, max_width) != 0) {
+        fprintf(stderr, "no tiling of a %d wide map in rows of %d cells\n", params.width, max_width);
+        return 2;
+    }
+    if (plan.num_tiles > 1 && cpu_threads == 0)
+        tile_plan_print(stdout, &plan);
+
+    size_t cells = (size_t)params.width * params.height;
+    inflate_dev_t *dev = inflate_open_uio(uio, (size_t)plan.in_width * params.height);
+    if (!dev) {
+        fprintf(stderr, "cannot open %s\n", uio);
+        return 1;
+    }
+
+    /* one map and one result buffer per frame in flight */
+    uint8_t *maps = (uint8_t *)malloc(cells * depth);
+    uint8_t *outs = (uint8_t *)malloc(cells * depth);
+    inflate_ticket_t tickets[INFLATE_QUEUE_DEPTH];
+    int failures = 0;
+
+    hybrid_t *hybrid = cpu_threads > 0 ? hybrid_open(dev, cpu_threads, max_width) : NULL;
+    double    start  = now_s();
+    for (int f = 0; hybrid && f < frames; f++) {
+        cluttered_map(maps, params.width, params.height, 1 + (int)(cells / 200));
+        if (hybrid_run(hybrid, maps, outs, &params) != 0)
+            failures++;
+    }
+    if (hybrid) {
+        printf("%dx%d, radius %d, accelerator and %d CPU threads : %.1f frames/s\n", params.width,
+               params.height, params.radius, cpu_threads, frames / (now_s() - start));
+        hybrid_print_stats(stdout, hybrid);
+        hybrid_close(hybrid);
+    }
+
+    for (int f = 0; !cpu_threads && plan.num_tiles > 1 && f < frames; f++) {
+        cluttered_map(maps, params.width, params.height, 1 + (int)(cells / 200));
+        if (inflate_tiled(dev, maps, outs, &params, &plan) != 0)
+            failures++;
+    }
+    for (int f = 0; !cpu_threads && plan.num_tiles == 1 && f < frames + depth; f++) {
+        int buf = f % depth;
+        if (f >= depth && inflate_wait(dev, tickets[buf], -1) != 0)
+            failures++;
+        if (f < frames) {
+            cluttered_map(maps + cells * buf, params.width, params.height, 1 + (int)(cells / 200));
+            tickets[buf] = inflate_submit(dev, maps + cells * buf, outs + cells * buf, &params);
+            if (tickets[buf] < 0) {
+                fprintf(stderr, "frame %d : submit error %lld\n", f, (long long)tickets[buf]);
+                failures++;
+                break;
+            }
+        }
+    }
+
+    inflate_stats_t stats;
+    inflate_get_stats(dev, &stats);
+    inflate_close(dev);
+    printf("%dx%d, radius %d, %d in flight : ", params.width, params.height, params.radius, depth);
+    inflate_print_stats(stdout, &stats);
+    if (failures)
+        printf("%d failures\n", failures);
+    free(maps);
+    free(outs);
+    return failures ? 1 : 0;
+}
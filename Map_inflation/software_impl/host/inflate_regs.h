@@ -0,0 +1,48 @@
+#ifndef INFLATE_REGS_H
+#define INFLATE_REGS_H
+
+/* ---------------- Register map of the accelerator ---------------- */
+/*
+ * Offsets and bits of the AXI4-Lite register file (axim_reg.sv), shared by
+ * the Linux backend (inflate_uio.c) and the MicroBlaze firmware
+ * (software_impl/firmware). Only the registers the drivers use.
+ */
+#define INFLATE_REG_CTRL            0x00
+#define INFLATE_REG_STATUS          0x04
+#define INFLATE_REG_FRAME_WIDTH     0x08
+#define INFLATE_REG_FRAME_HEIGHT    0x0C
+#define INFLATE_REG_RADIUS          0x10
+#define INFLATE_REG_MODE            0x14
+#define INFLATE_REG_IRQ_ENABLE      0x18
+#define INFLATE_REG_IRQ_STATUS      0x1C
+#define INFLATE_REG_CONFIG          0x24
+#define INFLATE_REG_KGEN_SCALE      0x28
+#define INFLATE_REG_KGEN_INSCRIBED  0x2C
+#define INFLATE_REG_KGEN_RESOLUTION 0x30
+#define INFLATE_REG_DMA_CTRL        0xA0
+#define INFLATE_REG_DMA_STATUS      0xA4
+#define INFLATE_REG_SRC_ADDR        0xA8
+#define INFLATE_REG_SRC_STRIDE      0xAC
+#define INFLATE_REG_SRC_WIDTH       0xB0
+#define INFLATE_REG_SRC_HEIGHT      0xB4
+#define INFLATE_REG_DST_ADDR        0xB8
+#define INFLATE_REG_DST_STRIDE      0xBC
+
+#define INFLATE_CTRL_START          (1u << 0)
+#define INFLATE_CTRL_STOP           (1u << 1)
+#define INFLATE_CTRL_KGEN_START     (1u << 4)
+#define INFLATE_STATUS_LOADING      (1u << 2)
+#define INFLATE_STATUS_KGEN_BUSY    (1u << 4)
+#define INFLATE_MODE_INFLATION      (1u << 0)
+#define INFLATE_MODE_BORDER         (1u << 4)
+#define INFLATE_MODE_REPLICATE      (1u << 5)
+#define INFLATE_IRQ_FRAME_DONE      (1u << 0)
+#define INFLATE_IRQ_KERNEL_READY    (1u << 1)
+#define INFLATE_DMA_READ_EN         (1u << 0)
+#define INFLATE_DMA_WRITE_EN        (1u << 1)
+#define INFLATE_DMA_ERRORS          (3u << 2)
+#define INFLATE_CONFIG_ARRAY_SIZE   0xFFu
+#define INFLATE_CONFIG_NUM_ENGINES(config)  (((config) >> 8) & 0xFFu)
+#define INFLATE_CONFIG_COST_WIDTH(config)   (((config) >> 16) & 0xFFu)   /* bits per output cell (saturated) */
+
+#endif /* INFLATE_REGS_H */
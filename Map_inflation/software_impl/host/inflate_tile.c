@@ -0,0 +1,126 @@
+#include "inflate_tile.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TILE_IN_FLIGHT (INFLATE_QUEUE_DEPTH / 2)
+
+int tile_plan(tile_plan_t *plan, int map_width, int map_height, int radius, int max_width)
+{
+    int n = 1;
+
+    if (map_width <= 0 || map_height <= 0 || radius < 0)
+        return -1;
+    if (map_width > max_width) {
+        if (max_width <= 2 * radius)
+            return -1;
+        n = (map_width - 2 * radius + (max_width - 2 * radius) - 1) / (max_width - 2 * radius);
+    }
+    if (n > TILE_MAX_TILES)
+        return -1;
+
+    /*
+     * n tiles of in_width columns cover the map with overlaps of 2r at
+     * least: n * in_width >= W + 2r(n-1), so the steps between the even
+     * positions below are at most in_width - 2r.
+     */
+    int in_width = (map_width + 2 * radius * (n - 1) + n - 1) / n;
+    if (in_width > map_width)
+        in_width = map_width;
+
+    plan->map_width  = map_width;
+    plan->map_height = map_height;
+    plan->radius     = radius;
+    plan->in_width   = in_width;
+    plan->num_tiles  = n;
+    for (int i = 0; i < n; i++) {
+        tile_t *tile = &plan->tiles[i];
+        tile->in_x0  = n > 1 ? (int)((int64_t)i * (map_width - in_width) / (n - 1)) : 0;
+        tile->out_x0 = i > 0 ? tile->in_x0 + radius : 0;
+    }
+    for (int i = 0; i < n; i++) {
+        int out_x1 = i + 1 < n ? plan->tiles[i + 1].out_x0 : map_width;
+        plan->tiles[i].out_width = out_x1 - plan->tiles[i].out_x0;
+    }
+    return 0;
+}
+
+uint64_t tile_plan_redundant_cells(const tile_plan_t *plan)
+{
+    return (uint64_t)(plan->num_tiles * plan->in_width - plan->map_width) * plan->map_height;
+}
+
+void tile_plan_print(FILE *out, const tile_plan_t *plan)
+{
+    uint64_t redundant = tile_plan_redundant_cells(plan);
+    uint64_t cells     = (uint64_t)plan->map_width * plan->map_height;
+
+    fprintf(out, "%dx%d map, radius %d : %d tiles of %d columns, %llu redundant cells (%.2f%% of the map)\n",
+            plan->map_width, plan->map_height, plan->radius, plan->num_tiles, plan->in_width,
+            (unsigned long long)redundant, 100.0 * (double)redundant / (double)cells);
+    for (int i = 0; i < plan->num_tiles; i++) {
+        const tile_t *tile = &plan->tiles[i];
+        fprintf(out, "  tile %2d : columns %5d..%5d, keeps %5d..%5d\n", i, tile->in_x0,
+                tile->in_x0 + plan->in_width - 1, tile->out_x0, tile->out_x0 + tile->out_width - 1);
+    }
+}
+
+/* Kept columns of tile i, from its result buffer into the map */
+static void stitch(const tile_plan_t *plan, int i, const uint8_t *result, uint8_t *out)
+{
+    const tile_t *tile = &plan->tiles[i];
+
+    for (int y = 0; y < plan->map_height; y++)
+        memcpy(out + (size_t)y * plan->map_width + tile->out_x0,
+               result + (size_t)y * plan->in_width + (tile->out_x0 - tile->in_x0), tile->out_width);
+}
+
+int inflate_tiled(inflate_dev_t *dev, const uint8_t *map, uint8_t *out,
+                  const inflate_params_t *params, const tile_plan_t *plan)
+{
+    if (plan->map_width != params->width || plan->map_height != params->height ||
+        plan->radius != params->radius)
+        return -EINVAL;
+
+    size_t   tile_cells = (size_t)plan->in_width * plan->map_height;
+    uint8_t *maps       = (uint8_t *)malloc(tile_cells * TILE_IN_FLIGHT);
+    uint8_t *results    = (uint8_t *)malloc(tile_cells * TILE_IN_FLIGHT);
+    inflate_ticket_t tickets[TILE_IN_FLIGHT];
+    inflate_params_t tile_params = *params;
+    int status = 0;
+
+    if (!maps || !results) {
+        free(maps);
+        free(results);
+        return -ENOMEM;
+    }
+    tile_params.width = plan->in_width;
+
+    /* tile i is cut out of the map while the ones before it run */
+    for (int i = 0; i < plan->num_tiles + TILE_IN_FLIGHT; i++) {
+        int buf = i % TILE_IN_FLIGHT;
+        int done = i - TILE_IN_FLIGHT;
+
+        if (done >= 0 && done < plan->num_tiles && tickets[buf] > 0) {
+            int s = inflate_wait(dev, tickets[buf], -1);
+            if (s == 0)
+                stitch(plan, done, results + tile_cells * buf, out);
+            else if (status == 0)
+                status = s;
+        }
+        if (i < plan->num_tiles) {
+            uint8_t *tile_map = maps + tile_cells * buf;
+            for (int y = 0; y < plan->map_height; y++)
+                memcpy(tile_map + (size_t)y * plan->in_width,
+                       map + (size_t)y * plan->map_width + plan->tiles[i].in_x0, plan->in_width);
+            tickets[buf] = inflate_submit(dev, tile_map, results + tile_cells * buf, &tile_params);
+            if (tickets[buf] < 0 && status == 0)
+                status = (int)tickets[buf];
+        }
+    }
+
+    free(maps);
+    free(results);
+    return status;
+}
@@ -0,0 +1,75 @@
+#ifndef INFLATE_TILE_H
+#define INFLATE_TILE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "inflate.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------- Column tiling of wide maps ---------------- */
+/*
+ * The accelerator takes rows of at most max_width cells (MAX_WIDTH of
+ * top.v, the depth of the line buffers, 2048 cells by default). A
+ * wider map is cut into column tiles, each with halos of radius cells on
+ * its inner sides, so every kept result sees its whole window:
+ *   - all the tiles have the same width, in_width <= max_width: the
+ *     geometry and the kernel are programmed once per map,
+ *   - the fewest tiles that fit, n = ceil((W - 2r) / (max_width - 2r)),
+ *     spread evenly: the redundant work is (n * in_width - W) * height
+ *     cells, the 2r columns of every seam and the rounding of in_width,
+ *   - tile i + 1 keeps its results from out_x0 = in_x0 + r, tile i keeps
+ *     the ones before, so the outputs meet without a seam,
+ *   - the tiles run left to right: the halo of a tile is the last columns
+ *     of the previous one, still warm in the caches and the DRAM rows.
+ * The rows are not cut: the engine has no limit on the number of rows.
+ */
+#define TILE_MAX_TILES     64
+#define TILE_DEFAULT_WIDTH 2048
+
+typedef struct {
+    int in_x0;                     /* first map column fed to the accelerator */
+    int out_x0;                    /* first column kept */
+    int out_width;                 /* columns kept, from out_x0 */
+} tile_t;
+
+typedef struct {
+    int    map_width;
+    int    map_height;
+    int    radius;
+    int    in_width;               /* columns of every tile, halos included */
+    int    num_tiles;
+    tile_t tiles[TILE_MAX_TILES];
+} tile_plan_t;
+
+/*
+ * Plan of a map_width x map_height map. Returns -1 if max_width cannot hold
+ * a result column and its two halos (max_width <= 2 * radius) or if the map
+ * needs more than TILE_MAX_TILES tiles.
+ */
+int tile_plan(tile_plan_t *plan, int map_width, int map_height, int radius, int max_width);
+
+/* Cells run more than once, and the share of the map they add */
+uint64_t tile_plan_redundant_cells(const tile_plan_t *plan);
+
+/* Tiles, their columns and the redundant work */
+void tile_plan_print(FILE *out, const tile_plan_t *plan);
+
+/*
+ * Runs the whole map (params->width x params->height) through dev, tile by
+ * tile, up to INFLATE_QUEUE_DEPTH / 2 tiles in flight (the caller can keep
+ * as many frames of its own pending), and stitches the results into out:
+ * the ones of the centred window on the whole map. Returns 0, -EINVAL if the plan is not the one of the map, -ENOMEM, or
+ * the first error of a tile.
+ */
+int inflate_tiled(inflate_dev_t *dev, const uint8_t *map, uint8_t *out,
+                  const inflate_params_t *params, const tile_plan_t *plan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INFLATE_TILE_H */
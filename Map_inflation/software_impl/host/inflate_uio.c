@@ -0,0 +1,245 @@
+#include "inflate.h"
+#include "inflate_regs.h"
+#include "kernel_gen.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* ---------------- UIO backend ---------------- */
+/*
+ * The accelerator as a UIO device (generic-uio, the irq output of top.v as
+ * its interrupt):
+ *   map 0 : the AXI4-Lite register window (axim_reg.sv),
+ *   map 1 : a physically contiguous buffer the DMA masters reach, cut
+ *           into INFLATE_SLOTS slots, each a source ROI and the
+ *           destination ROI after it.
+ * A frame is copied into the source ROI of a slot, read and written back
+ * by the DMA (DMA_CTRL READ_EN | WRITE_EN) after START, and the worker
+ * sleeps in poll() on the device until the frame done interrupt (the
+ * kernel ready one for the kernel load of configure). The
+ * copies of the other slot run meanwhile: the mapping is uncached
+ * (O_SYNC), so they are the transfer cost of a frame.
+ */
+#define KGEN_TIMEOUT_MS     100
+#define FRAME_TIMEOUT_MS    1000
+
+typedef struct {
+    int                fd;
+    volatile uint32_t *regs;
+    size_t             regs_size;
+    uint8_t           *buf;
+    size_t             buf_size;
+    uint64_t           buf_phys;
+    int                array_size;   /* CONFIG bits 7:0 */
+    size_t             stride;       /* bytes per ROI row, multiple of 4 */
+    size_t             frame;        /* bytes per ROI */
+} uio_ctx_t;
+
+/* Source ROI of a slot, its destination ROI follows */
+static size_t slot_offset(const uio_ctx_t *uio, int slot)
+{
+    return 2 * uio->frame * slot;
+}
+
+static uint32_t reg_read(uio_ctx_t *uio, uint32_t offset)
+{
+    return uio->regs[offset / 4];
+}
+
+static void reg_write(uio_ctx_t *uio, uint32_t offset, uint32_t value)
+{
+    uio->regs[offset / 4] = value;
+}
+
+/* /sys/class/uio/uioN/maps/map<index>/<field>, a hexadecimal value */
+static int sysfs_map_value(const char *uio, int index, const char *field, uint64_t *value)
+{
+    const char *name = strrchr(uio, '/');
+    char path[128];
+    unsigned long long v;
+
+    snprintf(path, sizeof(path), "/sys/class/uio/%s/maps/map%d/%s", name ? name + 1 : uio, index, field);
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return -errno;
+    int ok = fscanf(f, "%llx", &v) == 1;
+    fclose(f);
+    if (!ok)
+        return -EIO;
+    *value = v;
+    return 0;
+}
+
+/* Enables the interrupt line of the UIO device (masked again after every interrupt) */
+static int uio_unmask(uio_ctx_t *uio)
+{
+    uint32_t on = 1;
+    return write(uio->fd, &on, sizeof(on)) == sizeof(on) ? 0 : -errno;
+}
+
+/* Sleeps until the next interrupt of the device (unmasked before) */
+static int uio_wait_irq(uio_ctx_t *uio, int timeout_ms)
+{
+    struct pollfd pfd = { uio->fd, POLLIN, 0 };
+    uint32_t      count;
+
+    int ready = poll(&pfd, 1, timeout_ms);
+    if (ready <= 0) {
+        reg_write(uio, INFLATE_REG_CTRL, INFLATE_CTRL_STOP);
+        return ready == 0 ? -ETIMEDOUT : -errno;
+    }
+    if (read(uio->fd, &count, sizeof(count)) != sizeof(count))
+        return -errno;
+    return 0;
+}
+
+static int uio_configure(void *ctx, const inflate_params_t *params)
+{
+    uio_ctx_t *uio = (uio_ctx_t *)ctx;
+    size_t stride  = ((size_t)params->width + 3) & ~(size_t)3;
+    size_t frame   = stride * params->height;
+    int    status;
+
+    if (2 * INFLATE_SLOTS * frame > uio->buf_size || 2 * params->radius + 1 > uio->array_size)
+        return -EINVAL;
+    uio->stride = stride;
+    uio->frame  = frame;
+
+    reg_write(uio, INFLATE_REG_CTRL, INFLATE_CTRL_STOP);
+    reg_write(uio, INFLATE_REG_RADIUS, params->radius);
+    reg_write(uio, INFLATE_REG_FRAME_WIDTH, params->width);
+    reg_write(uio, INFLATE_REG_FRAME_HEIGHT, params->height);
+    reg_write(uio, INFLATE_REG_MODE, (params->inflation ? INFLATE_MODE_INFLATION : 0) | INFLATE_MODE_BORDER |
+                                     (params->replicate ? INFLATE_MODE_REPLICATE : 0));
+    reg_write(uio, INFLATE_REG_SRC_STRIDE, (uint32_t)stride);
+    reg_write(uio, INFLATE_REG_SRC_WIDTH, params->width);
+    reg_write(uio, INFLATE_REG_SRC_HEIGHT, params->height);
+    reg_write(uio, INFLATE_REG_DST_STRIDE, (uint32_t)stride);
+    reg_write(uio, INFLATE_REG_DMA_CTRL, INFLATE_DMA_READ_EN | INFLATE_DMA_WRITE_EN);
+
+    /* the kernel load, once per parameter change, ends with the kernel ready interrupt */
+    reg_write(uio, INFLATE_REG_IRQ_ENABLE, INFLATE_IRQ_KERNEL_READY);
+    reg_write(uio, INFLATE_REG_IRQ_STATUS, INFLATE_IRQ_KERNEL_READY);
+    if ((status = uio_unmask(uio)) != 0)
+        return status;
+    reg_write(uio, INFLATE_REG_KGEN_SCALE, KGEN_FIXED(params->cost_scaling_factor));
+    reg_write(uio, INFLATE_REG_KGEN_INSCRIBED, KGEN_FIXED(params->inscribed_radius));
+    reg_write(uio, INFLATE_REG_KGEN_RESOLUTION, KGEN_FIXED(params->resolution));
+    reg_write(uio, INFLATE_REG_CTRL, INFLATE_CTRL_KGEN_START);
+    if ((status = uio_wait_irq(uio, KGEN_TIMEOUT_MS)) != 0)
+        return status;
+    reg_write(uio, INFLATE_REG_IRQ_STATUS, INFLATE_IRQ_KERNEL_READY);
+    reg_write(uio, INFLATE_REG_IRQ_ENABLE, INFLATE_IRQ_FRAME_DONE);
+    return 0;
+}
+
+static int uio_load(void *ctx, int slot, const uint8_t *map, const inflate_params_t *params)
+{
+    uio_ctx_t *uio = (uio_ctx_t *)ctx;
+    uint8_t   *src = uio->buf + slot_offset(uio, slot);
+
+    for (int y = 0; y < params->height; y++)
+        memcpy(src + y * uio->stride, map + (size_t)y * params->width, params->width);
+    return 0;
+}
+
+static int uio_start(void *ctx, int slot, const inflate_params_t *params)
+{
+    uio_ctx_t *uio = (uio_ctx_t *)ctx;
+    uint64_t   src = uio->buf_phys + slot_offset(uio, slot);
+    int        status;
+
+    (void)params;
+    reg_write(uio, INFLATE_REG_IRQ_STATUS, INFLATE_IRQ_FRAME_DONE);
+    if ((status = uio_unmask(uio)) != 0)
+        return status;
+    reg_write(uio, INFLATE_REG_SRC_ADDR, (uint32_t)src);
+    reg_write(uio, INFLATE_REG_DST_ADDR, (uint32_t)(src + uio->frame));
+    reg_write(uio, INFLATE_REG_CTRL, INFLATE_CTRL_START);
+    return 0;
+}
+
+static int uio_wait(void *ctx, int slot, const inflate_params_t *params)
+{
+    uio_ctx_t *uio = (uio_ctx_t *)ctx;
+    int        status;
+
+    (void)slot;
+    (void)params;
+    if ((status = uio_wait_irq(uio, FRAME_TIMEOUT_MS)) != 0)
+        return status;
+    reg_write(uio, INFLATE_REG_IRQ_STATUS, INFLATE_IRQ_FRAME_DONE);
+    return (reg_read(uio, INFLATE_REG_DMA_STATUS) & INFLATE_DMA_ERRORS) ? -EIO : 0;
+}
+
+static int uio_store(void *ctx, int slot, uint8_t *out, const inflate_params_t *params)
+{
+    uio_ctx_t     *uio = (uio_ctx_t *)ctx;
+    const uint8_t *dst = uio->buf + slot_offset(uio, slot) + uio->frame;
+
+    for (int y = 0; y < params->height; y++)
+        memcpy(out + (size_t)y * params->width, dst + y * uio->stride, params->width);
+    return 0;
+}
+
+static void uio_close(void *ctx)
+{
+    uio_ctx_t *uio = (uio_ctx_t *)ctx;
+
+    if (uio->regs) {
+        reg_write(uio, INFLATE_REG_IRQ_ENABLE, 0);
+        reg_write(uio, INFLATE_REG_CTRL, INFLATE_CTRL_STOP);
+        munmap((void *)uio->regs, uio->regs_size);
+    }
+    if (uio->buf)
+        munmap(uio->buf, uio->buf_size);
+    if (uio->fd >= 0)
+        close(uio->fd);
+    free(uio);
+}
+
+inflate_dev_t *inflate_open_uio(const char *uio_path, size_t max_cells)
+{
+    uio_ctx_t *uio = (uio_ctx_t *)calloc(1, sizeof(*uio));
+    uint64_t   regs_size, buf_size;
+    long       page = sysconf(_SC_PAGESIZE);
+
+    if (!uio)
+        return NULL;
+    uio->fd = open(uio_path, O_RDWR | O_SYNC);
+    if (uio->fd < 0 ||
+        sysfs_map_value(uio_path, 0, "size", &regs_size) != 0 ||
+        sysfs_map_value(uio_path, 1, "size", &buf_size) != 0 ||
+        sysfs_map_value(uio_path, 1, "addr", &uio->buf_phys) != 0 ||
+        buf_size < 2 * INFLATE_SLOTS * ((max_cells + 3) & ~(size_t)3)) {
+        uio_close(uio);
+        return NULL;
+    }
+
+    /* map N of a UIO device is at offset N pages */
+    void *regs = mmap(NULL, regs_size, PROT_READ | PROT_WRITE, MAP_SHARED, uio->fd, 0);
+    void *buf  = mmap(NULL, buf_size, PROT_READ | PROT_WRITE, MAP_SHARED, uio->fd, page);
+    if (regs != MAP_FAILED) {
+        uio->regs      = (volatile uint32_t *)regs;
+        uio->regs_size = regs_size;
+    }
+    if (buf != MAP_FAILED) {
+        uio->buf      = (uint8_t *)buf;
+        uio->buf_size = buf_size;
+    }
+    if (!uio->regs || !uio->buf) {
+        uio_close(uio);
+        return NULL;
+    }
+    uio->array_size = reg_read(uio, INFLATE_REG_CONFIG) & INFLATE_CONFIG_ARRAY_SIZE;
+
+    inflate_backend_t backend = { "uio", uio_configure, uio_load, uio_start, uio_wait, uio_store,
+                                  uio_close, uio };
+    return inflate_open(&backend);
+}
@@ -0,0 +1,80 @@
+#include "kernel_gen.h"
+
+/* log2(e) in Q16.16 : exp(-x) = 2^(-x * log2(e)) */
+#define KGEN_LOG2E 94548u
+
+/* 2^(-i/32) in Q16.16, the hardware interpolates between two entries */
+static const uint32_t kgen_exp2_lut[33] = {
+    65536, 64132, 62757, 61413, 60097, 58809, 57549, 56316,
+    55109, 53928, 52773, 51642, 50535, 49452, 48393, 47356,
+    46341, 45348, 44376, 43425, 42495, 41584, 40693, 39821,
+    38968, 38133, 37316, 36516, 35734, 34968, 34219, 33486,
+    32768
+};
+
+/* floor(sqrt(value)), one result bit at a time */
+static uint32_t kgen_isqrt(uint32_t value)
+{
+    uint32_t root = 0;
+
+    for (int b = 15; b >= 0; b--) {
+        uint32_t trial = root | (1u << b);
+        if ((uint64_t)trial * trial <= value)
+            root = trial;
+    }
+    return root;
+}
+
+static uint32_t kgen_sat32(uint64_t value)
+{
+    return value > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)value;
+}
+
+uint8_t kgen_cost(int dx, int dy, int radius,
+                  uint32_t scale, uint32_t inscribed, uint32_t resolution)
+{
+    uint32_t d2 = (uint32_t)(dx * dx + dy * dy);
+
+    /* outside the inflation radius */
+    if (d2 > (uint32_t)(radius * radius))
+        return 0;
+
+    /* distance in meters, Q16.16 (root is in 1/256 cell) */
+    uint32_t root = kgen_isqrt(d2 << 16);
+    uint64_t dist = ((uint64_t)resolution * root) >> 8;
+
+    if (dist <= inscribed)
+        return KGEN_LETHAL;
+
+    /* 253 * exp(-scale * excess) = 253 * 2^-(n + f) */
+    uint32_t scale_l2e = kgen_sat32(((uint64_t)scale * KGEN_LOG2E) >> 16);
+    uint32_t excess    = kgen_sat32(dist - inscribed);
+    uint64_t y         = ((uint64_t)scale_l2e * excess) >> 16;
+    uint64_t n         = y >> 16;
+
+    if (n >= 8)
+        return 0;
+
+    uint32_t f    = (uint32_t)y & 0xFFFFu;
+    uint32_t i    = f >> 11;
+    uint32_t t    = f & 0x7FFu;
+    uint32_t mant = kgen_exp2_lut[i] - (((kgen_exp2_lut[i] - kgen_exp2_lut[i + 1]) * t) >> 11);
+
+    /*
+     * truncated like the float cast of kernel_compute(), but from the
+     * truncated distance: just past the inscribed radius, where the cost
+     * falls fastest, it may be up to 2 above 253 * expf()
+     */
+    return (uint8_t)((253u * mant) >> (16 + n));
+}
+
+void kgen_kernel(int radius, uint32_t scale, uint32_t inscribed,
+                 uint32_t resolution, uint8_t *kernel)
+{
+    int k = 2 * radius + 1;
+
+    for (int row = 0; row < k; row++)
+        for (int col = 0; col < k; col++)
+            kernel[row * k + col] = kgen_cost(col - radius, row - radius, radius,
+                                              scale, inscribed, resolution);
+}
@@ -0,0 +1,49 @@
+#ifndef INFLATE_KERNEL_GEN_H
+#define INFLATE_KERNEL_GEN_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------- On-chip kernel generator ---------------- */
+/*
+ * With CTRL.bit4 the accelerator computes the inflation kernel itself
+ * (see hardware_impl/kernel_gen.sv) from RADIUS and three Q16.16 registers:
+ *     0x28 KGEN_SCALE      : cost scaling factor (1/m)
+ *     0x2C KGEN_INSCRIBED  : inscribed radius (m)
+ *     0x30 KGEN_RESOLUTION : map resolution (m per cell)
+ * top.v feeds the generated weights to the weight loader in place of the
+ * host streams while KGEN_BUSY: the first kernel after reset lands straight
+ * in the active bank (STATUS.LOADING), every later one in the shadow bank,
+ * swapped in when the next frame starts, like a side channel load.
+ */
+#define KGEN_FRAC_BITS 16
+#define KGEN_LETHAL    254
+
+/* float -> Q16.16 register value, rounded to nearest */
+#define KGEN_FIXED(x) ((uint32_t)((x) * (float)(1u << KGEN_FRAC_BITS) + 0.5f))
+
+/*
+ * Reference generator, identical to the hardware one: cost of the cell
+ * (dx, dy) from the centre of a kernel of the given radius. It follows
+ * kernel_compute() within one cost unit (the cast of the float cost),
+ * except right around the inscribed radius: there the distance is
+ * truncated to 1/256 cell and the cost may be up to 2 off.
+ */
+uint8_t kgen_cost(int dx, int dy, int radius,
+                  uint32_t scale, uint32_t inscribed, uint32_t resolution);
+
+/*
+ * Whole (2*radius+1) x (2*radius+1) kernel, row-major, as the hardware
+ * loads it into the weight bank.
+ */
+void kgen_kernel(int radius, uint32_t scale, uint32_t inscribed,
+                 uint32_t resolution, uint8_t *kernel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INFLATE_KERNEL_GEN_H */
@@ -0,0 +1,46 @@
+#include <string.h>
+
+#include "rle.h"
+
+/* ---------------- Decoder ---------------- */
+long rle_decode(const uint32_t *tokens, size_t num_tokens,
+                uint8_t *cells, size_t num_cells)
+{
+    size_t pos = 0;
+
+    for (size_t t = 0; t < num_tokens; t++) {
+        uint32_t run = RLE_TOKEN_RUN(tokens[t]);
+
+        if (run == 0 || run > num_cells - pos)
+            return -1;
+
+        memset(cells + pos, RLE_TOKEN_COST(tokens[t]), run);
+        pos += run;
+    }
+
+    return (long)pos;
+}
+
+/* ---------------- Reference encoder ---------------- */
+long rle_encode(const uint8_t *cells, size_t num_cells,
+                uint32_t *tokens, size_t max_tokens)
+{
+    size_t n = 0;
+    size_t i = 0;
+
+    while (i < num_cells) {
+        uint8_t  cost = cells[i];
+        uint32_t run  = 1;
+
+        /* extend the run while the cost stays the same */
+        while (i + run < num_cells && cells[i + run] == cost && run < RLE_MAX_RUN)
+            run++;
+
+        if (n == max_tokens)
+            return -1;
+        tokens[n++] = RLE_TOKEN(run, cost);
+        i += run;
+    }
+
+    return (long)n;
+}
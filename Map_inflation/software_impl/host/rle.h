@@ -0,0 +1,37 @@
+#ifndef INFLATE_RLE_H
+#define INFLATE_RLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* ---------------- Run-length output format ---------------- */
+/*
+ * With MODE.bit2 set the accelerator sends one 32-bit token per run of
+ * equal costs (see hardware_impl/rle_encoder.sv):
+ *     bits 31..8 : run length (1 .. RLE_MAX_RUN)
+ *     bits  7..0 : cost of every cell of the run
+ * Runs follow the row-major order of the frame and never go past its last cell.
+ */
+#define RLE_VALUE_BITS 8
+#define RLE_MAX_RUN    ((1u << (32 - RLE_VALUE_BITS)) - 1u)
+
+#define RLE_TOKEN(run, cost) (((uint32_t)(run) << RLE_VALUE_BITS) | (uint8_t)(cost))
+#define RLE_TOKEN_RUN(tok)   ((uint32_t)(tok) >> RLE_VALUE_BITS)
+#define RLE_TOKEN_COST(tok)  ((uint8_t)((tok) & 0xFFu))
+
+/*
+ * Expands num_tokens tokens into at most num_cells costs.
+ * Returns the number of cells written, or -1 if a token has a zero run
+ * or the runs overflow the output buffer.
+ */
+long rle_decode(const uint32_t *tokens, size_t num_tokens,
+                uint8_t *cells, size_t num_cells);
+
+/*
+ * Reference encoder, identical to the hardware one : returns the number of
+ * tokens written, or -1 if max_tokens is too small.
+ */
+long rle_encode(const uint8_t *cells, size_t num_cells,
+                uint32_t *tokens, size_t max_tokens);
+
+#endif /* INFLATE_RLE_H */
@@ -0,0 +1,168 @@
+/*
+ * Host test of the CPU engine (cpu_inflate.c), the results computed in
+ * random bands of rows as the threads of hybrid.c take them:
+ *   - inflation with a zero border, on the cluttered maps of
+ *     generate_random_cluttered_costmap(), against map_inflation_compute()
+ *     (inflation_random.c): the kernel of kgen_kernel() follows the float
+ *     one of kernel_compute() within KGEN_TOLERANCE cost units,
+ *   - every mode and border policy on random maps and kernels, against the
+ *     same window run over a copy of the map with its border written out:
+ *     exactly.
+ *
+ *   gcc -std=c99 -Wall -Wextra -DINFLATION_NO_MAIN -I.. -o test_cpu_inflate test_cpu_inflate.c \
+ *       cpu_inflate.c kernel_gen.c ../inflation_random.c -lm
+ *   ./test_cpu_inflate
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cpu_inflate.h"
+#include "inflation_random.h"
+#include "kernel_gen.h"
+
+#define MAP_CASES      40
+#define CASES          400
+#define MAX_WIDTH      80
+#define MAX_HEIGHT     24
+#define MAX_RADIUS     7
+#define KGEN_TOLERANCE 2   /* 253 vs 254 * exp, truncation, distance near the inscribed radius */
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(uint32_t n)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return (seed >> 8) % n;
+}
+
+static void cpu_bands(const uint8_t *map, uint8_t *out, int width, int height, int radius,
+                      const uint8_t *weights, int inflation, int replicate)
+{
+    for (int y0 = 0, y1; y0 < height; y0 = y1) {
+        y1 = y0 + 1 + (int)rnd((uint32_t)(height - y0));
+        cpu_inflate_rows(map, out, width, height, y0, y1, radius, weights, inflation, replicate);
+    }
+}
+
+/* window over the map with its border of radius cells written out, saturated to 255 */
+static void padded_window(const uint8_t *map, uint8_t *out, int width, int height, int radius,
+                          const uint8_t *weights, int inflation, int replicate)
+{
+    int      k  = 2 * radius + 1;
+    int      pw = width + 2 * radius;
+    uint8_t *padded = (uint8_t *)calloc((size_t)pw * (height + 2 * radius), 1);
+
+    for (int py = 0; py < height + 2 * radius; py++) {
+        for (int px = 0; px < pw; px++) {
+            int x = px - radius, y = py - radius;
+            if (x < 0 || x >= width || y < 0 || y >= height) {
+                if (!replicate)
+                    continue;
+                x = x < 0 ? 0 : (x >= width ? width - 1 : x);
+                y = y < 0 ? 0 : (y >= height ? height - 1 : y);
+            }
+            padded[(size_t)py * pw + px] = map[(size_t)y * width + x];
+        }
+    }
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint32_t acc = inflation ? map[(size_t)y * width + x] : 0;
+            for (int r = 0; r < k; r++) {
+                for (int c = 0; c < k; c++) {
+                    uint8_t cell = padded[(size_t)(y + r) * pw + x + c];
+                    uint8_t w    = weights[r * k + c];
+                    if (!inflation)
+                        acc += (uint32_t)cell * w;
+                    else if (cell == LETHAL_OBSTACLE && w > acc)
+                        acc = w;
+                }
+            }
+            out[(size_t)y * width + x] = (uint8_t)(acc > 255 ? 255 : acc);
+        }
+    }
+    free(padded);
+}
+
+static int map_cases(void)
+{
+    static int     costmap[H][W];
+    static float   inflated[H][W];
+    static uint8_t map[W * H], out[W * H];
+    uint8_t        weights[(2 * MAX_RADIUS + 1) * (2 * MAX_RADIUS + 1)];
+    int            failures = 0;
+
+    srand(1);
+    for (int t = 0; t < MAP_CASES; t++) {
+        int   radius     = (int)rnd(MAX_RADIUS + 1);
+        float resolution = 0.025f * (float)(1 + rnd(4));
+        float inscribed  = resolution * 0.25f * (float)rnd(4 * radius + 1);
+        float scale      = 0.5f + 0.5f * (float)rnd(20);
+
+        generate_random_cluttered_costmap(costmap, 1 + (int)rnd(40), 1 + (int)rnd(5));
+        map_inflation_compute(costmap, scale, radius, inscribed, resolution, inflated);
+
+        for (int y = 0; y < H; y++)
+            for (int x = 0; x < W; x++)
+                map[y * W + x] = (uint8_t)costmap[y][x];
+        kgen_kernel(radius, KGEN_FIXED(scale), KGEN_FIXED(inscribed), KGEN_FIXED(resolution), weights);
+        cpu_bands(map, out, W, H, radius, weights, 1, 0);
+
+        for (int i = 0; i < W * H; i++) {
+            float want = inflated[i / W][i % W];
+            if (fabsf((float)out[i] - want) > KGEN_TOLERANCE) {
+                printf("FAIL map %d (radius %d, scale %.2f, inscribed %.4f, resolution %.3f) : "
+                       "cell (%d, %d) %u, map_inflation_compute %.2f\n",
+                       t, radius, scale, inscribed, resolution, i % W, i / W, out[i], want);
+                failures++;
+                break;
+            }
+        }
+    }
+    return failures;
+}
+
+int main(void)
+{
+    static uint8_t map[MAX_WIDTH * MAX_HEIGHT], out[MAX_WIDTH * MAX_HEIGHT], expected[MAX_WIDTH * MAX_HEIGHT];
+    uint8_t        weights[(2 * MAX_RADIUS + 1) * (2 * MAX_RADIUS + 1)];
+    int            failures = map_cases();
+
+    for (int t = 0; t < CASES; t++) {
+        int width     = 1 + (int)rnd(MAX_WIDTH);
+        int height    = 1 + (int)rnd(MAX_HEIGHT);
+        int radius    = (int)rnd(MAX_RADIUS + 1);
+        int k         = 2 * radius + 1;
+        int inflation = (int)rnd(2);
+        int replicate = (int)rnd(2);
+
+        for (int i = 0; i < width * height; i++)
+            map[i] = inflation ? (rnd(8) == 0 ? LETHAL_OBSTACLE : (uint8_t)rnd(254)) : (uint8_t)rnd(256);
+        for (int i = 0; i < k * k; i++)
+            weights[i] = (uint8_t)rnd(256);
+
+        padded_window(map, expected, width, height, radius, weights, inflation, replicate);
+        cpu_bands(map, out, width, height, radius, weights, inflation, replicate);
+
+        if (memcmp(out, expected, (size_t)width * height) != 0) {
+            for (int i = 0; i < width * height; i++) {
+                if (out[i] != expected[i]) {
+                    printf("FAIL case %d (%dx%d, radius %d, %s, %s) : cell (%d, %d) %u, expected %u\n", t, width,
+                           height, radius, inflation ? "inflation" : "convolution",
+                           replicate ? "replicate" : "zeros", i % width, i / width, out[i], expected[i]);
+                    break;
+                }
+            }
+            failures++;
+        }
+    }
+
+    if (failures) {
+        printf("%d cases failed\n", failures);
+        return 1;
+    }
+    printf("*** ALL TESTS PASSED! ***\n");
+    return 0;
+}
@@ -0,0 +1,173 @@
+/*
+ * Host test of the column tiling (inflate_tile.c): the tiles run through
+ * inflate.c on a backend that computes the centred window of every tile
+ * on its own (cpu_inflate.c, the border policy at the tile edges, like
+ * the accelerator), and the stitched results must be the ones of the
+ * window on the whole map, for random maps, widths, row limits, radii,
+ * modes and border policies. The redundant work of the halos is reported.
+ *
+ *   gcc -std=c99 -D_POSIX_C_SOURCE=200809L -Wall -Wextra -pthread -o test_inflate_tile test_inflate_tile.c \
+ *       inflate_tile.c inflate.c cpu_inflate.c kernel_gen.c -lm
+ *   ./test_inflate_tile
+ */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cpu_inflate.h"
+#include "inflate.h"
+#include "inflate_tile.h"
+#include "kernel_gen.h"
+
+#define CASES      150
+#define MAX_WIDTH  600
+#define MAX_HEIGHT 12
+#define MAX_RADIUS 5
+#define MAX_KERNEL (2 * MAX_RADIUS + 1)
+
+typedef struct {
+    uint8_t weights[MAX_KERNEL * MAX_KERNEL];
+    uint8_t maps[INFLATE_SLOTS][MAX_WIDTH * MAX_HEIGHT];
+    uint8_t results[INFLATE_SLOTS][MAX_WIDTH * MAX_HEIGHT];
+    int     frames;
+    int     max_width;
+} model_t;
+
+static int model_configure(void *ctx, const inflate_params_t *p)
+{
+    model_t *model = (model_t *)ctx;
+
+    if (p->width > model->max_width || p->width * p->height > MAX_WIDTH * MAX_HEIGHT || p->radius > MAX_RADIUS)
+        return -EINVAL;
+    kgen_kernel(p->radius, KGEN_FIXED(p->cost_scaling_factor), KGEN_FIXED(p->inscribed_radius),
+                KGEN_FIXED(p->resolution), model->weights);
+    return 0;
+}
+
+static int model_load(void *ctx, int slot, const uint8_t *map, const inflate_params_t *p)
+{
+    memcpy(((model_t *)ctx)->maps[slot], map, (size_t)p->width * p->height);
+    return 0;
+}
+
+static int model_start(void *ctx, int slot, const inflate_params_t *p)
+{
+    model_t *model = (model_t *)ctx;
+
+    model->frames++;
+    cpu_inflate_rows(model->maps[slot], model->results[slot], p->width, p->height, 0, p->height, p->radius,
+                     model->weights, p->inflation, p->replicate);
+    return 0;
+}
+
+static int model_wait(void *ctx, int slot, const inflate_params_t *p)
+{
+    (void)ctx, (void)slot, (void)p;
+    return 0;
+}
+
+static int model_store(void *ctx, int slot, uint8_t *out, const inflate_params_t *p)
+{
+    memcpy(out, ((model_t *)ctx)->results[slot], (size_t)p->width * p->height);
+    return 0;
+}
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(uint32_t n)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return (seed >> 8) % n;
+}
+
+int main(void)
+{
+    static model_t  model;
+    static uint8_t  map[MAX_WIDTH * MAX_HEIGHT], out[MAX_WIDTH * MAX_HEIGHT], expected[MAX_WIDTH * MAX_HEIGHT];
+    inflate_backend_t backend = {"model", model_configure, model_load, model_start, model_wait, model_store,
+                                 NULL, &model};
+    inflate_dev_t    *dev     = inflate_open(&backend);
+    uint8_t           weights[MAX_KERNEL * MAX_KERNEL];
+    uint64_t          cells = 0, redundant = 0;
+    int               failures = 0, tiled = 0;
+
+    if (!dev) {
+        printf("FAIL : no device\n");
+        return 1;
+    }
+
+    for (int t = 0; t < CASES; t++) {
+        inflate_params_t p = {0, 0, 0, 0, 0, 10.0f, 0.1f, 0.05f};
+        tile_plan_t      plan;
+
+        p.radius    = (int)rnd(MAX_RADIUS + 1);
+        p.inflation = (int)rnd(4) != 0;
+        p.replicate = (int)rnd(2);
+        p.width     = 1 + (int)rnd(MAX_WIDTH);
+        p.height    = 1 + (int)rnd(MAX_HEIGHT);
+
+        int max_width = 2 * p.radius + MAX_WIDTH / TILE_MAX_TILES + 1 + (int)rnd(100);   /* at most TILE_MAX_TILES tiles */
+        model.max_width = max_width;
+
+        if (tile_plan(&plan, p.width, p.height, p.radius, max_width) != 0) {
+            printf("FAIL case %d : no plan for %d columns, radius %d, max %d\n", t, p.width, p.radius, max_width);
+            failures++;
+            continue;
+        }
+        tiled += plan.num_tiles > 1;
+
+        /* the geometry of inflate_tile.h : radius columns of halo on the inner sides, no seam */
+        int ok = plan.in_width <= max_width && plan.tiles[0].out_x0 == 0 &&
+                 plan.tiles[plan.num_tiles - 1].in_x0 + plan.in_width == p.width &&
+                 tile_plan_redundant_cells(&plan) == (uint64_t)(plan.num_tiles * plan.in_width - p.width) * p.height;
+        for (int i = 0; i < plan.num_tiles; i++) {
+            const tile_t *tile = &plan.tiles[i];
+            ok = ok && tile->out_width > 0 && (i == 0 || tile->out_x0 - tile->in_x0 >= p.radius) &&
+                 (i == plan.num_tiles - 1 || (tile->in_x0 + plan.in_width) - (tile->out_x0 + tile->out_width) >= p.radius) &&
+                 (i == 0 || tile->out_x0 == plan.tiles[i - 1].out_x0 + plan.tiles[i - 1].out_width);
+        }
+        if (!ok) {
+            printf("FAIL case %d : plan\n", t);
+            tile_plan_print(stdout, &plan);
+            failures++;
+            continue;
+        }
+
+        for (int i = 0; i < p.width * p.height; i++)
+            map[i] = p.inflation ? (rnd(16) == 0 ? KGEN_LETHAL : (uint8_t)rnd(254)) : (uint8_t)rnd(8);
+        kgen_kernel(p.radius, KGEN_FIXED(p.cost_scaling_factor), KGEN_FIXED(p.inscribed_radius),
+                    KGEN_FIXED(p.resolution), weights);
+        cpu_inflate_rows(map, expected, p.width, p.height, 0, p.height, p.radius, weights, p.inflation, p.replicate);
+        cells     += (uint64_t)p.width * p.height;
+        redundant += tile_plan_redundant_cells(&plan);
+
+        memset(out, 0, sizeof(out));
+        int status = inflate_tiled(dev, map, out, &p, &plan);
+        if (status != 0) {
+            printf("FAIL case %d : inflate_tiled %d\n", t, status);
+            failures++;
+            continue;
+        }
+        for (int i = 0; i < p.width * p.height; i++) {
+            if (out[i] != expected[i]) {
+                printf("FAIL case %d (%dx%d, radius %d, max %d, %s, %s) : cell (%d, %d) %u, whole map %u\n", t,
+                       p.width, p.height, p.radius, max_width, p.inflation ? "inflation" : "convolution",
+                       p.replicate ? "replicate" : "zeros", i % p.width, i / p.width, out[i], expected[i]);
+                tile_plan_print(stdout, &plan);
+                failures++;
+                break;
+            }
+        }
+    }
+
+    inflate_close(dev);
+    printf("%d cases, %d tiled, %d frames, %llu redundant cells (%.1f%% of the maps)\n", CASES, tiled, model.frames,
+           (unsigned long long)redundant, 100.0 * (double)redundant / (double)cells);
+    if (failures) {
+        printf("%d cases failed\n", failures);
+        return 1;
+    }
+    printf("*** ALL TESTS PASSED! ***\n");
+    return 0;
+}
@@ -3,9 +3,16 @@
 #include <math.h>
 #include <time.h>
 
+#include "inflation_random.h"
+
 /* ---------------- Configuration ---------------- */
+/* map size, -DW=.. -DH=.. to build the tests on other maps (inflation_random.h) */
+#ifndef W
 #define W 100
+#endif
+#ifndef H
 #define H 100
+#endif
 #define LETHAL_OBSTACLE 254
 #define FREE_SPACE 0
 
@@ -158,6 +165,8 @@ void print_costmap_float(const char *title, float map[H][W])
 }
 
 /* ---------------- Main ---------------- */
+/* -DINFLATION_NO_MAIN : linked as the reference of the host tests and the RTL regression */
+#ifndef INFLATION_NO_MAIN
 int main(void)
 {
     srand((unsigned int)time(NULL));
@@ -193,3 +202,4 @@ int main(void)
 
     return 0;
 }
+#endif
@@ -0,0 +1,43 @@
+#ifndef INFLATION_RANDOM_H
+#define INFLATION_RANDOM_H
+
+/*
+ * Reference inflation of inflation_random.c, for the host tests and the
+ * RTL regression. Build inflation_random.c with -DINFLATION_NO_MAIN, and
+ * with the same -DW=.. -DH=.. as the code including this header.
+ */
+#ifndef W
+#define W 100
+#endif
+#ifndef H
+#define H 100
+#endif
+#define LETHAL_OBSTACLE 254
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+float kernel_compute(int dx, int dy,
+                     int inflation_radius,
+                     float cost_scaling_factor,
+                     float inscribed_radius,
+                     float resolution);
+
+void map_inflation_compute(
+    int costmap_in[H][W],
+    float cost_scaling_factor,
+    int inflation_radius,
+    float inscribed_radius,
+    float resolution,
+    float inflated_map[H][W]);
+
+void generate_random_cluttered_costmap(int map[H][W],
+                                       int num_clusters,
+                                       int max_radius);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INFLATION_RANDOM_H */